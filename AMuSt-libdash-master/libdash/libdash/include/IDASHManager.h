@@ -35,6 +35,15 @@ namespace dash
              */
             virtual mpd::IMPD* Open (char *path) = 0;
 
+            /**
+             *  Returns a pointer to dash::mpd::IMPD object representing the the information found in the MPD document held in memory
+             *  @param      data    the MPD document
+             *  @param      length  the size of the MPD document in bytes
+             *  @param      url     the URI the MPD document was fetched from, relative <em>BaseURLs</em> are resolved against it
+             *  @return     a pointer to an dash::mpd::IMPD object
+             */
+            virtual mpd::IMPD* Open (const char *data, size_t length, const char *url) = 0;
+
             /**
              *  Frees allocated memory and deletes the DashManager
              */
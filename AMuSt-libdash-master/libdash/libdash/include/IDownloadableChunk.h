@@ -33,7 +33,9 @@ namespace dash
                 virtual ~IDownloadableChunk(){}
 
                 /**
-                 *  Starts the download of this chunk and returns a bool value whether the starting of the download was possible or not
+                 *  Starts the download of this chunk and returns a bool value whether the starting of the download was possible or not.
+                 *  At most 4 chunks download at the same time, further ones are queued in the order they were started.
+                 *  The URI, range and server of the chunk are the ones it has at this call.
                  *  @return     a bool value
                  */
                 virtual bool    StartDownload           ()                              = 0;
@@ -27,6 +27,7 @@
 
 
 #include "adaptation-logic-factory.h"
+#include "representation-ladder.h"
 
 
 #include <iostream>
@@ -48,9 +49,6 @@ namespace player
 {
 
 
-typedef std::map<std::string, IRepresentation*> RepresentationsMap;
-
-
 class AdaptationLogic
 {
 public:
@@ -80,13 +78,19 @@ public:
   IRepresentation*
   GetLowestRepresentation();
 
+  // download bitrate estimated by the player's ThroughputEstimator
+  double
+  GetThroughputEstimate();
+
 protected:
   MultimediaPlayer* m_multimediaPlayer;
   RepresentationsMap* m_availableRepresentations;
+  RepresentationLadder* m_ladder; // shared by the players of the same representations
 
   static AdaptationLogic _staticLogic;
 
   AdaptationLogic()
+    : m_ladder(NULL)
   {
     ENSURE_ADAPTATION_LOGIC_REGISTERED(AdaptationLogic);
   }
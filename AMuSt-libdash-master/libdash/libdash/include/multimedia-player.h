@@ -23,6 +23,7 @@
 
 #include "multimediabuffer.h"
 #include "adaptation-logic.h"
+#include "throughput-estimator.h"
 
 #include <string>
 #include <typeinfo>
@@ -73,9 +74,23 @@ public:
   double
   GetLastDownloadBitRate();
 
+  // takes ownership; without an estimator the last download bitrate is used
+  void
+  SetThroughputEstimator(ThroughputEstimator* estimator);
+
+  void
+  AddDownloadSample(double bytes, double seconds, double now);
+
+  void
+  ResetThroughputEstimate();
+
+  double
+  GetThroughputEstimate();
+
 protected:
   MultimediaBuffer* m_buffer;
   double m_lastBitrate;
+  ThroughputEstimator* m_estimator;
   AdaptationLogic* m_adaptLogic;
   std::map<std::string, IRepresentation*>* m_availableRepresentations;
 };
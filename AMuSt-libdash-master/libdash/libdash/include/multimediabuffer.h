@@ -22,6 +22,7 @@
 #define MULTIMEDIABUFFER_HPP
 
 #include <map>
+#include <deque>
 #include <vector>
 #include "libdash.h"
 
@@ -88,20 +89,43 @@ protected:
   unsigned int toBufferSegmentNumber;
   unsigned int toConsumeSegmentNumber;
 
-  typedef std::map
-  <std::string, /*Representation*/
-  BufferRepresentationEntry
-  >BufferRepresentationEntryMap;
+  struct SlotEntry
+  {
+    unsigned int rep; // interned representation id
+    BufferRepresentationEntry entry;
+  };
+
+  // the representations buffered for one segment, ordered by representation id
+  typedef std::vector<SlotEntry> Slot;
+
+  struct RepresentationState
+  {
+    std::string id;
+    double bufferedSeconds;
+    unsigned int bufferedSegments;
+    unsigned int highestSegmentNr;
+  };
 
-  typedef std::map
-  <int, /*SegmentNumber*/
-  BufferRepresentationEntryMap
-  >MBuffer;
+  // slot i holds segment ringBase + i; empty slots at both ends are dropped
+  std::deque<Slot> ring;
+  unsigned int ringBase;
+  unsigned int bufferedSegments; // non-empty slots
 
-  MBuffer buff;
+  // running sum of the first (lowest id) representation of every buffered segment,
+  // i.e., what getBufferedSeconds() returns
+  double bufferedSeconds;
+
+  std::map<std::string, unsigned int> repIndex;
+  std::vector<RepresentationState> reps;
 
   BufferRepresentationEntry getHighestConsumableRepresentation(int segmentNumber);
 
+  Slot* findSlot(unsigned int segmentNumber);
+  Slot& getSlot(unsigned int segmentNumber);
+  int findRepresentation(const std::string& repId) const;
+  unsigned int internRepresentation(const std::string& repId);
+  unsigned int scanHighestBufferedSegmentNr(unsigned int rep);
+
 };
 }
 }
@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Christian Kreuzberger and Daniel Posch, Alpen-Adria-University
+ * Klagenfurt
+ *
+ * This file is part of amus-ndnSIM, based on ndnSIM. See AUTHORS for complete list of
+ * authors and contributors.
+ *
+ * amus-ndnSIM and ndnSIM are free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * amus-ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * amus-ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef DASH_REPRESENTATION_LADDER
+#define DASH_REPRESENTATION_LADDER
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "libdash.h"
+
+using namespace dash::mpd;
+
+namespace dash
+{
+namespace player
+{
+
+typedef std::map<std::string, IRepresentation*> RepresentationsMap;
+
+/*
+ * The available representations of a player, sorted by bandwidth, with
+ * everything an adaptation logic needs per segment request read out of the
+ * MPD once. Representations of equal bandwidth keep the order of their ids,
+ * so the lookups pick the same representation as a scan over the
+ * RepresentationsMap would.
+ *
+ * Players that offer the same representations share one ladder, see
+ * Acquire() and Release().
+ */
+class RepresentationLadder
+{
+public:
+  struct Step
+  {
+    IRepresentation* rep;
+    unsigned int bandwidth;
+    double segmentDuration; // seconds
+    const std::vector<ISegmentURL*>* segmentURLs; // NULL without a segment list
+  };
+
+  static RepresentationLadder* Acquire(const RepresentationsMap* availableRepresentations);
+  static void Release(RepresentationLadder* ladder);
+
+  // highest bandwidth strictly below bitrate, NULL if there is none
+  const Step* GetHighestBelow(double bitrate) const;
+  // lowest bandwidth strictly between low and high, NULL if there is none
+  const Step* GetLowestBetween(double low, double high) const;
+
+  // the representation with the smallest id
+  const Step* GetFirst() const;
+  const Step* Find(const IRepresentation* rep) const;
+
+  // segments of the first representation; all are assumed to have as many
+  unsigned int GetTotalSegments() const;
+
+  ISegmentURL* GetSegmentURL(const Step* step, unsigned int segmentNr) const;
+
+  size_t GetSize() const;
+
+  static size_t GetNLadders();
+
+private:
+  RepresentationLadder(const RepresentationsMap* availableRepresentations);
+
+  typedef std::vector<const IRepresentation*> Key;
+  struct Entry
+  {
+    RepresentationLadder* ladder;
+    unsigned int refs;
+  };
+
+  static std::map<Key, Entry> m_ladders;
+
+  Key m_key;
+  std::vector<Step> m_steps; // by bandwidth, then id
+  std::map<const IRepresentation*, unsigned int> m_index;
+  unsigned int m_first;
+  unsigned int m_totalSegments;
+};
+
+}
+}
+
+#endif // DASH_REPRESENTATION_LADDER
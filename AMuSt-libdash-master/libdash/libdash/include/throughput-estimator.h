@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Christian Kreuzberger and Daniel Posch, Alpen-Adria-University
+ * Klagenfurt
+ *
+ * This file is part of amus-ndnSIM, based on ndnSIM. See AUTHORS for complete list of
+ * authors and contributors.
+ *
+ * amus-ndnSIM and ndnSIM are free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * amus-ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * amus-ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef DASH_THROUGHPUT_ESTIMATOR
+#define DASH_THROUGHPUT_ESTIMATOR
+
+#include <deque>
+#include <string>
+
+
+namespace dash
+{
+namespace player
+{
+
+/*
+ * Estimates the download bitrate of a player from its finished downloads.
+ * A sample is the size of a download, how long it took and when it
+ * finished; estimates are in bit/s and 0 until there is a sample.
+ */
+class ThroughputEstimator
+{
+public:
+  virtual ~ThroughputEstimator() {}
+
+  virtual std::string GetName() const = 0;
+
+  virtual void AddSample(double bytes, double seconds, double now) = 0;
+  virtual double GetEstimate() const = 0;
+  virtual void Reset() = 0;
+};
+
+
+// exponentially weighted moving average of the download bitrates
+class EwmaThroughputEstimator : public ThroughputEstimator
+{
+public:
+  EwmaThroughputEstimator(double weight);
+
+  virtual std::string GetName() const
+  {
+    return "dash::player::EwmaThroughputEstimator";
+  }
+
+  virtual void AddSample(double bytes, double seconds, double now);
+  virtual double GetEstimate() const;
+  virtual void Reset();
+
+protected:
+  double m_weight; // of the newest sample
+  double m_estimate;
+  bool m_hasSample;
+};
+
+
+// harmonic mean of the last download bitrates, which keeps single fast
+// downloads from pulling the estimate up
+class HarmonicMeanThroughputEstimator : public ThroughputEstimator
+{
+public:
+  HarmonicMeanThroughputEstimator(unsigned int samples);
+
+  virtual std::string GetName() const
+  {
+    return "dash::player::HarmonicMeanThroughputEstimator";
+  }
+
+  virtual void AddSample(double bytes, double seconds, double now);
+  virtual double GetEstimate() const;
+  virtual void Reset();
+
+protected:
+  unsigned int m_samples;
+  std::deque<double> m_inverseRates; // 1/bitrate of the last downloads
+  double m_inverseSum;
+};
+
+
+// bytes received over the time spent downloading within the last seconds,
+// so long downloads weigh more than short ones and idle time does not count
+class SlidingWindowThroughputEstimator : public ThroughputEstimator
+{
+public:
+  SlidingWindowThroughputEstimator(double window);
+
+  virtual std::string GetName() const
+  {
+    return "dash::player::SlidingWindowThroughputEstimator";
+  }
+
+  virtual void AddSample(double bytes, double seconds, double now);
+  virtual double GetEstimate() const;
+  virtual void Reset();
+
+protected:
+  struct Download
+  {
+    double start;
+    double end;
+    double bytes;
+  };
+
+  double m_window; // seconds
+  std::deque<Download> m_downloads; // by end time
+};
+
+}
+}
+
+#endif // DASH_THROUGHPUT_ESTIMATOR
@@ -40,11 +40,11 @@ AlwaysLowestAdaptationLogic::GetNextSegment(unsigned int *requested_segment_numb
     return NULL; // everything downloaded
   }
 
-  IRepresentation* rep = GetLowestRepresentation();
-  *usedRepresentation = rep;
+  const RepresentationLadder::Step* rep = m_ladder->GetFirst();
+  *usedRepresentation = rep->rep;
   *requested_segment_number = currentSegmentNumber;
   *hasDownloadedAllSegments = false;
-  return rep->GetSegmentList()->GetSegmentURLs().at(currentSegmentNumber++);
+  return m_ladder->GetSegmentURL(rep, currentSegmentNumber++);
 }
 
 }
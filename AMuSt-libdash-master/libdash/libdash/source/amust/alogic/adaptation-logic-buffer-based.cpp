@@ -21,6 +21,8 @@
 #include "adaptation-logic-buffer-based.h"
 #include "multimedia-player.h"
 
+#include <algorithm>
+
 
 namespace dash
 {
@@ -41,80 +43,49 @@ BufferBasedAdaptationLogic::GetNextSegment(unsigned int *requested_segment_numbe
     return NULL; // everything downloaded
   }
 
-  const IRepresentation* useRep = NULL;;
+  const RepresentationLadder::Step* useRep = NULL;
 
   double speed_of_last_rep = 0.0;
 
-  double cur_download_speed = this->m_multimediaPlayer->GetLastDownloadBitRate();
+  double cur_download_speed = GetThroughputEstimate();
 
 
   if (lastUsedRep != NULL)
   {
-    speed_of_last_rep = lastUsedRep->GetBandwidth();
+    speed_of_last_rep = lastUsedRep->bandwidth;
     useRep = lastUsedRep;
 
 
     if (this->m_multimediaPlayer->GetBufferLevel() < 8) {
       // whatever representation it is, decrease it
-      double highest_bitrate = 0.0;
-
-      RepresentationsMap::iterator it;
-
-      // for (auto& keyValue : *(this->m_availableRepresentations))
-      for ( it = m_availableRepresentations->begin(); it != m_availableRepresentations->end(); it++)
-      {
-        const IRepresentation* rep = it->second;
-        // std::cerr << "Rep=" << keyValue.first << " has bitrate " << rep->GetBandwidth() << std::endl;
-        if (rep->GetBandwidth() < speed_of_last_rep && rep->GetBandwidth() < cur_download_speed)
-        {
-          if (rep->GetBandwidth() > highest_bitrate)
-          {
-            useRep = rep;
-            highest_bitrate = rep->GetBandwidth();
-          }
-        }
-      }
+      const RepresentationLadder::Step* lower = m_ladder->GetHighestBelow(std::min(speed_of_last_rep, cur_download_speed));
+      if (lower != NULL)
+        useRep = lower;
 
     } else if (this->m_multimediaPlayer->GetBufferLevel() < 14) {
       // stay at this representation, do not modify userep
     } else { // >= 16
       // time to increase to the next best representation
       fprintf(stderr, "trying to increase from %f\n", speed_of_last_rep);
-      double highest_bitrate = 999999999.99;
-
-      RepresentationsMap::iterator it;
-
-      // for (auto& keyValue : *(this->m_availableRepresentations))
-      for ( it = m_availableRepresentations->begin(); it != m_availableRepresentations->end(); it++)
-      {
-        const IRepresentation* rep = it->second;
-        // std::cerr << "Rep=" << keyValue.first << " has bitrate " << rep->GetBandwidth() << std::endl;
-        if (rep->GetBandwidth() > speed_of_last_rep && rep->GetBandwidth() < cur_download_speed)
-        {
-          if (rep->GetBandwidth() < highest_bitrate)
-          {
-            useRep = rep;
-            highest_bitrate = rep->GetBandwidth();
-          }
-        }
-      }
+      const RepresentationLadder::Step* higher = m_ladder->GetLowestBetween(speed_of_last_rep, std::min(cur_download_speed, 999999999.99));
+      if (higher != NULL)
+        useRep = higher;
     }
   }
 
 
   if (useRep == NULL) // fallback
-    useRep = GetLowestRepresentation();
+    useRep = m_ladder->GetFirst();
 
-  //std::cerr << "Representation used: " << useRep->GetId() << std::endl;
+  //std::cerr << "Representation used: " << useRep->rep->GetId() << std::endl;
 
-  //IRepresentation* rep = (this->m_availableRepresentations->begin()->second);
-  *usedRepresentation = useRep;
+  *usedRepresentation = useRep->rep;
   *requested_segment_number = currentSegmentNumber;
   *hasDownloadedAllSegments = false;
   lastUsedRep = useRep;
 
 
-  return useRep->GetSegmentList()->GetSegmentURLs().at(currentSegmentNumber++);
+  return m_ladder->GetSegmentURL(useRep, currentSegmentNumber++);
 }
 
 }
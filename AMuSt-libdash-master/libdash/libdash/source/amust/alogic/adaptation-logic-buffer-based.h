@@ -59,7 +59,7 @@ protected:
   }
 
   unsigned int currentSegmentNumber;
-  const IRepresentation* lastUsedRep;
+  const RepresentationLadder::Step* lastUsedRep;
 
 };
 }
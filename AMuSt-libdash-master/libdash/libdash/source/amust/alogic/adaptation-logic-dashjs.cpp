@@ -41,51 +41,33 @@ DASHJSAdaptationLogic::GetNextSegment(unsigned int *requested_segment_number,
     return NULL; // everything downloaded
   }
 
-  const IRepresentation* useRep = NULL;;
+  const RepresentationLadder::Step* useRep = NULL;
 
   double factor = 1.0;
 
 
 
 
-  double cur_download_speed = this->m_multimediaPlayer->GetLastDownloadBitRate();
+  double cur_download_speed = GetThroughputEstimate();
 
 
   double weighted_download_speed = (0.35*previousDownloadSpeed + 0.65*cur_download_speed);
 
-  double highest_bitrate = 0.0;
-
-  RepresentationsMap::iterator it;
-
-  // for (auto& keyValue : *(this->m_availableRepresentations))
-  for ( it = m_availableRepresentations->begin(); it != m_availableRepresentations->end(); it++)
-  {
-    const IRepresentation* rep = it->second;
-    // std::cerr << "Rep=" << keyValue.first << " has bitrate " << rep->GetBandwidth() << std::endl;
-    if (rep->GetBandwidth() < weighted_download_speed*factor)
-    {
-      if (rep->GetBandwidth() > highest_bitrate)
-      {
-        useRep = rep;
-        highest_bitrate = rep->GetBandwidth();
-      }
-    }
-  }
+  useRep = m_ladder->GetHighestBelow(weighted_download_speed*factor);
 
   if (useRep == NULL) // fallback
-    useRep = GetLowestRepresentation();
+    useRep = m_ladder->GetFirst();
 
-  //std::cerr << "Representation used: " << useRep->GetId() << std::endl;
+  //std::cerr << "Representation used: " << useRep->rep->GetId() << std::endl;
 
-  //IRepresentation* rep = (this->m_availableRepresentations->begin()->second);
-  *usedRepresentation = useRep;
+  *usedRepresentation = useRep->rep;
   *requested_segment_number = currentSegmentNumber;
   *hasDownloadedAllSegments = false;
 
   // remember previousDownloadSpeed
   previousDownloadSpeed = weighted_download_speed;
 
-  return useRep->GetSegmentList()->GetSegmentURLs().at(currentSegmentNumber++);
+  return m_ladder->GetSegmentURL(useRep, currentSegmentNumber++);
 }
 
 }
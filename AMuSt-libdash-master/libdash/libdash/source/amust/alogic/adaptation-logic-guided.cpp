@@ -33,7 +33,7 @@ ISegmentURL*
 GuidedAdaptationLogic::GetNextSegment(unsigned int *requested_segment_number, const dash::mpd::IRepresentation **usedRepresentation, bool *hasDownloadedAllSegments)
 {
   //TODO: read from file
-  double last_download_speed = this->m_multimediaPlayer->GetLastDownloadBitRate();
+  double last_download_speed = GetThroughputEstimate();
 
   if(currentSegmentNumber < getTotalSegments ())
     *hasDownloadedAllSegments = false;
@@ -32,7 +32,7 @@ ENSURE_ADAPTATION_LOGIC_INITIALIZED(RateBasedAdaptationLogic)
 ISegmentURL*
 RateBasedAdaptationLogic::GetNextSegment(unsigned int *requested_segment_number, const dash::mpd::IRepresentation **usedRepresentation, bool *hasDownloadedAllSegments)
 {
-  double last_download_speed = this->m_multimediaPlayer->GetLastDownloadBitRate();
+  double last_download_speed = GetThroughputEstimate();
 
   if(currentSegmentNumber < getTotalSegments ())
     *hasDownloadedAllSegments = false;
@@ -43,35 +43,15 @@ RateBasedAdaptationLogic::GetNextSegment(unsigned int *requested_segment_number,
   }
 
 
-  const IRepresentation* useRep = NULL;
-
-  double highest_bitrate = 0.0;
-
-
-  RepresentationsMap::iterator it;
-
-  // for (auto& keyValue : *(this->m_availableRepresentations))
-  for ( it = m_availableRepresentations->begin(); it != m_availableRepresentations->end(); it++)
-  {
-    const IRepresentation* rep = it->second;
-    if (rep->GetBandwidth() < last_download_speed)
-    {
-      if (rep->GetBandwidth() > highest_bitrate)
-      {
-        useRep = rep;
-        highest_bitrate = rep->GetBandwidth();
-      }
-    }
-  }
+  const RepresentationLadder::Step* useRep = m_ladder->GetHighestBelow(last_download_speed);
 
   if (useRep == NULL)
-    useRep = GetLowestRepresentation();
+    useRep = m_ladder->GetFirst();
 
-  //IRepresentation* rep = (this->m_availableRepresentations->begin()->second);
-  *usedRepresentation = useRep;
+  *usedRepresentation = useRep->rep;
   *requested_segment_number = currentSegmentNumber;
   *hasDownloadedAllSegments = false;
-  return useRep->GetSegmentList()->GetSegmentURLs().at(currentSegmentNumber++);
+  return m_ladder->GetSegmentURL(useRep, currentSegmentNumber++);
 }
 }
 
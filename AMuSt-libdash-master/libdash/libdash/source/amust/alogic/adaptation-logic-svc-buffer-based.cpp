@@ -57,7 +57,7 @@ AbstractSVCBufferBasedAdaptationLogic::GetNextSegment(unsigned int* requested_se
         *requested_segment_number = next_segment_number;
         *usedRepresentation = m_orderdByDepIdReps[i];
         *hasDownloadedAllSegments = false;
-        return m_orderdByDepIdReps[i]->GetSegmentList()->GetSegmentURLs().at(next_segment_number);
+        return m_ladder->GetSegmentURL(m_layers[i], next_segment_number);
       }
       else
         *hasDownloadedAllSegments = true;
@@ -81,7 +81,7 @@ AbstractSVCBufferBasedAdaptationLogic::GetNextSegment(unsigned int* requested_se
         *requested_segment_number = next_segment_number;
         *usedRepresentation = m_orderdByDepIdReps[i];
         *hasDownloadedAllSegments = false;
-        return m_orderdByDepIdReps[i]->GetSegmentList()->GetSegmentURLs().at(next_segment_number);
+        return m_ladder->GetSegmentURL(m_layers[i], next_segment_number);
       }
       else
         *hasDownloadedAllSegments = true;
@@ -104,7 +104,7 @@ AbstractSVCBufferBasedAdaptationLogic::GetNextSegment(unsigned int* requested_se
       *requested_segment_number = next_segment_number;
       *usedRepresentation = m_orderdByDepIdReps[i];
       *hasDownloadedAllSegments = false;
-      return m_orderdByDepIdReps[i]->GetSegmentList()->GetSegmentURLs().at(next_segment_number);
+      return m_ladder->GetSegmentURL(m_layers[i], next_segment_number);
     }
     else
       *hasDownloadedAllSegments = true;
@@ -119,10 +119,12 @@ AbstractSVCBufferBasedAdaptationLogic::SetAvailableRepresentations(std::map<std:
 {
   AdaptationLogic::SetAvailableRepresentations (availableRepresentations);
   orderRepresentationsByDepIds();
+  m_layers.clear();
+  for (std::map<int, IRepresentation*>::iterator it = m_orderdByDepIdReps.begin(); it != m_orderdByDepIdReps.end(); ++it)
+    m_layers.push_back(m_ladder->Find(it->second));
 
   //calc typical segment duration (we assume all reps have the same duration..)
-  segment_duration = (double) m_orderdByDepIdReps.begin()->second->GetSegmentList()->GetDuration();
-  segment_duration /= (double) m_orderdByDepIdReps.begin()->second->GetSegmentList()->GetTimescale ();
+  segment_duration = m_layers.front()->segmentDuration;
 }
 
 //this functions classifies reps into layers depending on the DepIds.
@@ -67,6 +67,7 @@ protected:
   unsigned int getNextNeededSegmentNumber(int layer);
 
   std::map<int /*level*/, IRepresentation*> m_orderdByDepIdReps;
+  std::vector<const RepresentationLadder::Step*> m_layers; // ladder steps of m_orderdByDepIdReps
 
   double alpha;
   int gamma; //BUFFER_MIN_SIZE
@@ -71,15 +71,13 @@ SVCRateBasedAdaptationLogic::GetNextSegment(unsigned int *requested_segment_numb
     double highest_bitrate = 0.0;
     for (std::map<int /*level/layer*/, IRepresentation*>::iterator it = m_orderdByDepIdReps.begin (); it != m_orderdByDepIdReps.end (); ++it)
     {
-      const IRepresentation* rep = it->second;
-      //std::cerr << "Rep=" << keyValue.first << " has bitrate " << rep->GetBandwidth() << std::endl;
-      if (rep->GetBandwidth() < max_allowed_bitrate)
+      unsigned int bandwidth = m_layers[it->first]->bandwidth;
+      if (bandwidth < max_allowed_bitrate)
       {
-        if (rep->GetBandwidth() > highest_bitrate)
+        if (bandwidth > highest_bitrate)
         {
-          //useRep = rep;
           layerForRep = it->first;
-          highest_bitrate = rep->GetBandwidth();
+          highest_bitrate = bandwidth;
         }
       }
     }
@@ -106,12 +104,12 @@ SVCRateBasedAdaptationLogic::GetNextSegment(unsigned int *requested_segment_numb
   if(repsForCurSegment.empty ())
     curSegmentNumber++; // then increase segment number
 
-  return (*usedRepresentation)->GetSegmentList()->GetSegmentURLs().at(*requested_segment_number);
+  return m_ladder->GetSegmentURL(m_ladder->Find(*usedRepresentation), *requested_segment_number);
 }
 
 void SVCRateBasedAdaptationLogic::updateEMA ()
 {
-  ema_download_bitrate = m_multimediaPlayer->GetLastDownloadBitRate() * RateBasedEMA_W + (1-RateBasedEMA_W) * ema_download_bitrate;
+  ema_download_bitrate = GetThroughputEstimate() * RateBasedEMA_W + (1-RateBasedEMA_W) * ema_download_bitrate;
 }
 
 bool SVCRateBasedAdaptationLogic::hasMinBufferLevel(const dash::mpd::IRepresentation*)
@@ -158,10 +156,12 @@ SVCRateBasedAdaptationLogic::SetAvailableRepresentations(std::map<std::string, I
 {
   AdaptationLogic::SetAvailableRepresentations (availableRepresentations);
   orderRepresentationsByDepIds();
+  m_layers.clear();
+  for (std::map<int, IRepresentation*>::iterator it = m_orderdByDepIdReps.begin(); it != m_orderdByDepIdReps.end(); ++it)
+    m_layers.push_back(m_ladder->Find(it->second));
 
   //calc typical segment duration (we assume all reps have the same duration..)
-  segment_duration = (double) m_orderdByDepIdReps.begin()->second->GetSegmentList()->GetDuration();
-  segment_duration /= (double) m_orderdByDepIdReps.begin()->second->GetSegmentList()->GetTimescale ();
+  segment_duration = m_layers.front()->segmentDuration;
 }
 
 //this functions classifies reps into layers depending on the DepIds.
@@ -75,6 +75,7 @@ protected:
   bool hasMinBufferLevel();
 
   std::map<int /*level/layer*/, IRepresentation*> m_orderdByDepIdReps;
+  std::vector<const RepresentationLadder::Step*> m_layers; // ladder steps of m_orderdByDepIdReps
 
   //unsigned int getNextNeededSegmentNumber(int layer);
   unsigned int curSegmentNumber;
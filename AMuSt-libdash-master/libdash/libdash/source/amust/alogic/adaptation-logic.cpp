@@ -30,6 +30,7 @@ ENSURE_ADAPTATION_LOGIC_INITIALIZED(AdaptationLogic)
 
 
 AdaptationLogic::AdaptationLogic(MultimediaPlayer* mPlayer)
+  : m_ladder(NULL)
 {
   this->m_multimediaPlayer = mPlayer;
 }
@@ -38,7 +39,8 @@ AdaptationLogic::AdaptationLogic(MultimediaPlayer* mPlayer)
 
 AdaptationLogic::~AdaptationLogic()
 {
-
+  if (m_ladder != NULL)
+    RepresentationLadder::Release(m_ladder);
 }
 
 
@@ -46,6 +48,10 @@ void
 AdaptationLogic::SetAvailableRepresentations(std::map<std::string, IRepresentation*>* availableRepresentations)
 {
   this->m_availableRepresentations = availableRepresentations;
+
+  if (m_ladder != NULL)
+    RepresentationLadder::Release(m_ladder);
+  m_ladder = RepresentationLadder::Acquire(availableRepresentations);
 }
 
 
@@ -63,13 +69,21 @@ AdaptationLogic::GetNextSegment(unsigned int *requested_segment_number, const da
 IRepresentation*
 AdaptationLogic::GetLowestRepresentation()
 {
-    return (this->m_availableRepresentations->begin()->second);
+    return m_ladder->GetFirst()->rep;
+}
+
+double
+AdaptationLogic::GetThroughputEstimate()
+{
+  return m_multimediaPlayer->GetThroughputEstimate();
 }
 
 // we assume that in all represntation the same amount of segments exists..
 unsigned int AdaptationLogic::getTotalSegments()
 {
-  return m_availableRepresentations->begin()->second->GetSegmentList ()->GetSegmentURLs().size();
+  if (m_ladder == NULL)
+    return 0;
+  return m_ladder->GetTotalSegments();
 }
 
 bool AdaptationLogic::hasMinBufferLevel(const dash::mpd::IRepresentation* rep)
@@ -73,7 +73,7 @@ SVCNoAdaptationLogic::GetNextSegment(unsigned int *requested_segment_number, con
     *requested_segment_number = next_segment_number;
     *usedRepresentation = m_orderdByDepIdReps[chosen_layer];
     *hasDownloadedAllSegments = false;
-    return m_orderdByDepIdReps[chosen_layer]->GetSegmentList()->GetSegmentURLs().at(next_segment_number);
+    return m_ladder->GetSegmentURL(m_layers[chosen_layer], next_segment_number);
   }
 
   *hasDownloadedAllSegments = true;
@@ -92,6 +92,9 @@ void SVCNoAdaptationLogic::SetAvailableRepresentations(std::map<std::string, IRe
 {
   AdaptationLogic::SetAvailableRepresentations (availableRepresentations);
   orderRepresentationsByDepIds();
+  m_layers.clear();
+  for (std::map<int, IRepresentation*>::iterator it = m_orderdByDepIdReps.begin(); it != m_orderdByDepIdReps.end(); ++it)
+    m_layers.push_back(m_ladder->Find(it->second));
 }
 
 unsigned int SVCNoAdaptationLogic::getNextNeededSegmentNumber(int layer)
@@ -66,6 +66,7 @@ protected:
   unsigned int currentSegmentNumber;
 
   std::map<int /*level*/, IRepresentation*> m_orderdByDepIdReps;
+  std::vector<const RepresentationLadder::Step*> m_layers; // ladder steps of m_orderdByDepIdReps
 
   SVCNoAdaptationLogic()
   {
@@ -45,12 +45,16 @@ MultimediaPlayer::~MultimediaPlayer()
   if(m_buffer)
     delete(m_buffer);
   m_buffer = NULL;
+
+  delete m_estimator;
+  m_estimator = NULL;
 }
 
 MultimediaPlayer::MultimediaPlayer(std::string AdaptationLogicStr, unsigned int maxBufferedSeconds)
 {
   m_buffer = new MultimediaBuffer(maxBufferedSeconds);
   m_lastBitrate = 0;
+  m_estimator = NULL;
   AdaptationLogic* aLogic = AdaptationLogicFactory::Create(AdaptationLogicStr, this);
 
   if (aLogic == NULL)
@@ -151,5 +155,38 @@ MultimediaPlayer::GetLastDownloadBitRate()
 }
 
 
+void
+MultimediaPlayer::SetThroughputEstimator(ThroughputEstimator* estimator)
+{
+  delete m_estimator;
+  m_estimator = estimator;
+}
+
+
+void
+MultimediaPlayer::AddDownloadSample(double bytes, double seconds, double now)
+{
+  if (m_estimator)
+    m_estimator->AddSample(bytes, seconds, now);
+}
+
+
+void
+MultimediaPlayer::ResetThroughputEstimate()
+{
+  if (m_estimator)
+    m_estimator->Reset();
+}
+
+
+double
+MultimediaPlayer::GetThroughputEstimate()
+{
+  if (m_estimator)
+    return m_estimator->GetEstimate();
+  return this->m_lastBitrate;
+}
+
+
 }
 }
@@ -31,11 +31,15 @@ MultimediaBuffer::MultimediaBuffer(unsigned int maxBufferedSeconds)
 
   toBufferSegmentNumber = 0;
   toConsumeSegmentNumber = 0;
+
+  ringBase = 0;
+  bufferedSegments = 0;
+  bufferedSeconds = 0.0;
 }
 
 MultimediaBuffer::~MultimediaBuffer()
 {
-  buff.clear();
+  ring.clear();
 }
 
 bool MultimediaBuffer::addToBuffer(unsigned int segmentNumber, const dash::mpd::IRepresentation* usedRepresentation, float experiencedDownloadBitrate)
@@ -53,18 +57,20 @@ bool MultimediaBuffer::addToBuffer(unsigned int segmentNumber, const dash::mpd::
   // Check if segment has depIds
   if(usedRepresentation->GetDependencyId ().size() > 0)
   {
-    // if so find the correct map
-    MBuffer::iterator it = buff.find (segmentNumber);
-    if(it == buff.end ())
+    // if so find the correct slot
+    Slot* slot = findSlot (segmentNumber);
+    if(slot == NULL)
       return false;
 
-    BufferRepresentationEntryMap map = it->second;
-
     for(std::vector<std::string>::const_iterator k = usedRepresentation->GetDependencyId ().begin ();
         k !=  usedRepresentation->GetDependencyId ().end (); k++)
     {
       //depId not found we can not add this layer
-      if(map.find ((*k)) == map.end ())
+      int dep = findRepresentation (*k);
+      bool found = false;
+      for(Slot::iterator e = slot->begin (); dep >= 0 && e != slot->end (); ++e)
+        found |= (e->rep == (unsigned int) dep);
+      if(!found)
       {
         //fprintf(stderr, "Could not find '%s' in map\n", (*k).c_str());
         return false;
@@ -81,15 +87,43 @@ bool MultimediaBuffer::addToBuffer(unsigned int segmentNumber, const dash::mpd::
   // Add segment to buffer
   //fprintf(stderr, "Inserted something for Segment %d in Buffer\n", segmentNumber);
 
-  MultimediaBuffer::BufferRepresentationEntry entry;
-  entry.repId = usedRepresentation->GetId ();
-  entry.segmentDuration = duration;
-  entry.segmentNumber = segmentNumber;
-  entry.depIds = usedRepresentation->GetDependencyId ();
-  entry.bitrate_bit_s = usedRepresentation->GetBandwidth ();
-  entry.experienced_bitrate_bit_s = (unsigned int) experiencedDownloadBitrate;
+  SlotEntry added;
+  added.rep = internRepresentation (usedRepresentation->GetId ());
+  added.entry.repId = usedRepresentation->GetId ();
+  added.entry.segmentDuration = duration;
+  added.entry.segmentNumber = segmentNumber;
+  added.entry.depIds = usedRepresentation->GetDependencyId ();
+  added.entry.bitrate_bit_s = usedRepresentation->GetBandwidth ();
+  added.entry.experienced_bitrate_bit_s = (unsigned int) experiencedDownloadBitrate;
+
+  Slot& slot = getSlot (segmentNumber);
+  if(slot.empty ())
+    bufferedSegments++;
+  else
+    bufferedSeconds -= slot.front ().entry.segmentDuration;
+
+  // keep the slot ordered by representation id, replacing an entry of the same representation
+  Slot::iterator pos = slot.begin ();
+  while(pos != slot.end () && pos->entry.repId < added.entry.repId)
+    ++pos;
+
+  RepresentationState& rep = reps[added.rep];
+  if(pos != slot.end () && pos->rep == added.rep)
+  {
+    rep.bufferedSeconds -= pos->entry.segmentDuration;
+    *pos = added;
+  }
+  else
+  {
+    slot.insert (pos, added);
+    rep.bufferedSegments++;
+  }
+  rep.bufferedSeconds += duration;
+  if(rep.highestSegmentNr < segmentNumber)
+    rep.highestSegmentNr = segmentNumber;
+
+  bufferedSeconds += slot.front ().entry.segmentDuration;
 
-  buff[segmentNumber][usedRepresentation->GetId ()] = entry;
   toBufferSegmentNumber++;
   return true;
 }
@@ -145,43 +179,26 @@ bool MultimediaBuffer::isEmpty()
 /** get buffered seconds from all segments */
 double MultimediaBuffer::getBufferedSeconds()
 {
-  double bufferSize = 0.0;
-
-  for(MBuffer::iterator it = buff.begin (); it != buff.end (); ++it)
-    bufferSize += it->second.begin()->second.segmentDuration;
-
-  //fprintf(stderr, "BufferSize for lowestRep = %f\n", bufferSize);
-  return bufferSize;
+  //fprintf(stderr, "BufferSize for lowestRep = %f\n", bufferedSeconds);
+  return bufferedSeconds;
 }
 
 /** get buffered seconds only from segments belonging to the representation id repId */
 double MultimediaBuffer::getBufferedSeconds(std::string repId)
 {
-  double bufferSize = 0.0;
-  for(MBuffer::iterator it = buff.begin (); it != buff.end (); ++it)
-  {
-    BufferRepresentationEntryMap::iterator k = it->second.find(repId);
-    if(k != it->second.end())
-    {
-      bufferSize += k->second.segmentDuration;
-    }
-  }
-  //fprintf(stderr, "BufferSize for rep[%s] = %f\n", repId.c_str (),bufferSize);
-  return bufferSize;
+  int rep = findRepresentation (repId);
+  if(rep < 0)
+    return 0.0;
+  //fprintf(stderr, "BufferSize for rep[%s] = %f\n", repId.c_str (),reps[rep].bufferedSeconds);
+  return reps[rep].bufferedSeconds;
 }
 
 unsigned int MultimediaBuffer::getHighestBufferedSegmentNr(std::string repId)
 {
-  //std::map should be orderd based on operator<, so iterate from the back
-  for(MBuffer::reverse_iterator it = buff.rbegin (); it != buff.rend (); ++it)
-  {
-    BufferRepresentationEntryMap::iterator k = it->second.find(repId);
-    if(k != it->second.end())
-    {
-      return k->second.segmentNumber;
-    }
-  }
-  return 0;
+  int rep = findRepresentation (repId);
+  if(rep < 0)
+    return 0;
+  return reps[rep].highestSegmentNr;
 }
 
 
@@ -192,15 +209,48 @@ MultimediaBuffer::BufferRepresentationEntry MultimediaBuffer::consumeFromBuffer(
   if(isEmpty())
     return entryConsumed;
 
-  MBuffer::iterator it = buff.find (toConsumeSegmentNumber);
-  if(it == buff.end ())
+  Slot* slot = findSlot (toConsumeSegmentNumber);
+  if(slot == NULL)
   {
     fprintf(stderr, "Could not find SegmentNumber. This should never happen\n");
     return entryConsumed;
   }
 
   entryConsumed = getHighestConsumableRepresentation(toConsumeSegmentNumber);
-  buff.erase (it);
+
+  bufferedSeconds -= slot->front ().entry.segmentDuration;
+  for(Slot::iterator e = slot->begin (); e != slot->end (); ++e)
+  {
+    RepresentationState& rep = reps[e->rep];
+    rep.bufferedSeconds -= e->entry.segmentDuration;
+    rep.bufferedSegments--;
+  }
+  slot->clear ();
+  bufferedSegments--;
+
+  // drop the empty slots at both ends of the ring
+  while(!ring.empty () && ring.front ().empty ())
+  {
+    ring.pop_front ();
+    ringBase++;
+  }
+  while(!ring.empty () && ring.back ().empty ())
+    ring.pop_back ();
+
+  // reset the running sums once nothing is left, so rounding errors do not pile up
+  if(bufferedSegments == 0)
+    bufferedSeconds = 0.0;
+  for(std::vector<RepresentationState>::iterator rep = reps.begin (); rep != reps.end (); ++rep)
+  {
+    if(rep->bufferedSegments == 0)
+    {
+      rep->bufferedSeconds = 0.0;
+      rep->highestSegmentNr = 0;
+    }
+    else if(rep->highestSegmentNr == toConsumeSegmentNumber)
+      rep->highestSegmentNr = scanHighestBufferedSegmentNr (rep - reps.begin ());
+  }
+
   toConsumeSegmentNumber++;
   return entryConsumed;
 }
@@ -209,23 +259,21 @@ MultimediaBuffer::BufferRepresentationEntry MultimediaBuffer::getHighestConsumab
 {
   BufferRepresentationEntry consumableEntry;
 
-  // find the correct entry map
-  MBuffer::iterator it = buff.find (segmentNumber);
-  if(it == buff.end ())
+  // find the correct slot
+  Slot* slot = findSlot (segmentNumber);
+  if(slot == NULL)
   {
     return consumableEntry;
   }
 
-  BufferRepresentationEntryMap map = it->second;
-
   //find entry with most depIds.
   unsigned int most_depIds = 0;
-  for(BufferRepresentationEntryMap::iterator k = map.begin (); k != map.end (); ++k)
+  for(Slot::iterator k = slot->begin (); k != slot->end (); ++k)
   {
-    if(most_depIds <= k->second.depIds.size())
+    if(most_depIds <= k->entry.depIds.size())
     {
-      consumableEntry = k->second;
-      most_depIds = k->second.depIds.size();
+      consumableEntry = k->entry;
+      most_depIds = k->entry.depIds.size();
     }
   }
   return consumableEntry;
@@ -241,3 +289,62 @@ double MultimediaBuffer::getBufferedPercentage(std::string repId)
   return getBufferedSeconds (repId) / maxBufferedSeconds;
 }
 
+/** the slot of segmentNumber, or NULL if nothing is buffered for it */
+MultimediaBuffer::Slot* MultimediaBuffer::findSlot(unsigned int segmentNumber)
+{
+  if(ring.empty () || segmentNumber < ringBase || segmentNumber - ringBase >= ring.size ())
+    return NULL;
+  Slot* slot = &ring[segmentNumber - ringBase];
+  return slot->empty () ? NULL : slot;
+}
+
+/** the slot of segmentNumber, growing the ring if needed */
+MultimediaBuffer::Slot& MultimediaBuffer::getSlot(unsigned int segmentNumber)
+{
+  if(ring.empty ())
+    ringBase = segmentNumber;
+  while(segmentNumber < ringBase)
+  {
+    ring.push_front (Slot ());
+    ringBase--;
+  }
+  if(segmentNumber - ringBase >= ring.size ())
+    ring.resize (segmentNumber - ringBase + 1);
+  return ring[segmentNumber - ringBase];
+}
+
+int MultimediaBuffer::findRepresentation(const std::string& repId) const
+{
+  std::map<std::string, unsigned int>::const_iterator it = repIndex.find (repId);
+  return it == repIndex.end () ? -1 : (int) it->second;
+}
+
+unsigned int MultimediaBuffer::internRepresentation(const std::string& repId)
+{
+  int rep = findRepresentation (repId);
+  if(rep >= 0)
+    return rep;
+
+  RepresentationState state;
+  state.id = repId;
+  state.bufferedSeconds = 0.0;
+  state.bufferedSegments = 0;
+  state.highestSegmentNr = 0;
+  reps.push_back (state);
+  repIndex[repId] = reps.size () - 1;
+  return reps.size () - 1;
+}
+
+/** only needed if segments below the one just consumed are still buffered */
+unsigned int MultimediaBuffer::scanHighestBufferedSegmentNr(unsigned int rep)
+{
+  for(std::deque<Slot>::reverse_iterator it = ring.rbegin (); it != ring.rend (); ++it)
+  {
+    for(Slot::iterator e = it->begin (); e != it->end (); ++e)
+    {
+      if(e->rep == rep)
+        return e->entry.segmentNumber;
+    }
+  }
+  return 0;
+}
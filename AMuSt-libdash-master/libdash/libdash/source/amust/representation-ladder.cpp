@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Christian Kreuzberger and Daniel Posch, Alpen-Adria-University
+ * Klagenfurt
+ *
+ * This file is part of amus-ndnSIM, based on ndnSIM. See AUTHORS for complete list of
+ * authors and contributors.
+ *
+ * amus-ndnSIM and ndnSIM are free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * amus-ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * amus-ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "representation-ladder.h"
+
+#include <algorithm>
+
+
+namespace dash
+{
+namespace player
+{
+
+namespace
+{
+bool
+BandwidthLess(const RepresentationLadder::Step& a, const RepresentationLadder::Step& b)
+{
+  return a.bandwidth < b.bandwidth;
+}
+
+bool
+StepBelow(const RepresentationLadder::Step& step, double bitrate)
+{
+  return step.bandwidth < bitrate;
+}
+
+bool
+BitrateBelow(double bitrate, const RepresentationLadder::Step& step)
+{
+  return bitrate < step.bandwidth;
+}
+}
+
+std::map<RepresentationLadder::Key, RepresentationLadder::Entry> RepresentationLadder::m_ladders;
+
+RepresentationLadder*
+RepresentationLadder::Acquire(const RepresentationsMap* availableRepresentations)
+{
+  Key key;
+  for (RepresentationsMap::const_iterator it = availableRepresentations->begin(); it != availableRepresentations->end(); ++it)
+    key.push_back(it->second);
+
+  std::map<Key, Entry>::iterator it = m_ladders.find(key);
+  if (it != m_ladders.end())
+  {
+    it->second.refs++;
+    return it->second.ladder;
+  }
+
+  Entry entry;
+  entry.ladder = new RepresentationLadder(availableRepresentations);
+  entry.refs = 1;
+  m_ladders[key] = entry;
+  return entry.ladder;
+}
+
+void
+RepresentationLadder::Release(RepresentationLadder* ladder)
+{
+  std::map<Key, Entry>::iterator it = m_ladders.find(ladder->m_key);
+  if (--it->second.refs == 0)
+  {
+    m_ladders.erase(it);
+    delete ladder;
+  }
+}
+
+size_t
+RepresentationLadder::GetNLadders()
+{
+  return m_ladders.size();
+}
+
+RepresentationLadder::RepresentationLadder(const RepresentationsMap* availableRepresentations)
+  : m_first(0)
+  , m_totalSegments(0)
+{
+  for (RepresentationsMap::const_iterator it = availableRepresentations->begin(); it != availableRepresentations->end(); ++it)
+  {
+    IRepresentation* rep = it->second;
+    ISegmentList* segmentList = rep->GetSegmentList();
+
+    Step step;
+    step.rep = rep;
+    step.bandwidth = rep->GetBandwidth();
+    step.segmentDuration = 0.0;
+    step.segmentURLs = NULL;
+    if (segmentList != NULL)
+    {
+      step.segmentURLs = &segmentList->GetSegmentURLs();
+      step.segmentDuration = (double) segmentList->GetDuration() / (double) segmentList->GetTimescale();
+    }
+
+    if (m_steps.empty() && step.segmentURLs != NULL)
+      m_totalSegments = step.segmentURLs->size();
+
+    m_key.push_back(rep);
+    m_steps.push_back(step);
+  }
+
+  // stable, so equal bandwidths stay in id order
+  std::stable_sort(m_steps.begin(), m_steps.end(), BandwidthLess);
+
+  for (unsigned int i = 0; i < m_steps.size(); i++)
+  {
+    m_index[m_steps[i].rep] = i;
+    if (!m_key.empty() && m_steps[i].rep == m_key.front())
+      m_first = i;
+  }
+}
+
+const RepresentationLadder::Step*
+RepresentationLadder::GetHighestBelow(double bitrate) const
+{
+  std::vector<Step>::const_iterator it = std::lower_bound(m_steps.begin(), m_steps.end(), bitrate, StepBelow);
+  if (it == m_steps.begin())
+    return NULL;
+
+  unsigned int bandwidth = (it - 1)->bandwidth;
+  if (bandwidth == 0)
+    return NULL;
+
+  // the first of the steps with that bandwidth
+  return &*std::lower_bound(m_steps.begin(), it, (double) bandwidth, StepBelow);
+}
+
+const RepresentationLadder::Step*
+RepresentationLadder::GetLowestBetween(double low, double high) const
+{
+  std::vector<Step>::const_iterator it = std::upper_bound(m_steps.begin(), m_steps.end(), low, BitrateBelow);
+  if (it == m_steps.end() || !(it->bandwidth < high))
+    return NULL;
+  return &*it;
+}
+
+const RepresentationLadder::Step*
+RepresentationLadder::GetFirst() const
+{
+  return m_steps.empty() ? NULL : &m_steps[m_first];
+}
+
+const RepresentationLadder::Step*
+RepresentationLadder::Find(const IRepresentation* rep) const
+{
+  std::map<const IRepresentation*, unsigned int>::const_iterator it = m_index.find(rep);
+  if (it == m_index.end())
+    return NULL;
+  return &m_steps[it->second];
+}
+
+unsigned int
+RepresentationLadder::GetTotalSegments() const
+{
+  return m_totalSegments;
+}
+
+ISegmentURL*
+RepresentationLadder::GetSegmentURL(const Step* step, unsigned int segmentNr) const
+{
+  return step->segmentURLs->at(segmentNr);
+}
+
+size_t
+RepresentationLadder::GetSize() const
+{
+  return m_steps.size();
+}
+
+}
+}
@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2015 Christian Kreuzberger and Daniel Posch, Alpen-Adria-University
+ * Klagenfurt
+ *
+ * This file is part of amus-ndnSIM, based on ndnSIM. See AUTHORS for complete list of
+ * authors and contributors.
+ *
+ * amus-ndnSIM and ndnSIM are free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * amus-ndnSIM is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * amus-ndnSIM, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "throughput-estimator.h"
+
+#include <algorithm>
+
+
+namespace dash
+{
+namespace player
+{
+
+EwmaThroughputEstimator::EwmaThroughputEstimator(double weight)
+  : m_weight(weight)
+  , m_estimate(0.0)
+  , m_hasSample(false)
+{
+}
+
+void
+EwmaThroughputEstimator::AddSample(double bytes, double seconds, double now)
+{
+  if (seconds <= 0.0)
+    return;
+
+  double bitrate = bytes * 8.0 / seconds;
+  if (m_hasSample)
+    m_estimate = m_weight * bitrate + (1.0 - m_weight) * m_estimate;
+  else
+    m_estimate = bitrate;
+  m_hasSample = true;
+}
+
+double
+EwmaThroughputEstimator::GetEstimate() const
+{
+  return m_estimate;
+}
+
+void
+EwmaThroughputEstimator::Reset()
+{
+  m_estimate = 0.0;
+  m_hasSample = false;
+}
+
+
+HarmonicMeanThroughputEstimator::HarmonicMeanThroughputEstimator(unsigned int samples)
+  : m_samples(std::max(samples, 1u))
+  , m_inverseSum(0.0)
+{
+}
+
+void
+HarmonicMeanThroughputEstimator::AddSample(double bytes, double seconds, double now)
+{
+  if (seconds <= 0.0 || bytes <= 0.0)
+    return;
+
+  m_inverseRates.push_back(seconds / (bytes * 8.0));
+  m_inverseSum += m_inverseRates.back();
+  if (m_inverseRates.size() > m_samples)
+  {
+    m_inverseSum -= m_inverseRates.front();
+    m_inverseRates.pop_front();
+  }
+}
+
+double
+HarmonicMeanThroughputEstimator::GetEstimate() const
+{
+  if (m_inverseRates.empty())
+    return 0.0;
+  return m_inverseRates.size() / m_inverseSum;
+}
+
+void
+HarmonicMeanThroughputEstimator::Reset()
+{
+  m_inverseRates.clear();
+  m_inverseSum = 0.0;
+}
+
+
+SlidingWindowThroughputEstimator::SlidingWindowThroughputEstimator(double window)
+  : m_window(window)
+{
+}
+
+void
+SlidingWindowThroughputEstimator::AddSample(double bytes, double seconds, double now)
+{
+  if (seconds <= 0.0)
+    return;
+
+  Download download;
+  download.start = now - seconds;
+  download.end = now;
+  download.bytes = bytes;
+  m_downloads.push_back(download);
+
+  while (m_downloads.size() > 1 && m_downloads.front().end <= now - m_window)
+    m_downloads.pop_front();
+}
+
+double
+SlidingWindowThroughputEstimator::GetEstimate() const
+{
+  if (m_downloads.empty())
+    return 0.0;
+
+  // downloads of one player do not overlap; a download reaching into the
+  // window counts with the share of its bytes received inside it
+  double windowStart = m_downloads.back().end - m_window;
+  double bytes = 0.0;
+  double busy = 0.0;
+  for (std::deque<Download>::const_iterator it = m_downloads.begin(); it != m_downloads.end(); ++it)
+  {
+    double start = std::max(it->start, windowStart);
+    double share = (it->end - start) / (it->end - it->start);
+    bytes += it->bytes * share;
+    busy += it->end - start;
+  }
+  if (busy <= 0.0)
+    return 0.0;
+  return bytes * 8.0 / busy;
+}
+
+void
+SlidingWindowThroughputEstimator::Reset()
+{
+  m_downloads.clear();
+}
+
+}
+}
@@ -28,9 +28,19 @@ IMPD*           DASHManager::Open   (char *path)
 	// fprintf(stderr, "\nMPD: %s\n", path);
     DOMParser parser(path);
 
+    return this->Open(parser);
+}
+IMPD*           DASHManager::Open   (const char *data, size_t length, const char *url)
+{
+    DOMParser parser(data, length, url);
+
+    return this->Open(parser);
+}
+IMPD*           DASHManager::Open   (DOMParser &parser)
+{
     uint32_t fetchTime = Time::GetCurrentUTCTimeInSec();
 
-    if (!parser.Parse())
+    if (!parser.Parse() || parser.GetRootNode()->GetName() != "MPD")
         return NULL;
 
     MPD* mpd = parser.GetRootNode()->ToMPD();
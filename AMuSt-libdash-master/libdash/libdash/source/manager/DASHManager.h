@@ -28,7 +28,11 @@ namespace dash
             virtual ~DASHManager    ();
 
             mpd::IMPD*  Open    (char *path);
+            mpd::IMPD*  Open    (const char *data, size_t length, const char *url);
             void        Delete  ();
+
+        private:
+            mpd::IMPD*  Open    (xml::DOMParser &parser);
     };
 }
 
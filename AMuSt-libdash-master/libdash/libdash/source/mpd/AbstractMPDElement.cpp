@@ -29,13 +29,18 @@ const std::vector<INode *>                  AbstractMPDElement::GetAdditionalSub
 }
 const std::map<std::string, std::string>    AbstractMPDElement::GetRawAttributes        ()  const
 {
-    return this->rawAttributes;
+    std::map<std::string, std::string> attributes;
+
+    for(size_t i = 0; i < this->rawAttributes.size(); i++)
+        attributes[*this->rawAttributes[i].name] = this->rawAttributes[i].value;
+
+    return attributes;
 }
 void                                        AbstractMPDElement::AddAdditionalSubNode    (INode *node)
 {
     this->additionalSubNodes.push_back(node);
 }
-void                                        AbstractMPDElement::AddRawAttributes        (std::map<std::string, std::string> attributes)
+void                                        AbstractMPDElement::AddRawAttributes        (const Attributes &attributes)
 {
     this->rawAttributes = attributes;
 }
\ No newline at end of file
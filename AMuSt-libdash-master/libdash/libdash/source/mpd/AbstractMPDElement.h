@@ -15,6 +15,7 @@
 #include "config.h"
 
 #include "IMPDElement.h"
+#include "../xml/Attribute.h"
 
 namespace dash
 {
@@ -29,11 +30,11 @@ namespace dash
                 virtual const std::vector<xml::INode *>             GetAdditionalSubNodes   ()  const;
                 virtual const std::map<std::string, std::string>    GetRawAttributes        ()  const;
                 virtual void                                        AddAdditionalSubNode    (xml::INode * node);
-                virtual void                                        AddRawAttributes        (std::map<std::string, std::string> attributes);
+                virtual void                                        AddRawAttributes        (const xml::Attributes &attributes);
 
             private:
                 std::vector<xml::INode *>           additionalSubNodes;
-                std::map<std::string, std::string>  rawAttributes;
+                xml::Attributes                     rawAttributes;
         };
     }
 }
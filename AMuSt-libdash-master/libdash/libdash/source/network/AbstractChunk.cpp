@@ -20,6 +20,7 @@ uint32_t AbstractChunk::BLOCKSIZE = 32768;
 AbstractChunk::AbstractChunk        ()  :
                connection           (NULL),
                dlThread             (NULL),
+               scheduled            (false),
                bytesDownloaded      (0)
 {
 }
@@ -27,12 +28,23 @@ AbstractChunk::~AbstractChunk       ()
 {
     this->AbortDownload();
 
+    if(this->scheduled)
+        DownloadEngine::Instance()->Release(this);
+
     DestroyThreadPortable(this->dlThread);
 }
 
 void    AbstractChunk::AbortDownload                ()
 {
     this->stateManager.CheckAndSet(IN_PROGRESS, REQUEST_ABORT);
+
+    /* no worker picked it up yet, so nobody else will set it to ABORTED */
+    if(this->scheduled && DownloadEngine::Instance()->Cancel(this))
+    {
+        this->stateManager.State(ABORTED);
+        this->blockStream.SetEOS(true);
+    }
+
     this->stateManager.CheckAndWait(REQUEST_ABORT, ABORTED);
 }
 bool    AbstractChunk::StartDownload                ()
@@ -40,27 +52,19 @@ bool    AbstractChunk::StartDownload                ()
     if(this->stateManager.State() != NOT_STARTED)
         return false;
 
-    curl_global_init(CURL_GLOBAL_ALL);
+    /* a worker of the engine downloads it, on a connection kept open from an earlier chunk if there is one */
+    std::stringstream server;
+    server << this->Host() << ":" << this->Port();
 
-    this->curl = curl_easy_init();
-    curl_easy_setopt(this->curl, CURLOPT_URL, this->AbsoluteURI().c_str());
-    curl_easy_setopt(this->curl, CURLOPT_WRITEFUNCTION, CurlResponseCallback);
-    curl_easy_setopt(this->curl, CURLOPT_WRITEDATA, (void *)this);
-    /* Debug Callback */
-    curl_easy_setopt(this->curl, CURLOPT_VERBOSE, 1L);
-    curl_easy_setopt(this->curl, CURLOPT_DEBUGFUNCTION, CurlDebugCallback);
-    curl_easy_setopt(this->curl, CURLOPT_DEBUGDATA, (void *)this);
-    curl_easy_setopt(this->curl, CURLOPT_FAILONERROR, true);
-
-    if(this->HasByteRange())
-        curl_easy_setopt(this->curl, CURLOPT_RANGE, this->Range().c_str());
-
-    this->dlThread = CreateThreadPortable (DownloadInternalConnection, this);
-
-    if(this->dlThread == NULL)
-        return false;
+    this->downloadURI       = this->AbsoluteURI();
+    this->downloadRange     = this->HasByteRange() ? this->Range() : "";
+    this->downloadServer    = server.str();
+    this->downloadType      = this->GetType();
 
     this->stateManager.State(IN_PROGRESS);
+    this->scheduled = true;
+
+    DownloadEngine::Instance()->Schedule(this);
 
     return true;
 }
@@ -143,23 +147,28 @@ void*   AbstractChunk::DownloadExternalConnection   (void *abstractchunk)
 
     return NULL;
 }
-void*   AbstractChunk::DownloadInternalConnection   (void *abstractchunk)
+void    AbstractChunk::DownloadInternalConnection   (CURL *curl)
 {
-    AbstractChunk *chunk  = (AbstractChunk *) abstractchunk;
-
-    chunk->response = curl_easy_perform(chunk->curl);
-
-    curl_easy_cleanup(chunk->curl);
-    curl_global_cleanup();
-
-    if(chunk->stateManager.State() == REQUEST_ABORT)
-        chunk->stateManager.State(ABORTED);
+    curl_easy_setopt(curl, CURLOPT_URL, this->downloadURI.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, CurlResponseCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)this);
+    /* Debug Callback */
+    curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
+    curl_easy_setopt(curl, CURLOPT_DEBUGFUNCTION, CurlDebugCallback);
+    curl_easy_setopt(curl, CURLOPT_DEBUGDATA, (void *)this);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, true);
+    /* the handle may still carry the range of the previous chunk */
+    curl_easy_setopt(curl, CURLOPT_RANGE, this->downloadRange.empty() ? (const char *)NULL : this->downloadRange.c_str());
+
+    if(this->stateManager.State() != REQUEST_ABORT)
+        this->response = curl_easy_perform(curl);
+
+    if(this->stateManager.State() == REQUEST_ABORT)
+        this->stateManager.State(ABORTED);
     else
-        chunk->stateManager.State(COMPLETED);
+        this->stateManager.State(COMPLETED);
 
-    chunk->blockStream.SetEOS(true);
-
-    return NULL;
+    this->blockStream.SetEOS(true);
 }
 void    AbstractChunk::NotifyDownloadRateChanged    ()
 {
@@ -208,9 +217,9 @@ void    AbstractChunk::HandleHeaderOutCallback      ()
 {
     HTTPTransaction *httpTransaction = new HTTPTransaction();
 
-    httpTransaction->SetOriginalUrl(this->AbsoluteURI());
-    httpTransaction->SetRange(this->Range());
-    httpTransaction->SetType(this->GetType());
+    httpTransaction->SetOriginalUrl(this->downloadURI);
+    httpTransaction->SetRange(this->downloadRange);
+    httpTransaction->SetType(this->downloadType);
     httpTransaction->SetRequestSentTime(Time::GetCurrentUTCTimeStr());
 
     this->httpTransactions.push_back(httpTransaction);
@@ -16,6 +16,7 @@
 
 #include "IDownloadableChunk.h"
 #include "DownloadStateManager.h"
+#include "DownloadEngine.h"
 #include "../helpers/SyncedBlockStream.h"
 #include "../portable/Networking.h"
 #include <curl/curl.h>
@@ -68,11 +69,18 @@ namespace dash
                 const std::vector<dash::metrics::IHTTPTransaction *>&   GetHTTPTransactionList  () const;
 
             private:
+                friend class DownloadEngine;
+
                 std::vector<IDownloadObserver *>    observers;
                 THREAD_HANDLE                       dlThread;
                 IConnection                         *connection;
+                bool                                scheduled;
+                /* taken when the download is scheduled, a worker must not call the virtual getters of a chunk being destroyed */
+                std::string                         downloadURI;
+                std::string                         downloadRange;
+                std::string                         downloadServer;
+                dash::metrics::HTTPTransactionType  downloadType;
                 helpers::SyncedBlockStream          blockStream;
-                CURL                                *curl;
                 CURLcode                            response;
                 uint64_t                            bytesDownloaded;
                 DownloadStateManager                stateManager;
@@ -83,7 +91,7 @@ namespace dash
                 static uint32_t BLOCKSIZE;
 
                 static void*    DownloadExternalConnection  (void *chunk);
-                static void*    DownloadInternalConnection  (void *chunk);
+                void            DownloadInternalConnection  (CURL *curl);
                 static size_t   CurlResponseCallback        (void *contents, size_t size, size_t nmemb, void *userp);
                 static size_t   CurlHeaderCallback          (void *headerData, size_t size, size_t nmemb, void *userdata);
                 static size_t   CurlDebugCallback           (CURL *url, curl_infotype infoType, char * data, size_t length, void *userdata);
@@ -0,0 +1,173 @@
+/*
+ * DownloadEngine.cpp
+ *****************************************************************************
+ * Copyright (C) 2012, bitmovin Softwareentwicklung OG, All Rights Reserved
+ *
+ * Email: libdash-dev@vicky.bitmovin.net
+ *
+ * This source code and its use and distribution, is subject to the terms
+ * and conditions of the applicable license agreement.
+ *****************************************************************************/
+
+#include "DownloadEngine.h"
+#include "AbstractChunk.h"
+
+using namespace dash::network;
+
+const uint32_t DownloadEngine::WORKERS;
+
+DownloadEngine::DownloadEngine          ()  :
+                stopping                (false)
+{
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    InitializeCriticalSection   (&this->engineLock);
+    InitializeConditionVariable (&this->queueChanged);
+    InitializeConditionVariable (&this->chunkFinished);
+
+    for(uint32_t i = 0; i < WORKERS; i++)
+    {
+        THREAD_HANDLE worker = CreateThreadPortable (Work, this);
+        if(worker != NULL)
+            this->workers.push_back(worker);
+    }
+}
+DownloadEngine::~DownloadEngine         ()
+{
+    EnterCriticalSection(&this->engineLock);
+    this->stopping = true;
+    WakeAllConditionVariable(&this->queueChanged);
+    LeaveCriticalSection(&this->engineLock);
+
+    for(size_t i = 0; i < this->workers.size(); i++)
+    {
+        JoinThreadPortable(this->workers.at(i));
+        DestroyThreadPortable(this->workers.at(i));
+    }
+
+    std::map<std::string, std::vector<CURL *> >::iterator it;
+    for(it = this->idleHandles.begin(); it != this->idleHandles.end(); ++it)
+        for(size_t i = 0; i < it->second.size(); i++)
+            curl_easy_cleanup(it->second.at(i));
+
+    curl_global_cleanup();
+
+    DeleteConditionVariable (&this->chunkFinished);
+    DeleteConditionVariable (&this->queueChanged);
+    DeleteCriticalSection   (&this->engineLock);
+}
+
+DownloadEngine* DownloadEngine::Instance    ()
+{
+    static DownloadEngine engine;
+    return &engine;
+}
+void            DownloadEngine::Schedule    (AbstractChunk *chunk)
+{
+    EnterCriticalSection(&this->engineLock);
+
+    this->queue.push_back(chunk);
+
+    WakeConditionVariable(&this->queueChanged);
+    LeaveCriticalSection(&this->engineLock);
+}
+bool            DownloadEngine::Cancel      (AbstractChunk *chunk)
+{
+    EnterCriticalSection(&this->engineLock);
+
+    bool found = false;
+    for(size_t i = 0; i < this->queue.size() && !found; i++)
+    {
+        if(this->queue.at(i) == chunk)
+        {
+            this->queue.erase(this->queue.begin() + i);
+            found = true;
+        }
+    }
+
+    LeaveCriticalSection(&this->engineLock);
+
+    return found;
+}
+/* the chunk is about to be deleted, wait until no worker uses it anymore */
+void            DownloadEngine::Release     (AbstractChunk *chunk)
+{
+    this->Cancel(chunk);
+
+    EnterCriticalSection(&this->engineLock);
+
+    while(this->running.count(chunk))
+        SleepConditionVariableCS(&this->chunkFinished, &this->engineLock, INFINITE);
+
+    LeaveCriticalSection(&this->engineLock);
+}
+CURL*           DownloadEngine::AcquireHandle   (const std::string &server)
+{
+    CURL *curl = NULL;
+
+    EnterCriticalSection(&this->engineLock);
+
+    std::vector<CURL *> &idle = this->idleHandles[server];
+    if(!idle.empty())
+    {
+        curl = idle.back();
+        idle.pop_back();
+    }
+
+    LeaveCriticalSection(&this->engineLock);
+
+    if(curl == NULL)
+        curl = curl_easy_init();
+
+    return curl;
+}
+void            DownloadEngine::ReleaseHandle   (const std::string &server, CURL *curl)
+{
+    EnterCriticalSection(&this->engineLock);
+
+    std::vector<CURL *> &idle = this->idleHandles[server];
+    bool keep = idle.size() < WORKERS;
+    if(keep)
+        idle.push_back(curl);
+
+    LeaveCriticalSection(&this->engineLock);
+
+    if(!keep)
+        curl_easy_cleanup(curl);
+}
+void*           DownloadEngine::Work            (void *downloadengine)
+{
+    DownloadEngine *engine = (DownloadEngine *) downloadengine;
+
+    EnterCriticalSection(&engine->engineLock);
+
+    while(true)
+    {
+        while(!engine->stopping && engine->queue.empty())
+            SleepConditionVariableCS(&engine->queueChanged, &engine->engineLock, INFINITE);
+
+        if(engine->stopping)
+            break;
+
+        AbstractChunk *chunk = engine->queue.front();
+        engine->queue.pop_front();
+        engine->running.insert(chunk);
+
+        LeaveCriticalSection(&engine->engineLock);
+
+        std::string server = chunk->downloadServer;
+
+        CURL *curl = engine->AcquireHandle(server);
+        chunk->DownloadInternalConnection(curl);
+        engine->ReleaseHandle(server, curl);
+
+        EnterCriticalSection(&engine->engineLock);
+
+        engine->running.erase(chunk);
+        WakeAllConditionVariable(&engine->chunkFinished);
+    }
+
+    LeaveCriticalSection(&engine->engineLock);
+
+    return NULL;
+}
@@ -0,0 +1,70 @@
+/*
+ * DownloadEngine.h
+ *****************************************************************************
+ * Copyright (C) 2012, bitmovin Softwareentwicklung OG, All Rights Reserved
+ *
+ * Email: libdash-dev@vicky.bitmovin.net
+ *
+ * This source code and its use and distribution, is subject to the terms
+ * and conditions of the applicable license agreement.
+ *****************************************************************************/
+
+#ifndef DOWNLOADENGINE_H_
+#define DOWNLOADENGINE_H_
+
+#include "config.h"
+
+#include "../portable/MultiThreading.h"
+#include <curl/curl.h>
+#include <set>
+
+namespace dash
+{
+    namespace network
+    {
+        class AbstractChunk;
+
+        /*
+         * Downloads the chunks started with AbstractChunk::StartDownload() on a
+         * fixed pool of worker threads. Finished curl handles are kept per
+         * host and port, so the next chunk from the same server reuses their
+         * open connection instead of setting up a new one.
+         */
+        class DownloadEngine
+        {
+            public:
+                static DownloadEngine*  Instance    ();
+
+                void    Schedule    (AbstractChunk *chunk);
+                bool    Cancel      (AbstractChunk *chunk);
+                void    Release     (AbstractChunk *chunk);
+
+                /*
+                 * Number of worker threads, i.e. chunks that download at the
+                 * same time, and of idle handles kept per server. Further
+                 * chunks wait in the queue in the order they were started.
+                 */
+                static const uint32_t WORKERS = 4;
+
+            private:
+                DownloadEngine          ();
+                virtual ~DownloadEngine ();
+
+                std::vector<THREAD_HANDLE>                      workers;
+                std::deque<AbstractChunk *>                     queue;
+                std::set<AbstractChunk *>                       running;
+                std::map<std::string, std::vector<CURL *> >     idleHandles;
+                bool                                            stopping;
+
+                mutable CRITICAL_SECTION    engineLock;
+                mutable CONDITION_VARIABLE  queueChanged;
+                mutable CONDITION_VARIABLE  chunkFinished;
+
+                CURL*           AcquireHandle   (const std::string &server);
+                void            ReleaseHandle   (const std::string &server, CURL *curl);
+                static void*    Work            (void *engine);
+        };
+    }
+}
+
+#endif /* DOWNLOADENGINE_H_ */
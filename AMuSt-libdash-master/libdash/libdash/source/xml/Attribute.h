@@ -0,0 +1,36 @@
+/*
+ * Attribute.h
+ *****************************************************************************
+ * Copyright (C) 2012, bitmovin Softwareentwicklung OG, All Rights Reserved
+ *
+ * Email: libdash-dev@vicky.bitmovin.net
+ *
+ * This source code and its use and distribution, is subject to the terms
+ * and conditions of the applicable license agreement.
+ *****************************************************************************/
+
+#ifndef ATTRIBUTE_H_
+#define ATTRIBUTE_H_
+
+#include "config.h"
+
+namespace dash
+{
+    namespace xml
+    {
+        /*
+         * An attribute of a parsed element. The name is interned in the
+         * NameTable, so the attributes of an element are a flat array of
+         * pointer and value pairs instead of a map of string copies.
+         */
+        struct Attribute
+        {
+            const std::string   *name;
+            std::string         value;
+        };
+
+        typedef std::vector<Attribute> Attributes;
+    }
+}
+
+#endif /* ATTRIBUTE_H_ */
@@ -14,17 +14,27 @@
 using namespace dash::xml;
 using namespace dash::helpers;
 
+static const xmlChar xmlnsName[] = "xmlns";
+
 DOMParser::DOMParser    (std::string url) :
            url          (url),
-           reader       (NULL),
-           root         (NULL)
+           mpdPath      (Path::GetDirectoryPath(url)),
+           buffer       (NULL),
+           length       (0)
+{
+    this->Init();
+}
+DOMParser::DOMParser    (const char *buffer, size_t length, std::string url) :
+           url          (url),
+           mpdPath      (Path::GetDirectoryPath(url)),
+           buffer       (buffer),
+           length       (length)
 {
     this->Init();
 }
 DOMParser::~DOMParser   ()
 {
     xmlCleanupParser();
-    delete(this->root);
 }
 
 Node*   DOMParser::GetRootNode              () const
@@ -33,97 +43,144 @@ Node*   DOMParser::GetRootNode              () const
 }
 bool    DOMParser::Parse                    ()
 {
-    this->reader = xmlReaderForFile(this->url.c_str(), NULL, 0);
+    xmlSAXHandler handler;
+    memset(&handler, 0, sizeof(handler));
 
-    if(this->reader == NULL)
-        return false;
+    handler.initialized     = XML_SAX2_MAGIC;
+    handler.startElementNs  = StartElement;
+    handler.endElementNs    = EndElement;
+    handler.characters      = Characters;
+    handler.cdataBlock      = Characters;
 
-    if(xmlTextReaderRead(this->reader)) 
-        this->root = this->ProcessNode();
+    if(this->buffer)
+        this->context = xmlCreateMemoryParserCtxt(this->buffer, (int) this->length);
+    else
+        this->context = xmlCreateFileParserCtxt(this->url.c_str());
 
-    if(this->root == NULL)
+    if(this->context == NULL)
         return false;
 
-    xmlFreeTextReader(this->reader);
+    *this->context->sax     = handler;
+    this->context->userData = this;
 
-    return true;
+    xmlParseDocument(this->context);
+    /* a truncated or mismatched document still leaves a partial tree behind */
+    bool wellFormed = this->context->wellFormed;
+    xmlFreeParserCtxt(this->context);
+    this->context = NULL;
+
+    /* the names are pointers into the dictionary of the parser context */
+    this->names.clear();
+    this->openNodes.clear();
+    this->text.clear();
+
+    return wellFormed && this->root != NULL;
 }
-Node*   DOMParser::ProcessNode              ()
+void    DOMParser::StartElement             (void *domparser, const xmlChar *localname, const xmlChar *prefix, const xmlChar *uri,
+                                             int nbNamespaces, const xmlChar **namespaces,
+                                             int nbAttributes, int nbDefaulted, const xmlChar **attributes)
 {
-    int type = xmlTextReaderNodeType(this->reader);
-
-    if(type != WhiteSpace && type != Text)
-    {
-        while (type == Comment || type == WhiteSpace)
-        {
-            xmlTextReaderRead(this->reader);
-            type = xmlTextReaderNodeType(this->reader);
-        }
+    DOMParser *parser = (DOMParser *) domparser;
 
-        Node *node = new Node();
-        node->SetType(type);
-        node->SetMPDPath(Path::GetDirectoryPath(url));
+    parser->AddText();
 
-        if(xmlTextReaderConstName(this->reader) == NULL)
-        {
-            delete node;
-            return NULL;
-        }
+    Node *node = parser->arena.NewNode();
+    node->SetType(Start);
+    node->SetMPDPath(&parser->mpdPath);
+    node->SetName(parser->Intern(prefix, localname));
+    node->ReserveAttributes(nbNamespaces + nbAttributes);
 
-        std::string name    = (const char *) xmlTextReaderConstName(this->reader);
-        int         isEmpty = xmlTextReaderIsEmptyElement(this->reader);
+    /* namespace declarations are attributes of the element like in the document, xmlns="..." or xmlns:prefix="..." */
+    for(int i = 0; i < nbNamespaces; i++)
+    {
+        const xmlChar       *prefix = namespaces[2 * i];
+        const xmlChar       *value  = namespaces[2 * i + 1];
+        const std::string   *name   = prefix ? parser->Intern(xmlnsName, prefix) : parser->Intern(NULL, xmlnsName);
 
-        node->SetName(name);
+        node->AddAttribute(name, (const char *) value, xmlStrlen(value));
+    }
 
-        this->AddAttributesToNode(node);
+    /* localname, prefix, URI, value and end of the value per attribute */
+    for(int i = 0; i < nbAttributes; i++)
+    {
+        const xmlChar       **attribute = &attributes[5 * i];
+        const std::string   *name       = parser->Intern(attribute[1], attribute[0]);
+        int                 length      = attribute[4] - attribute[3];
 
-        if(isEmpty)
-            return node;
+        /* entity references are left in the value, e.g. &amp; as &#38; */
+        if(memchr(attribute[3], '&', length))
+        {
+            xmlChar *value = xmlStringLenDecodeEntities(parser->context, attribute[3], length, XML_SUBSTITUTE_REF, 0, 0, 0);
+            node->AddAttribute(name, (const char *) value, xmlStrlen(value));
+            xmlFree(value);
+        }
+        else
+        {
+            node->AddAttribute(name, (const char *) attribute[3], length);
+        }
+    }
 
-        Node    *subnode    = NULL;
-        int     ret         = xmlTextReaderRead(this->reader);
+    if(parser->openNodes.empty())
+    {
+        if(parser->root == NULL)
+            parser->root = node;
+    }
+    else
+    {
+        parser->openNodes.back()->AddSubNode(node);
+    }
 
-        while(ret == 1)
-        {
-            if(!strcmp(name.c_str(), (const char *) xmlTextReaderConstName(this->reader)))
-            {
-                return node;
-            }
+    parser->openNodes.push_back(node);
+}
+void    DOMParser::EndElement               (void *domparser, const xmlChar *localname, const xmlChar *prefix, const xmlChar *uri)
+{
+    DOMParser *parser = (DOMParser *) domparser;
 
-            subnode = this->ProcessNode();
+    parser->AddText();
 
-            if(subnode != NULL)
-                node->AddSubNode(subnode);
+    if(!parser->openNodes.empty())
+        parser->openNodes.pop_back();
+}
+void    DOMParser::Characters               (void *domparser, const xmlChar *chars, int length)
+{
+    DOMParser *parser = (DOMParser *) domparser;
 
-            ret = xmlTextReaderRead(this->reader);
-        }
+    if(!parser->openNodes.empty())
+        parser->text.append((const char *) chars, length);
+}
+/* text up to the next tag becomes a text node, unless it is only the indentation between elements */
+void    DOMParser::AddText                  ()
+{
+    if(this->text.empty())
+        return;
 
-        return node;
-    } else if (type == Text)
+    if(this->text.find_first_not_of(" \t\r\n") != std::string::npos)
     {
-       const char* text = (const char *) xmlTextReaderReadString(this->reader);
-
-       if(text != NULL)
-       {
-           Node *node = new Node();
-           node->SetType(type);
-           node->SetText(text);
-           return node;
-       }
+        Node *node = this->arena.NewNode();
+        node->SetType(Text);
+        node->SetText(this->text);
+        this->openNodes.back()->AddSubNode(node);
     }
-    return NULL;
+
+    this->text.clear();
 }
-void    DOMParser::AddAttributesToNode      (Node *node)
+/* the parser hands out the same pointers for equal names, so each name is interned only once per parse */
+const std::string*  DOMParser::Intern       (const xmlChar *prefix, const xmlChar *localname)
 {
-    if(xmlTextReaderHasAttributes(this->reader))
-    {
-        while(xmlTextReaderMoveToNextAttribute(this->reader))
-        {
-            std::string key      = (const char *) xmlTextReaderConstName(this->reader);
-            std::string value    = (const char *) xmlTextReaderConstValue(this->reader);
-            node->AddAttribute(key, value);
-        }
-    }
+    QName qname(prefix, localname);
+
+    std::map<QName, const std::string *>::iterator it = this->names.find(qname);
+
+    if(it != this->names.end())
+        return it->second;
+
+    std::string name = (const char *) localname;
+    if(prefix)
+        name = std::string((const char *) prefix) + ":" + name;
+
+    const std::string *interned = NameTable::Intern(name.c_str());
+    this->names[qname] = interned;
+    return interned;
 }
 void    DOMParser::Print                    (Node *node, int offset)
 {
@@ -149,8 +206,8 @@ void    DOMParser::Print                    (Node *node, int offset)
 }
 void    DOMParser::Init                     ()
 {
+    this->context   = NULL;
     this->root      = NULL;
-    this->reader    = NULL;
 }
 void    DOMParser::Print                    ()
 {
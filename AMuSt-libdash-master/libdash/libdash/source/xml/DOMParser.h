@@ -15,7 +15,10 @@
 #include "config.h"
 
 #include "Node.h"
-#include <libxml/xmlreader.h>
+#include "NodeArena.h"
+#include "NameTable.h"
+#include <libxml/parser.h>
+#include <libxml/parserInternals.h>
 #include "../helpers/Path.h"
 
 namespace dash
@@ -31,10 +34,16 @@ namespace dash
             Text            = 3,
         };
 
+        /*
+         * Builds the DOM from the SAX2 events of libxml2. The nodes live in an
+         * arena owned by the parser and element and attribute names are
+         * interned, so the DOM is only valid as long as the parser exists.
+         */
         class DOMParser
         {
             public:
                 DOMParser           (std::string url);
+                DOMParser           (const char *buffer, size_t length, std::string url);
                 virtual ~DOMParser  ();
 
                 bool    Parse       ();
@@ -42,14 +51,29 @@ namespace dash
                 void    Print       ();
 
             private:
-                xmlTextReaderPtr    reader;
-                Node                *root;
-                std::string         url;
-
-                void    Init                    ();
-                Node*   ProcessNode             ();
-                void    AddAttributesToNode     (Node *node);
-                void    Print                   (Node *node, int offset);
+                typedef std::pair<const xmlChar *, const xmlChar *> QName;
+
+                xmlParserCtxtPtr                        context;
+                Node                                    *root;
+                std::string                             url;
+                std::string                             mpdPath;
+                const char                              *buffer;
+                size_t                                  length;
+                NodeArena                               arena;
+                std::vector<Node *>                     openNodes;
+                std::string                             text;
+                std::map<QName, const std::string *>    names;
+
+                void                Init                    ();
+                const std::string*  Intern                  (const xmlChar *prefix, const xmlChar *localname);
+                void                AddText                 ();
+                void                Print                   (Node *node, int offset);
+
+                static void         StartElement            (void *parser, const xmlChar *localname, const xmlChar *prefix, const xmlChar *uri,
+                                                             int nbNamespaces, const xmlChar **namespaces,
+                                                             int nbAttributes, int nbDefaulted, const xmlChar **attributes);
+                static void         EndElement              (void *parser, const xmlChar *localname, const xmlChar *prefix, const xmlChar *uri);
+                static void         Characters              (void *parser, const xmlChar *chars, int length);
         };
     }
 }
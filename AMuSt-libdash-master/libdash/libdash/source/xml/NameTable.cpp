@@ -0,0 +1,36 @@
+/*
+ * NameTable.cpp
+ *****************************************************************************
+ * Copyright (C) 2012, bitmovin Softwareentwicklung OG, All Rights Reserved
+ *
+ * Email: libdash-dev@vicky.bitmovin.net
+ *
+ * This source code and its use and distribution, is subject to the terms
+ * and conditions of the applicable license agreement.
+ *****************************************************************************/
+
+#include "NameTable.h"
+
+using namespace dash::xml;
+
+NameTable::NameTable    ()
+{
+    InitializeCriticalSection(&this->namesLock);
+}
+NameTable::~NameTable   ()
+{
+    DeleteCriticalSection(&this->namesLock);
+}
+
+const std::string*  NameTable::Intern   (const char *name)
+{
+    static NameTable table;
+
+    EnterCriticalSection(&table.namesLock);
+
+    const std::string *interned = &*table.names.insert(name).first;
+
+    LeaveCriticalSection(&table.namesLock);
+
+    return interned;
+}
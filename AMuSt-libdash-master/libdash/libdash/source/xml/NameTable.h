@@ -0,0 +1,44 @@
+/*
+ * NameTable.h
+ *****************************************************************************
+ * Copyright (C) 2012, bitmovin Softwareentwicklung OG, All Rights Reserved
+ *
+ * Email: libdash-dev@vicky.bitmovin.net
+ *
+ * This source code and its use and distribution, is subject to the terms
+ * and conditions of the applicable license agreement.
+ *****************************************************************************/
+
+#ifndef NAMETABLE_H_
+#define NAMETABLE_H_
+
+#include "config.h"
+
+#include "../portable/MultiThreading.h"
+#include <set>
+
+namespace dash
+{
+    namespace xml
+    {
+        /*
+         * Element and attribute names shared by all parsed nodes. An MPD only
+         * uses a few dozen distinct names, so every name is stored once for the
+         * lifetime of the library and nodes just point to it.
+         */
+        class NameTable
+        {
+            public:
+                static const std::string*   Intern  (const char *name);
+
+            private:
+                NameTable           ();
+                virtual ~NameTable  ();
+
+                std::set<std::string>       names;
+                mutable CRITICAL_SECTION    namesLock;
+        };
+    }
+}
+
+#endif /* NAMETABLE_H_ */
@@ -15,22 +15,43 @@
 using namespace dash::xml;
 using namespace dash::metrics;
 
-Node::Node  ()
+static const std::string emptyString;
+
+Node::Node  () :
+    attributeMap(NULL),
+    name(&emptyString),
+    type(0),
+    mpdPath(NULL),
+    ownsSubNodes(true)
+{
+}
+Node::Node  (bool ownsSubNodes) :
+    attributeMap(NULL),
+    name(&emptyString),
+    type(0),
+    mpdPath(NULL),
+    ownsSubNodes(ownsSubNodes)
 {
 }
 Node::Node  (const Node& other) :
+    attributes(other.attributes),
+    attributeMap(NULL),
     name(other.name),
     text(other.text),
     type(other.type),
-    attributes(other.attributes)
+    mpdPath(NULL),
+    ownsSubNodes(true)
 {
     for (size_t i = 0; i < other.subNodes.size(); i++)
         this->subNodes.push_back(new Node(*(other.subNodes.at(i))));
 }
 Node::~Node ()
 {
-    for(size_t i = 0; i < this->subNodes.size(); i++)
-        delete(this->subNodes.at(i));
+    if(this->ownsSubNodes)
+        for(size_t i = 0; i < this->subNodes.size(); i++)
+            delete(this->subNodes.at(i));
+
+    delete(this->attributeMap);
 }
 
 dash::mpd::ProgramInformation*              Node::ToProgramInformation  ()  const
@@ -83,7 +104,7 @@ dash::mpd::BaseUrl*                         Node::ToBaseUrl             ()  cons
     }
     if (this->GetText() == "./")
     {
-        baseUrl->SetUrl(this->mpdPath);
+        baseUrl->SetUrl(this->mpdPath ? *this->mpdPath : emptyString);
     }
     else 
     {
@@ -96,7 +117,7 @@ dash::mpd::BaseUrl*                         Node::ToBaseUrl             ()  cons
 dash::mpd::Descriptor*                      Node::ToDescriptor          ()  const
 {
     dash::mpd::Descriptor *descriptor = new dash::mpd::Descriptor();
-    std::vector<Node *> subNodes = this->GetSubNodes();
+    const std::vector<Node *> &subNodes = this->GetSubNodes();
 
     if (this->HasAttribute("schemeIdUri"))
     {
@@ -118,7 +139,7 @@ dash::mpd::Descriptor*                      Node::ToDescriptor          ()  cons
 dash::mpd::ContentComponent*                Node::ToContentComponent    ()  const
 {
     dash::mpd::ContentComponent *contentComponent = new dash::mpd::ContentComponent();
-    std::vector<Node *> subNodes = this->GetSubNodes();
+    const std::vector<Node *> &subNodes = this->GetSubNodes();
 
     if (this->HasAttribute("id"))
     {
@@ -190,7 +211,7 @@ dash::mpd::URLType*                         Node::ToURLType             (HTTPTra
 dash::mpd::SegmentBase*                     Node::ToSegmentBase         ()  const
 {
     dash::mpd::SegmentBase* segmentBase = new dash::mpd::SegmentBase();
-    std::vector<Node *> subNodes = this->GetSubNodes();
+    const std::vector<Node *> &subNodes = this->GetSubNodes();
 
     SetCommonValuesForSeg(*segmentBase);
 
@@ -227,7 +248,7 @@ dash::mpd::SegmentTimeline*                 Node::ToSegmentTimeline     ()  cons
 {
     dash::mpd::SegmentTimeline* segmentTimeline = new dash::mpd::SegmentTimeline();
 
-    std::vector<Node *> subNodes = this->GetSubNodes();
+    const std::vector<Node *> &subNodes = this->GetSubNodes();
     for(size_t i = 0; i < subNodes.size(); i++)
     {
         if (subNodes.at(i)->GetName() == "S")
@@ -273,7 +294,7 @@ dash::mpd::SegmentURL*                      Node::ToSegmentURL          ()  cons
 dash::mpd::SegmentList*                     Node::ToSegmentList         ()  const
 {
     dash::mpd::SegmentList* segmentList = new dash::mpd::SegmentList();
-    std::vector<Node *> subNodes = this->GetSubNodes();
+    const std::vector<Node *> &subNodes = this->GetSubNodes();
 
     SetCommonValuesForMSeg(*segmentList);
 
@@ -304,7 +325,7 @@ dash::mpd::SegmentList*                     Node::ToSegmentList         ()  cons
 dash::mpd::SegmentTemplate*                 Node::ToSegmentTemplate     ()  const
 {
     dash::mpd::SegmentTemplate *segmentTemplate = new dash::mpd::SegmentTemplate();
-    std::vector<Node *> subNodes = this->GetSubNodes();
+    const std::vector<Node *> &subNodes = this->GetSubNodes();
 
     SetCommonValuesForMSeg(*segmentTemplate);
 
@@ -338,7 +359,7 @@ dash::mpd::SegmentTemplate*                 Node::ToSegmentTemplate     ()  cons
 dash::mpd::SubRepresentation*               Node::ToSubRepresentation   ()  const
 {
     dash::mpd::SubRepresentation* subRepresentation = new dash::mpd::SubRepresentation();
-    std::vector<Node *> subNodes = this->GetSubNodes();
+    const std::vector<Node *> &subNodes = this->GetSubNodes();
 
     SetCommonValuesForRep(*subRepresentation);
 
@@ -370,7 +391,7 @@ dash::mpd::SubRepresentation*               Node::ToSubRepresentation   ()  cons
 dash::mpd::Representation*                  Node::ToRepresentation      ()  const
 {
     dash::mpd::Representation* representation = new dash::mpd::Representation();
-    std::vector<Node *> subNodes = this->GetSubNodes();
+    const std::vector<Node *> &subNodes = this->GetSubNodes();
 
     SetCommonValuesForRep(*representation);
 
@@ -432,7 +453,7 @@ dash::mpd::Representation*                  Node::ToRepresentation      ()  cons
 dash::mpd::AdaptationSet*                   Node::ToAdaptationSet       ()  const
 {
     dash::mpd::AdaptationSet *adaptationSet = new dash::mpd::AdaptationSet();
-    std::vector<Node *> subNodes = this->GetSubNodes();
+    const std::vector<Node *> &subNodes = this->GetSubNodes();
 
     SetCommonValuesForRep(*adaptationSet);
 
@@ -587,7 +608,7 @@ dash::mpd::Subset*                          Node::ToSubset              ()  cons
 dash::mpd::Period*                          Node::ToPeriod              ()  const
 {
     dash::mpd::Period *period = new dash::mpd::Period();
-    std::vector<Node *> subNodes = this->GetSubNodes();
+    const std::vector<Node *> &subNodes = this->GetSubNodes();
 
     if (this->HasAttribute("xlink:href"))
     {
@@ -697,7 +718,7 @@ dash::mpd::Metrics*                         Node::ToMetrics             ()  cons
 dash::mpd::MPD*                             Node::ToMPD                 ()  const
 {
     dash::mpd::MPD *mpd = new dash::mpd::MPD();
-    std::vector<Node *> subNodes = this->GetSubNodes();
+    const std::vector<Node *> &subNodes = this->GetSubNodes();
 
     if (this->HasAttribute("id"))
     {
@@ -779,13 +800,13 @@ dash::mpd::MPD*                             Node::ToMPD                 ()  cons
     }
 
     dash::mpd::BaseUrl *mpdPathBaseUrl = new dash::mpd::BaseUrl();
-    mpdPathBaseUrl->SetUrl(mpdPath);
+    mpdPathBaseUrl->SetUrl(this->mpdPath ? *this->mpdPath : emptyString);
     mpd->SetMPDPathBaseUrl(mpdPathBaseUrl);
 
     mpd->AddRawAttributes(this->attributes);
     return mpd;
 }
-void                                        Node::SetMPDPath            (std::string path)
+void                                        Node::SetMPDPath            (const std::string *path)
 {
     this->mpdPath = path;
 }
@@ -804,37 +825,77 @@ void                                        Node::AddSubNode            (Node *n
 }
 const std::string&                          Node::GetName               ()  const
 {
-    return this->name;
+    return *this->name;
 }
 void                                        Node::SetName               (const std::string &name)
+{
+    this->name = NameTable::Intern(name.c_str());
+}
+void                                        Node::SetName               (const std::string *name)
 {
     this->name = name;
 }
+const Attribute*                            Node::FindAttribute         (const char *name) const
+{
+    for(size_t i = 0; i < this->attributes.size(); i++)
+        if(!strcmp(this->attributes[i].name->c_str(), name))
+            return &this->attributes[i];
+
+    return NULL;
+}
 const std::string&                          Node::GetAttributeValue     (std::string key)   const
 {
-    //return this->attributes[key];
-    return this->attributes.find(key)->second;
+    return this->GetAttributeValue(key.c_str());
 }
-bool                                        Node::HasAttribute          (const std::string& name) const
+const std::string&                          Node::GetAttributeValue     (const char *key)   const
 {
-    if(this->attributes.find(name) != this->attributes.end())
-        return true;
+    const Attribute *attribute = this->FindAttribute(key);
 
-    return false;
+    return attribute ? attribute->value : emptyString;
+}
+bool                                        Node::HasAttribute          (const std::string& name) const
+{
+    return this->FindAttribute(name.c_str()) != NULL;
+}
+bool                                        Node::HasAttribute          (const char *name) const
+{
+    return this->FindAttribute(name) != NULL;
 }
 void                                        Node::AddAttribute          (const std::string &key, const std::string &value)
 {
-    this->attributes[key] = value;
+    this->AddAttribute(NameTable::Intern(key.c_str()), value.data(), value.size());
 }
-std::vector<std::string>                    Node::GetAttributeKeys      ()  const
+void                                        Node::AddAttribute          (const std::string *key, const char *value, size_t length)
 {
-    std::vector<std::string> keys;
-    std::map<std::string, std::string>::const_iterator it;
+    delete(this->attributeMap);
+    this->attributeMap = NULL;
 
-    for(it = this->attributes.begin(); it != this->attributes.end(); ++it)
+    for(size_t i = 0; i < this->attributes.size(); i++)
     {
-        keys.push_back(it->first);
+        if(this->attributes[i].name == key)
+        {
+            this->attributes[i].value.assign(value, length);
+            return;
+        }
     }
+
+    this->attributes.push_back(Attribute());
+    this->attributes.back().name    = key;
+    this->attributes.back().value.assign(value, length);
+}
+void                                        Node::ReserveAttributes     (size_t count)
+{
+    this->attributes.reserve(count);
+}
+std::vector<std::string>                    Node::GetAttributeKeys      ()  const
+{
+    std::vector<std::string>                            keys;
+    const std::map<std::string, std::string>            &attributes = this->GetAttributes();
+    std::map<std::string, std::string>::const_iterator  it;
+
+    for(it = attributes.begin(); it != attributes.end(); ++it)
+        keys.push_back(it->first);
+
     return keys;
 }
 bool                                        Node::HasText               ()  const
@@ -859,16 +920,23 @@ void                                        Node::SetText               (const s
 }
 void                                        Node::Print                 (std::ostream &stream)  const
 {
-    stream << this->name;
-    std::vector<std::string> keys = this->GetAttributeKeys();
-    for(size_t i = 0; i < keys.size(); i++)
-        stream << " " << keys.at(i) << "=" << this->GetAttributeValue(keys.at(i));
+    stream << *this->name;
+    for(size_t i = 0; i < this->attributes.size(); i++)
+        stream << " " << *this->attributes[i].name << "=" << this->attributes[i].value;
 
     stream << std::endl;
 }
+/* the attributes are kept in a flat array, the map is only built for callers that ask for it */
 const std::map<std::string,std::string>&    Node::GetAttributes         ()  const
 {
-    return this->attributes;
+    if(this->attributeMap == NULL)
+    {
+        this->attributeMap = new std::map<std::string, std::string>();
+
+        for(size_t i = 0; i < this->attributes.size(); i++)
+            (*this->attributeMap)[*this->attributes[i].name] = this->attributes[i].value;
+    }
+    return *this->attributeMap;
 }
 int                                         Node::GetType               ()  const
 {
@@ -880,7 +948,7 @@ void                                        Node::SetType               (int typ
 }
 void                                        Node::SetCommonValuesForRep (dash::mpd::RepresentationBase& object) const
 {
-    std::vector<Node *> subNodes = this->GetSubNodes();
+    const std::vector<Node *> &subNodes = this->GetSubNodes();
 
     if (this->HasAttribute("profiles"))
     {
@@ -960,7 +1028,7 @@ void                                        Node::SetCommonValuesForRep (dash::m
 }
 void                                        Node::SetCommonValuesForSeg (dash::mpd::SegmentBase& object) const
 {
-    std::vector<Node *> subNodes = this->GetSubNodes();
+    const std::vector<Node *> &subNodes = this->GetSubNodes();
 
     if (this->HasAttribute("timescale"))
     {
@@ -995,7 +1063,7 @@ void                                        Node::SetCommonValuesForSeg (dash::m
 }
 void                                        Node::SetCommonValuesForMSeg(dash::mpd::MultipleSegmentBase& object) const
 {
-    std::vector<Node *> subNodes = this->GetSubNodes();
+    const std::vector<Node *> &subNodes = this->GetSubNodes();
 
     SetCommonValuesForSeg(object);
 
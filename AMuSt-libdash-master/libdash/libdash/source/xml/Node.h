@@ -15,6 +15,8 @@
 #include "config.h"
 
 #include "INode.h"
+#include "Attribute.h"
+#include "NameTable.h"
 #include "../helpers/String.h"
 #include "../mpd/AdaptationSet.h"
 #include "../mpd/BaseUrl.h"
@@ -58,17 +60,27 @@ namespace dash
                 int                                         GetType             ()  const;
                 void                                        SetType             (int type);
                 const std::string&                          GetAttributeValue   (std::string key) const;
+                const std::string&                          GetAttributeValue   (const char *key) const;
                 void                                        AddSubNode          (Node *node);
                 void                                        SetName             (const std::string &name);
+                void                                        SetName             (const std::string *name);
                 bool                                        HasAttribute        (const std::string& name) const;
+                bool                                        HasAttribute        (const char *name) const;
                 void                                        AddAttribute        (const std::string &key, const std::string &value);
+                void                                        AddAttribute        (const std::string *key, const char *value, size_t length);
+                void                                        ReserveAttributes   (size_t count);
                 bool                                        HasText             ()  const;
                 void                                        SetText             (const std::string &text);
                 void                                        Print               (std::ostream &stream)  const;
                 dash::mpd::MPD*                             ToMPD               ()  const;
-                void                                        SetMPDPath          (std::string path);
+                void                                        SetMPDPath          (const std::string *path);
 
             private:
+                friend class NodeArena;
+
+                Node            (bool ownsSubNodes);
+
+                const Attribute*                            FindAttribute           (const char *name) const;
                 void                                        SetCommonValuesForRep   (dash::mpd::RepresentationBase& object) const;
                 void                                        SetCommonValuesForSeg   (dash::mpd::SegmentBase& object) const;
                 void                                        SetCommonValuesForMSeg  (dash::mpd::MultipleSegmentBase& object) const;
@@ -91,12 +103,14 @@ namespace dash
                 dash::mpd::Subset*                          ToSubset                ()  const;
                 dash::mpd::URLType*                         ToURLType               (dash::metrics::HTTPTransactionType transActType)  const;
 
-                std::vector<Node *>                 subNodes;
-                std::map<std::string, std::string>  attributes;
-                std::string                         name;
-                std::string                         text;
-                int                                 type;
-                std::string                         mpdPath;
+                std::vector<Node *>                         subNodes;
+                Attributes                                  attributes;
+                mutable std::map<std::string, std::string>  *attributeMap;
+                const std::string                           *name;
+                std::string                                 text;
+                int                                         type;
+                const std::string                           *mpdPath;
+                bool                                        ownsSubNodes;
 
         };
     }
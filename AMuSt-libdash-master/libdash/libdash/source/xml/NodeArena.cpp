@@ -0,0 +1,43 @@
+/*
+ * NodeArena.cpp
+ *****************************************************************************
+ * Copyright (C) 2012, bitmovin Softwareentwicklung OG, All Rights Reserved
+ *
+ * Email: libdash-dev@vicky.bitmovin.net
+ *
+ * This source code and its use and distribution, is subject to the terms
+ * and conditions of the applicable license agreement.
+ *****************************************************************************/
+
+#include "NodeArena.h"
+#include <new>
+
+using namespace dash::xml;
+
+NodeArena::NodeArena    () :
+           used         (BLOCKSIZE)
+{
+}
+NodeArena::~NodeArena   ()
+{
+    for(size_t i = 0; i < this->blocks.size(); i++)
+    {
+        size_t nodes = (i + 1 == this->blocks.size()) ? this->used : BLOCKSIZE;
+
+        for(size_t j = 0; j < nodes; j++)
+            this->blocks.at(i)[j].~Node();
+
+        ::operator delete(this->blocks.at(i));
+    }
+}
+
+Node*   NodeArena::NewNode  ()
+{
+    if(this->used == BLOCKSIZE)
+    {
+        this->blocks.push_back((Node *) ::operator new(BLOCKSIZE * sizeof(Node)));
+        this->used = 0;
+    }
+
+    return new (&this->blocks.back()[this->used++]) Node(false);
+}
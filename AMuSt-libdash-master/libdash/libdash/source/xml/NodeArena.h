@@ -0,0 +1,45 @@
+/*
+ * NodeArena.h
+ *****************************************************************************
+ * Copyright (C) 2012, bitmovin Softwareentwicklung OG, All Rights Reserved
+ *
+ * Email: libdash-dev@vicky.bitmovin.net
+ *
+ * This source code and its use and distribution, is subject to the terms
+ * and conditions of the applicable license agreement.
+ *****************************************************************************/
+
+#ifndef NODEARENA_H_
+#define NODEARENA_H_
+
+#include "config.h"
+
+#include "Node.h"
+
+namespace dash
+{
+    namespace xml
+    {
+        /*
+         * Allocates the nodes of one parsed document in large blocks instead of
+         * one heap allocation per element, and destroys all of them at once.
+         * The nodes do not delete their subnodes, the arena owns them.
+         */
+        class NodeArena
+        {
+            public:
+                NodeArena           ();
+                virtual ~NodeArena  ();
+
+                Node*   NewNode     ();
+
+            private:
+                std::vector<Node *> blocks;
+                size_t              used;
+
+                static const size_t BLOCKSIZE = 1024;
+        };
+    }
+}
+
+#endif /* NODEARENA_H_ */
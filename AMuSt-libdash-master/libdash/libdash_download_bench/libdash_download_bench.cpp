@@ -0,0 +1,199 @@
+/*
+ * libdash_download_bench.cpp
+ *****************************************************************************
+ * Copyright (C) 2012, bitmovin Softwareentwicklung OG, All Rights Reserved
+ *
+ * Email: libdash-dev@vicky.bitmovin.net
+ *
+ * This source code and its use and distribution, is subject to the terms
+ * and conditions of the applicable license agreement.
+ *****************************************************************************/
+
+/*
+ * Downloads the segments of a video described by a representations csv (as
+ * read by the DASH server of the simulator, e.g. content/representations/
+ * netflix_vid1.csv) one after the other through libdash's internal curl
+ * download path, and reports the time per segment.
+ *
+ * Create the segment files, then serve them with a keep-alive HTTP server
+ * (without TCP_NODELAY, Python's server stalls every reply on delayed ACKs):
+ *
+ *   libdash_download_bench --create /tmp/www netflix_vid1.csv 300
+ *   cd /tmp/www && python3 -c "import http.server as h; \
+ *       h.SimpleHTTPRequestHandler.disable_nagle_algorithm = True; \
+ *       h.test(HandlerClass=h.SimpleHTTPRequestHandler, port=8000, protocol='HTTP/1.1')"
+ *   libdash_download_bench http://127.0.0.1:8000/ netflix_vid1.csv 300
+ */
+
+#include "../libdash/source/network/AbstractChunk.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+using namespace dash::network;
+using namespace std;
+
+class BenchChunk : public AbstractChunk
+{
+    public:
+        BenchChunk          (const std::string &url) :
+                            uri (url),
+                            port(80)
+        {
+            size_t hostStart    = this->uri.find("://") + 3;
+            size_t pathStart    = this->uri.find('/', hostStart);
+            this->host          = this->uri.substr(hostStart, pathStart - hostStart);
+            this->path          = this->uri.substr(pathStart);
+
+            size_t colon = this->host.find(':');
+            if(colon != std::string::npos)
+            {
+                this->port = strtoul(this->host.substr(colon + 1).c_str(), NULL, 10);
+                this->host = this->host.substr(0, colon);
+            }
+        }
+        virtual ~BenchChunk ()
+        {
+        }
+
+        virtual std::string&    AbsoluteURI     ()  { return this->uri; }
+        virtual std::string&    Host            ()  { return this->host; }
+        virtual size_t          Port            ()  { return this->port; }
+        virtual std::string&    Path            ()  { return this->path; }
+        virtual std::string&    Range           ()  { return this->range; }
+        virtual size_t          StartByte       ()  { return 0; }
+        virtual size_t          EndByte         ()  { return 0; }
+        virtual bool            HasByteRange    ()  { return false; }
+        virtual dash::metrics::HTTPTransactionType  GetType()   { return dash::metrics::MediaSegment; }
+
+    private:
+        std::string uri;
+        std::string host;
+        size_t      port;
+        std::string path;
+        std::string range;
+};
+
+struct Representation
+{
+    std::string id;
+    long        segmentSize;
+};
+
+static double Now ()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/* the segment names and sizes DASHFakeServerApplication serves for this csv */
+static bool ReadRepresentations (const char *csv, std::vector<Representation> &representations)
+{
+    ifstream in(csv);
+    if(!in.is_open())
+        return false;
+
+    int         duration = 0;
+    std::string line;
+    while(getline(in, line))
+    {
+        if(line.compare(0, 16, "segmentDuration=") == 0)
+        {
+            duration = atoi(line.c_str() + 16);
+            continue;
+        }
+
+        std::vector<std::string> fields;
+        std::stringstream        ss(line);
+        std::string              field;
+        while(getline(ss, field, ','))
+            fields.push_back(field);
+
+        if(fields.size() < 5 || atoi(fields.at(4).c_str()) <= 0)
+            continue;
+
+        Representation representation;
+        representation.id           = fields.at(0);
+        representation.segmentSize  = (double)atoi(fields.at(4).c_str()) / 8.0 * duration * 1024;
+        representations.push_back(representation);
+    }
+    return !representations.empty();
+}
+
+/* segment i is taken from representation i % #representations, like a player that switches a lot */
+static std::string SegmentPath (const std::vector<Representation> &representations, int i)
+{
+    std::ostringstream path;
+    path << "vid1/repr_" << representations.at(i % representations.size()).id << "_seg_" << i << ".264";
+    return path.str();
+}
+
+static int Create (const std::string &dir, const std::vector<Representation> &representations, int segments)
+{
+    mkdir(dir.c_str(), 0755);
+    mkdir((dir + "/vid1").c_str(), 0755);
+
+    for(int i = 0; i < segments; i++)
+    {
+        ofstream out((dir + "/" + SegmentPath(representations, i)).c_str(), ios::out | ios::binary);
+        std::string body(representations.at(i % representations.size()).segmentSize, 'x');
+        out.write(body.data(), body.size());
+    }
+    return 0;
+}
+
+static int Download (const std::string &base, const std::vector<Representation> &representations, int segments)
+{
+    uint8_t     buffer[32768];
+    uint64_t    bytes   = 0;
+    double      start   = Now();
+
+    for(int i = 0; i < segments; i++)
+    {
+        BenchChunk chunk(base + SegmentPath(representations, i));
+        if(!chunk.StartDownload())
+        {
+            cerr << "Cannot start the download of " << chunk.AbsoluteURI() << endl;
+            return 1;
+        }
+
+        int ret;
+        while((ret = chunk.Read(buffer, sizeof(buffer))) > 0)
+            bytes += ret;
+    }
+
+    double seconds = Now() - start;
+    cout << "segments " << segments << " bytes " << bytes
+         << " time-per-segment " << seconds * 1000.0 / segments << " ms"
+         << " throughput " << bytes * 8.0 / seconds / 1e6 << " Mbit/s" << endl;
+    return 0;
+}
+
+int main (int argc, char **argv)
+{
+    bool create = argc == 5 && std::string(argv[1]) == "--create";
+    if(argc != 4 && !create)
+    {
+        cerr << "usage: " << argv[0] << " [--create dir | base-url] representations.csv segments" << endl;
+        return 1;
+    }
+
+    std::vector<Representation> representations;
+    if(!ReadRepresentations(argv[argc - 2], representations))
+    {
+        cerr << "Cannot read " << argv[argc - 2] << endl;
+        return 1;
+    }
+    int segments = atoi(argv[argc - 1]);
+
+    if(create)
+        return Create(argv[2], representations, segments);
+    return Download(argv[1], representations, segments);
+}
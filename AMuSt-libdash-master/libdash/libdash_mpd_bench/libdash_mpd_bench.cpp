@@ -0,0 +1,146 @@
+/*
+ * libdash_mpd_bench.cpp
+ *****************************************************************************
+ * Copyright (C) 2012, bitmovin Softwareentwicklung OG, All Rights Reserved
+ *
+ * Email: libdash-dev@vicky.bitmovin.net
+ *
+ * This source code and its use and distribution, is subject to the terms
+ * and conditions of the applicable license agreement.
+ *****************************************************************************/
+
+/*
+ * Generates a SegmentList MPD with the given number of representations and
+ * SegmentURLs per representation, parses it a few times with libdash and
+ * reports the parse time and the heap held by the parsed MPD.
+ *
+ *   libdash_mpd_bench 10 5000            parse from a file
+ *   libdash_mpd_bench 10 5000 --memory   parse from a buffer
+ */
+
+#include "libdash.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <stdlib.h>
+#include <stdio.h>
+#include <malloc.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+using namespace dash;
+using namespace dash::mpd;
+using namespace std;
+
+static double Now ()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static size_t HeapInUse ()
+{
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+static std::string Generate (int representations, int segments)
+{
+    std::ostringstream mpd;
+    mpd << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" type=\"static\" minBufferTime=\"PT2S\""
+        << " mediaPresentationDuration=\"PT" << segments * 2 << "S\" profiles=\"urn:mpeg:dash:profile:full:2011\">\n"
+        << "  <BaseURL>http://localhost/content/</BaseURL>\n"
+        << "  <Period start=\"PT0S\">\n"
+        << "    <AdaptationSet mimeType=\"video/mp4\" segmentAlignment=\"true\" bitstreamSwitching=\"true\">\n";
+
+    for(int r = 0; r < representations; r++)
+    {
+        mpd << "      <Representation id=\"" << r << "\" codecs=\"avc1\" width=\"1280\" height=\"720\""
+            << " frameRate=\"24\" bandwidth=\"" << (r + 1) * 250000 << "\">\n"
+            << "        <SegmentList duration=\"2\" timescale=\"1\">\n"
+            << "          <Initialization sourceURL=\"vid1/repr_" << r << "_init.mp4\"/>\n";
+
+        for(int s = 0; s < segments; s++)
+            mpd << "          <SegmentURL media=\"vid1/repr_" << r << "_seg_" << s << ".264\""
+                << " mediaRange=\"0-" << (r + 1) * 62500 << "\"/>\n";
+
+        mpd << "        </SegmentList>\n"
+            << "      </Representation>\n";
+    }
+
+    mpd << "    </AdaptationSet>\n"
+        << "  </Period>\n"
+        << "</MPD>\n";
+    return mpd.str();
+}
+
+static size_t CountSegmentURLs (IMPD *mpd)
+{
+    size_t                          count   = 0;
+    std::vector<IRepresentation *>  reps    = mpd->GetPeriods().at(0)->GetAdaptationSets().at(0)->GetRepresentation();
+
+    for(size_t i = 0; i < reps.size(); i++)
+        count += reps.at(i)->GetSegmentList()->GetSegmentURLs().size();
+
+    return count;
+}
+
+int main (int argc, char **argv)
+{
+    bool memory = argc == 4 && std::string(argv[3]) == "--memory";
+    if(argc != 3 && !memory)
+    {
+        cerr << "usage: " << argv[0] << " representations segments [--memory]" << endl;
+        return 1;
+    }
+
+    int         representations = atoi(argv[1]);
+    int         segments        = atoi(argv[2]);
+    std::string xml             = Generate(representations, segments);
+    std::string path            = "/tmp/libdash_mpd_bench.mpd";
+
+    ofstream out(path.c_str(), ios::out | ios::binary);
+    out << xml;
+    out.close();
+
+    IDASHManager    *manager    = CreateDashManager();
+    double          best        = 0;
+    size_t          held        = 0;
+    size_t          urls        = 0;
+
+    for(int run = 0; run < 5; run++)
+    {
+        size_t heap     = HeapInUse();
+        double start    = Now();
+        IMPD   *mpd     = memory ? manager->Open(xml.data(), xml.size(), path.c_str())
+                                 : manager->Open((char *) path.c_str());
+        double seconds  = Now() - start;
+
+        if(mpd == NULL)
+        {
+            cerr << "Cannot parse the MPD" << endl;
+            return 1;
+        }
+
+        if(run == 0 || seconds < best)
+            best = seconds;
+        held = HeapInUse() - heap;
+        urls = CountSegmentURLs(mpd);
+        delete mpd;
+    }
+    manager->Delete();
+    remove(path.c_str());
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    cout << "mpd " << xml.size() / 1024 << " KB segment-urls " << urls
+         << " parse " << best * 1000.0 << " ms"
+         << " heap-held " << held / 1024 << " KB"
+         << " max-rss " << usage.ru_maxrss << " KB" << endl;
+    return 0;
+}
@@ -46,7 +46,7 @@ int
 main (int argc, char *argv[])
 {
   Config::SetDefault ("ns3::TcpSocketBase::EnableMpTcp", BooleanValue(true));
-  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue("ns3::MpTcpCongestionLia"));
+  Config::SetDefault ("ns3::MpTcpSocketBase::CongestionControlType", StringValue("ns3::MpTcpCongestionLia"));
 
   // LogComponentEnable ("HttpClientApplication", LOG_LEVEL_ALL);
   // LogComponentEnable ("DASHFakeServerApplication", LOG_LEVEL_ALL);
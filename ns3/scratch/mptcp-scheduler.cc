@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Network topology
+//
+//       n0 ----------- n1   (--rate1, --delay1)
+//          ----------- n1   (--rate2, --delay2)
+//
+// - n0 fetches --segments video segments of --duration seconds at --bitrate
+//   from n1, one after the other over one MPTCP connection, for each of the
+//   MPTCP schedulers (or only --scheduler).
+// - A playback buffer starts playing once the first segment is in, and the
+//   next segment is requested as soon as the buffer holds less than --buffer
+//   seconds. A stall is counted every time the buffer runs dry.
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <stdio.h>
+#include "ns3/core-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/network-module.h"
+#include "ns3/ipv4-address-generator.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("MpTcpSchedulerExample");
+
+static uint32_t segments = 60;
+static double duration = 2.0;
+static double maxBuffer = 10.0;
+static std::vector<double> downloadTime;  // Seconds per segment
+static uint32_t stalls = 0;
+static double stallTime = 0;
+static double playUntil = 0;              // Simulation time the buffered video lasts until
+
+class SegmentFetcher : public HttpClientApplication
+{
+public:
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("SegmentFetcher")
+      .SetParent<HttpClientApplication> ()
+      .AddConstructor<SegmentFetcher> ()
+    ;
+    return tid;
+  }
+
+protected:
+  virtual void OnFileReceived (unsigned status, unsigned length)
+  {
+    HttpClientApplication::OnFileReceived (status, length);
+    double now = Simulator::Now ().GetSeconds ();
+    downloadTime.push_back (now - m_requested);
+    if (downloadTime.size () == 1)
+      playUntil = now;
+    else if (now > playUntil)
+      {
+        stalls++;
+        stallTime += now - playUntil;
+        playUntil = now;
+      }
+    playUntil += duration;
+
+    if (downloadTime.size () == segments)
+      {
+        Simulator::Stop ();
+        return;
+      }
+    double wait = std::max (0.0, playUntil - now - maxBuffer);
+    Simulator::Schedule (Seconds (wait + 0.001), &SegmentFetcher::Next, this);
+  }
+
+  virtual void StartApplication (void)
+  {
+    m_requested = Simulator::Now ().GetSeconds ();
+    HttpClientApplication::StartApplication ();
+  }
+
+private:
+  void Next (void)
+  {
+    StopApplication ();
+    StartApplication ();
+  }
+
+  double m_requested;
+};
+
+static void
+Run (DataDistribAlgo_t scheduler, std::string name, std::string rate1, std::string delay1,
+     std::string rate2, std::string delay2, std::string metaFile)
+{
+  downloadTime.clear ();
+  stalls = 0;
+  stallTime = 0;
+  playUntil = 0;
+  Ipv4AddressGenerator::Reset ();
+  Config::SetDefault ("ns3::MpTcpSocketBase::SchedulingAlgorithm", EnumValue (scheduler));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue (rate1));
+  p2p.SetChannelAttribute ("Delay", StringValue (delay1));
+  NetDeviceContainer d0 = p2p.Install (nodes);
+  p2p.SetDeviceAttribute ("DataRate", StringValue (rate2));
+  p2p.SetChannelAttribute ("Delay", StringValue (delay2));
+  NetDeviceContainer d1 = p2p.Install (nodes);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer i0 = ipv4.Assign (d0);
+  ipv4.SetBase ("10.0.1.0", "255.255.255.0");
+  ipv4.Assign (d1);
+
+  HttpServerHelper server (Ipv4Address::GetAny (), 80, "/", "localhost");
+  server.SetAttribute ("MetaDataFile", StringValue (metaFile));
+  server.SetAttribute ("MetaDataDirectory", StringValue (""));
+  ApplicationContainer serverApps = server.Install (nodes.Get (1));
+  serverApps.Start (Seconds (0.0));
+
+  Ptr<SegmentFetcher> client = CreateObject<SegmentFetcher> ();
+  client->SetAttribute ("RemoteAddress", AddressValue (i0.GetAddress (1)));
+  client->SetAttribute ("FileToRequest", StringValue ("segment.bin"));
+  client->SetAttribute ("KeepAlive", BooleanValue (true));
+  nodes.Get (0)->AddApplication (client);
+  client->SetStartTime (Seconds (1.0));
+
+  Simulator::Stop (Seconds (1000.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  double sum = 0;
+  double max = 0;
+  for (uint32_t i = 0; i < downloadTime.size (); i++)
+    {
+      sum += downloadTime[i];
+      max = std::max (max, downloadTime[i]);
+    }
+  double mean = downloadTime.empty () ? 0 : sum / downloadTime.size ();
+  printf ("%-12s %8u/%-4u %10.1f %10.1f %8u %10.2f\n", name.c_str (), (uint32_t) downloadTime.size (), segments,
+          mean * 1000, max * 1000, stalls, stallTime);
+}
+
+int main (int argc, char *argv[])
+{
+  std::string rate1 = "8Mbps";
+  std::string delay1 = "10ms";
+  std::string rate2 = "4Mbps";
+  std::string delay2 = "100ms";
+  std::string bitrate = "6Mbps";
+  std::string scheduler = "";
+
+  CommandLine cmd;
+  cmd.AddValue ("rate1", "Data rate of the first path", rate1);
+  cmd.AddValue ("delay1", "Delay of the first path", delay1);
+  cmd.AddValue ("rate2", "Data rate of the second path", rate2);
+  cmd.AddValue ("delay2", "Delay of the second path", delay2);
+  cmd.AddValue ("bitrate", "Video bit rate of the segments", bitrate);
+  cmd.AddValue ("duration", "Playback duration of one segment in seconds", duration);
+  cmd.AddValue ("segments", "Number of segments to fetch", segments);
+  cmd.AddValue ("buffer", "Seconds of video to buffer before pausing the download", maxBuffer);
+  cmd.AddValue ("scheduler", "Only run this scheduler (Round_Robin, Min_RTT, BLEST or ECF)", scheduler);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1400));
+  Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (0));
+  Config::SetDefault ("ns3::DropTailQueue::Mode", StringValue ("QUEUE_MODE_PACKETS"));
+  Config::SetDefault ("ns3::DropTailQueue::MaxPackets", UintegerValue (100));
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (MpTcpSocketBase::GetTypeId ()));
+  Config::SetDefault ("ns3::MpTcpSocketBase::MaxSubflows", UintegerValue (8));
+
+  uint32_t segmentSize = DataRate (bitrate).GetBitRate () * duration / 8;
+  std::string metaFile = "mptcp-scheduler.csv";
+  std::ofstream meta (metaFile.c_str ());
+  meta << "segment.bin," << segmentSize << std::endl;
+  meta.close ();
+
+  printf ("%u segments of %u bytes, path 1 %s/%s, path 2 %s/%s\n", segments, segmentSize,
+          rate1.c_str (), delay1.c_str (), rate2.c_str (), delay2.c_str ());
+  printf ("%-12s %13s %10s %10s %8s %10s\n", "scheduler", "segments", "mean(ms)", "max(ms)", "stalls", "stalled(s)");
+
+  const DataDistribAlgo_t algos[] = { Round_Robin, Min_RTT, BLEST, ECF };
+  const char *names[] = { "Round_Robin", "Min_RTT", "BLEST", "ECF" };
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      if (scheduler.empty () || scheduler == names[i])
+        Run (algos[i], names[i], rate1, delay1, rate2, delay2, metaFile);
+    }
+
+  remove (metaFile.c_str ());
+  return 0;
+}
@@ -123,7 +123,7 @@ std::string /* mpd string */
 DASHFakeServerApplication::ImportDASHRepresentations (std::string mpdMetaDataFilename, int video_id)
 {
   NS_LOG_FUNCTION(mpdMetaDataFilename << video_id);
-// read m_mpdMetaDataFiles and fill m_fileSizes
+// read m_mpdMetaDataFiles and fill m_catalog
   std::ifstream infile(mpdMetaDataFilename.c_str());
   if (!infile.is_open())
   {
@@ -197,104 +197,83 @@ DASHFakeServerApplication::ImportDASHRepresentations (std::string mpdMetaDataFil
   std::ofstream segments_file;
   segments_file.open("segments", std::ofstream::app);
 
+  // each line is reprId,QualityIndex,screenWidth,screenHeight,bitrate and,
+  // with bitrate variation, sigma/mu,avgChunkSize; split it in one pass
+  std::vector<std::string> fields;
+
   while (std::getline(infile,line))
   {
-    if (line.length() > 2) // line must not be empty
+    if (line.length() <= 2) // line must not be empty
+      continue;
+
+    fields.clear();
+    size_t start = 0;
+    for (;;)
+    {
+      size_t comma = line.find(',', start);
+      fields.push_back(line.substr(start, comma - start));
+      if (comma == std::string::npos)
+        break;
+      start = comma + 1;
+    }
+
+    if (fields.size() < 5)
+      continue;
+
+    const std::string& repr_id = fields[0];
+    const std::string& quality_index = fields[1];
+    const std::string& repr_width = fields[2];
+    const std::string& repr_height = fields[3];
+    const std::string& repr_bitrate = fields[4];
+    double sigma_mu = -1;
+    double avgchunksize = 0;
+
+    if (fields.size() > 5)
+    {
+      sigma_mu = atof(fields[5].c_str());
+      avgchunksize = atof(fields[fields.size() > 6 ? 6 : 5].c_str());
+    }
+    double bitrate = atof(repr_bitrate.c_str());
+    int iBitrate = atoi(repr_bitrate.c_str()); // read bitrate in kilobit/s
+
+    NS_LOG_DEBUG ("Representation ID = "<<repr_id.c_str()<<", height = "<<repr_height.c_str()<<", bitrate = " <<repr_bitrate.c_str());
+    mpdData << "<Representation id=\"" << repr_id << "\" codecs=\"avc1\" mimeType=\"video/mp4\"" <<
+         " width=\"" << repr_width << "\" height=\"" << repr_height << "\" startWithSAP=\"1\" bandwidth=\"" << (iBitrate*1000) << "\">" << std::endl;
+    mpdData << "<SegmentList duration=\"" << segment_duration << "\">" << std::endl;
+
+
+    //JEREMIE: modify the size of each segment according to bit rate variation
+    Ptr<LogNormalRandomVariable> x = CreateObject<LogNormalRandomVariable> ();
+    if(sigma_mu>=0){
+      double delta=std::sqrt(1.0/(sigma_mu*sigma_mu)+2*std::log(avgchunksize));
+      double sigma=-1/sigma_mu+delta;
+      double mu=sigma/sigma_mu;
+      //double mu=std::log(bitrate*bitrate/std::sqrt(bitrate*bitrate+sigma_mu*bitrate));
+      //double sigma=std::sqrt(std::log(sigma_mu*bitrate/(bitrate*bitrate)+1));
+      NS_LOG_INFO( bitrate << " " << sigma_mu << " " << sigma << " " << mu );
+      x->SetAttribute("Mu", DoubleValue (mu));
+      x->SetAttribute("Sigma", DoubleValue (sigma));
+      NS_LOG_INFO( quality_index << " " << avgchunksize << " " << iBitrate << " " << mu << " " << sigma << " " << x->GetValue() << " " << bitrate << " " << sigma_mu*bitrate << " " << sigma_mu << " " << x->GetValue());
+    }
+
+    long iSegmentSize = (double)iBitrate/8.0 * (double)segment_duration * 1024; // in byte
+
+    for (int i = 0; i < number_of_segments; i++)
     {
-      size_t pos1 = line.find(",");
-      if (pos1 != std::string::npos)
-      {
-        std::string repr_id = line.substr(0, pos1);
-        line = line.substr(pos1+1);
-
-        pos1 = line.find(",");
-        if (pos1 != std::string::npos)
-        {
-         std::string quality_index = line.substr(0, pos1);
-         line = line.substr(pos1+1);
-
-         pos1 = line.find(",");
-         if (pos1 != std::string::npos)
-         {
-          std::string repr_width = line.substr(0, pos1);
-          line = line.substr(pos1+1);
-
-          pos1 = line.find(",");
-
-          if (pos1 != std::string::npos)
-          {
-            std::string repr_height = line.substr(0, pos1);
-	    line = line.substr(pos1+1);
-
-	    pos1 = line.find(",");
-
-	    std::string repr_bitrate; 
-	    std::string repr_sigma_mu;
-	    std::string repr_avgchuncksize;
-	    double bitrate;
-	    double sigma_mu=-1;
-	    double avgchunksize;
-
-            if (pos1 != std::string::npos)
-            {
-               repr_bitrate  = line.substr(0, pos1);
-	       line = line.substr(pos1+1);
-	       pos1 = line.find(",");
-               repr_sigma_mu  = line.substr(0, pos1);
-               repr_avgchuncksize = line.substr(pos1+1);
-	       sigma_mu=atof(repr_sigma_mu.c_str());
-	       avgchunksize=atof(repr_avgchuncksize.c_str());	
-	    }else{
-	       repr_bitrate  = line.substr(pos1+1);
-	    }
-	    bitrate=atof(repr_bitrate.c_str());
-	    int iBitrate = atoi(repr_bitrate.c_str()); // read bitrate in kilobit/s
-
-            NS_LOG_DEBUG ("Representation ID = "<<repr_id.c_str()<<", height = "<<repr_height.c_str()<<", bitrate = " <<repr_bitrate.c_str());
-            mpdData << "<Representation id=\"" << repr_id << "\" codecs=\"avc1\" mimeType=\"video/mp4\"" <<
-                 " width=\"" << repr_width << "\" height=\"" << repr_height << "\" startWithSAP=\"1\" bandwidth=\"" << (iBitrate*1000) << "\">" << std::endl;
-            mpdData << "<SegmentList duration=\"" << segment_duration << "\">" << std::endl;
-
-
-	    //JEREMIE: modify the size of each segment according to bit rate variation 
-	    Ptr<LogNormalRandomVariable> x = CreateObject<LogNormalRandomVariable> ();
-	    if(sigma_mu>=0){
-		double delta=std::sqrt(1.0/(sigma_mu*sigma_mu)+2*std::log(avgchunksize));
-		double sigma=-1/sigma_mu+delta; 
-		double mu=sigma/sigma_mu;
-		//double mu=std::log(bitrate*bitrate/std::sqrt(bitrate*bitrate+sigma_mu*bitrate));
-		//double sigma=std::sqrt(std::log(sigma_mu*bitrate/(bitrate*bitrate)+1));
-	    	NS_LOG_INFO( bitrate << " " << sigma_mu << " " << sigma << " " << mu );
-	    	x->SetAttribute("Mu", DoubleValue (mu));
-	   	x->SetAttribute("Sigma", DoubleValue (sigma));
-	    	NS_LOG_INFO( quality_index << " " << avgchunksize << " " << iBitrate << " " << mu << " " << sigma << " " << x->GetValue() << " " << bitrate << " " << sigma_mu*bitrate << " " << sigma_mu << " " << x->GetValue());
-		//exit(0);
-	    }
-            
-	    long iSegmentSize = (double)iBitrate/8.0 * (double)segment_duration * 1024; // in byte
-            
-	    for (int i = 0; i < number_of_segments; i++)
-            {
-              std::ostringstream segmentFileName;
-              segmentFileName << "vid" << video_id << "/repr_" << repr_id << "_seg_" << i << ".264";
-	      if(sigma_mu>=0){
-			iBitrate=(int)x->GetValue()/ (double)segment_duration;
-			iSegmentSize = (double)iBitrate/8.0 * (double)segment_duration * 1024; // in byte
-	      }
-	      segments_file  << video_id << " " << repr_id << " " << i << " " << iSegmentSize << " " << quality_index << "\n";
-              m_fileSizes[m_metaDataContentDirectory + segmentFileName.str()] = iSegmentSize;
-
-              m_virtualFiles.push_back(m_metaDataContentDirectory + segmentFileName.str());
-              mpdData << "<SegmentURL media=\"" <<  "repr_" << repr_id << "_seg_" << i << ".264" << "\"/> " << std::endl;
-              //fprintf(stderr, "SegmentName=%s\n", (m_metaDataContentDirectory + segmentFileName.str()).c_str());
-            }
-
-            mpdData << "</SegmentList>" << std::endl << "</Representation>" << std::endl;
-          }
-        }
-       }
+      std::ostringstream segmentFileName;
+      segmentFileName << "vid" << video_id << "/repr_" << repr_id << "_seg_" << i << ".264";
+      if(sigma_mu>=0){
+        iBitrate=(int)x->GetValue()/ (double)segment_duration;
+        iSegmentSize = (double)iBitrate/8.0 * (double)segment_duration * 1024; // in byte
       }
+      segments_file  << video_id << " " << repr_id << " " << i << " " << iSegmentSize << " " << quality_index << "\n";
+      m_catalog.AddVirtualFile(m_metaDataContentDirectory + segmentFileName.str(), iSegmentSize);
+
+      mpdData << "<SegmentURL media=\"" <<  "repr_" << repr_id << "_seg_" << i << ".264" << "\"/> " << std::endl;
+      //fprintf(stderr, "SegmentName=%s\n", (m_metaDataContentDirectory + segmentFileName.str()).c_str());
     }
+
+    mpdData << "</SegmentList>" << std::endl << "</Representation>" << std::endl;
   }
   segments_file.close();
   mpdData << "</AdaptationSet></Period></MPD>" << std::endl;
@@ -454,12 +433,9 @@ DASHFakeServerApplication::StartApplication (void)
 
     SSMpdFilename << m_mpdDirectory << "vid" << video_id << ".mpd.gz";
 
-    m_fileSizes[SSMpdFilename.str()] = compressedMpdData.size();
-
-    NS_LOG_INFO ("Adding " << SSMpdFilename.str().c_str() << " to m_fileSizes with size " << compressedMpdData.size());
-
+    NS_LOG_INFO ("Adding " << SSMpdFilename.str().c_str() << " to m_catalog with size " << compressedMpdData.size());
 
-    m_mpdFileContents[SSMpdFilename.str()] = compressedMpdData;
+    m_catalog.AddMemoryFile(SSMpdFilename.str(), compressedMpdData);
 
     video_id++;
   }
@@ -481,7 +457,8 @@ DASHFakeServerApplication::StopApplication ()
     m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
   }
 
-  this->m_virtualFiles.clear (); // Vitalii: let's see if it helps with memory leaking
+  // later requests on connections still open find nothing
+  m_catalog.Clear ();
 }
 
 
@@ -510,13 +487,14 @@ DASHFakeServerApplication::ConnectionAccepted (Ptr<Socket> s, const Address& add
 
   uint64_t socket_id = RegisterSocket(socket);
 
-  m_activeClients[socket_id] = new HttpServerFakeVirtualClientSocket(socket_id, "/", m_fileSizes, m_virtualFiles, m_mpdFileContents,
+  m_activeClients[socket_id] = new HttpServerFakeVirtualClientSocket(socket_id, "/", m_catalog,
                   MakeCallback(&DASHFakeServerApplication::FinishedCallback, this));
 
   NS_LOG_DEBUG (socket << " " << Simulator::Now () << " Successful socket id : " << socket_id << " Connection Accepted From " << address);
 
   // set callbacks for this socket to be in HttpServerFakeClientSocket class
   socket->SetSendCallback (MakeCallback (&HttpServerFakeVirtualClientSocket::HandleReadyToTransmit, m_activeClients[socket_id]));
+  socket->SetDataSentCallback (MakeCallback (&HttpServerFakeVirtualClientSocket::HandleDataSent, m_activeClients[socket_id]));
   socket->SetRecvCallback (MakeCallback (&HttpServerFakeVirtualClientSocket::HandleIncomingData, m_activeClients[socket_id]));
 
 
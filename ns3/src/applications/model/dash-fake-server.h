@@ -101,10 +101,7 @@ private:
 
   std::map<uint64_t /* socket id */, std::string /* packet buffer */ > m_activePackets;
 
-  std::map<std::string, long> m_fileSizes;
-  std::vector<std::string> m_virtualFiles;
-
-  std::map<std::string, std::string> m_mpdFileContents;
+  HttpFileCatalog m_catalog;
 
   uint64_t m_lastSocketID;
 
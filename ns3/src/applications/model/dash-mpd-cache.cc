@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Parsed MPDs shared by the DASH clients of a simulation
+
+
+#include <sstream>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/hash.h"
+#include "ns3/string.h"
+#include "dash-mpd-cache.h"
+
+
+NS_LOG_COMPONENT_DEFINE ("DashMpdCache");
+
+namespace ns3 {
+
+DashMpdCache::Entries DashMpdCache::m_entries;
+DashMpdCache::Keys DashMpdCache::m_keys;
+
+dash::mpd::IMPD*
+DashMpdCache::Acquire (std::string url, const std::string &body)
+{
+  std::ostringstream key;
+  key << url << "#" << std::hex << Hash64 (body) << "-" << body.size ();
+
+  Entries::iterator it = m_entries.find (key.str ());
+  if (it != m_entries.end ())
+    {
+      NS_LOG_DEBUG ("Reusing parsed MPD " << key.str ());
+      it->second.refs++;
+      return it->second.mpd;
+    }
+
+  NS_LOG_DEBUG ("Parsing MPD " << key.str ());
+  dash::mpd::IMPD *mpd = Parse (url, body);
+  if (mpd == NULL)
+    {
+      return NULL;
+    }
+  Entry entry;
+  entry.mpd = mpd;
+  entry.refs = 1;
+  m_entries[key.str ()] = entry;
+  m_keys[mpd] = key.str ();
+  return mpd;
+}
+
+void
+DashMpdCache::Release (dash::mpd::IMPD *mpd)
+{
+  Keys::iterator key = m_keys.find (mpd);
+  NS_ASSERT_MSG (key != m_keys.end (), "MPD was not acquired from the cache");
+  Entries::iterator it = m_entries.find (key->second);
+  if (--it->second.refs == 0)
+    {
+      NS_LOG_DEBUG ("Deleting parsed MPD " << key->second);
+      delete mpd;
+      m_entries.erase (it);
+      m_keys.erase (key);
+    }
+}
+
+uint32_t
+DashMpdCache::GetNMpds (void)
+{
+  return m_entries.size ();
+}
+
+dash::mpd::IMPD*
+DashMpdCache::Parse (const std::string &url, const std::string &body)
+{
+  std::string xml;
+  try
+  {
+    xml = zlib_decompress_string (body);
+  }
+  catch (std::exception &e)
+  {
+    NS_LOG_DEBUG (e.what () << " Assuming MPD was not zipped!");
+    xml = body;
+  }
+
+  dash::IDASHManager *manager = CreateDashManager ();
+  dash::mpd::IMPD *mpd = manager->Open (xml.data (), xml.size (), url.c_str ());
+  manager->Delete ();
+
+  if (mpd == NULL)
+    {
+      NS_LOG_ERROR ("Error parsing mpd " << url);
+    }
+  return mpd;
+}
+
+} // namespace ns3
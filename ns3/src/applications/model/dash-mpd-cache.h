@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Parsed MPDs shared by the DASH clients of a simulation
+
+
+#ifndef DASH_MPD_CACHE_H
+#define DASH_MPD_CACHE_H
+
+#include <stdint.h>
+#include <string>
+#include <map>
+
+#include "libdash.h"
+
+
+namespace ns3 {
+
+/**
+ * \brief Process-wide, reference counted cache of parsed MPDs
+ *
+ * Every MultimediaConsumer still downloads its MPD, but clients that got
+ * the same bytes from the same URL share one parsed IMPD instead of each
+ * writing, decompressing and parsing their own copy. The tree is treated
+ * as read-only by its users and deleted when the last one releases it.
+ */
+class DashMpdCache
+{
+public:
+  /**
+   * \brief Get the parsed MPD of a downloaded body, parsing it on first use
+   * \param url the URL the MPD was downloaded from
+   * \param body the downloaded bytes, gzip compressed or not
+   * \returns the MPD, to be given back with Release (), or NULL if the body
+   *          could not be parsed
+   */
+  static dash::mpd::IMPD* Acquire (std::string url, const std::string &body);
+
+  /**
+   * \brief Give back an MPD returned by Acquire ()
+   */
+  static void Release (dash::mpd::IMPD *mpd);
+
+  /// \returns the number of distinct MPDs currently parsed
+  static uint32_t GetNMpds (void);
+
+private:
+  struct Entry
+  {
+    dash::mpd::IMPD *mpd;
+    uint32_t refs;
+  };
+  typedef std::map<std::string, Entry> Entries;
+  typedef std::map<dash::mpd::IMPD*, std::string> Keys;
+
+  static dash::mpd::IMPD* Parse (const std::string &url, const std::string &body);
+
+  static Entries m_entries;   // by URL and content hash
+  static Keys m_keys;         // entry key of each MPD
+};
+
+} // namespace ns3
+
+#endif /* DASH_MPD_CACHE_H */
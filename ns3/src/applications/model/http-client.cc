@@ -35,6 +35,8 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/integer.h"
+#include "ns3/enum.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/mp-tcp-socket-base.h"
 
@@ -85,10 +87,36 @@ HttpClientApplication::GetTypeId (void)
                    StringValue(""),
                    MakeStringAccessor(&HttpClientApplication::m_outFile),
                    MakeStringChecker())
+    .AddAttribute("OutfileMode", "What to do with the downloaded bytes: write them to WriteOutfile, keep them "
+                   "in memory, only checksum them or only count them (the last three do no disk I/O)",
+                   EnumValue(HttpDownloadWriter::TO_FILE),
+                   MakeEnumAccessor(&HttpClientApplication::m_outFileMode),
+                   MakeEnumChecker(HttpDownloadWriter::TO_FILE, "File",
+                                   HttpDownloadWriter::TO_MEMORY, "Memory",
+                                   HttpDownloadWriter::CHECKSUM, "Checksum",
+                                   HttpDownloadWriter::DISCARD, "Discard"))
     .AddAttribute("KeepAlive", "Whether or not the connection should be re-used every time (default: false)",
                    BooleanValue(false),
                    MakeBooleanAccessor(&HttpClientApplication::m_keepAlive),
                    MakeBooleanChecker())
+    .AddAttribute("PipelineDepth", "Maximum number of requests outstanding on a keep-alive connection; "
+                   "more than 1 allows PipelineRequest to send requests before the current download has finished",
+                   UintegerValue(1),
+                   MakeUintegerAccessor(&HttpClientApplication::m_pipelineDepth),
+                   MakeUintegerChecker<uint32_t>(1))
+    .AddAttribute("RangeFirst", "First byte of the files to request; -1 requests the whole files",
+                   IntegerValue(-1),
+                   MakeIntegerAccessor(&HttpClientApplication::m_rangeFirst),
+                   MakeIntegerChecker<int64_t>(-1))
+    .AddAttribute("RangeLast", "Last byte of the files to request, when RangeFirst is set; -1 requests up to their end",
+                   IntegerValue(-1),
+                   MakeIntegerAccessor(&HttpClientApplication::m_rangeLast),
+                   MakeIntegerChecker<int64_t>(-1))
+    .AddAttribute("Multipath", "Whether the connection opens MPTCP subflows over the other interfaces of the node; "
+                   "if not, it stays on the path of its first subflow like a plain TCP connection",
+                   BooleanValue(true),
+                   MakeBooleanAccessor(&HttpClientApplication::m_multipath),
+                   MakeBooleanChecker())
     .AddTraceSource("FileDownloadFinished", "Trace called every time a download finishes",
                    MakeTraceSourceAccessor(&HttpClientApplication::m_downloadFinishedTrace))
     .AddTraceSource("HeaderReceived", "Trace called every time a header is received",
@@ -108,6 +136,8 @@ HttpClientApplication::HttpClientApplication ()
   node_id = 0;
   m_socket = 0;
   lastDownloadBitrate = -1;
+  lastDownloadSeconds = 0;
+  m_responseStatus = 0;
 
   _tmpbuffer = NULL; // init this thing
 
@@ -136,6 +166,18 @@ HttpClientApplication::GetLastDownloadBandwidth ()
   return r;
 }
 
+uint32_t
+HttpClientApplication::GetLastDownloadChecksum () const
+{
+  return m_writer.GetChecksum ();
+}
+
+const std::string &
+HttpClientApplication::GetLastDownloadData () const
+{
+  return m_writer.GetData ();
+}
+
 std::string
 HttpClientApplication::GetRemoteAddress ()
 {
@@ -221,14 +263,21 @@ HttpClientApplication::TryEstablishConnection (void)
       m_socket = DynamicCast<MpTcpSocketBase>(Socket::CreateSocket (GetNode (), tid));
       m_socket->SetFlowType("Long");
       m_socket->SetOutputFileName("NULL");
+      if (!m_multipath)
+      {
+        m_socket->SetAttribute("PathManagement", EnumValue(Default));
+      }
       if (Ipv4Address::IsMatchingType(m_peerAddress) == true)
       {
         m_socket->Bind();
-        int errno = m_socket->Connect (InetSocketAddress (Ipv4Address::ConvertFrom(m_peerAddress), m_peerPort));
+        if (m_socket->Connect (InetSocketAddress (Ipv4Address::ConvertFrom(m_peerAddress), m_peerPort)) == -1)
+        {
+          NS_FATAL_ERROR ("Failed to connect to " << Ipv4Address::ConvertFrom(m_peerAddress) << ":" << m_peerPort);
+        }
         m_socket->SetFlowId(0);
         m_socket->SetDupAckThresh(0);
 
-        NS_LOG_DEBUG("Binding to Ipv4:" << Ipv4Address::ConvertFrom(m_peerAddress) << ":" << m_peerPort << ", errno=" << errno);
+        NS_LOG_DEBUG("Binding to Ipv4:" << Ipv4Address::ConvertFrom(m_peerAddress) << ":" << m_peerPort);
 
       }
       else if (Ipv6Address::IsMatchingType(m_peerAddress) == true)
@@ -285,14 +334,8 @@ HttpClientApplication::StartApplication (void)
   m_active = true;
   _start_time = Simulator::Now ().GetMilliSeconds ();
 
-  // Create OutFile
-  if (!m_outFile.empty())
-  {
-   ///fprintf(stderr, "Client(%d): Creating outfile %s\n", node_id, m_outFile.c_str());
-    // (re)create outfile
-    FILE* fp = fopen(m_outFile.c_str(), "w");
-    fclose(fp);
-  }
+  // (re)create outfile, it stays open until the download is finished
+  m_writer.Open(m_outFileMode, m_outFile);
 
  ///fprintf(stderr, "Establishing connection (time=%f)...\n",Simulator::Now().GetSeconds());
   TryEstablishConnection();
@@ -374,6 +417,8 @@ HttpClientApplication::StopApplication ()
   }
 
   m_active = false;
+  m_writer.Close();
+  m_pipelinedRequests.clear();
 
   if (m_socket != 0 && !m_keepAlive)
   {
@@ -438,14 +483,21 @@ HttpClientApplication::DoSendGetRequest (Ptr<Socket> s, uint32_t txSpace)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<MpTcpSocketBase> localSocket = DynamicCast<MpTcpSocketBase> (s);
+  m_is_first_packet = true;
+  m_responseHeader.clear ();
+
+  SendGetRequest (DynamicCast<MpTcpSocketBase> (s), m_fileToRequest);
+}
 
-  m_downloadStartedTrace(this, this->m_fileToRequest);
+void
+HttpClientApplication::SendGetRequest (Ptr<MpTcpSocketBase> localSocket, std::string fileToRequest)
+{
+  m_downloadStartedTrace(this, fileToRequest);
 
   // Create HTTP 1.1 compatible request
   std::stringstream requestSS;
- ///fprintf(stderr, "Client(%d, %f): Executing  'GET %s'\n", node_id, Simulator::Now().GetSeconds(), m_fileToRequest.c_str());
-  requestSS << "GET " << m_fileToRequest << " HTTP/1.1" << CRLF;
+ ///fprintf(stderr, "Client(%d, %f): Executing  'GET %s'\n", node_id, Simulator::Now().GetSeconds(), fileToRequest.c_str());
+  requestSS << "GET " << fileToRequest << " HTTP/1.1" << CRLF;
   requestSS << "Host: " << m_hostName << CRLF;
   //requestSS << "Pragma: no-cache" << CRLF;
   //requestSS << "Cache-Control: no-cache" << CRLF;
@@ -453,6 +505,14 @@ HttpClientApplication::DoSendGetRequest (Ptr<Socket> s, uint32_t txSpace)
   requestSS << "User-Agent: ns-3 (applications/model/http-client.cc)" << CRLF;
   requestSS << "Accept-Encoding: identity" << CRLF; // no compression, gzip, etc... allowed
 
+  if (m_rangeFirst >= 0)
+  {
+    requestSS << "Range: bytes=" << m_rangeFirst << "-";
+    if (m_rangeLast >= 0)
+      requestSS << m_rangeLast;
+    requestSS << CRLF;
+  }
+
   if (m_keepAlive)
   {
     requestSS << "Connection: keep-alive" << CRLF;
@@ -464,9 +524,6 @@ HttpClientApplication::DoSendGetRequest (Ptr<Socket> s, uint32_t txSpace)
   requestSS << CRLF;
 
 
-  m_is_first_packet = true;
-
-
   std::string requestString = requestSS.str();
   //fprintf(stderr, "Creating Request String:\n%s\n------------\n", requestString.c_str());
 
@@ -520,6 +577,51 @@ HttpClientApplication::CancelDownload()
 }
 
 
+bool
+HttpClientApplication::CanPipelineRequest () const
+{
+  // the current request has to be out, so that the pipelined ones follow it
+  return m_active && m_keepAlive && m_socket != 0 && m_currentState != 0
+         && m_sentGetRequest && !m_finished_download
+         && m_pipelinedRequests.size () + 1 < m_pipelineDepth;
+}
+
+
+bool
+HttpClientApplication::PipelineRequest (std::string fileToRequest)
+{
+  NS_LOG_FUNCTION (this << fileToRequest);
+
+  if (!CanPipelineRequest ())
+    return false;
+
+  m_pipelinedRequests.push_back (fileToRequest);
+  SendGetRequest (m_socket, fileToRequest);
+  return true;
+}
+
+
+bool
+HttpClientApplication::NextPipelinedResponse ()
+{
+  if (!m_active || m_pipelinedRequests.empty ())
+    return false;
+
+  m_fileToRequest = m_pipelinedRequests.front ();
+  m_pipelinedRequests.pop_front ();
+  NS_LOG_DEBUG ("Client(" << node_id << "): Continuing with pipelined " << m_fileToRequest);
+
+  // what StartApplication and TryEstablishConnection would do, except that
+  // the request is out already; the download starts when the previous one ends
+  m_finished_download = false;
+  m_is_first_packet = true;
+  m_bytesRecv = 0;
+  _start_time = Simulator::Now ().GetMilliSeconds ();
+  m_writer.Open (m_outFileMode, m_outFile);
+  return true;
+}
+
+
 uint32_t
 HttpClientApplication::ParseResponseHeader(const uint8_t* buffer, size_t len, int* realStatusCode, unsigned int* contentLength)
 {
@@ -553,6 +655,8 @@ HttpClientApplication::ParseResponseHeader(const uint8_t* buffer, size_t len, in
       actualStatusCode[3] = '\0';
 
       int iStatusCode = atoi(actualStatusCode);
+      // known even if the rest of the header is not, e.g. for a 404 without body
+      *realStatusCode = iStatusCode;
 
       if (iStatusCode == 404)
       {
@@ -574,7 +678,9 @@ HttpClientApplication::ParseResponseHeader(const uint8_t* buffer, size_t len, in
           {
             pos = p - strContentLength;
             char actualContentLength[12];
+            pos = std::min(pos, 11);
             strncpy(actualContentLength,strContentLength,pos);
+            actualContentLength[pos] = '\0'; // strncpy does not terminate
             unsigned int iActualContentLength = atoi(actualContentLength);
 
 
@@ -584,7 +690,6 @@ HttpClientApplication::ParseResponseHeader(const uint8_t* buffer, size_t len, in
             if (p)
             {
               // done!
-              *realStatusCode = iStatusCode;
               *contentLength = iActualContentLength;
 
               pos = p - strbuffer;
@@ -623,6 +728,10 @@ HttpClientApplication::ParseResponseHeader(const uint8_t* buffer, size_t len, in
 void
 HttpClientApplication::OnFileReceived(unsigned status, unsigned length)
 {
+  // subclasses may read the outfile right after this
+  m_writer.Close();
+  NS_LOG_DEBUG("Client(" << node_id << "): Received " << m_writer.GetBytes() << " bytes, checksum " << m_writer.GetChecksum());
+
   if (!m_active)
     return;
 
@@ -637,7 +746,13 @@ HttpClientApplication::OnFileReceived(unsigned status, unsigned length)
 
   double downloadSpeed = ((double)requested_content_length)/((double)seconds);
 
+  // a pipelined response can arrive together with the one before it, which
+  // has measured the bitrate already
+  if (milliSeconds <= 0 && lastDownloadBitrate > 0)
+    downloadSpeed = lastDownloadBitrate / 8.0;
+
   lastDownloadBitrate = downloadSpeed * 8.0; // do not forget to do *8, as this is a BIT-rate
+  lastDownloadSeconds = seconds;
 
   m_downloadFinishedTrace(this, this->m_fileToRequest, downloadSpeed, milliSeconds);
 }
@@ -673,7 +788,10 @@ HttpClientApplication::HandleRead (Ptr<Socket> s)
 
   uint32_t bytes_recv_this_time = 0;
 
-  while ((packet = socket->Recv ()) && (packet->GetSize() != 0)) // Vitalii: before mptcp it was while (true)
+  // read in chunks of up to the size of _tmpbuffer (minus the trailing '\0'); the
+  // packets reference the socket's receive buffer, bytes are copied out only
+  // when they are actually looked at
+  while ((packet = socket->RecvPacket (128*1024 - 1)) && (packet->GetSize() != 0)) // Vitalii: before mptcp it was while (true)
   {
     // packet = socket->RecvFrom (from);
 
@@ -685,66 +803,79 @@ HttpClientApplication::HandleRead (Ptr<Socket> s)
 
     packet->RemoveAllPacketTags ();
     packet->RemoveAllByteTags ();
-    // PARSE PACKET
-    size_t packet_size = packet->CopyData(_tmpbuffer, packet->GetSize());
-    _tmpbuffer[packet_size] = '\0';
+    size_t packet_size = packet->GetSize();
+
+    // PARSE PACKET; a chunk running past the end of the current response
+    // holds the start of the next pipelined one
+    if (m_is_first_packet || m_writer.NeedsData() || packet_size > requested_content_length - m_bytesRecv)
+    {
+      packet_size = packet->CopyData(_tmpbuffer, packet_size);
+      _tmpbuffer[packet_size] = '\0';
+    }
 
     // NS_LOG_UNCOND ("\n\nsize: " << packet_size << " |" << _tmpbuffer << "|\n");
 
     bytes_recv_this_time += packet_size;
 
-    if (m_is_first_packet)
+    size_t offset = 0;
+    while (offset < packet_size)
     {
-      m_is_first_packet = false;
-      // parse header
-      int status_code = 0;
-      int where = ParseResponseHeader(_tmpbuffer, packet_size, &status_code, &(this->requested_content_length));
-      //fprintf(stderr, "content starts at position %d, with length %d (status code %d)\n", where, requested_content_length, status_code);
-      m_bytesRecv += packet_size - where;
-
-      m_headerReceivedTrace(this, this->m_fileToRequest, requested_content_length);
-
-      // write to file
-      if (!m_outFile.empty())
+      if (m_is_first_packet)
       {
-        // open outfile to append
-        FILE* fp = fopen(m_outFile.c_str(), "a");
-
-        fwrite(&_tmpbuffer[where], sizeof(uint8_t), packet_size-where, fp);
+        // collect the header, which may be split over several chunks
+        const char* start = (const char*) &_tmpbuffer[offset];
+        const char* end = m_responseHeader.empty () ? strstr (start, CRLF CRLF) : NULL;
+        size_t headerBytes;
+        if (end)
+        {
+          headerBytes = end - start + 4;
+          m_responseHeader.assign (start, headerBytes);
+        }
+        else
+        {
+          size_t received = m_responseHeader.size ();
+          m_responseHeader.append (start, packet_size - offset);
+          size_t pos = m_responseHeader.find (CRLF CRLF, received < 3 ? 0 : received - 3);
+          if (pos == std::string::npos)
+            break; // the rest comes with the next chunk
+          headerBytes = pos + 4 - received;
+          m_responseHeader.resize (pos + 4);
+        }
+        offset += headerBytes;
+        m_is_first_packet = false;
+
+        // parse header
+        m_responseStatus = 0;
+        int where = ParseResponseHeader((const uint8_t*) m_responseHeader.c_str (), m_responseHeader.size (),
+                                        &m_responseStatus, &(this->requested_content_length));
+        //fprintf(stderr, "content starts at position %d, with length %d (status code %d)\n", where, requested_content_length, m_responseStatus);
+        if (where == 0)
+        {
+          NS_LOG_WARN ("Client(" << node_id << "): No content length in the response to " << m_fileToRequest);
+          requested_content_length = 0;
+        }
+        m_responseHeader.clear ();
 
-        fclose(fp);
+        m_headerReceivedTrace(this, this->m_fileToRequest, requested_content_length);
       }
 
-
-    } else {
-      m_bytesRecv += packet_size;
+      size_t bodyBytes = std::min (packet_size - offset, (size_t) (requested_content_length - m_bytesRecv));
+      m_bytesRecv += bodyBytes;
 
       // write to file
-      if (!m_outFile.empty())
-      {
-        // open outfile to append
-        FILE* fp = fopen(m_outFile.c_str(), "a");
+      m_writer.Write(&_tmpbuffer[offset], bodyBytes);
+      offset += bodyBytes;
 
-        fwrite(_tmpbuffer, sizeof(uint8_t), packet_size, fp);
-
-        fclose(fp);
+      // we have received the whole file!
+      if (m_bytesRecv == requested_content_length)
+      {
+        NS_LOG_DEBUG("All bytes received, this means we are done...");
+        OnFileReceived(m_responseStatus, requested_content_length);
+        // the rest of the chunk belongs to the next pipelined response
+        if (!NextPipelinedResponse ())
+          return;
       }
     }
-    
-    // we have received the whole file!
-    if (m_bytesRecv == requested_content_length)
-    {
-      NS_LOG_DEBUG("All bytes received, this means we are done...");
-      OnFileReceived(0, requested_content_length);
-      // break;
-      return;
-    }
-    else if (m_bytesRecv > requested_content_length)
-    {
-     ///fprintf(stderr, "Client(%d)::HandleRead(time=%f) Expected only %d bytes, but received already %d bytes\n",
-        // node_id, Simulator::Now().GetSeconds(), requested_content_length, m_bytesRecv);
-    }
-
   }
 
   //fprintf(stderr, "Client(%d)::HandleRead(time=%f) handled %d bytes this time\n", node_id, Simulator::Now().GetSeconds(), bytes_recv_this_time);
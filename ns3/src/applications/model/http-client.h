@@ -31,6 +31,9 @@
 #include "ns3/traced-callback.h"
 #include "ns3/tcp-socket.h"
 #include "ns3/mp-tcp-socket-base.h"
+#include "http-download-writer.h"
+
+#include <deque>
 
 
 
@@ -96,8 +99,36 @@ public:
 
   void CancelDownload ();
 
+  /**
+   * \returns whether PipelineRequest can send another request right now
+   */
+  bool CanPipelineRequest () const;
+
+  /**
+   * \brief Request another file on the keep-alive connection while the
+   * current download is still in progress
+   *
+   * The response is handled right after the current one, as if FileToRequest
+   * had been set to fileToRequest and the application had been restarted.
+   * At most PipelineDepth requests are outstanding at a time.
+   *
+   * \param fileToRequest the name of the file to request
+   * \returns false if the request could not be sent, see CanPipelineRequest
+   */
+  bool PipelineRequest (std::string fileToRequest);
+
   double GetLastDownloadBandwidth ();
 
+  /**
+   * \returns the checksum of the last downloaded body, when OutfileMode is Checksum
+   */
+  uint32_t GetLastDownloadChecksum () const;
+
+  /**
+   * \returns the last downloaded body, when OutfileMode is Memory
+   */
+  const std::string &GetLastDownloadData () const;
+
   std::string GetRemoteAddress ();
 
   Ipv4Address m_publicPeerAddress; //!< public peer addr
@@ -117,10 +148,17 @@ protected:
 
 
   double lastDownloadBitrate;
+  double lastDownloadSeconds; //!< how long the last download took
 
   uint32_t node_id;
 
   bool m_keepAlive;
+  uint32_t m_pipelineDepth; //!< Maximum number of outstanding requests on the connection
+  bool m_multipath; //!< Whether the connection opens subflows over the other interfaces
+
+  int64_t m_rangeFirst; //!< First byte to request, -1 for the whole file
+  int64_t m_rangeLast; //!< Last byte to request, -1 for up to the end of the file
+  int m_responseStatus; //!< Status code of the current response, 0 if its header is not in yet
 
 
 protected: // callbacks/traces
@@ -159,6 +197,7 @@ protected: // callbacks/traces
   std::string m_fileToRequest;
   std::string m_hostName; //!< The hostname of the destiatnion server
   std::string m_outFile;
+  HttpDownloadWriter::Mode m_outFileMode; //!< What to do with the downloaded bytes
 
   bool m_active;
 
@@ -168,6 +207,8 @@ private:
 
   uint8_t* _tmpbuffer;
 
+  HttpDownloadWriter m_writer; //!< Output of the current download
+
   /**
    * \brief Callback from Socket when ready to send a packet
    */
@@ -179,6 +220,17 @@ private:
    */
   virtual void DoSendGetRequest (Ptr<Socket> localSocket, uint32_t txSpace);
 
+  /**
+   * \brief Sending the GET request of fileToRequest
+   */
+  void SendGetRequest (Ptr<MpTcpSocketBase> localSocket, std::string fileToRequest);
+
+  /**
+   * \brief Continue with the response to the oldest pipelined request
+   * \returns false if there is none
+   */
+  bool NextPipelinedResponse ();
+
   /**
    * \brief Handle a packet reception.
    *
@@ -209,6 +261,9 @@ private:
 
   bool m_sentGetRequest; //!< Indicates whether a GET request has been sent yet or not
 
+  std::deque<std::string> m_pipelinedRequests; //!< Files requested after m_fileToRequest, in order
+  std::string m_responseHeader; //!< Response header received so far, when it is split over chunks
+
 
   /// Callbacks for tracing the packet Tx events
   TracedCallback<Ptr<const Packet> > m_txTrace;
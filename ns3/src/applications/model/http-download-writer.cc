@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Output of the bodies downloaded by HttpClientApplication
+
+
+#include <stdlib.h>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "http-download-writer.h"
+
+
+NS_LOG_COMPONENT_DEFINE ("HttpDownloadWriter");
+
+namespace ns3 {
+
+HttpDownloadWriter::HttpDownloadWriter ()
+  : m_mode (DISCARD),
+    m_fp (NULL),
+    m_buffer (NULL),
+    m_bytes (0),
+    m_hasher (Create<Hash::Function::Fnv1a> ()),
+    m_checksum (0)
+{
+}
+
+HttpDownloadWriter::~HttpDownloadWriter ()
+{
+  Close ();
+  free (m_buffer);
+}
+
+void
+HttpDownloadWriter::Open (Mode mode, std::string fileName)
+{
+  NS_LOG_FUNCTION (this << mode << fileName);
+  Close ();
+  m_mode = mode;
+  m_bytes = 0;
+  m_checksum = m_hasher.clear ().GetHash32 ("", 0);
+  m_data.clear ();
+
+  if (m_mode == TO_FILE && !fileName.empty ())
+    {
+      m_fp = fopen (fileName.c_str (), "wb");
+      NS_ABORT_MSG_UNLESS (m_fp != NULL, "Cannot open outfile " << fileName);
+      if (m_buffer == NULL)
+        {
+          m_buffer = (char*)malloc (BUFFER_SIZE);
+        }
+      setvbuf (m_fp, m_buffer, _IOFBF, BUFFER_SIZE);
+    }
+}
+
+void
+HttpDownloadWriter::Write (const uint8_t *buffer, size_t length)
+{
+  m_bytes += length;
+  switch (m_mode)
+    {
+    case TO_FILE:
+      if (m_fp != NULL)
+        {
+          fwrite (buffer, sizeof (uint8_t), length, m_fp);
+        }
+      break;
+    case TO_MEMORY:
+      m_data.append ((const char*)buffer, length);
+      break;
+    case CHECKSUM:
+      m_checksum = m_hasher.GetHash32 ((const char*)buffer, length);
+      break;
+    case DISCARD:
+      break;
+    }
+}
+
+void
+HttpDownloadWriter::Close (void)
+{
+  if (m_fp != NULL)
+    {
+      NS_LOG_FUNCTION (this << m_bytes);
+      fclose (m_fp);
+      m_fp = NULL;
+    }
+}
+
+bool
+HttpDownloadWriter::NeedsData (void) const
+{
+  return m_fp != NULL || m_mode == TO_MEMORY || m_mode == CHECKSUM;
+}
+
+uint64_t
+HttpDownloadWriter::GetBytes (void) const
+{
+  return m_bytes;
+}
+
+const std::string &
+HttpDownloadWriter::GetData (void) const
+{
+  return m_data;
+}
+
+uint32_t
+HttpDownloadWriter::GetChecksum (void) const
+{
+  return m_checksum;
+}
+
+} // namespace ns3
@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Output of the bodies downloaded by HttpClientApplication
+
+
+#ifndef HTTP_DOWNLOAD_WRITER_H
+#define HTTP_DOWNLOAD_WRITER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include "ns3/hash.h"
+
+
+namespace ns3 {
+
+/**
+ * \brief Sink for the body of one download at a time
+ *
+ * In TO_FILE mode the output file is opened once per download and written
+ * through a large stdio buffer, so the many small reads of a download turn
+ * into a few large writes. CHECKSUM mode only hashes the body and DISCARD
+ * mode only counts it; neither touches the disk. TO_MEMORY keeps small
+ * bodies, such as an MPD, for the application to use directly.
+ */
+class HttpDownloadWriter
+{
+public:
+  enum Mode
+  {
+    TO_FILE,    //!< Write the body to a file
+    TO_MEMORY,  //!< Keep the body in memory, see GetData ()
+    CHECKSUM,   //!< Keep a running hash of the body, no disk I/O
+    DISCARD     //!< Only count the bytes
+  };
+
+  HttpDownloadWriter ();
+  ~HttpDownloadWriter ();
+
+  /**
+   * \brief Start a new download, closing the previous one
+   * \param mode what to do with the bytes
+   * \param fileName output file, truncated; only used in TO_FILE mode, where
+   *        an empty name means nothing is written
+   */
+  void Open (Mode mode, std::string fileName);
+
+  /**
+   * \brief Append body bytes of the current download
+   */
+  void Write (const uint8_t *buffer, size_t length);
+
+  /**
+   * \brief Finish the current download; in TO_FILE mode the file is complete
+   *        on disk when this returns
+   */
+  void Close (void);
+
+  /// \returns true if Write () needs the bytes, false if it only counts them
+  bool NeedsData (void) const;
+  /// \returns the body bytes written since Open ()
+  uint64_t GetBytes (void) const;
+  /// \returns the body written since Open (), in TO_MEMORY mode
+  const std::string &GetData (void) const;
+  /**
+   * \returns the 32 bit FNV-1a hash of the body written since Open (), in
+   *          CHECKSUM mode; it does not depend on how the body was split
+   *          into Write () calls
+   */
+  uint32_t GetChecksum (void) const;
+
+private:
+  HttpDownloadWriter (const HttpDownloadWriter &);
+  HttpDownloadWriter &operator= (const HttpDownloadWriter &);
+
+  static const size_t BUFFER_SIZE = 1024 * 1024;
+
+  Mode m_mode;
+  FILE *m_fp;
+  char *m_buffer;              // stdio buffer of m_fp, kept across downloads
+  uint64_t m_bytes;
+  Hasher m_hasher;
+  uint32_t m_checksum;
+  std::string m_data;
+};
+
+} // namespace ns3
+
+#endif /* HTTP_DOWNLOAD_WRITER_H */
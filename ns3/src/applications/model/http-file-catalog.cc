@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Files served by the HTTP server applications
+
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ns3/log.h"
+#include "http-file-catalog.h"
+
+
+NS_LOG_COMPONENT_DEFINE ("HttpFileCatalog");
+
+namespace ns3 {
+
+HttpFileCatalog::Mapping::Mapping (const uint8_t *data, long size)
+  : m_data (data),
+    m_size (size)
+{
+}
+
+HttpFileCatalog::Mapping::~Mapping ()
+{
+  munmap ((void *)m_data, m_size);
+}
+
+const uint8_t*
+HttpFileCatalog::Mapping::GetData (void) const
+{
+  return m_data;
+}
+
+void
+HttpFileCatalog::AddVirtualFile (const std::string &path, long size)
+{
+  Entry &entry = m_files[path];
+  entry.size = size;
+  entry.source = VIRTUAL;
+  entry.content.clear ();
+  entry.mapping = 0;
+}
+
+void
+HttpFileCatalog::AddMemoryFile (const std::string &path, const std::string &content)
+{
+  Entry &entry = m_files[path];
+  entry.size = content.size ();
+  entry.source = MEMORY;
+  entry.content = content;
+  entry.mapping = 0;
+}
+
+const HttpFileCatalog::Entry*
+HttpFileCatalog::Find (const std::string &path)
+{
+  Files::const_iterator it = m_files.find (path);
+  if (it != m_files.end ())
+    {
+      return &it->second;
+    }
+
+  int fd = open (path.c_str (), O_RDONLY);
+  struct stat stat_buf;
+  if (fd < 0 || fstat (fd, &stat_buf) != 0 || !S_ISREG (stat_buf.st_mode))
+    {
+      NS_LOG_INFO ("File not found: '" << path << "'");
+      if (fd >= 0)
+        {
+          close (fd);
+        }
+      return NULL;
+    }
+
+  Ptr<Mapping> mapping;
+  if (stat_buf.st_size > 0)
+    {
+      void *data = mmap (NULL, stat_buf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED)
+        {
+          NS_LOG_WARN ("Cannot map '" << path << "'");
+          close (fd);
+          return NULL;
+        }
+      mapping = Create<Mapping> ((const uint8_t *)data, stat_buf.st_size);
+    }
+  close (fd);
+
+  NS_LOG_DEBUG ("Adding '" << path << "' from disk with size " << stat_buf.st_size);
+  Entry &entry = m_files[path];
+  entry.size = stat_buf.st_size;
+  entry.source = DISK;
+  entry.mapping = mapping;
+  return &entry;
+}
+
+uint32_t
+HttpFileCatalog::GetNFiles (void) const
+{
+  return m_files.size ();
+}
+
+void
+HttpFileCatalog::Clear (void)
+{
+  m_files.clear ();
+}
+
+} // namespace ns3
@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Files served by the HTTP server applications
+
+
+#ifndef HTTP_FILE_CATALOG_H
+#define HTTP_FILE_CATALOG_H
+
+#include <stdint.h>
+#include <string>
+
+#include "ns3/hash.h"
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/sgi-hashmap.h"
+
+
+namespace ns3 {
+
+/**
+ * \brief The files an HTTP server application serves, by path
+ *
+ * A request is answered with one hash lookup, which tells the size of the
+ * file and where its body comes from: generated for virtual files, held in
+ * memory (e.g. a generated MPD), or read from disk. The server fills the
+ * catalog when it starts and its client sockets share it; files on disk
+ * that are not in it are looked up on their first request and remembered.
+ *
+ * Files on disk are mapped read-only once and the replies of all sockets
+ * are cut from that mapping, so no socket holds a copy of a whole file.
+ */
+class HttpFileCatalog
+{
+public:
+  enum Source
+  {
+    DISK,     //!< Read from the file of the same path
+    VIRTUAL,  //!< Generated, only the size is known
+    MEMORY    //!< Held in Entry::content
+  };
+
+  /**
+   * \brief A file on disk mapped read-only into memory
+   *
+   * Unmapped when the last reference goes, so a reply still being sent
+   * keeps its bytes even if the catalog forgets the file.
+   */
+  class Mapping : public SimpleRefCount<Mapping>
+  {
+  public:
+    Mapping (const uint8_t *data, long size);
+    ~Mapping ();
+
+    const uint8_t* GetData (void) const;
+
+  private:
+    const uint8_t *m_data;
+    long m_size;
+  };
+
+  struct Entry
+  {
+    long size;
+    Source source;
+    std::string content;
+    Ptr<Mapping> mapping; //!< Of a DISK file with size > 0
+  };
+
+  /**
+   * \brief Add a file of the given size whose body is generated
+   */
+  void AddVirtualFile (const std::string &path, long size);
+
+  /**
+   * \brief Add a file whose body is content
+   */
+  void AddMemoryFile (const std::string &path, const std::string &content);
+
+  /**
+   * \returns the file at path, or NULL if it is neither in the catalog
+   *          nor readable on disk; the entry is valid until the catalog
+   *          changes
+   */
+  const Entry* Find (const std::string &path);
+
+  /// \returns the number of files in the catalog
+  uint32_t GetNFiles (void) const;
+
+  void Clear (void);
+
+private:
+  struct PathHash
+  {
+    size_t operator() (const std::string &path) const
+    {
+      return Hash32 (path);
+    }
+  };
+
+  typedef sgi::hash_map<std::string, Entry, PathHash> Files;
+  Files m_files;
+};
+
+} // namespace ns3
+
+#endif /* HTTP_FILE_CATALOG_H */
@@ -19,6 +19,7 @@
  **/
 
 #include "http-multimedia-consumer.h"
+#include "dash-mpd-cache.h"
 
 #include "ns3/ptr.h"
 #include "ns3/log.h"
@@ -38,8 +39,6 @@ typedef MultimediaConsumer<HttpClientApplication> HTTPMultimediaConsumer;
 NS_OBJECT_ENSURE_REGISTERED(HTTPMultimediaConsumer);
 
 
-template <typename Parent> std::string MultimediaConsumer<Parent>::alphabet = std::string("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ1234567890");
-
 template<class Parent>
 TypeId
 MultimediaConsumer<Parent>::GetTypeId(void)
@@ -68,6 +67,33 @@ MultimediaConsumer<Parent>::GetTypeId(void)
       .template AddAttribute("AdaptationLogic", "Defines the adaptation logic to be used; ",
                           StringValue("dash::player::AlwaysLowestAdaptationLogic"),
                     MakeStringAccessor (&MultimediaConsumer<Parent>::m_adaptationLogicStr), MakeStringChecker ())
+      .template AddAttribute("ThroughputEstimator", "How the adaptation logic estimates the download bitrate: "
+                          "LastDownload (bitrate of the last segment), Ewma, HarmonicMean (of the last downloads) "
+                          "or SlidingWindow (bytes over download time in the last seconds)",
+                          EnumValue(LastDownload),
+                    MakeEnumAccessor(&MultimediaConsumer<Parent>::m_throughputEstimator),
+                    MakeEnumChecker(LastDownload, "LastDownload",
+                                    Ewma, "Ewma",
+                                    HarmonicMean, "HarmonicMean",
+                                    SlidingWindow, "SlidingWindow"))
+      .template AddAttribute("EwmaWeight", "Weight of the newest download for the Ewma throughput estimator", DoubleValue(0.3),
+                    MakeDoubleAccessor(&MultimediaConsumer<Parent>::m_ewmaWeight), MakeDoubleChecker<double>(0.0, 1.0))
+      .template AddAttribute("HarmonicMeanSamples", "Number of downloads averaged by the HarmonicMean throughput estimator", UintegerValue(5),
+                    MakeUintegerAccessor(&MultimediaConsumer<Parent>::m_harmonicMeanSamples), MakeUintegerChecker<uint32_t>(1))
+      .template AddAttribute("SlidingWindow", "Time span of the SlidingWindow throughput estimator", TimeValue(Seconds(6.0)),
+                    MakeTimeAccessor(&MultimediaConsumer<Parent>::m_slidingWindow), MakeTimeChecker())
+      .template AddAttribute("Prefetch", "Ask the adaptation logic for the next segments while the current one is downloading "
+                          "and pipeline their requests, up to PipelineDepth requests (not for layered content)", BooleanValue(false),
+                    MakeBooleanAccessor(&MultimediaConsumer<Parent>::m_prefetch), MakeBooleanChecker())
+      .template AddAttribute("RangeConnections", "Number of connections each segment is split over in byte ranges, "
+                          "which are fetched in parallel; 1 downloads segments on the player's own connection", UintegerValue(1),
+                    MakeUintegerAccessor(&MultimediaConsumer<Parent>::m_rangeConnections), MakeUintegerChecker<uint32_t>(1))
+      .template AddAttribute("RangeServers", "Comma separated addresses of the server the range connections take turns connecting to, "
+                          "e.g. one per path; empty connects all of them to the server of the MPD", StringValue(""),
+                    MakeStringAccessor(&MultimediaConsumer<Parent>::m_rangeServers), MakeStringChecker())
+      .template AddAttribute("RangeMultipath", "Whether the range connections are MPTCP connections over all paths, "
+                          "or each stays on the path towards its server like a plain TCP connection", BooleanValue(true),
+                    MakeBooleanAccessor(&MultimediaConsumer<Parent>::m_rangeMultipath), MakeBooleanChecker())
       .template AddAttribute("StartRepresentationId", """Defines the representation ID of the representation to start streaming; "
                           "can be either an ID from the MPD file or one of the following keywords: "
                           "lowest, auto (lowest = the lowest representation available, auto = use adaptation logic to decide)",
@@ -92,6 +118,7 @@ MultimediaConsumer<Parent>::MultimediaConsumer() : super()
   NS_LOG_FUNCTION_NOARGS();
   mpd = NULL;
   mPlayer = NULL;
+  m_segmentOutfileMode = HttpDownloadWriter::TO_FILE;
 }
 
 
@@ -101,6 +128,21 @@ MultimediaConsumer<Parent>::~MultimediaConsumer()
 }
 
 
+template<class Parent>
+void
+MultimediaConsumer<Parent>::DoDispose(void)
+{
+  NS_LOG_FUNCTION_NOARGS();
+  // the node does not know the range clients, see HttpRangeClientApplication
+  for (size_t i = 0; i < m_rangeClients.size(); i++)
+  {
+    m_rangeClients[i]->Dispose();
+  }
+  m_rangeClients.clear();
+  super::DoDispose();
+}
+
+
 
 ///////////////////////////////////////////////////
 //             Application Methods               //
@@ -135,28 +177,19 @@ MultimediaConsumer<Parent>::StartApplication() // Called at time specified by St
   }
 
 
-  std::stringstream ss_tempDir;
-  ss_tempDir << "-ns3-node-" << super::node_id ;
-
-  for(int i = 0; i < 8; ++i)
-     ss_tempDir << MultimediaConsumer<Parent>::alphabet[rand()%MultimediaConsumer<Parent>::alphabet.size()];
-
-  m_tempDir = ns3::SystemPath::MakeTemporaryDirectoryName() + ss_tempDir.str();
-
-  NS_LOG_DEBUG("Client(" << super::node_id << "): Temporary Directory: " << m_tempDir);
-  ns3::SystemPath::MakeDirectories(m_tempDir);
-
-  m_tempMpdFile = m_tempDir + "/mpd.xml.gz";
-
   m_mpdParsed = false;
   m_initSegmentIsGlobal = false;
   m_hasInitSegment = false;
   m_hasDownloadedAllSegments = false;
   m_hasStartedPlaying = false;
   m_freezeStartTime = 0;
+  m_waitingToPlay = false;
   totalConsumedSegments = 0;
   requestedRepresentation = NULL;
   requestedSegmentURL = NULL;
+  m_segmentInFlight = false;
+  m_prefetchedSegments.clear();
+  m_rangesPending = 0;
 
   m_currentDownloadType = MPD;
   m_startTime = Simulator::Now().GetMilliSeconds();
@@ -168,8 +201,26 @@ MultimediaConsumer<Parent>::StartApplication() // Called at time specified by St
   NS_ASSERT_MSG(mPlayer->GetAdaptationLogic() != NULL,
           "Could not initialize adaptation logic...");
 
+  switch (m_throughputEstimator)
+  {
+  case Ewma:
+    mPlayer->SetThroughputEstimator(new dash::player::EwmaThroughputEstimator(m_ewmaWeight));
+    break;
+  case HarmonicMean:
+    mPlayer->SetThroughputEstimator(new dash::player::HarmonicMeanThroughputEstimator(m_harmonicMeanSamples));
+    break;
+  case SlidingWindow:
+    mPlayer->SetThroughputEstimator(new dash::player::SlidingWindowThroughputEstimator(m_slidingWindow.GetSeconds()));
+    break;
+  case LastDownload:
+    break;
+  }
+
   super::SetAttribute("FileToRequest", StringValue(mpd_request_name));
-  super::SetAttribute("WriteOutfile", StringValue(m_tempMpdFile));
+  super::SetAttribute("WriteOutfile", StringValue(""));
+  // the MPD is parsed from memory, whatever the segments do with their bytes
+  m_segmentOutfileMode = super::m_outFileMode;
+  super::m_outFileMode = HttpDownloadWriter::TO_MEMORY;
   super::SetAttribute("KeepAlive", StringValue("true"));
 
   // do base stuff
@@ -190,9 +241,13 @@ MultimediaConsumer<Parent>::StopApplication() // Called at time specified by Sto
   // Cancelling Event Timers
   m_consumerLoopTimer.Cancel();
   Simulator::Cancel(m_consumerLoopTimer);
+  m_waitingToPlay = false;
 
   m_downloadEventTimer.Cancel();
   Simulator::Cancel(m_downloadEventTimer);
+  m_segmentInFlight = false;
+  m_prefetchedSegments.clear();
+  CloseRangeConnections();
 
   /*OK LOG ALL NOT RECEIVED FILES FROM MPD*/
   if(traceNotDownloadedSegments)
@@ -214,19 +269,19 @@ MultimediaConsumer<Parent>::StopApplication() // Called at time specified by Sto
     }
   }
 
-  // clean up mpd/DASH specific stuff
-  if (mpd != NULL)
-  {
-    delete mpd;
-    mpd = NULL;
-  }
-
+  // clean up mpd/DASH specific stuff; the player refers into the mpd
   if (mPlayer != NULL)
   {
     delete mPlayer;
     mPlayer = NULL;
   }
 
+  if (mpd != NULL)
+  {
+    DashMpdCache::Release(mpd);
+    mpd = NULL;
+  }
+
 
   // make sure to close the socket, in case it is still open
   super::SetAttribute("KeepAlive", StringValue("false"));
@@ -252,75 +307,18 @@ MultimediaConsumer<Parent>::setMpdUrl (std::string url)
   m_mpdUrl = ss.str ();
 }
 
-template<class Parent>
-bool
-MultimediaConsumer<Parent>::DecompressFile ( std::string source, std::string filename )
-{
-  NS_LOG_FUNCTION(source << filename);
-  std::ifstream infile( source.c_str(), std::ios_base::in | std::ios_base::binary ); //Creates the input stream
-  //Tests if the file is being opened correctly.
-  if ( !infile )
-  {
-   std::cerr<< "Can't open file: " << source << std::endl;
-   return false;
-  }
-
-  // read
-  std::string compressed_str((std::istreambuf_iterator<char>(infile)),
-                 std::istreambuf_iterator<char>());
-
-  try
-  {
-    std::string decompressed = zlib_decompress_string(compressed_str);
-
-    std::ofstream outfile( filename.c_str(), std::ios_base::out |  std::ios_base::binary ); //Creates the output stream
-    outfile << decompressed;
-    outfile.close();
-  }
-  catch(std::exception& e)
-  {
-    //std::cerr << e.what() << std::endl;
-    NS_LOG_DEBUG(e.what() << " Assuming file was not zipped!");
-    return false;
-  }
-
-
-  return true;
-}
-
-
 template<class Parent>
 void
 MultimediaConsumer<Parent>::OnMpdFile()
 {
  ///fprintf(stderr, "Client(%d): On MPD File...\n", super::node_id);
 
-  // check if file was gziped, if not, we use it as is
-  if (m_tempMpdFile.find(".gz") != std::string::npos)
-  {
-    // file was compressed, decompress it
-    NS_LOG_DEBUG("GZIP MPD File " << m_tempMpdFile << " received. Decompressing...");
-    std::string newFileName = m_tempMpdFile.substr(0, m_tempMpdFile.find(".gz"));
-
-    // TODO DECOMPRESS
-    if(DecompressFile(m_tempMpdFile, newFileName))
-      m_tempMpdFile = newFileName;
-  }
-
-
-  // NS_LOG_UNCOND("MPD File " << m_tempMpdFile << " received. Parsing now...");
-
-  dash::IDASHManager *manager;
-  manager = CreateDashManager();
-  mpd = manager->Open((char*)m_tempMpdFile.c_str());
-
-  // We don't need the manager anymore...
-  manager->Delete();
-  manager = NULL;
+  // clients downloading the same MPD share its parsed tree
+  mpd = DashMpdCache::Acquire(m_mpdUrl, super::GetLastDownloadData());
 
   if (mpd == NULL)
   {
-    NS_LOG_ERROR("Error parsing mpd " << m_tempMpdFile);
+    NS_LOG_ERROR("Client(" << super::node_id << "): Error parsing mpd " << m_mpdUrl);
     return;
   }
 
@@ -558,13 +556,6 @@ MultimediaConsumer<Parent>::OnMpdFile()
 
   // we received the MDP, so we can now start the timer for playing
   SchedulePlay(startupDelay);
-
-  /* also we can delete the folder (m_tempDir) the MPD is stored in */
-  std::string rmdir_cmd = "rm -rf " + m_tempDir;
-  if (system(rmdir_cmd.c_str()) != 0)
-  {
-   ///fprintf(stderr, "Error: could not delete directory '%s'.\n", m_tempDir.c_str());
-  }
 }
 
 
@@ -612,7 +603,10 @@ MultimediaConsumer<Parent>::OnMultimediaFile()
     if(mPlayer->EnoughSpaceInBuffer(requestedSegmentNr, requestedRepresentation, m_isLayeredContent))
     {
       if(mPlayer->AddToBuffer(requestedSegmentNr, requestedRepresentation, super::lastDownloadBitrate, m_isLayeredContent))
+      {
         NS_LOG_DEBUG("Segment Accepted for Buffering");
+        ResumePlay();
+      }
       else
         NS_LOG_DEBUG("Segment Rejected for Buffering");
     }
@@ -624,6 +618,14 @@ MultimediaConsumer<Parent>::OnMultimediaFile()
     }
   }
 
+  // with Prefetch, the client goes on with the response to the next segment
+  m_segmentInFlight = !m_prefetchedSegments.empty();
+  if (m_segmentInFlight)
+  {
+    requestedSegmentNr = m_prefetchedSegments.front().segmentNr;
+    requestedRepresentation = m_prefetchedSegments.front().representation;
+    m_prefetchedSegments.pop_front();
+  }
 
   m_currentDownloadType = Segment;
   ScheduleDownloadOfSegment();
@@ -637,6 +639,13 @@ MultimediaConsumer<Parent>::OnFileReceived(unsigned status, unsigned length)
   // make sure that the file is being properly retrieved by the super class first!
   super::OnFileReceived(status, length);
 
+  // the same downloads that set the last download bitrate feed the estimator
+  if (super::m_active && (!m_mpdParsed || m_currentDownloadType == Segment))
+  {
+    mPlayer->AddDownloadSample(super::requested_content_length, super::lastDownloadSeconds,
+                               Simulator::Now().GetSeconds());
+  }
+
  ///fprintf(stderr, "Client: On File Received called\n");
 
   if (!m_mpdParsed)
@@ -671,6 +680,7 @@ MultimediaConsumer<Parent>::DownloadInitSegment()
   super::StopApplication();
   super::SetAttribute("FileToRequest", StringValue(m_baseURL + m_initSegment));
   super::SetAttribute("WriteOutfile", StringValue(""));
+  super::m_outFileMode = m_segmentOutfileMode;
   super::StartApplication();
 }
 
@@ -702,6 +712,13 @@ MultimediaConsumer<Parent>::DownloadSegment()
     return;
   }*/
 
+  if (m_segmentInFlight)
+  {
+    // the next segment is on its way already, see OnMultimediaFile
+    PrefetchSegments();
+    return;
+  }
+
   // get segment number and rep id
   requestedRepresentation = NULL;
   requestedSegmentNr = 0;
@@ -723,13 +740,213 @@ MultimediaConsumer<Parent>::DownloadSegment()
     return;
   }
 
+  if (m_rangeConnections > 1)
+    FetchSegmentRanges(m_baseURL + requestedSegmentURL->GetMediaURI());
+  else
+    FetchSegment(m_baseURL + requestedSegmentURL->GetMediaURI());
+
+  // a stalled player has to watch downloads of layers, see DoPlay
+  if (requestedRepresentation->GetDependencyId().size() > 0)
+    ResumePlay();
+  else if (m_prefetch && m_rangeConnections == 1)
+  {
+    m_segmentInFlight = true;
+    PrefetchSegments();
+  }
+}
+
+
+template<class Parent>
+void
+MultimediaConsumer<Parent>::PrefetchSegments()
+{
+  // layers are requested depending on the buffer, see DoPlay
+  if (m_isLayeredContent)
+    return;
+
+  // everything requested has to fit into the buffer once it has arrived, so
+  // that OnMultimediaFile never holds back a segment with more behind it
+  double requestedSeconds = GetSegmentDuration(requestedRepresentation);
+  const IRepresentation* last = requestedRepresentation;
+  for (typename std::deque<PrefetchedSegment>::iterator it = m_prefetchedSegments.begin(); it != m_prefetchedSegments.end(); ++it)
+  {
+    requestedSeconds += GetSegmentDuration(it->representation);
+    last = it->representation;
+  }
+
+  while (super::CanPipelineRequest() &&
+         mPlayer->GetBufferLevel() + requestedSeconds + GetSegmentDuration(last) <= m_maxBufferedSeconds)
+  {
+    PrefetchedSegment next;
+    bool allRequested = false;
+    ISegmentURL* segmentURL = mPlayer->GetAdaptationLogic()->GetNextSegment(&next.segmentNr, &next.representation, &allRequested);
+    // DownloadSegment finds out about the end once the pipeline has drained
+    if (allRequested || segmentURL == NULL)
+      break;
+
+    NS_LOG_DEBUG("Client(" << super::node_id << "): Prefetching segment " << next.segmentNr << " of " << next.representation->GetId());
+    super::PipelineRequest(m_baseURL + segmentURL->GetMediaURI());
+    m_prefetchedSegments.push_back(next);
+    requestedSeconds += GetSegmentDuration(next.representation);
+    last = next.representation;
+  }
+}
+
+
+template<class Parent>
+void
+MultimediaConsumer<Parent>::FetchSegment(std::string fileToRequest)
+{
+  // in one piece on the player's own connection, OnFileReceived takes it
   super::StopApplication();
-  super::SetAttribute("FileToRequest", StringValue(m_baseURL + requestedSegmentURL->GetMediaURI()));
+  super::SetAttribute("FileToRequest", StringValue(fileToRequest));
   super::SetAttribute("WriteOutfile", StringValue(""));
   super::StartApplication();
 }
 
 
+template<class Parent>
+void
+MultimediaConsumer<Parent>::FetchSegmentRanges(std::string fileToRequest)
+{
+  if (m_rangeClients.empty())
+  {
+    std::vector<std::string> servers;
+    std::stringstream ss(m_rangeServers);
+    std::string server;
+    while (std::getline(ss, server, ','))
+    {
+      if (!server.empty())
+        servers.push_back(server);
+    }
+
+    for (uint32_t i = 0; i < m_rangeConnections; i++)
+    {
+      Ptr<HttpRangeClientApplication> client = CreateObject<HttpRangeClientApplication>();
+      client->SetNode(super::GetNode());
+      client->SetRemote(servers.empty() ? super::m_publicPeerAddress : Ipv4Address(servers[i % servers.size()].c_str()), 80);
+      client->SetAttribute("RemoteHostName", StringValue(super::m_hostName));
+      client->SetAttribute("KeepAlive", BooleanValue(true));
+      client->SetAttribute("Multipath", BooleanValue(m_rangeMultipath));
+      client->SetAttribute("OutfileMode", EnumValue(m_segmentOutfileMode));
+      client->SetFetchedCallback(MakeCallback(&MultimediaConsumer<Parent>::OnRangeFetched, this));
+      m_rangeClients.push_back(client);
+    }
+  }
+
+  // the MPD only tells the average size of a segment; split it in proportion
+  // to what each connection got last time, so that the ranges finish about
+  // together, and leave the last range open so that it takes whatever the
+  // estimate missed (ranges behind the end of the segment come back empty)
+  double expectedBytes = requestedRepresentation->GetBandwidth() * GetSegmentDuration(requestedRepresentation) / 8.0;
+  std::vector<double> weights;
+  double totalWeight = 0.0;
+  for (size_t i = 0; i < m_rangeClients.size(); i++)
+  {
+    weights.push_back(std::max(m_rangeClients[i]->GetLastDownloadBandwidth(), 0.0));
+    totalWeight += weights.back();
+  }
+  if (std::find(weights.begin(), weights.end(), 0.0) != weights.end())
+  {
+    weights.assign(weights.size(), 1.0);
+    totalWeight = weights.size();
+  }
+
+  super::m_fileToRequest = fileToRequest;
+  super::m_downloadStartedTrace(this, fileToRequest);
+  m_rangesPending = m_rangeClients.size();
+  m_rangeBytes = 0;
+  m_rangeStartTime = Simulator::Now().GetMilliSeconds();
+
+  int64_t first = 0;
+  for (size_t i = 0; i < m_rangeClients.size(); i++)
+  {
+    int64_t last = -1;
+    if (i + 1 < m_rangeClients.size())
+      last = first + std::max((int64_t) (expectedBytes * weights[i] / totalWeight), (int64_t) 1) - 1;
+
+    NS_LOG_DEBUG("Client(" << super::node_id << "): Fetching bytes " << first << "-" << last << " of " << fileToRequest);
+    m_rangeClients[i]->Fetch(fileToRequest, first, last);
+    first = last + 1;
+  }
+}
+
+
+template<class Parent>
+void
+MultimediaConsumer<Parent>::OnRangeFetched(Ptr<HttpRangeClientApplication> client)
+{
+  if (!super::m_active || m_rangesPending == 0)
+    return;
+
+  if (!client->GotRange())
+  {
+    // a server that does not do ranges, or an error; the other ranges are
+    // of no use without this one, so get the segment in one piece instead.
+    // The connection is closed once its callback has returned.
+    NS_LOG_DEBUG("Client(" << super::node_id << "): Range of " << super::m_fileToRequest << " failed with status "
+                 << client->GetStatus() << ", fetching the whole segment");
+    m_rangesPending = 0;
+    Simulator::ScheduleNow(&MultimediaConsumer<Parent>::FetchWholeSegment, this);
+    return;
+  }
+
+  m_rangeBytes += client->GetBytes();
+  if (--m_rangesPending > 0)
+    return;
+
+  // the ranges cover the segment from its first byte on, so with the last
+  // one in the segment is complete; account for it like OnFileReceived
+  // accounts for a segment downloaded in one piece
+  long milliSeconds = Simulator::Now().GetMilliSeconds() - m_rangeStartTime;
+  double seconds = milliSeconds / 1000.0;
+  double downloadSpeed = m_rangeBytes / seconds;
+  if (milliSeconds <= 0 && super::lastDownloadBitrate > 0)
+    downloadSpeed = super::lastDownloadBitrate / 8.0;
+
+  super::requested_content_length = m_rangeBytes;
+  super::lastDownloadBitrate = downloadSpeed * 8.0;
+  super::lastDownloadSeconds = seconds;
+  super::m_downloadFinishedTrace(this, super::m_fileToRequest, downloadSpeed, milliSeconds);
+
+  mPlayer->AddDownloadSample(m_rangeBytes, seconds, Simulator::Now().GetSeconds());
+  OnMultimediaFile();
+}
+
+
+template<class Parent>
+void
+MultimediaConsumer<Parent>::FetchWholeSegment()
+{
+  if (!super::m_active)
+    return;
+
+  CloseRangeConnections();
+  FetchSegment(super::m_fileToRequest);
+}
+
+
+template<class Parent>
+void
+MultimediaConsumer<Parent>::CloseRangeConnections()
+{
+  for (size_t i = 0; i < m_rangeClients.size(); i++)
+  {
+    m_rangeClients[i]->Close();
+  }
+  // the clients stay, their sockets call back into them until they are closed
+  m_rangesPending = 0;
+}
+
+
+template<class Parent>
+double
+MultimediaConsumer<Parent>::GetSegmentDuration(const IRepresentation* rep)
+{
+  return (double) rep->GetSegmentList()->GetDuration() / (double) rep->GetSegmentList()->GetTimescale();
+}
+
+
 
 
 
@@ -737,6 +954,7 @@ template<class Parent>
 void
 MultimediaConsumer<Parent>::SchedulePlay(double wait_time)
 {
+  m_waitingToPlay = false;
   m_consumerLoopTimer.Cancel();
   m_consumerLoopTimer = Simulator::Schedule(Seconds(wait_time), &MultimediaConsumer<Parent>::DoPlay, this);
 }
@@ -758,26 +976,54 @@ MultimediaConsumer<Parent>::DoPlay()
     //we finished streaming just return
     return;
   }
-  else //we stall
+  else if(requestedRepresentation != NULL && !m_hasDownloadedAllSegments && requestedRepresentation->GetDependencyId().size() > 0) // means we are downloading something with dependencies
   {
-     //restart timer
-     SchedulePlay(); // with default parm.
+    //we stall, and keep checking whether to abort the download of the layer
+    SchedulePlay(); // with default parm.
 
-    //check if we should abort the download
-    if(requestedRepresentation != NULL && !m_hasDownloadedAllSegments && requestedRepresentation->GetDependencyId().size() > 0) // means we are downloading something with dependencies
+    //check buffer state
+    if(!mPlayer->GetAdaptationLogic()->hasMinBufferLevel(requestedRepresentation))
     {
-      //check buffer state
-      if(!mPlayer->GetAdaptationLogic()->hasMinBufferLevel(requestedRepresentation))
-      {
-        //abort download ...
-        NS_LOG_DEBUG("Aborting to download a segment with repId = " << requestedRepresentation->GetId().c_str());
+      //abort download ...
+      NS_LOG_DEBUG("Aborting to download a segment with repId = " << requestedRepresentation->GetId().c_str());
   NS_LOG_UNCOND ("\n\n stop 3 \n\n");
-        super::StopApplication();
-        mPlayer->SetLastDownloadBitRate(0.0);//set dl_bitrate to zero.
-        ScheduleDownloadOfSegment();
-      }
+      super::StopApplication();
+      mPlayer->SetLastDownloadBitRate(0.0);//set dl_bitrate to zero.
+      mPlayer->ResetThroughputEstimate();
+      ScheduleDownloadOfSegment();
     }
   }
+  else //we stall
+  {
+    WaitForPlay();
+  }
+}
+
+
+template<class Parent>
+void
+MultimediaConsumer<Parent>::WaitForPlay()
+{
+  // nothing DoPlay looks at changes before a segment is added to the buffer,
+  // so do not poll until then
+  m_waitingToPlay = true;
+  m_stallTime = Simulator::Now();
+}
+
+
+template<class Parent>
+void
+MultimediaConsumer<Parent>::ResumePlay()
+{
+  if (!m_waitingToPlay)
+    return;
+  m_waitingToPlay = false;
+
+  // play at the first MULTIMEDIA_CONSUMER_LOOP_TIMER tick after now, as polling
+  // from the start of the stall would have, so that the traces do not change
+  int64_t tick = Seconds(MULTIMEDIA_CONSUMER_LOOP_TIMER).GetTimeStep();
+  int64_t stalled = (Simulator::Now() - m_stallTime).GetTimeStep();
+  m_consumerLoopTimer = Simulator::Schedule(TimeStep(tick - stalled % tick), &MultimediaConsumer<Parent>::DoPlay, this);
 }
 
 template<class Parent>
@@ -22,6 +22,7 @@
 #define HTTP_MULTIMEDIACONSUMER_H
 
 #include "http-client.h"
+#include "http-range-client.h"
 
 
 
@@ -42,6 +43,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/integer.h"
 #include "ns3/double.h"
+#include "ns3/enum.h"
 
 #include "libdash.h"
 
@@ -69,6 +71,7 @@ class MultimediaConsumer : public Parent {
   typedef Parent super;
 public:
   enum DownloadType { MPD = 0, InitSegment = 1, Segment = 2 };
+  enum ThroughputEstimatorType { LastDownload = 0, Ewma = 1, HarmonicMean = 2, SlidingWindow = 3 };
   static TypeId
   GetTypeId();
 
@@ -94,10 +97,10 @@ public:
 
 protected:
   virtual void
-  OnFileReceived(unsigned status, unsigned length);
+  DoDispose(void);
 
-  bool
-  DecompressFile ( std::string source, std::string filename );
+  virtual void
+  OnFileReceived(unsigned status, unsigned length);
 
   std::string m_mpdUrl;     ///< \brief http URL of the MPD
   unsigned int m_screenWidth; ///< \brief The spatial width of the simulated screen
@@ -111,9 +114,19 @@ protected:
   std::string m_startRepresentationId;  ///< \brief The representation ID for initializing streaming
   std::string m_adaptationLogicStr;     ///< \brief The adaptation logic that should be used
 
+  ThroughputEstimatorType m_throughputEstimator; ///< \brief How the adaptation logic sees the download bitrate
+  double m_ewmaWeight;            ///< \brief Weight of the newest download for the Ewma estimator
+  uint32_t m_harmonicMeanSamples; ///< \brief Downloads averaged by the HarmonicMean estimator
+  Time m_slidingWindow;           ///< \brief Time span of the SlidingWindow estimator
+
+  bool m_prefetch; ///< \brief Whether to request the next segments while the current one is downloading
+
+  uint32_t m_rangeConnections; ///< \brief Connections each segment is fetched over in byte ranges, 1 for none
+  std::string m_rangeServers;  ///< \brief Comma separated server addresses of the range connections
+  bool m_rangeMultipath;       ///< \brief Whether the range connections are MPTCP connections over all paths
+
 
-  std::string m_tempDir; ///< \brief a temporary directory for storing and parsing the downloaded mpd file
-  std::string m_tempMpdFile; ///< \brief path to the temporary MPD file
+  HttpDownloadWriter::Mode m_segmentOutfileMode; ///< \brief OutfileMode for the segments, the MPD is always kept in memory
 
 
   dash::mpd::IMPD *mpd; ///< \brief Pointer to the MPD
@@ -134,8 +147,6 @@ protected:
   uint32_t m_userId;
   uint32_t m_videoId;
 
-  static std::string alphabet;
-
   bool m_mpdParsed;
   bool m_initSegmentIsGlobal;
   bool m_hasInitSegment;
@@ -148,13 +159,31 @@ protected:
   const dash::mpd::IRepresentation* requestedRepresentation;
   unsigned int requestedSegmentNr;
 
+  struct PrefetchedSegment
+  {
+    unsigned int segmentNr;
+    const dash::mpd::IRepresentation* representation;
+  };
+
+  bool m_segmentInFlight; ///< \brief with Prefetch, the requested segment is being downloaded
+  std::deque<PrefetchedSegment> m_prefetchedSegments; ///< \brief pipelined after the requested segment, in order
+
+  std::vector<Ptr<HttpRangeClientApplication> > m_rangeClients; ///< \brief with RangeConnections, one per connection, not added to the node
+  uint32_t m_rangesPending;  ///< \brief ranges of the requested segment not in yet
+  uint32_t m_rangeBytes;     ///< \brief bytes of the requested segment in so far
+  int64_t m_rangeStartTime;  ///< \brief when the ranges of the requested segment were requested, in ms
+
 
 
   void SchedulePlay(double wait_time = MULTIMEDIA_CONSUMER_LOOP_TIMER);
   void DoPlay();
   double consume();
+  void WaitForPlay();
+  void ResumePlay();
 
   EventId m_consumerLoopTimer;
+  bool m_waitingToPlay; ///< \brief stalled, DoPlay runs again once the buffer changes
+  Time m_stallTime;     ///< \brief when the stall started, DoPlay keeps to the MULTIMEDIA_CONSUMER_LOOP_TIMER grid from there
   EventId m_downloadEventTimer;
 
   std::vector<std::string> m_downloadedInitSegments; ///< \brief a vector containing the representation IDs of which we have init segments
@@ -179,6 +208,14 @@ protected:
   virtual void
   DownloadSegment();
 
+  void PrefetchSegments();
+  void FetchSegment(std::string fileToRequest);
+  void FetchSegmentRanges(std::string fileToRequest);
+  void OnRangeFetched(Ptr<HttpRangeClientApplication> client);
+  void FetchWholeSegment();
+  void CloseRangeConnections();
+  double GetSegmentDuration(const dash::mpd::IRepresentation* rep);
+
   //Vitalii: removed dependencyIDs to fit the videoID. Dunno how to make more than 8 params in a traced callback :)
   TracedCallback<Ptr<ns3::Application> /*App*/, unsigned int /* UserId */, unsigned int /* videoId */, unsigned int /*SegmentNr*/,
                 std::string /*RepresentationId*/, unsigned int /* experiendedBitrate */,
@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - HTTP Range Client Application class
+
+
+#include "ns3/log.h"
+#include "http-range-client.h"
+
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HttpRangeClientApplication");
+
+NS_OBJECT_ENSURE_REGISTERED (HttpRangeClientApplication);
+
+TypeId
+HttpRangeClientApplication::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HttpRangeClientApplication")
+    .SetParent<HttpClientApplication> ()
+    .SetGroupName("Applications")
+    .AddConstructor<HttpRangeClientApplication> ()
+  ;
+  return tid;
+}
+
+HttpRangeClientApplication::HttpRangeClientApplication ()
+{
+  NS_LOG_FUNCTION (this);
+  m_status = 0;
+  m_bytes = 0;
+}
+
+HttpRangeClientApplication::~HttpRangeClientApplication ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HttpRangeClientApplication::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_fetched = MakeNullCallback<void, Ptr<HttpRangeClientApplication> > ();
+  HttpClientApplication::DoDispose ();
+}
+
+void
+HttpRangeClientApplication::Fetch (std::string fileToRequest, int64_t first, int64_t last)
+{
+  NS_LOG_FUNCTION (this << fileToRequest << first << last);
+
+  // the same as MultimediaConsumer does for each segment on its own connection
+  StopApplication ();
+  m_fileToRequest = fileToRequest;
+  m_rangeFirst = first;
+  m_rangeLast = last;
+  m_status = 0;
+  m_bytes = 0;
+  StartApplication ();
+}
+
+void
+HttpRangeClientApplication::Close ()
+{
+  NS_LOG_FUNCTION (this);
+
+  // StopApplication only closes connections that are not kept alive
+  bool keepAlive = m_keepAlive;
+  m_keepAlive = false;
+  StopApplication ();
+  m_keepAlive = keepAlive;
+}
+
+int
+HttpRangeClientApplication::GetStatus () const
+{
+  return m_status;
+}
+
+bool
+HttpRangeClientApplication::GotRange () const
+{
+  return m_status == 206 || m_status == 416;
+}
+
+uint32_t
+HttpRangeClientApplication::GetBytes () const
+{
+  return m_bytes;
+}
+
+void
+HttpRangeClientApplication::SetFetchedCallback (Callback<void, Ptr<HttpRangeClientApplication> > fetched)
+{
+  m_fetched = fetched;
+}
+
+void
+HttpRangeClientApplication::OnFileReceived (unsigned status, unsigned length)
+{
+  HttpClientApplication::OnFileReceived (status, length);
+
+  if (!m_active)
+    return;
+
+  NS_LOG_DEBUG ("Client(" << node_id << "): Fetched " << length << " bytes from " << m_rangeFirst
+                << " of " << m_fileToRequest << ", status " << status);
+  m_status = status;
+  m_bytes = length;
+  if (!m_fetched.IsNull ())
+    m_fetched (this);
+}
+
+} // Namespace ns3
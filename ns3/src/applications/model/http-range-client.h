@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - HTTP Range Client Application class
+
+
+#ifndef HTTP_RANGE_CLIENT_APPLICATION_H
+#define HTTP_RANGE_CLIENT_APPLICATION_H
+
+#include "http-client.h"
+#include "ns3/callback.h"
+
+
+namespace ns3 {
+
+/**
+ * \brief Fetches one byte range of a file at a time on a keep-alive
+ * connection of its own
+ *
+ * Several of these fetch the ranges of a file in parallel, e.g. one per
+ * path of a multihomed node, see the RangeConnections attribute of
+ * MultimediaConsumer. The application is not added to the node with
+ * Node::AddApplication: the node would start it at its start time with no
+ * range to fetch, while Fetch starts it anew for every range. Whoever
+ * creates it owns it, closes it and disposes of it.
+ */
+class HttpRangeClientApplication : public HttpClientApplication
+{
+public:
+  static TypeId GetTypeId (void);
+
+  HttpRangeClientApplication ();
+
+  virtual ~HttpRangeClientApplication ();
+
+  /**
+   * \brief Request bytes first to last of fileToRequest, once the previous fetch is done
+   * \param last the last byte, -1 for up to the end of the file
+   */
+  void Fetch (std::string fileToRequest, int64_t first, int64_t last);
+
+  /**
+   * \brief Stop fetching and close the connection; the next Fetch opens a new one
+   */
+  void Close ();
+
+  /**
+   * \returns the status code of the last fetch: 206, 416 if the range
+   *          starts behind the end of the file, 200 from a server that
+   *          ignored the range and sent the whole file, or an error
+   */
+  int GetStatus () const;
+
+  /**
+   * \returns whether the last fetch got what was asked for: a 206, or a
+   *          416 for a range behind the end of the file, which is empty
+   */
+  bool GotRange () const;
+
+  /**
+   * \returns the body bytes of the last fetch
+   */
+  uint32_t GetBytes () const;
+
+  /**
+   * \brief Set the callback called when a fetch is done
+   */
+  void SetFetchedCallback (Callback<void, Ptr<HttpRangeClientApplication> > fetched);
+
+protected:
+  virtual void DoDispose (void);
+
+  virtual void OnFileReceived (unsigned status, unsigned length);
+
+private:
+  int m_status;
+  uint32_t m_bytes;
+  Callback<void, Ptr<HttpRangeClientApplication> > m_fetched;
+};
+
+} // namespace ns3
+
+#endif /* HTTP_RANGE_CLIENT_APPLICATION_H */
@@ -8,11 +8,11 @@
 #include "ns3/socket.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 #include "ns3/mp-tcp-socket-base.h"
 
 
 #include <sys/types.h>
-#include <sys/stat.h>
 
 #define CRLF "\r\n"
 
@@ -25,9 +25,8 @@ namespace ns3
 
 HttpServerFakeClientSocket::HttpServerFakeClientSocket(uint64_t socket_id,
     std::string contentDir,
-    std::map<std::string /* filename */, long /* file size */>& fileSizes,
-    std::vector<std::string /* filename */>& virtualFiles,
-    Callback<void, uint64_t> finished_callback) : m_fileSizes(fileSizes), m_virtualFiles(virtualFiles)
+    HttpFileCatalog& catalog,
+    Callback<void, uint64_t> finished_callback) : m_catalog(catalog)
 {
   this->m_socket_id = socket_id;
   this->m_finished_callback = finished_callback;
@@ -41,7 +40,16 @@ HttpServerFakeClientSocket::HttpServerFakeClientSocket(uint64_t socket_id,
 
   m_keep_alive = false;
 
+  m_hasRange = false;
+  m_rangeFirst = -1;
+  m_rangeLast = -1;
+
   m_is_virtual_file = false;
+  m_bodyFirst = 0;
+
+  m_servingRequests = false;
+  m_inDataSent = false;
+  m_sndBufSize = 0;
 }
 
 
@@ -93,15 +101,45 @@ HttpServerFakeClientSocket::HandleIncomingData(Ptr<Socket> s)
     free(buffer);
 
 
-    if (string_ends_width(m_activeRecvString, std::string(CRLF)))
+    // split off every complete request; a pipelining client sends the next
+    // ones before the reply to the first is out
+    size_t end;
+    while ((end = m_activeRecvString.find(CRLF CRLF)) != std::string::npos)
     {
-      m_currentBytesTx = 0;
-      m_totalBytesToTx = 0;
-
-      FinishedIncomingData(socket, from, m_activeRecvString);
-      m_activeRecvString = "";
+      m_pendingRequests.push_back(m_activeRecvString.substr(0, end + 4));
+      m_activeRecvString.erase(0, end + 4);
     }
   }
+
+  ServePendingRequests(socket);
+}
+
+
+// Reply to the pending requests in the order they came in. The next reply is
+// only started once the current one has been handed to the socket completely,
+// so replies never interleave.
+void
+HttpServerFakeClientSocket::ServePendingRequests(Ptr<Socket> socket)
+{
+  // called again by HandleReadyToTransmit while a reply is being started
+  if (m_servingRequests)
+    return;
+
+  m_servingRequests = true;
+  while (!m_pendingRequests.empty() && m_currentBytesTx >= m_totalBytesToTx)
+  {
+    std::string request = m_pendingRequests.front();
+    m_pendingRequests.pop_front();
+
+    m_currentBytesTx = 0;
+    m_totalBytesToTx = 0;
+    this->m_bytesToTransmit.clear();
+    this->m_packetToTransmit = 0;
+    this->m_bodyMapping = 0;
+
+    FinishedIncomingData(socket, Address(), request);
+  }
+  m_servingRequests = false;
 }
 
 
@@ -140,10 +178,83 @@ HttpServerFakeClientSocket::ParseHTTPHeader(std::string data)
     this->m_keep_alive = true;
   }
 
+  // check for a byte range: "bytes=first-last", "bytes=first-" or "bytes=-suffix"
+  m_hasRange = false;
+  m_rangeFirst = -1;
+  m_rangeLast = -1;
+  size_t range = data.find("Range: bytes=");
+  if (range != std::string::npos)
+  {
+    const char* spec = &cBuffer[range + 13];
+    char* end;
+    if (*spec != '-')
+    {
+      m_rangeFirst = strtol(spec, &end, 10);
+      spec = end;
+    }
+    if (*spec == '-')
+    {
+      spec++;
+      if (*spec >= '0' && *spec <= '9')
+        m_rangeLast = strtol(spec, &end, 10);
+      // "bytes=-" is no range at all
+      m_hasRange = m_rangeFirst >= 0 || m_rangeLast >= 0;
+    }
+  }
+
   return sFilename;
 }
 
 
+// Status line and headers of the reply to a file of filesize bytes, with
+// the part of the file that goes into the body: all of it, or the range of
+// the request, clamped to the file (206), or nothing if the range starts
+// behind the end of the file (416)
+std::string
+HttpServerFakeClientSocket::ReplyHeader(long filesize, long* first, long* length)
+{
+  std::stringstream replySS;
+  *first = 0;
+  *length = filesize;
+
+  if (m_hasRange)
+  {
+    long last = filesize - 1;
+    if (m_rangeFirst < 0)
+    {
+      *first = std::max(0L, filesize - m_rangeLast);
+    } else
+    {
+      *first = m_rangeFirst;
+      if (m_rangeLast >= 0 && m_rangeLast < last)
+        last = m_rangeLast;
+    }
+
+    if (*first > last)
+    {
+      *length = 0;
+      replySS << "HTTP/1.1 416 Range Not Satisfiable" << CRLF;
+      replySS << "Content-Range: bytes */" << filesize << CRLF;
+      replySS << "Content-Length: 0" << CRLF;
+      replySS << CRLF;
+      return replySS.str();
+    }
+
+    *length = last - *first + 1;
+    replySS << "HTTP/1.1 206 Partial Content" << CRLF;
+    replySS << "Content-Range: bytes " << *first << "-" << last << "/" << filesize << CRLF;
+  } else
+  {
+    replySS << "HTTP/1.1 200 OK" << CRLF; // OR HTTP/1.1 404 Not Found
+  }
+  replySS << "Content-Type: text/xml; charset=utf-8" << CRLF; // e.g., when sending the MPD
+  replySS << "Content-Length: " << *length << CRLF;
+  replySS << CRLF;
+
+  return replySS.str();
+}
+
+
 void HttpServerFakeClientSocket::ConnectionClosedNormal(Ptr<Socket> socket)
 {
   NS_LOG_INFO ("Server(" << m_socket_id << "): Connection closing normally...");
@@ -151,6 +262,7 @@ void HttpServerFakeClientSocket::ConnectionClosedNormal(Ptr<Socket> socket)
 
   // remove the send callback
   socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t > ());
+  socket->SetDataSentCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t > ());
   // remove the recv callback
   socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
 
@@ -165,6 +277,7 @@ void HttpServerFakeClientSocket::ConnectionClosedError(Ptr<Socket> socket)
 
   // remove the send callback
   socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t > ());
+  socket->SetDataSentCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t > ());
   // remove the recv callback
   socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
 
@@ -172,31 +285,6 @@ void HttpServerFakeClientSocket::ConnectionClosedError(Ptr<Socket> socket)
 }
 
 
-// GetFileSize either from m_fileSizes map or from disk
-long HttpServerFakeClientSocket::GetFileSize(std::string filename)
-{
-  // check if is already in m_fileSizes
-  if (m_fileSizes.find(filename) != m_fileSizes.end())
-  {
-    return m_fileSizes[filename];
-  }
-  // else: query disk for file size
-
-  struct stat stat_buf;
-  int rc = stat(filename.c_str(), &stat_buf);
-
-  if (rc == 0)
-  {
-    m_fileSizes[filename] = stat_buf.st_size;
-    return stat_buf.st_size;
-  }
-  // else: file not found
-  NS_LOG_INFO ("Server(" << m_socket_id << ") ERROR: File not found: '" << filename.c_str() << "'");
-  return -1;
-}
-
-
-
 void
 HttpServerFakeClientSocket::LogCwndChange(uint32_t oldCwnd, uint32_t newCwnd)
 {
@@ -219,11 +307,11 @@ HttpServerFakeClientSocket::FinishedIncomingData(Ptr<Socket> socket, Address fro
 
   NS_LOG_INFO ("[" << Simulator::Now().GetSeconds() << "s] Server(" << m_socket_id << "): Opening '" << filename.c_str() << "'");
 
-  long filesize = GetFileSize(filename);
+  const HttpFileCatalog::Entry* file = m_catalog.Find(filename);
 
   m_is_virtual_file = false;
 
-  if (filesize == -1)
+  if (file == NULL)
   {
     NS_LOG_INFO ("Server(" << m_socket_id << "): Error, '" << filename.c_str () << "' not found!");
     // return 404
@@ -235,70 +323,33 @@ HttpServerFakeClientSocket::FinishedIncomingData(Ptr<Socket> socket, Address fro
     // Vitalii: somehow the app send buffer doesn't get cleared from previous
     //          data/segments, so let's clear it here for sure
     this->m_bytesToTransmit.clear();
-    // Create a proper header
-    std::stringstream replySS;
-    replySS << "HTTP/1.1 200 OK" << CRLF; // OR HTTP/1.1 404 Not Found
-    replySS << "Content-Type: text/xml; charset=utf-8" << CRLF; // e.g., when sending the MPD
-    replySS << "Content-Length: " << filesize << CRLF;
-    replySS << CRLF;
+    // Create a proper header, for the whole file or the requested range of it
+    long first, length;
+    std::string replyString = ReplyHeader(file->size, &first, &length);
 
-    //fprintf(stderr, "Replying with header:\n%s\n", replySS.str().c_str());
+    //fprintf(stderr, "Replying with header:\n%s\n", replyString.c_str());
 
-    std::string replyString = replySS.str();
     uint8_t* buffer = (uint8_t*)replyString.c_str();
     AddBytesToTransmit(buffer,replyString.length());
 
-    // now append the virtual payload data
-    uint8_t tmp[4096];
-
-    if (std::find(m_virtualFiles.begin(), m_virtualFiles.end(), filename) != m_virtualFiles.end())
+    // now append the payload; only the (small) in-memory files are copied,
+    // the other bodies are produced by GetBytesToTransmit when they are sent
+    if (file->source == HttpFileCatalog::VIRTUAL)
     {
-      // handle virtual payload
-      // fill tmp with some random data
-      NS_LOG_DEBUG ("Server("<<m_socket_id<<"): Generating virtual payload of size "<<filesize<<" ...");
-
+      NS_LOG_DEBUG ("Server("<<m_socket_id<<"): Generating virtual payload of size "<<length<<" ...");
 
-      this->m_totalBytesToTx += filesize;
+      this->m_totalBytesToTx += length;
       this->m_is_virtual_file = true;
-
-      /*
-      for (int i = 0; i < 4096; i++)
-      {
-        tmp[i] = (uint8_t)rand();
-      }
-
-
-      int cnt = 0;
-
-      while (cnt < filesize)
-      {
-        if (cnt + 4096 < filesize)
-        {
-          AddBytesToTransmit(tmp, 4096);
-        } else {
-          AddBytesToTransmit(tmp, filesize - cnt);
-        }
-        cnt += 4096;
-      } */
+    } else if (file->source == HttpFileCatalog::MEMORY)
+    {
+      AddBytesToTransmit((const uint8_t*)file->content.c_str() + first, length);
     } else
     {
-      NS_LOG_INFO ("[" << Simulator::Now().GetSeconds() << "s] Server(" << m_socket_id << "): Opening file on disk with size " << filesize);
-      // handle actual payload
-      FILE* fp = fopen(filename.c_str(), "rb");
-
-      int size_returned = 4096;
-
-      while (size_returned == 4096)
-      {
-        size_returned = fread(tmp, 1, 4096, fp);
+      NS_LOG_INFO ("[" << Simulator::Now().GetSeconds() << "s] Server(" << m_socket_id << "): Sending file on disk with size " << file->size);
 
-        if (size_returned > 0)
-        {
-          AddBytesToTransmit(tmp, size_returned);
-        }
-      }
-
-      fclose(fp);
+      this->m_totalBytesToTx += length;
+      this->m_bodyMapping = file->mapping;
+      this->m_bodyFirst = first;
     }
   }
 
@@ -319,6 +370,12 @@ HttpServerFakeClientSocket::HandleReadyToTransmit(Ptr<Socket> s, uint32_t txSize
   }
   if (m_currentBytesTx >= m_totalBytesToTx && m_totalBytesToTx > 0)
   {
+    if (!m_pendingRequests.empty())
+    {
+      ServePendingRequests(socket);
+      return;
+    }
+
     // already sent everything, check if we need to "close" the socket and disband this object, or if we keep it alive
     if (!m_keep_alive)
     {
@@ -330,6 +387,7 @@ HttpServerFakeClientSocket::HandleReadyToTransmit(Ptr<Socket> s, uint32_t txSize
         socket->Close();
         // remove the send callback
         socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t > ());
+        socket->SetDataSentCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t > ());
         // remove the recv callback
         socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
 
@@ -339,6 +397,8 @@ HttpServerFakeClientSocket::HandleReadyToTransmit(Ptr<Socket> s, uint32_t txSize
         // we already finished sending, so we can clear the buffer for the sake of saving memory
         this->m_bytesToTransmit.clear();
         std::vector<uint8_t>().swap( this->m_bytesToTransmit ); // explicitly clear the buffer
+        this->m_packetToTransmit = 0;
+        this->m_bodyMapping = 0;
         m_is_shutdown = true; // make sure to set that flag to true, so that we do not call this stuff again
       }
     } else {
@@ -350,6 +410,8 @@ HttpServerFakeClientSocket::HandleReadyToTransmit(Ptr<Socket> s, uint32_t txSize
       // we already finished sending, so we can clear the buffer for the sake of saving memory
       this->m_bytesToTransmit.clear();
       std::vector<uint8_t>().swap( this->m_bytesToTransmit ); // explicitly clear the buffer
+      this->m_packetToTransmit = 0;
+      this->m_bodyMapping = 0;
       m_is_shutdown = true;
     }
     return;
@@ -357,63 +419,55 @@ HttpServerFakeClientSocket::HandleReadyToTransmit(Ptr<Socket> s, uint32_t txSize
   //fprintf(stderr, "Server(%ld)::HandleReadyToTransmit(socket,txSize=%u)\n", m_socket_id, txSize);
 
 
-  // get txSize bytes from m_bytesToTransmit, starting at byte m_currentBytesTx
-
-  while (m_currentBytesTx < m_totalBytesToTx && socket->GetTxAvailable () > 0)
+  // queue the reply in chunks up to the free space of the socket buffer,
+  // HandleDataSent queues more as the socket sends; each chunk is a slice
+  // of the header packet plus the body as produced by GetBytesToTransmit
+  while (m_currentBytesTx < m_totalBytesToTx && socket->GetTxAvailable() > 0)
   {
-    uint32_t remainingBytes = m_totalBytesToTx - m_currentBytesTx;
-
-    // if (remainingBytes > 2860)
-    //   remainingBytes = 2860;
-    if (remainingBytes > 1400)
-      remainingBytes = 1400;
-
-    if (remainingBytes < socket->GetTxAvailable ())
+    uint32_t chunk = std::min(std::min(m_totalBytesToTx - m_currentBytesTx, CHUNK_SIZE), socket->GetTxAvailable());
+    int amountSent = socket->FillBuffer (GetBytesToTransmit (m_currentBytesTx, chunk));
+    if (amountSent <= 0)
     {
-      remainingBytes = std::min(remainingBytes, socket->GetTxAvailable ());
-      NS_LOG_WARN ("Server::HandleReadyToTransmit: Socket has less Tx space " <<
-                    "available than we need; this can potentially make issues" <<
-                    "for pushing data into socket tx buffer!");
+      NS_LOG_INFO ("Server(" << m_socket_id << "): failed to queue " << chunk << " bytes, waiting for next transmit...");
+      break;
     }
-
-    Ptr<Packet> replyPacket;
-    uint8_t *buffer;
-    if (!m_is_virtual_file)
-    {
-      buffer = (uint8_t*) &((this->m_bytesToTransmit)[m_currentBytesTx]);
-      replyPacket = Create<Packet> (buffer, remainingBytes);
-    } else
-    {
-      if (m_currentBytesTx == 0) // reply with header
-      {
-        buffer = (uint8_t*) &((this->m_bytesToTransmit)[m_currentBytesTx]);
-        replyPacket = Create<Packet> (buffer, this->m_bytesToTransmit.size());
-      } else {
-        // create a virtual reply packet
-        buffer = (uint8_t*)malloc(remainingBytes);
-
-        replyPacket = Create<Packet> (buffer, remainingBytes);
-        free (buffer);
-      }
-    }
-
-    // std::cout << "\n\n size: " << remainingBytes << " |" << buffer << "|\n";
-    int amountSent = socket->FillBuffer (buffer, remainingBytes);
+    m_currentBytesTx += amountSent;
+  }
+  if (!m_inDataSent)
     socket->SendBufferedData ();
-    // free (buffer);
-    // int amountSent = socket->Send (replyPacket);
 
-    if (amountSent <= 0)
-    {
-      NS_LOG_INFO ("Server(" << m_socket_id << "): failed to transmit " << remainingBytes << " bytes, waiting for next transmit...");
-      // we will be called again, when new TX space becomes available;
-      return;
-    }
+  if (m_currentBytesTx >= m_totalBytesToTx)
+  {
+    ServePendingRequests(socket);
+  }
+}
 
-    m_currentBytesTx += amountSent;
 
-    //fprintf(stderr, "Server(%ld)::HandleReadyToTransmit - Transmitted %d bytes, %u remaining\n", m_socket_id, amountSent, m_totalBytesToTx - m_currentBytesTx);
+// The socket is in the middle of an ACK or a send and goes on with what is
+// queued here, so only the queueing part of HandleReadyToTransmit runs. If
+// the socket ran out of data before its window closed, e.g. at the start of
+// a reply when the cwnd outgrew the socket buffer, the refill is sent right
+// away instead of with the next ACK. Once the reply is queued completely
+// there is nothing to do until the next request.
+void
+HttpServerFakeClientSocket::HandleDataSent(Ptr<Socket> s, uint32_t txAvailable)
+{
+  if (m_currentBytesTx >= m_totalBytesToTx)
+    return;
+
+  Ptr<MpTcpSocketBase> socket = DynamicCast<MpTcpSocketBase>(s);
+  if (m_sndBufSize == 0)
+  {
+    UintegerValue sndBufSize;
+    socket->GetAttribute("SndBufSize", sndBufSize);
+    m_sndBufSize = sndBufSize.Get();
   }
+  bool drained = (txAvailable >= m_sndBufSize);
+  m_inDataSent = true;
+  HandleReadyToTransmit(socket, txAvailable);
+  m_inDataSent = false;
+  if (drained)
+    Simulator::ScheduleNow(&MpTcpSocketBase::SendBufferedData, socket);
 }
 
 
@@ -421,7 +475,49 @@ void HttpServerFakeClientSocket::AddBytesToTransmit(const uint8_t* buffer, uint3
 {
   std::copy(buffer, buffer+size, std::back_inserter(this->m_bytesToTransmit));
   this->m_totalBytesToTx += size;
+  this->m_packetToTransmit = 0; // rebuilt on the next call to GetBytesToTransmit
   // delete[] buffer; // Vitalii: let's see if deleting the passed buffer works good so that it won't leak memory// double free :(
 }
 
+
+
+// Return 'size' bytes of the reply starting at 'offset' as a packet. Bytes
+// collected with AddBytesToTransmit are turned into one packet once and then
+// sliced with CreateFragment. The body behind them is produced here: cut
+// from the shared mapping of a file on disk, or, for a virtual file, a
+// zero-filled packet that never materializes its payload.
+Ptr<Packet>
+HttpServerFakeClientSocket::GetBytesToTransmit(uint32_t offset, uint32_t size)
+{
+  uint32_t stored = this->m_bytesToTransmit.size();
+  if (m_packetToTransmit == 0 && stored > 0)
+  {
+    m_packetToTransmit = Create<Packet> (&(this->m_bytesToTransmit[0]), stored);
+  }
+
+  uint32_t fromStored = offset < stored ? std::min(size, stored - offset) : 0;
+  if (fromStored == size)
+  {
+    return m_packetToTransmit->CreateFragment (offset, fromStored);
+  }
+
+  uint32_t bodyOffset = offset + fromStored - stored;
+  Ptr<Packet> body;
+  if (m_bodyMapping != 0)
+  {
+    body = Create<Packet> (m_bodyMapping->GetData() + m_bodyFirst + bodyOffset, size - fromStored);
+  } else
+  {
+    body = Create<Packet> (size - fromStored);
+  }
+
+  if (fromStored == 0)
+  {
+    return body;
+  }
+  Ptr<Packet> p = m_packetToTransmit->CreateFragment (offset, fromStored);
+  p->AddAtEnd (body);
+  return p;
+}
+
 };
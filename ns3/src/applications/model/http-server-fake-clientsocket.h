@@ -7,7 +7,9 @@
 #include "ns3/ptr.h"
 #include "ns3/string.h"
 #include "ns3/tcp-socket.h"
+#include "http-file-catalog.h"
 
+#include <deque>
 #include <map>
 #include <vector>
 #include <stdio.h>
@@ -23,8 +25,7 @@ class HttpServerFakeClientSocket
 {
 public:
   HttpServerFakeClientSocket(uint64_t socket_id,
-  std::string contentDir, std::map<std::string /* filename */, long /* file size */>& fileSizes,
-  std::vector<std::string /* filename */>& virtualFiles,
+  std::string contentDir, HttpFileCatalog& catalog,
   Callback<void, uint64_t> finished_callback);
 
   virtual ~HttpServerFakeClientSocket();
@@ -34,6 +35,9 @@ public:
 
   void HandleReadyToTransmit(Ptr<Socket> socket, uint32_t txSize);
 
+  // DataSent callback: MpTcpSocketBase reports freed buffer space this way
+  void HandleDataSent(Ptr<Socket> socket, uint32_t txAvailable);
+
 
   void ConnectionClosedNormal (Ptr<Socket> socket);
   void ConnectionClosedError (Ptr<Socket> socket);
@@ -47,11 +51,12 @@ protected:
   Callback<void, uint64_t> m_finished_callback;
 
   virtual void FinishedIncomingData(Ptr<Socket> socket, Address from, std::string data);
+  void ServePendingRequests(Ptr<Socket> socket);
   void AddBytesToTransmit(const uint8_t* buffer, uint32_t size);
+  Ptr<Packet> GetBytesToTransmit(uint32_t offset, uint32_t size);
 
   std::string ParseHTTPHeader(std::string data);
-
-  long GetFileSize(std::string filename);
+  std::string ReplyHeader(long filesize, long* first, long* length);
 
 
 
@@ -63,7 +68,14 @@ protected:
   uint32_t bytes_sent;
 
   uint32_t m_totalBytesToTx;
-  uint32_t m_currentBytesTx;
+  uint32_t m_currentBytesTx; // queued into the socket so far
+
+  // the reply goes into the socket in pieces of at most this many bytes, as
+  // buffer space frees up, so that a connection never holds more than its
+  // socket buffer of a file on disk
+  static const uint32_t CHUNK_SIZE = 4 * 1460;
+  bool m_inDataSent; // the socket sends what is queued once HandleDataSent returns
+  uint32_t m_sndBufSize; // of the socket, read by the first HandleDataSent
 
   bool m_is_shutdown;
 
@@ -71,13 +83,27 @@ protected:
 
   bool m_keep_alive;
 
+  // byte range of the current request, see ParseHTTPHeader
+  bool m_hasRange;
+  long m_rangeFirst; // -1 for the last m_rangeLast bytes of the file
+  long m_rangeLast;  // -1 for up to the end of the file
+
   std::vector<uint8_t> m_bytesToTransmit;
+  Ptr<Packet> m_packetToTransmit; // m_bytesToTransmit as a packet, sliced into the socket without copying
+
+  // body of the reply behind m_bytesToTransmit, up to m_totalBytesToTx:
+  // bytes m_bodyFirst... of a mapped file, or zeros if there is no mapping
+  Ptr<HttpFileCatalog::Mapping> m_bodyMapping;
+  long m_bodyFirst;
 
 
   std::string m_activeRecvString;
 
-  std::map<std::string,long>& m_fileSizes;
-  std::vector<std::string>& m_virtualFiles;
+  // complete requests of a pipelining client, answered one after the other
+  std::deque<std::string> m_pendingRequests;
+  bool m_servingRequests;
+
+  HttpFileCatalog& m_catalog; // of the server, shared by its client sockets
 };
 
 } // namespace ns3
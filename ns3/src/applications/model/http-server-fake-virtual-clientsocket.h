@@ -9,22 +9,17 @@ class Socket;
 class Address;
 
 
+// The client socket of DASHFakeServerApplication. Virtual segments used to
+// be filled with random bytes here; the base class now produces every body
+// lazily, so this only remains as the DASH server's socket type.
 class HttpServerFakeVirtualClientSocket : public HttpServerFakeClientSocket
 {
 public:
   HttpServerFakeVirtualClientSocket(uint64_t socket_id,
-  std::string contentDir, std::map<std::string /* filename */, long /* file size */>& fileSizes,
-  std::vector<std::string /* filename */>& fakeFiles, std::map<std::string,std::string>& /* virtual file host */ virtualHostedFiles,
+  std::string contentDir, HttpFileCatalog& catalog,
   Callback<void, uint64_t> finished_callback);
 
   ~HttpServerFakeVirtualClientSocket();
-
-protected:
-  std::map<std::string,std::string>& m_virtualHostedFiles;
-
-  void FinishedIncomingData(Ptr<Socket> socket, Address from, std::string data);
-
-
 };
 
 } // namespace ns3
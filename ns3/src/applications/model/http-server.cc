@@ -212,7 +212,7 @@ HttpServerApplication::StartApplication (void)
 
   // parse meta data csv file
 
-  // read m_metaDataFile and fill m_fileSizes
+  // read m_metaDataFile and fill m_catalog
   std::ifstream infile(m_metaDataFile.c_str());
   if (!infile.is_open())
   {
@@ -232,11 +232,9 @@ HttpServerApplication::StartApplication (void)
         std::string line_filename = line.substr(0, pos);
         std::string line_filesize = line.substr(pos+1);
         //fprintf(stderr, "First=%s,Second=%s\n", line_filename.c_str(), line_filesize.c_str());
-        m_fileSizes[m_contentDir + m_metaDataContentDirectory + line_filename] = atoi(line_filesize.c_str());
+        m_catalog.AddVirtualFile(m_contentDir + m_metaDataContentDirectory + line_filename, atoi(line_filesize.c_str()));
 
         NS_LOG_INFO ("Added '" << (m_contentDir + m_metaDataContentDirectory + line_filename).c_str() << "' to the store!\n");
-
-        m_virtualFiles.push_back(m_contentDir + m_metaDataContentDirectory + line_filename);
       }
     }
   }
@@ -289,13 +287,14 @@ HttpServerApplication::ConnectionAccepted (Ptr<Socket> socket, const Address& ad
 
   uint64_t socket_id = RegisterSocket(socket);
 
-  m_activeClients[socket_id] = new HttpServerFakeClientSocket(socket_id, m_contentDir, m_fileSizes, m_virtualFiles,
+  m_activeClients[socket_id] = new HttpServerFakeClientSocket(socket_id, m_contentDir, m_catalog,
                   MakeCallback(&HttpServerApplication::FinishedCallback, this));
 
   NS_LOG_DEBUG (socket << " " << Simulator::Now () << " Successful socket id : " << socket_id << " Connection Accepted From " << address);
 
   // set callbacks for this socket to be in HttpServerFakeClientSocket class
   socket->SetSendCallback (MakeCallback (&HttpServerFakeClientSocket::HandleReadyToTransmit, m_activeClients[socket_id]));
+  socket->SetDataSentCallback (MakeCallback (&HttpServerFakeClientSocket::HandleDataSent, m_activeClients[socket_id]));
   socket->SetRecvCallback (MakeCallback (&HttpServerFakeClientSocket::HandleIncomingData, m_activeClients[socket_id]));
 
 
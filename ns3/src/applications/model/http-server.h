@@ -99,8 +99,7 @@ private:
 
   std::map<uint64_t /* socket id */, std::string /* packet buffer */ > m_activePackets;
 
-  std::map<std::string, long> m_fileSizes;
-  std::vector<std::string> m_virtualFiles;
+  HttpFileCatalog m_catalog;
 
   uint64_t m_lastSocketID;
 
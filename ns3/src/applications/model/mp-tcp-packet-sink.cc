@@ -144,10 +144,15 @@ MpTcpPacketSink::HandleRead(Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << m_socket);
   Ptr<MpTcpSocketBase> mpSocket = DynamicCast<MpTcpSocketBase>(socket);
-  uint32_t dataAmount = mpSocket->Recv(size);
-  //uint32_t dataAmount = m_socket->Recv(buf, size);
-  m_totalRx += dataAmount;
-  NS_LOG_INFO ("MpTcpPacketSink:HandleRead() -> Received " << dataAmount << " bytes total Rx " << m_totalRx);
+  uint32_t dataAmount;
+  // Drain the socket: a filled hole can make far more than one read in-order at once,
+  // and what stays unread closes the window advertised to the sender
+  while ((dataAmount = mpSocket->Recv(size)) > 0)
+    {
+      //uint32_t dataAmount = m_socket->Recv(buf, size);
+      m_totalRx += dataAmount;
+      NS_LOG_INFO ("MpTcpPacketSink:HandleRead() -> Received " << dataAmount << " bytes total Rx " << m_totalRx);
+    }
 }
 
 void
@@ -0,0 +1,462 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <deque>
+#include <sstream>
+#include "ns3/test.h"
+#include "ns3/ptr.h"
+#include "ns3/callback.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/dash-mpd-cache.h"
+
+using namespace ns3;
+using dash::mpd::ISegment;
+
+/// DownloadEngine::WORKERS of libdash, the chunks downloaded at the same time
+static const uint32_t WORKERS = 4;
+
+/**
+ * A keep-alive HTTP/1.1 server on the loopback interface that serves
+ * Body () of every path, ranges included. Each connection has a thread of
+ * its own, and replies are held until Release (), so that the test sees
+ * how many requests the engine has in progress at once.
+ */
+class LoopbackHttpServer
+{
+public:
+  LoopbackHttpServer ();
+  ~LoopbackHttpServer ();
+
+  uint16_t GetPort (void) const;
+  /// Lets the held replies, and all later ones, go
+  void Release (void);
+  /// Waits up to 10 s for n requests in progress
+  bool WaitInProgress (uint32_t n);
+
+  uint32_t GetConnections (void);
+  uint32_t GetMaxInProgress (void);
+  /// "path range" of every request received, range empty if it had none
+  std::vector<std::string> GetRequests (void);
+
+  static std::string Body (std::string path);
+
+private:
+  void Accept (void);
+  void Serve (void);
+  void Reply (int fd, std::string header);
+
+  int m_listenFd;
+  uint16_t m_port;
+  Ptr<SystemThread> m_acceptThread;
+
+  SystemMutex m_lock;
+  bool m_released;
+  std::vector<Ptr<SystemThread> > m_threads;
+  std::vector<int> m_fds;
+  std::deque<int> m_accepted;       //!< Connections no thread took yet
+  std::vector<std::string> m_requests;
+  uint32_t m_inProgress;
+  uint32_t m_maxInProgress;
+};
+
+LoopbackHttpServer::LoopbackHttpServer ()
+  : m_port (0),
+    m_released (false),
+    m_inProgress (0),
+    m_maxInProgress (0)
+{
+  m_listenFd = socket (AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr;
+  memset (&addr, 0, sizeof (addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  socklen_t len = sizeof (addr);
+  if (bind (m_listenFd, (struct sockaddr *) &addr, sizeof (addr)) == 0
+      && listen (m_listenFd, 16) == 0
+      && getsockname (m_listenFd, (struct sockaddr *) &addr, &len) == 0)
+    {
+      m_port = ntohs (addr.sin_port);
+    }
+  m_acceptThread = Create<SystemThread> (MakeCallback (&LoopbackHttpServer::Accept, this));
+  m_acceptThread->Start ();
+}
+
+LoopbackHttpServer::~LoopbackHttpServer ()
+{
+  // Wakes accept () and every recv () with an error or the end of the stream
+  shutdown (m_listenFd, SHUT_RDWR);
+  m_acceptThread->Join ();
+  close (m_listenFd);
+  Release ();
+  m_lock.Lock ();
+  std::vector<Ptr<SystemThread> > threads = m_threads;
+  for (size_t i = 0; i < m_fds.size (); i++)
+    {
+      shutdown (m_fds[i], SHUT_RDWR);
+    }
+  m_lock.Unlock ();
+  for (size_t i = 0; i < threads.size (); i++)
+    {
+      threads[i]->Join ();
+    }
+  for (size_t i = 0; i < m_fds.size (); i++)
+    {
+      close (m_fds[i]);
+    }
+}
+
+uint16_t
+LoopbackHttpServer::GetPort (void) const
+{
+  return m_port;
+}
+
+void
+LoopbackHttpServer::Release (void)
+{
+  CriticalSection cs (m_lock);
+  m_released = true;
+}
+
+bool
+LoopbackHttpServer::WaitInProgress (uint32_t n)
+{
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      {
+        CriticalSection cs (m_lock);
+        if (m_inProgress >= n)
+          return true;
+      }
+      usleep (10000);
+    }
+  return false;
+}
+
+uint32_t
+LoopbackHttpServer::GetConnections (void)
+{
+  CriticalSection cs (m_lock);
+  return m_fds.size ();
+}
+
+uint32_t
+LoopbackHttpServer::GetMaxInProgress (void)
+{
+  CriticalSection cs (m_lock);
+  return m_maxInProgress;
+}
+
+std::vector<std::string>
+LoopbackHttpServer::GetRequests (void)
+{
+  CriticalSection cs (m_lock);
+  return m_requests;
+}
+
+std::string
+LoopbackHttpServer::Body (std::string path)
+{
+  std::string body;
+  while (body.size () < 1000)
+    {
+      body += path;
+    }
+  return body.substr (0, 1000);
+}
+
+void
+LoopbackHttpServer::Accept (void)
+{
+  int fd;
+  while ((fd = accept (m_listenFd, 0, 0)) >= 0)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&LoopbackHttpServer::Serve, this));
+      {
+        CriticalSection cs (m_lock);
+        m_fds.push_back (fd);
+        m_accepted.push_back (fd);
+        m_threads.push_back (thread);
+      }
+      thread->Start ();
+    }
+}
+
+void
+LoopbackHttpServer::Serve (void)
+{
+  int fd;
+  {
+    CriticalSection cs (m_lock);
+    fd = m_accepted.front ();
+    m_accepted.pop_front ();
+  }
+  std::string buffer;
+  char data[1024];
+  ssize_t n;
+  while ((n = recv (fd, data, sizeof (data), 0)) > 0)
+    {
+      buffer.append (data, n);
+      size_t end;
+      while ((end = buffer.find ("\r\n\r\n")) != std::string::npos)
+        {
+          std::string header = buffer.substr (0, end + 2);
+          buffer.erase (0, end + 4);
+          Reply (fd, header);
+        }
+    }
+}
+
+void
+LoopbackHttpServer::Reply (int fd, std::string header)
+{
+  std::istringstream request (header);
+  std::string method, path;
+  request >> method >> path;
+  std::string range;
+  size_t pos = header.find ("Range: bytes=");
+  if (pos != std::string::npos)
+    {
+      pos += 13;
+      range = header.substr (pos, header.find ("\r\n", pos) - pos);
+    }
+  {
+    CriticalSection cs (m_lock);
+    m_requests.push_back (path + " " + range);
+    m_inProgress++;
+    m_maxInProgress = std::max (m_maxInProgress, m_inProgress);
+  }
+
+  while (true)
+    {
+      {
+        CriticalSection cs (m_lock);
+        if (m_released)
+          break;
+      }
+      usleep (1000);
+    }
+
+  std::string body = Body (path);
+  std::ostringstream reply;
+  if (range.empty ())
+    {
+      reply << "HTTP/1.1 200 OK\r\n";
+    }
+  else
+    {
+      size_t minus = range.find ('-');
+      size_t first = atoi (range.substr (0, minus).c_str ());
+      size_t last = atoi (range.substr (minus + 1).c_str ());
+      reply << "HTTP/1.1 206 Partial Content\r\n"
+            << "Content-Range: bytes " << first << "-" << last << "/" << body.size () << "\r\n";
+      body = body.substr (first, last - first + 1);
+    }
+  reply << "Content-Length: " << body.size () << "\r\n\r\n" << body;
+  std::string data = reply.str ();
+  send (fd, data.data (), data.size (), MSG_NOSIGNAL);
+
+  CriticalSection cs (m_lock);
+  m_inProgress--;
+}
+
+/**
+ * One SegmentURL behind the base URL of the server for every entry of the
+ * comma separated list, "name" or "name range" as in "v0 100-199".
+ */
+static dash::mpd::IMPD *
+AcquireMpd (uint16_t port, std::string media)
+{
+  std::ostringstream body;
+  body << "<?xml version=\"1.0\"?>\n"
+       << "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" type=\"static\">\n"
+       << " <BaseURL>http://127.0.0.1:" << port << "/</BaseURL>\n"
+       << " <Period><AdaptationSet><Representation id=\"r\" bandwidth=\"1000\">\n"
+       << "  <SegmentList duration=\"2\">\n";
+  std::istringstream names (media);
+  std::string name;
+  while (std::getline (names, name, ','))
+    {
+      size_t blank = name.find (' ');
+      body << "   <SegmentURL media=\"" << name.substr (0, blank) << "\"";
+      if (blank != std::string::npos)
+        {
+          body << " mediaRange=\"" << name.substr (blank + 1) << "\"";
+        }
+      body << "/>\n";
+    }
+  body << "  </SegmentList>\n"
+       << " </Representation></AdaptationSet></Period>\n"
+       << "</MPD>\n";
+  std::ostringstream url;
+  url << "http://127.0.0.1:" << port << "/engine.mpd";
+  return DashMpdCache::Acquire (url.str (), body.str ());
+}
+
+static ISegment *
+GetSegment (dash::mpd::IMPD *mpd, size_t index)
+{
+  dash::mpd::IRepresentation *rep = mpd->GetPeriods ().at (0)->GetAdaptationSets ().at (0)->GetRepresentation ().at (0);
+  return rep->GetSegmentList ()->GetSegmentURLs ().at (index)->ToMediaSegment (mpd->GetBaseUrls ());
+}
+
+/// Everything the chunk delivers, up to its end of stream
+static std::string
+ReadAll (ISegment *segment)
+{
+  std::string result;
+  uint8_t data[512];
+  int n;
+  while ((n = segment->Read (data, sizeof (data))) > 0)
+    {
+      result.append ((const char *) data, n);
+    }
+  return result;
+}
+
+/**
+ * Six chunks started at once: four are requested, the others wait in the
+ * queue. A queued chunk aborts without a request, the remaining one is
+ * requested once a worker is free.
+ */
+class DashDownloadEngineQueueTestCase : public TestCase
+{
+public:
+  DashDownloadEngineQueueTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DashDownloadEngineQueueTestCase::DashDownloadEngineQueueTestCase ()
+  : TestCase ("Chunks beyond the worker count are queued")
+{
+}
+
+void
+DashDownloadEngineQueueTestCase::DoRun (void)
+{
+  LoopbackHttpServer server;
+  NS_TEST_ASSERT_MSG_NE (server.GetPort (), 0, "Loopback server is listening");
+  dash::mpd::IMPD *mpd = AcquireMpd (server.GetPort (), "s0,s1,s2,s3,s4,s5");
+  NS_TEST_ASSERT_MSG_NE (mpd, 0, "MPD is parsed");
+
+  std::vector<ISegment *> segments;
+  for (size_t i = 0; i < 6; i++)
+    {
+      segments.push_back (GetSegment (mpd, i));
+      NS_TEST_ASSERT_MSG_EQ (segments[i]->StartDownload (), true, "Download " << i << " starts");
+    }
+  NS_TEST_ASSERT_MSG_EQ (server.WaitInProgress (WORKERS), true, "One request per worker");
+
+  segments[5]->AbortDownload ();
+  NS_TEST_ASSERT_MSG_EQ (ReadAll (segments[5]), "", "Aborted in the queue, nothing to read");
+
+  server.Release ();
+  for (size_t i = 0; i < 5; i++)
+    {
+      std::ostringstream path;
+      path << "/s" << i;
+      NS_TEST_ASSERT_MSG_EQ (ReadAll (segments[i]), LoopbackHttpServer::Body (path.str ()), "Body of " << path.str ());
+    }
+  for (size_t i = 0; i < segments.size (); i++)
+    {
+      delete segments[i];
+    }
+
+  std::vector<std::string> requests = server.GetRequests ();
+  NS_TEST_ASSERT_MSG_EQ (requests.size (), 5, "Every chunk but the aborted one is requested");
+  NS_TEST_ASSERT_MSG_EQ (std::count (requests.begin (), requests.end (), "/s5 "), 0, "Aborted chunk requested");
+  NS_TEST_ASSERT_MSG_EQ (server.GetMaxInProgress (), WORKERS, "Requests in progress at once");
+  NS_TEST_ASSERT_MSG_LT (server.GetConnections (), WORKERS + 1, "One connection per worker at most");
+  DashMpdCache::Release (mpd);
+}
+
+/**
+ * The chunk downloads the URI, range and server it had when it was
+ * started, whatever the segment is changed to afterwards.
+ */
+class DashDownloadEngineSnapshotTestCase : public TestCase
+{
+public:
+  DashDownloadEngineSnapshotTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DashDownloadEngineSnapshotTestCase::DashDownloadEngineSnapshotTestCase ()
+  : TestCase ("AbstractChunk snapshots URI, range and server at the start")
+{
+}
+
+void
+DashDownloadEngineSnapshotTestCase::DoRun (void)
+{
+  LoopbackHttpServer server;
+  NS_TEST_ASSERT_MSG_NE (server.GetPort (), 0, "Loopback server is listening");
+  server.Release ();
+  dash::mpd::IMPD *mpd = AcquireMpd (server.GetPort (), "v0 100-199,v1");
+  NS_TEST_ASSERT_MSG_NE (mpd, 0, "MPD is parsed");
+
+  std::ostringstream uri;
+  uri << "http://127.0.0.1:" << server.GetPort () << "/v0";
+  ISegment *segment = GetSegment (mpd, 0);
+  NS_TEST_ASSERT_MSG_EQ (segment->StartDownload (), true, "Download starts");
+  segment->AbsoluteURI ("http://127.0.0.1:1/other");
+  segment->Range ("0-0");
+  segment->Host ("other.invalid");
+  segment->Port (1);
+
+  NS_TEST_ASSERT_MSG_EQ (ReadAll (segment), LoopbackHttpServer::Body ("/v0").substr (100, 100), "Original range of the original URI");
+  std::vector<std::string> requests = server.GetRequests ();
+  NS_TEST_ASSERT_MSG_EQ (requests.size (), 1, "One request");
+  NS_TEST_ASSERT_MSG_EQ (requests[0], "/v0 100-199", "Request of the snapshot");
+  NS_TEST_ASSERT_MSG_EQ (segment->GetHTTPTransactionList ().size (), 1, "One transaction");
+  NS_TEST_ASSERT_MSG_EQ (segment->GetHTTPTransactionList ()[0]->OriginalUrl (), uri.str (), "Transaction URL");
+  NS_TEST_ASSERT_MSG_EQ (segment->GetHTTPTransactionList ()[0]->Range (), "100-199", "Transaction range");
+  // Returns once no worker has the chunk, i.e. its handle is idle again
+  delete segment;
+
+  // Found only if the handle was kept under the server of the snapshot
+  segment = GetSegment (mpd, 1);
+  NS_TEST_ASSERT_MSG_EQ (segment->StartDownload (), true, "Download starts");
+  NS_TEST_ASSERT_MSG_EQ (ReadAll (segment), LoopbackHttpServer::Body ("/v1"), "Body of /v1");
+  delete segment;
+  NS_TEST_ASSERT_MSG_EQ (server.GetConnections (), 1, "Connection reused for the same server");
+  DashMpdCache::Release (mpd);
+}
+
+static class DashDownloadEngineTestSuite : public TestSuite
+{
+public:
+  DashDownloadEngineTestSuite ()
+    : TestSuite ("dash-download-engine", UNIT)
+  {
+    AddTestCase (new DashDownloadEngineQueueTestCase, TestCase::QUICK);
+    AddTestCase (new DashDownloadEngineSnapshotTestCase, TestCase::QUICK);
+  }
+} g_dashDownloadEngineTestSuite;
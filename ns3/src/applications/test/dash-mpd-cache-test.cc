@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/dash-mpd-cache.h"
+
+using namespace ns3;
+
+/**
+ * Clients with the same MPD body share one parsed tree, a different body
+ * or URL gets its own, and the trees go away with their last user.
+ */
+class DashMpdCacheTestCase : public TestCase
+{
+public:
+  DashMpdCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+  std::string MakeMpd (uint32_t bandwidth);
+};
+
+DashMpdCacheTestCase::DashMpdCacheTestCase ()
+  : TestCase ("Shared parsed MPDs")
+{
+}
+
+std::string
+DashMpdCacheTestCase::MakeMpd (uint32_t bandwidth)
+{
+  std::ostringstream mpd;
+  mpd << "<?xml version=\"1.0\"?>\n"
+      << "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" type=\"static\">\n"
+      << " <BaseURL>http://10.0.0.2/content/</BaseURL>\n"
+      << " <Period><AdaptationSet>\n"
+      << "  <Representation id=\"r1\" bandwidth=\"" << bandwidth << "\"/>\n"
+      << " </AdaptationSet></Period>\n"
+      << "</MPD>\n";
+  return mpd.str ();
+}
+
+void
+DashMpdCacheTestCase::DoRun (void)
+{
+  std::string url = "http://10.0.0.2/content/mpds/vid1.mpd";
+  std::string body = MakeMpd (1000);
+
+  dash::mpd::IMPD *a = DashMpdCache::Acquire (url, body);
+  NS_TEST_ASSERT_MSG_NE (a, 0, "MPD is parsed");
+  NS_TEST_ASSERT_MSG_EQ (a->GetPeriods ().at (0)->GetAdaptationSets ().at (0)->GetRepresentation ().at (0)->GetBandwidth (),
+                         1000, "Parsed MPD holds the representation");
+  dash::mpd::IMPD *b = DashMpdCache::Acquire (url, body);
+  NS_TEST_ASSERT_MSG_EQ (a, b, "Same body, same tree");
+  dash::mpd::IMPD *c = DashMpdCache::Acquire (url, MakeMpd (2000));
+  NS_TEST_ASSERT_MSG_NE (a, c, "Changed body, new tree");
+  dash::mpd::IMPD *d = DashMpdCache::Acquire ("http://10.0.0.3/content/mpds/vid1.mpd", body);
+  NS_TEST_ASSERT_MSG_NE (a, d, "Other URL, new tree");
+  NS_TEST_ASSERT_MSG_EQ (DashMpdCache::GetNMpds (), 3, "Three distinct MPDs");
+
+  DashMpdCache::Release (a);
+  NS_TEST_ASSERT_MSG_EQ (DashMpdCache::GetNMpds (), 3, "Tree still in use");
+  DashMpdCache::Release (b);
+  DashMpdCache::Release (c);
+  DashMpdCache::Release (d);
+  NS_TEST_ASSERT_MSG_EQ (DashMpdCache::GetNMpds (), 0, "Trees are deleted with their last user");
+
+  NS_TEST_ASSERT_MSG_EQ (DashMpdCache::Acquire (url, "not an mpd"), 0, "Broken MPDs are not cached");
+  NS_TEST_ASSERT_MSG_EQ (DashMpdCache::GetNMpds (), 0, "Nothing cached");
+}
+
+static class DashMpdCacheTestSuite : public TestSuite
+{
+public:
+  DashMpdCacheTestSuite ()
+    : TestSuite ("dash-mpd-cache", UNIT)
+  {
+    AddTestCase (new DashMpdCacheTestCase, TestCase::QUICK);
+  }
+} g_dashMpdCacheTestSuite;
@@ -0,0 +1,247 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <fstream>
+#include <map>
+#include <sstream>
+#include "ns3/test.h"
+#include "libdash.h"
+
+using namespace ns3;
+using dash::mpd::IMPD;
+using dash::xml::INode;
+
+/// libdash's sample MPD, with extra elements and attributes on every level
+static const std::string SAMPLE_MPD = "../../../../AMuSt-libdash-master/libdash/bin/TestMPD.mpd";
+
+/// INode::GetType () of elements and of their text
+static const int ELEMENT = 1;
+static const int TEXT = 3;
+
+/// The additional child of an element with the given name, 0 if none
+static INode *
+FindNode (const std::vector<INode *> &nodes, std::string name)
+{
+  for (size_t i = 0; i < nodes.size (); i++)
+    {
+      if (nodes[i]->GetName () == name)
+        return nodes[i];
+    }
+  return 0;
+}
+
+/// Raw attribute of an MPD element, empty if it has none
+static std::string
+GetRaw (const dash::mpd::IMPDElement *element, std::string key)
+{
+  std::map<std::string, std::string> attributes = element->GetRawAttributes ();
+  std::map<std::string, std::string>::const_iterator it = attributes.find (key);
+  return it == attributes.end () ? "" : it->second;
+}
+
+/**
+ * The sample MPD parsed from memory: the elements libdash knows become
+ * the MPD objects, the others stay nodes with their names, attributes and
+ * text, and the unknown attributes are kept raw. Parsing the file gives
+ * the same tree.
+ */
+class DashMpdParserSampleTestCase : public TestCase
+{
+public:
+  DashMpdParserSampleTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DashMpdParserSampleTestCase::DashMpdParserSampleTestCase ()
+  : TestCase ("Sample MPD parsed from memory")
+{
+}
+
+void
+DashMpdParserSampleTestCase::DoRun (void)
+{
+  std::string path = CreateDataDirFilename (SAMPLE_MPD);
+  std::ifstream file (path.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (file.good (), true, "Sample MPD " << path << " is readable");
+  std::ostringstream data;
+  data << file.rdbuf ();
+  std::string xml = data.str ();
+
+  dash::IDASHManager *manager = CreateDashManager ();
+  IMPD *mpd = manager->Open (xml.data (), xml.size (), "http://10.0.0.2/content/mpds/TestMPD.mpd");
+  NS_TEST_ASSERT_MSG_NE (mpd, 0, "Sample MPD is parsed");
+
+  // MPD attributes and its own additional element
+  NS_TEST_ASSERT_MSG_EQ (mpd->GetType (), "static", "MPD type");
+  NS_TEST_ASSERT_MSG_EQ (mpd->GetMediaPresentationDuration (), "PT0H9M56.46S", "MPD duration");
+  NS_TEST_ASSERT_MSG_EQ (mpd->GetMinBufferTime (), "PT2.0S", "MPD minBufferTime");
+  NS_TEST_ASSERT_MSG_EQ (mpd->GetProfiles ().size (), 1, "One profile");
+  NS_TEST_ASSERT_MSG_EQ (mpd->GetProfiles ()[0], "urn:mpeg:dash:profile:isoff-main:2011", "MPD profile");
+  NS_TEST_ASSERT_MSG_EQ (GetRaw (mpd, "myMDPAttribute"), "mpd", "Unknown MPD attribute kept raw");
+  INode *node = FindNode (mpd->GetAdditionalSubNodes (), "MPDElement");
+  NS_TEST_ASSERT_MSG_NE (node, 0, "Unknown MPD child kept as node");
+  NS_TEST_ASSERT_MSG_EQ (node->GetType (), ELEMENT, "Element node");
+  NS_TEST_ASSERT_MSG_EQ (node->GetAttributes ().size (), 0, "No attributes");
+  NS_TEST_ASSERT_MSG_EQ (node->GetText (), "### MPDTestText ###", "Element text");
+  // The text is a child of its own, as libxml2's reader reported it
+  NS_TEST_ASSERT_MSG_EQ (node->GetNodes ().size (), 1, "One text child");
+  NS_TEST_ASSERT_MSG_EQ (node->GetNodes ()[0]->GetType (), TEXT, "Text node");
+  NS_TEST_ASSERT_MSG_EQ (node->GetNodes ()[0]->GetText (), "### MPDTestText ###", "Text of the text node");
+
+  // Text of known elements
+  NS_TEST_ASSERT_MSG_EQ (mpd->GetProgramInformations ().size (), 1, "One ProgramInformation");
+  NS_TEST_ASSERT_MSG_EQ (mpd->GetProgramInformations ()[0]->GetTitle (), "### Title ###", "Title text");
+  NS_TEST_ASSERT_MSG_EQ (mpd->GetProgramInformations ()[0]->GetLang (), "en", "ProgramInformation lang");
+  NS_TEST_ASSERT_MSG_EQ (mpd->GetBaseUrls ().size (), 1, "One MPD BaseURL");
+  NS_TEST_ASSERT_MSG_EQ (mpd->GetBaseUrls ()[0]->GetUrl (), "http://www.testurl.com/folder/subfolder/videos/", "BaseURL text");
+
+  // Period level, in document order
+  NS_TEST_ASSERT_MSG_EQ (mpd->GetPeriods ().size (), 1, "One Period");
+  dash::mpd::IPeriod *period = mpd->GetPeriods ()[0];
+  NS_TEST_ASSERT_MSG_EQ (period->GetStart (), "PT0S", "Period start");
+  NS_TEST_ASSERT_MSG_EQ (GetRaw (period, "myPeriodAttribute"), "period", "Unknown Period attribute");
+  NS_TEST_ASSERT_MSG_EQ (GetRaw (period->GetBaseURLs ()[0], "myBaseURLAttribute"), "baseurl", "Unknown BaseURL attribute");
+  NS_TEST_ASSERT_MSG_EQ (period->GetSegmentList ()->GetSegmentURLs ().size (), 3, "Period SegmentURLs");
+  dash::mpd::ISegmentURL *url = period->GetSegmentList ()->GetSegmentURLs ()[1];
+  NS_TEST_ASSERT_MSG_EQ (url->GetMediaURI (), "bunny_2s_50kbit/bunny_50kbit_dashNonSeg.mp4", "SegmentURL media");
+  NS_TEST_ASSERT_MSG_EQ (url->GetMediaRange (), "13827-22232", "SegmentURL mediaRange");
+  node = FindNode (period->GetSegmentList ()->GetSegmentURLs ()[0]->GetAdditionalSubNodes (), "SegmentURLElement");
+  NS_TEST_ASSERT_MSG_NE (node, 0, "Unknown SegmentURL child");
+  NS_TEST_ASSERT_MSG_EQ (node->GetText (), "### SegmentURLTestText ###", "SegmentURL child text");
+  std::vector<dash::mpd::ITimeline *> &timelines = period->GetSegmentTemplate ()->GetSegmentTimeline ()->GetTimelines ();
+  NS_TEST_ASSERT_MSG_EQ (timelines.size (), 3, "Timeline entries");
+  NS_TEST_ASSERT_MSG_EQ (timelines[2]->GetStartTime (), 720720, "Third S t");
+  NS_TEST_ASSERT_MSG_EQ (timelines[2]->GetDuration (), 180180, "Third S d");
+  NS_TEST_ASSERT_MSG_EQ (GetRaw (timelines[0], "myTimelineAttribute"), "Timeline1", "Unknown S attribute");
+  NS_TEST_ASSERT_MSG_EQ (period->GetSubsets ().size (), 1, "One Subset");
+  NS_TEST_ASSERT_MSG_EQ (FindNode (period->GetAdditionalSubNodes (), "PeriodElement")->GetText (), "### PeriodTestText ###", "Period child text");
+
+  // Adaptation set and its descriptors
+  NS_TEST_ASSERT_MSG_EQ (period->GetAdaptationSets ().size (), 1, "One AdaptationSet");
+  dash::mpd::IAdaptationSet *set = period->GetAdaptationSets ()[0];
+  NS_TEST_ASSERT_MSG_EQ (set->GetMimeType (), "video/mp4", "AdaptationSet mimeType");
+  NS_TEST_ASSERT_MSG_EQ (set->GetCodecs ().size (), 1, "One codec");
+  NS_TEST_ASSERT_MSG_EQ (set->GetCodecs ()[0], "avc1.4D401F", "AdaptationSet codecs");
+  NS_TEST_ASSERT_MSG_EQ (set->GetContentComponent ().size (), 1, "One ContentComponent");
+  dash::mpd::IContentComponent *component = set->GetContentComponent ()[0];
+  NS_TEST_ASSERT_MSG_EQ (component->GetContentType (), "video", "ContentComponent contentType");
+  NS_TEST_ASSERT_MSG_EQ (component->GetAccessibility ().size (), 1, "One Accessibility");
+  node = FindNode (component->GetAccessibility ()[0]->GetAdditionalSubNodes (), "NestedDescriptorElement");
+  NS_TEST_ASSERT_MSG_NE (node, 0, "Descriptor child");
+  NS_TEST_ASSERT_MSG_EQ (node->GetText (), "### Nested DescriptorTestText ###", "Descriptor child text");
+  NS_TEST_ASSERT_MSG_EQ (component->GetRole ().size (), 1, "Empty Role is kept");
+  std::vector<INode *> protection = set->GetContentProtection ()[0]->GetAdditionalSubNodes ();
+  NS_TEST_ASSERT_MSG_EQ (protection.size (), 2, "ContentProtection children");
+  NS_TEST_ASSERT_MSG_EQ (protection[0]->GetName (), "License", "First child");
+  NS_TEST_ASSERT_MSG_EQ (protection[0]->GetText (), "http://MoviesSP.example.com/protect?license=jfjhwlsdkfiowkl", "License text");
+  NS_TEST_ASSERT_MSG_EQ (protection[1]->GetName (), "Content", "Second child");
+  node = FindNode (set->GetSegmentTemplate ()->GetSegmentTimeline ()->GetAdditionalSubNodes (), "SegmentTimelineElementInAdapatationSet");
+  NS_TEST_ASSERT_MSG_NE (node, 0, "SegmentTimeline child");
+  NS_TEST_ASSERT_MSG_EQ (node->HasAttribute ("mySpecialAttr"), true, "Child attribute");
+  NS_TEST_ASSERT_MSG_EQ (node->GetAttributeValue ("mySpecialAttr"), "123", "Child attribute value");
+  NS_TEST_ASSERT_MSG_EQ (node->GetAttributes ().size (), 1, "Child attributes");
+
+  // Representations
+  NS_TEST_ASSERT_MSG_EQ (set->GetRepresentation ().size (), 3, "Three Representations");
+  dash::mpd::IRepresentation *rep = set->GetRepresentation ()[0];
+  NS_TEST_ASSERT_MSG_EQ (rep->GetId (), "v0", "Representation id");
+  NS_TEST_ASSERT_MSG_EQ (rep->GetBandwidth (), 250000, "Representation bandwidth");
+  NS_TEST_ASSERT_MSG_EQ (rep->GetWidth (), 320, "Representation width");
+  NS_TEST_ASSERT_MSG_EQ (rep->GetBaseURLs ()[0]->GetUrl (), "folderForRep/", "Representation BaseURL");
+  NS_TEST_ASSERT_MSG_EQ (rep->GetSubRepresentations ().size (), 1, "One SubRepresentation");
+  NS_TEST_ASSERT_MSG_EQ (FindNode (rep->GetAdditionalSubNodes (), "RepresentationElement")->GetText (), "### RepresentationTestText ###", "Representation child text");
+  NS_TEST_ASSERT_MSG_EQ (set->GetRepresentation ()[2]->GetId (), "v2", "Last Representation id");
+  NS_TEST_ASSERT_MSG_EQ (set->GetRepresentation ()[2]->GetHeight (), 720, "Last Representation height");
+
+  // Metrics
+  NS_TEST_ASSERT_MSG_EQ (mpd->GetMetrics ().size (), 1, "One Metrics");
+  NS_TEST_ASSERT_MSG_EQ (mpd->GetMetrics ()[0]->GetReportings ()[0]->GetValue (), "bla", "Reporting value");
+  NS_TEST_ASSERT_MSG_EQ (FindNode (mpd->GetMetrics ()[0]->GetAdditionalSubNodes (), "MetricsElement")->GetText (), "### Metrics TestText ###", "Metrics child text");
+
+  // The file gives the same tree
+  IMPD *fromFile = manager->Open ((char *) path.c_str ());
+  NS_TEST_ASSERT_MSG_NE (fromFile, 0, "Sample MPD file is parsed");
+  dash::mpd::IAdaptationSet *fileSet = fromFile->GetPeriods ()[0]->GetAdaptationSets ()[0];
+  NS_TEST_ASSERT_MSG_EQ (fileSet->GetRepresentation ().size (), set->GetRepresentation ().size (), "Same Representations");
+  NS_TEST_ASSERT_MSG_EQ (fileSet->GetRepresentation ()[1]->GetBandwidth (), set->GetRepresentation ()[1]->GetBandwidth (), "Same bandwidth");
+  NS_TEST_ASSERT_MSG_EQ (fromFile->GetAdditionalSubNodes ().size (), mpd->GetAdditionalSubNodes ().size (), "Same MPD children");
+  NS_TEST_ASSERT_MSG_EQ (fromFile->GetRawAttributes ().size (), mpd->GetRawAttributes ().size (), "Same MPD attributes");
+
+  delete fromFile;
+  delete mpd;
+  manager->Delete ();
+}
+
+/**
+ * Documents that are not well formed, or not an MPD, give no tree.
+ */
+class DashMpdParserMalformedTestCase : public TestCase
+{
+public:
+  DashMpdParserMalformedTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DashMpdParserMalformedTestCase::DashMpdParserMalformedTestCase ()
+  : TestCase ("Malformed MPDs are rejected")
+{
+}
+
+void
+DashMpdParserMalformedTestCase::DoRun (void)
+{
+  const char *documents[] = {
+    "",
+    "<?xml version=\"1.0\"?>\n<MPD type=\"static\"><Period><AdaptationSet>",
+    "<?xml version=\"1.0\"?>\n<MPD type=\"static\"><Period></AdaptationSet></MPD>",
+    "<?xml version=\"1.0\"?>\n<MPD type=\"static><Period/></MPD>",
+    "not xml at all",
+    "<?xml version=\"1.0\"?>\n<html><body/></html>",
+  };
+  dash::IDASHManager *manager = CreateDashManager ();
+  for (size_t i = 0; i < sizeof (documents) / sizeof (documents[0]); i++)
+    {
+      std::string xml = documents[i];
+      IMPD *mpd = manager->Open (xml.data (), xml.size (), "http://10.0.0.2/content/mpds/bad.mpd");
+      NS_TEST_ASSERT_MSG_EQ (mpd, 0, "Document " << i << " is rejected");
+    }
+
+  // The parser is usable again after a failure
+  std::string xml = "<?xml version=\"1.0\"?>\n<MPD type=\"static\"><Period><AdaptationSet>"
+    "<Representation id=\"r\" bandwidth=\"1000\"/></AdaptationSet></Period></MPD>";
+  IMPD *mpd = manager->Open (xml.data (), xml.size (), "http://10.0.0.2/content/mpds/good.mpd");
+  NS_TEST_ASSERT_MSG_NE (mpd, 0, "Well formed MPD after the failures");
+  NS_TEST_ASSERT_MSG_EQ (mpd->GetPeriods ()[0]->GetAdaptationSets ()[0]->GetRepresentation ()[0]->GetBandwidth (), 1000, "Bandwidth");
+  delete mpd;
+  manager->Delete ();
+}
+
+static class DashMpdParserTestSuite : public TestSuite
+{
+public:
+  DashMpdParserTestSuite ()
+    : TestSuite ("dash-mpd-parser", UNIT)
+  {
+    SetDataDir (NS_TEST_SOURCEDIR);
+    AddTestCase (new DashMpdParserSampleTestCase, TestCase::QUICK);
+    AddTestCase (new DashMpdParserMalformedTestCase, TestCase::QUICK);
+  }
+} g_dashMpdParserTestSuite;
@@ -0,0 +1,228 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <map>
+#include "ns3/test.h"
+#include "ns3/dash-mpd-cache.h"
+#include "multimediabuffer.h"
+
+using namespace ns3;
+using dash::mpd::IRepresentation;
+using dash::player::MultimediaBuffer;
+
+typedef std::map<std::string, IRepresentation*> Representations;
+
+/**
+ * Representations a (2 s segments, 1000 bit/s), b (4 s, 2000 bit/s) and
+ * the layer c on top of a (2 s, 1500 bit/s).
+ */
+static dash::mpd::IMPD *
+AcquireMpd (Representations &reps)
+{
+  std::string body =
+    "<?xml version=\"1.0\"?>\n"
+    "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" type=\"static\">\n"
+    " <Period><AdaptationSet>\n"
+    "  <Representation id=\"a\" bandwidth=\"1000\">\n"
+    "   <SegmentList duration=\"4\" timescale=\"2\"><SegmentURL media=\"a-0.m4s\"/></SegmentList>\n"
+    "  </Representation>\n"
+    "  <Representation id=\"b\" bandwidth=\"2000\">\n"
+    "   <SegmentList duration=\"4\" timescale=\"1\"><SegmentURL media=\"b-0.m4s\"/></SegmentList>\n"
+    "  </Representation>\n"
+    "  <Representation id=\"c\" bandwidth=\"1500\" dependencyId=\"a\">\n"
+    "   <SegmentList duration=\"4\" timescale=\"2\"><SegmentURL media=\"c-0.m4s\"/></SegmentList>\n"
+    "  </Representation>\n"
+    " </AdaptationSet></Period>\n"
+    "</MPD>\n";
+  dash::mpd::IMPD *mpd = DashMpdCache::Acquire ("http://10.0.0.2/buffer.mpd", body);
+  if (mpd != 0)
+    {
+      std::vector<IRepresentation*> list = mpd->GetPeriods ().at (0)->GetAdaptationSets ().at (0)->GetRepresentation ();
+      for (size_t i = 0; i < list.size (); i++)
+        {
+          reps[list[i]->GetId ()] = list[i];
+        }
+    }
+  return mpd;
+}
+
+/**
+ * Fills a 10 s buffer, consumes from its front while adding at its back
+ * until it ran empty, and starts over from the next segment number.
+ */
+class DashMultimediaBufferRingTestCase : public TestCase
+{
+public:
+  DashMultimediaBufferRingTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DashMultimediaBufferRingTestCase::DashMultimediaBufferRingTestCase ()
+  : TestCase ("MultimediaBuffer add and consume across the front of the buffer")
+{
+}
+
+void
+DashMultimediaBufferRingTestCase::DoRun (void)
+{
+  Representations reps;
+  dash::mpd::IMPD *mpd = AcquireMpd (reps);
+  NS_TEST_ASSERT_MSG_NE (mpd, 0, "MPD is parsed");
+  IRepresentation *a = reps["a"];
+
+  MultimediaBuffer buffer (10);
+  NS_TEST_ASSERT_MSG_EQ (buffer.isEmpty (), true, "Starts empty");
+  for (unsigned int s = 0; s < 5; s++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (buffer.addToBuffer (s, a, 1200), true, "Segment " << s << " fits");
+    }
+  NS_TEST_ASSERT_MSG_EQ_TOL (buffer.getBufferedSeconds (), 10.0, 1e-9, "Five segments of 2 s");
+  NS_TEST_ASSERT_MSG_EQ (buffer.isFull (), false, "Exactly at the limit is not full");
+  NS_TEST_ASSERT_MSG_EQ (buffer.isFull (2.0), true, "No room for another segment");
+  NS_TEST_ASSERT_MSG_EQ (buffer.enoughSpaceInTotalBuffer (5, a), false, "No room for another segment");
+  NS_TEST_ASSERT_MSG_EQ (buffer.addToBuffer (5, a, 1200), false, "Full buffer rejects a segment");
+  NS_TEST_ASSERT_MSG_EQ (buffer.addToBuffer (7, a, 1200), false, "Segment beyond the next one to buffer");
+
+  MultimediaBuffer::BufferRepresentationEntry entry = buffer.consumeFromBuffer ();
+  NS_TEST_ASSERT_MSG_EQ (entry.segmentNumber, 0, "Oldest segment first");
+  NS_TEST_ASSERT_MSG_EQ (entry.repId, "a", "Representation of the segment");
+  NS_TEST_ASSERT_MSG_EQ (entry.bitrate_bit_s, 1000, "Advertised bitrate");
+  NS_TEST_ASSERT_MSG_EQ (entry.experienced_bitrate_bit_s, 1200, "Experienced bitrate");
+  NS_TEST_ASSERT_MSG_EQ_TOL (buffer.getBufferedSeconds (), 8.0, 1e-9, "Consumed segment left");
+  NS_TEST_ASSERT_MSG_EQ (buffer.nextSegmentNrToBeConsumed (), 1, "Next segment to consume");
+
+  // The front moves while segments are added at the back
+  for (unsigned int s = 5; s < 25; s++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (buffer.addToBuffer (s, a, 1200), true, "Segment " << s << " fits again");
+      NS_TEST_ASSERT_MSG_EQ (buffer.getHighestBufferedSegmentNr ("a"), s, "Highest buffered");
+      entry = buffer.consumeFromBuffer ();
+      NS_TEST_ASSERT_MSG_EQ (entry.segmentNumber, s - 4, "Segments come out in order");
+      NS_TEST_ASSERT_MSG_EQ_TOL (buffer.getBufferedSeconds (), 8.0, 1e-9, "Level stays");
+      NS_TEST_ASSERT_MSG_EQ_TOL (buffer.getBufferedSeconds ("a"), 8.0, 1e-9, "Level of a stays");
+    }
+
+  for (unsigned int s = 21; s < 25; s++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (buffer.consumeFromBuffer ().segmentNumber, s, "Drained in order");
+    }
+  NS_TEST_ASSERT_MSG_EQ (buffer.isEmpty (), true, "Drained");
+  NS_TEST_ASSERT_MSG_EQ (buffer.getBufferedSeconds (), 0.0, "Level reset when empty");
+  NS_TEST_ASSERT_MSG_EQ (buffer.getBufferedSeconds ("a"), 0.0, "Level of a reset when empty");
+  NS_TEST_ASSERT_MSG_EQ (buffer.getHighestBufferedSegmentNr ("a"), 0, "Nothing of a buffered");
+  NS_TEST_ASSERT_MSG_EQ (buffer.consumeFromBuffer ().repId, "InvalidSegment", "Nothing to consume");
+  NS_TEST_ASSERT_MSG_EQ (buffer.nextSegmentNrToBeConsumed (), 25, "An empty buffer does not advance");
+
+  // Starting over from an empty buffer
+  NS_TEST_ASSERT_MSG_EQ (buffer.addToBuffer (25, a, 1200), true, "Segment after the drain");
+  NS_TEST_ASSERT_MSG_EQ (buffer.consumeFromBuffer ().segmentNumber, 25, "Consumed after the drain");
+  NS_TEST_ASSERT_MSG_EQ (buffer.isEmpty (), true, "Drained again");
+
+  DashMpdCache::Release (mpd);
+}
+
+/**
+ * Segments of two representations and a layer: the total level follows
+ * the first representation by id of every segment, each representation
+ * keeps its own level and highest segment, and the entry consumed is the
+ * one with most dependencies.
+ */
+class DashMultimediaBufferRepresentationTestCase : public TestCase
+{
+public:
+  DashMultimediaBufferRepresentationTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DashMultimediaBufferRepresentationTestCase::DashMultimediaBufferRepresentationTestCase ()
+  : TestCase ("MultimediaBuffer per-representation bookkeeping")
+{
+}
+
+void
+DashMultimediaBufferRepresentationTestCase::DoRun (void)
+{
+  Representations reps;
+  dash::mpd::IMPD *mpd = AcquireMpd (reps);
+  NS_TEST_ASSERT_MSG_NE (mpd, 0, "MPD is parsed");
+  IRepresentation *a = reps["a"];
+  IRepresentation *b = reps["b"];
+  IRepresentation *c = reps["c"];
+
+  MultimediaBuffer buffer (100);
+  NS_TEST_ASSERT_MSG_EQ (buffer.addToBuffer (0, b, 2000), true, "b of segment 0");
+  NS_TEST_ASSERT_MSG_EQ_TOL (buffer.getBufferedSeconds (), 4.0, 1e-9, "Segment 0 is b");
+  NS_TEST_ASSERT_MSG_EQ (buffer.addToBuffer (0, a, 1000), true, "a of segment 0");
+  NS_TEST_ASSERT_MSG_EQ_TOL (buffer.getBufferedSeconds (), 2.0, 1e-9, "a comes before b and now defines segment 0");
+  NS_TEST_ASSERT_MSG_EQ (buffer.addToBuffer (1, b, 2000), true, "b of segment 1");
+  NS_TEST_ASSERT_MSG_EQ (buffer.addToBuffer (1, c, 1500), false, "Layer c needs a in segment 1");
+  NS_TEST_ASSERT_MSG_EQ (buffer.addToBuffer (0, c, 1500), true, "Layer c on a in segment 0");
+  NS_TEST_ASSERT_MSG_EQ (buffer.addToBuffer (0, a, 800), true, "a of segment 0 again");
+
+  NS_TEST_ASSERT_MSG_EQ_TOL (buffer.getBufferedSeconds (), 6.0, 1e-9, "a of segment 0 and b of segment 1");
+  NS_TEST_ASSERT_MSG_EQ_TOL (buffer.getBufferedSeconds ("a"), 2.0, 1e-9, "A segment is counted once per representation");
+  NS_TEST_ASSERT_MSG_EQ_TOL (buffer.getBufferedSeconds ("b"), 8.0, 1e-9, "b of both segments");
+  NS_TEST_ASSERT_MSG_EQ_TOL (buffer.getBufferedSeconds ("c"), 2.0, 1e-9, "The layer");
+  NS_TEST_ASSERT_MSG_EQ (buffer.getBufferedSeconds ("x"), 0.0, "Unknown representation");
+  NS_TEST_ASSERT_MSG_EQ_TOL (buffer.getBufferedPercentage (), 0.06, 1e-9, "Total percentage");
+  NS_TEST_ASSERT_MSG_EQ_TOL (buffer.getBufferedPercentage ("b"), 0.08, 1e-9, "Percentage of b");
+  NS_TEST_ASSERT_MSG_EQ (buffer.getHighestBufferedSegmentNr ("a"), 0, "Highest a");
+  NS_TEST_ASSERT_MSG_EQ (buffer.getHighestBufferedSegmentNr ("b"), 1, "Highest b");
+  NS_TEST_ASSERT_MSG_EQ (buffer.getHighestBufferedSegmentNr ("x"), 0, "Unknown representation");
+  NS_TEST_ASSERT_MSG_EQ (buffer.isFull ("b", 92.0), false, "b has room for 92 s");
+  NS_TEST_ASSERT_MSG_EQ (buffer.isFull ("b", 93.0), true, "b has no room for 93 s");
+  NS_TEST_ASSERT_MSG_EQ (buffer.enoughSpaceInLayeredBuffer (2, c), true, "Room for c");
+
+  MultimediaBuffer::BufferRepresentationEntry entry = buffer.consumeFromBuffer ();
+  NS_TEST_ASSERT_MSG_EQ (entry.segmentNumber, 0, "Segment 0");
+  NS_TEST_ASSERT_MSG_EQ (entry.repId, "c", "The layer with most dependencies is played");
+  NS_TEST_ASSERT_MSG_EQ (entry.depIds.size (), 1, "Dependencies of c");
+  NS_TEST_ASSERT_MSG_EQ_TOL (buffer.getBufferedSeconds (), 4.0, 1e-9, "b defines segment 1");
+  NS_TEST_ASSERT_MSG_EQ (buffer.getBufferedSeconds ("a"), 0.0, "All of a consumed");
+  NS_TEST_ASSERT_MSG_EQ (buffer.getBufferedSeconds ("c"), 0.0, "All of c consumed");
+  NS_TEST_ASSERT_MSG_EQ_TOL (buffer.getBufferedSeconds ("b"), 4.0, 1e-9, "b of segment 0 went with it");
+  NS_TEST_ASSERT_MSG_EQ (buffer.getHighestBufferedSegmentNr ("b"), 1, "b of segment 1 left");
+
+  NS_TEST_ASSERT_MSG_EQ (buffer.addToBuffer (2, a, 1000), true, "a of segment 2");
+  NS_TEST_ASSERT_MSG_EQ (buffer.getHighestBufferedSegmentNr ("a"), 2, "Highest a again");
+  NS_TEST_ASSERT_MSG_EQ_TOL (buffer.getBufferedSeconds (), 6.0, 1e-9, "Segments 1 and 2");
+
+  entry = buffer.consumeFromBuffer ();
+  NS_TEST_ASSERT_MSG_EQ (entry.repId, "b", "Segment 1 is b only");
+  NS_TEST_ASSERT_MSG_EQ (buffer.getHighestBufferedSegmentNr ("b"), 0, "Nothing of b buffered");
+  NS_TEST_ASSERT_MSG_EQ_TOL (buffer.getBufferedSeconds (), 2.0, 1e-9, "Segment 2");
+  entry = buffer.consumeFromBuffer ();
+  NS_TEST_ASSERT_MSG_EQ (entry.segmentNumber, 2, "Segment 2");
+  NS_TEST_ASSERT_MSG_EQ (buffer.isEmpty (), true, "Drained");
+
+  DashMpdCache::Release (mpd);
+}
+
+static class DashMultimediaBufferTestSuite : public TestSuite
+{
+public:
+  DashMultimediaBufferTestSuite ()
+    : TestSuite ("dash-multimedia-buffer", UNIT)
+  {
+    AddTestCase (new DashMultimediaBufferRingTestCase, TestCase::QUICK);
+    AddTestCase (new DashMultimediaBufferRepresentationTestCase, TestCase::QUICK);
+  }
+} g_dashMultimediaBufferTestSuite;
@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <sstream>
+#include "ns3/test.h"
+#include "ns3/dash-mpd-cache.h"
+#include "representation-ladder.h"
+
+using namespace ns3;
+using dash::player::RepresentationLadder;
+using dash::player::RepresentationsMap;
+
+/**
+ * Compares the ladder lookups with the scans over the representations
+ * map that the adaptation logics used to do, including representations of
+ * equal and of zero bandwidth, and checks that players of the same
+ * representations share one ladder.
+ */
+class DashRepresentationLadderTestCase : public TestCase
+{
+public:
+  DashRepresentationLadderTestCase ();
+
+private:
+  virtual void DoRun (void);
+  IRepresentation* ScanHighestBelow (double bitrate);
+  IRepresentation* ScanLowestBetween (double low, double high);
+
+  RepresentationsMap m_reps;
+};
+
+DashRepresentationLadderTestCase::DashRepresentationLadderTestCase ()
+  : TestCase ("Representation ladder lookups")
+{
+}
+
+IRepresentation*
+DashRepresentationLadderTestCase::ScanHighestBelow (double bitrate)
+{
+  IRepresentation *useRep = NULL;
+  double highest_bitrate = 0.0;
+  for (RepresentationsMap::iterator it = m_reps.begin (); it != m_reps.end (); it++)
+    {
+      if (it->second->GetBandwidth () < bitrate && it->second->GetBandwidth () > highest_bitrate)
+        {
+          useRep = it->second;
+          highest_bitrate = it->second->GetBandwidth ();
+        }
+    }
+  return useRep;
+}
+
+IRepresentation*
+DashRepresentationLadderTestCase::ScanLowestBetween (double low, double high)
+{
+  IRepresentation *useRep = NULL;
+  double lowest_bitrate = high;
+  for (RepresentationsMap::iterator it = m_reps.begin (); it != m_reps.end (); it++)
+    {
+      if (it->second->GetBandwidth () > low && it->second->GetBandwidth () < lowest_bitrate)
+        {
+          useRep = it->second;
+          lowest_bitrate = it->second->GetBandwidth ();
+        }
+    }
+  return useRep;
+}
+
+void
+DashRepresentationLadderTestCase::DoRun (void)
+{
+  // ids deliberately not in bandwidth order
+  const char *ids[] = { "a", "b", "c", "d", "e", "f", "g" };
+  uint32_t bandwidths[] = { 3000, 1000, 0, 3000, 500, 8000, 1000 };
+
+  std::ostringstream body;
+  body << "<?xml version=\"1.0\"?>\n"
+       << "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" type=\"static\">\n"
+       << " <Period><AdaptationSet>\n";
+  for (int i = 0; i < 7; i++)
+    {
+      body << "  <Representation id=\"" << ids[i] << "\" bandwidth=\"" << bandwidths[i] << "\">\n"
+           << "   <SegmentList duration=\"4\" timescale=\"2\">\n";
+      for (int s = 0; s < 3; s++)
+        {
+          body << "    <SegmentURL media=\"" << ids[i] << "-" << s << ".m4s\"/>\n";
+        }
+      body << "   </SegmentList>\n"
+           << "  </Representation>\n";
+    }
+  body << " </AdaptationSet></Period>\n"
+       << "</MPD>\n";
+
+  dash::mpd::IMPD *mpd = DashMpdCache::Acquire ("http://10.0.0.2/ladder.mpd", body.str ());
+  NS_TEST_ASSERT_MSG_NE (mpd, 0, "MPD is parsed");
+  std::vector<IRepresentation*> reps = mpd->GetPeriods ().at (0)->GetAdaptationSets ().at (0)->GetRepresentation ();
+  for (size_t i = 0; i < reps.size (); i++)
+    {
+      m_reps[reps[i]->GetId ()] = reps[i];
+    }
+
+  RepresentationLadder *ladder = RepresentationLadder::Acquire (&m_reps);
+  NS_TEST_ASSERT_MSG_EQ (ladder->GetSize (), 7, "Every representation is on the ladder");
+  NS_TEST_ASSERT_MSG_EQ (ladder->GetFirst ()->rep, m_reps.begin ()->second, "First is the smallest id");
+  NS_TEST_ASSERT_MSG_EQ (ladder->GetTotalSegments (), 3, "Segments of the first representation");
+  NS_TEST_ASSERT_MSG_EQ_TOL (ladder->GetFirst ()->segmentDuration, 2.0, 1e-9, "Duration in seconds");
+
+  for (double bitrate = 0; bitrate < 10000; bitrate += 250)
+    {
+      const RepresentationLadder::Step *step = ladder->GetHighestBelow (bitrate);
+      NS_TEST_ASSERT_MSG_EQ ((step ? step->rep : NULL), ScanHighestBelow (bitrate),
+                             "Highest below " << bitrate);
+      step = ladder->GetLowestBetween (bitrate, 6000);
+      NS_TEST_ASSERT_MSG_EQ ((step ? step->rep : NULL), ScanLowestBetween (bitrate, 6000),
+                             "Lowest above " << bitrate);
+    }
+
+  const RepresentationLadder::Step *step = ladder->Find (m_reps["f"]);
+  NS_TEST_ASSERT_MSG_EQ (step->bandwidth, 8000, "Found by representation");
+  NS_TEST_ASSERT_MSG_EQ (ladder->GetSegmentURL (step, 2)->GetMediaURI (), "f-2.m4s", "Segment URL by number");
+
+  RepresentationLadder *other = RepresentationLadder::Acquire (&m_reps);
+  NS_TEST_ASSERT_MSG_EQ (other, ladder, "Same representations, same ladder");
+  m_reps.erase ("f");
+  RepresentationLadder *smaller = RepresentationLadder::Acquire (&m_reps);
+  NS_TEST_ASSERT_MSG_NE (smaller, ladder, "Other representations, own ladder");
+  NS_TEST_ASSERT_MSG_EQ (RepresentationLadder::GetNLadders (), 2, "Two distinct ladders");
+
+  RepresentationLadder::Release (smaller);
+  RepresentationLadder::Release (other);
+  NS_TEST_ASSERT_MSG_EQ (RepresentationLadder::GetNLadders (), 1, "Ladder still in use");
+  RepresentationLadder::Release (ladder);
+  NS_TEST_ASSERT_MSG_EQ (RepresentationLadder::GetNLadders (), 0, "Ladders go away with their last user");
+  DashMpdCache::Release (mpd);
+}
+
+static class DashRepresentationLadderTestSuite : public TestSuite
+{
+public:
+  DashRepresentationLadderTestSuite ()
+    : TestSuite ("dash-representation-ladder", UNIT)
+  {
+    AddTestCase (new DashRepresentationLadderTestCase, TestCase::QUICK);
+  }
+} g_dashRepresentationLadderTestSuite;
@@ -0,0 +1,94 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "throughput-estimator.h"
+#include "multimedia-player.h"
+
+using namespace ns3;
+using namespace dash::player;
+
+/**
+ * Feeds the estimators a few downloads with known bitrates and checks
+ * their estimates by hand, and that a player without an estimator still
+ * reports the last download bitrate.
+ */
+class DashThroughputEstimatorTestCase : public TestCase
+{
+public:
+  DashThroughputEstimatorTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DashThroughputEstimatorTestCase::DashThroughputEstimatorTestCase ()
+  : TestCase ("Throughput estimators")
+{
+}
+
+void
+DashThroughputEstimatorTestCase::DoRun (void)
+{
+  // 1 Mbit/s for 2 s, then 4 Mbit/s for 1 s, finishing at 2 s and 3 s
+  EwmaThroughputEstimator ewma (0.25);
+  NS_TEST_ASSERT_MSG_EQ (ewma.GetEstimate (), 0.0, "No estimate without samples");
+  ewma.AddSample (250000, 2.0, 2.0);
+  NS_TEST_ASSERT_MSG_EQ_TOL (ewma.GetEstimate (), 1e6, 1e-3, "First sample is the estimate");
+  ewma.AddSample (500000, 1.0, 3.0);
+  NS_TEST_ASSERT_MSG_EQ_TOL (ewma.GetEstimate (), 0.25 * 4e6 + 0.75 * 1e6, 1e-3, "Weighted average");
+  ewma.AddSample (100, 0.0, 3.0);
+  NS_TEST_ASSERT_MSG_EQ_TOL (ewma.GetEstimate (), 1.75e6, 1e-3, "Downloads without duration are skipped");
+  ewma.Reset ();
+  NS_TEST_ASSERT_MSG_EQ (ewma.GetEstimate (), 0.0, "Reset forgets the samples");
+
+  HarmonicMeanThroughputEstimator harmonic (2);
+  harmonic.AddSample (250000, 2.0, 2.0);
+  harmonic.AddSample (500000, 1.0, 3.0);
+  NS_TEST_ASSERT_MSG_EQ_TOL (harmonic.GetEstimate (), 2.0 / (1 / 1e6 + 1 / 4e6), 1e-3, "Harmonic mean");
+  harmonic.AddSample (500000, 2.0, 5.0);
+  NS_TEST_ASSERT_MSG_EQ_TOL (harmonic.GetEstimate (), 2.0 / (1 / 4e6 + 1 / 2e6), 1e-3, "Only the last samples count");
+
+  SlidingWindowThroughputEstimator window (2.0);
+  window.AddSample (250000, 2.0, 2.0);
+  window.AddSample (500000, 1.0, 3.0);
+  // window [1, 3]: half of the first download and all of the second
+  NS_TEST_ASSERT_MSG_EQ_TOL (window.GetEstimate (), (125000 + 500000) * 8 / 2.0, 1e-3, "Bytes over time in the window");
+  window.AddSample (250000, 1.0, 10.0);
+  // window [8, 10]: idle time does not count
+  NS_TEST_ASSERT_MSG_EQ_TOL (window.GetEstimate (), 2e6, 1e-3, "Only download time counts");
+
+  MultimediaPlayer player ("dash::player::AlwaysLowestAdaptationLogic", 30);
+  player.SetLastDownloadBitRate (3e6);
+  player.AddDownloadSample (250000, 2.0, 2.0);
+  NS_TEST_ASSERT_MSG_EQ_TOL (player.GetThroughputEstimate (), 3e6, 1e-3, "Without estimator, the last bitrate");
+  player.SetThroughputEstimator (new EwmaThroughputEstimator (0.5));
+  player.AddDownloadSample (250000, 2.0, 2.0);
+  NS_TEST_ASSERT_MSG_EQ_TOL (player.GetThroughputEstimate (), 1e6, 1e-3, "With estimator, its estimate");
+  player.ResetThroughputEstimate ();
+  NS_TEST_ASSERT_MSG_EQ (player.GetThroughputEstimate (), 0.0, "Reset through the player");
+}
+
+static class DashThroughputEstimatorTestSuite : public TestSuite
+{
+public:
+  DashThroughputEstimatorTestSuite ()
+    : TestSuite ("dash-throughput-estimator", UNIT)
+  {
+    AddTestCase (new DashThroughputEstimatorTestCase, TestCase::QUICK);
+  }
+} g_dashThroughputEstimatorTestSuite;
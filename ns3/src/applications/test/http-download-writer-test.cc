@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <stdio.h>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include "ns3/test.h"
+#include "ns3/hash.h"
+#include "ns3/http-download-writer.h"
+
+using namespace ns3;
+
+/**
+ * Writes the same body in many small pieces in every mode and checks the
+ * file contents, the byte count and that the checksum matches a one-shot
+ * hash of the body.
+ */
+class HttpDownloadWriterTestCase : public TestCase
+{
+public:
+  HttpDownloadWriterTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void WriteBody (HttpDownloadWriter &writer);
+
+  std::string m_body;
+};
+
+HttpDownloadWriterTestCase::HttpDownloadWriterTestCase ()
+  : TestCase ("HTTP download writer modes")
+{
+  for (uint32_t i = 0; i < 100000; i++)
+    {
+      m_body.push_back ((char)(i * 7 + i / 13));
+    }
+}
+
+void
+HttpDownloadWriterTestCase::WriteBody (HttpDownloadWriter &writer)
+{
+  size_t offset = 0;
+  size_t piece = 1;
+  while (offset < m_body.size ())
+    {
+      size_t length = std::min (piece, m_body.size () - offset);
+      writer.Write ((const uint8_t*)m_body.data () + offset, length);
+      offset += length;
+      piece = piece % 1500 + 7;
+    }
+}
+
+void
+HttpDownloadWriterTestCase::DoRun (void)
+{
+  HttpDownloadWriter writer;
+  std::string file = CreateTempDirFilename ("http-download.out");
+
+  // Twice, so the second download has to truncate the first one
+  for (int i = 0; i < 2; i++)
+    {
+      writer.Open (HttpDownloadWriter::TO_FILE, file);
+      NS_TEST_ASSERT_MSG_EQ (writer.NeedsData (), true, "Writing to a file needs the bytes");
+      WriteBody (writer);
+      writer.Close ();
+      std::ifstream in (file.c_str (), std::ios::binary);
+      std::string contents ((std::istreambuf_iterator<char> (in)), std::istreambuf_iterator<char> ());
+      NS_TEST_ASSERT_MSG_EQ ((contents == m_body), true, "File holds exactly the body");
+    }
+  remove (file.c_str ());
+
+  writer.Open (HttpDownloadWriter::TO_FILE, "");
+  NS_TEST_ASSERT_MSG_EQ (writer.NeedsData (), false, "No outfile, nothing to write");
+
+  writer.Open (HttpDownloadWriter::CHECKSUM, file);
+  NS_TEST_ASSERT_MSG_EQ (writer.NeedsData (), true, "Checksum needs the bytes");
+  WriteBody (writer);
+  writer.Close ();
+  Hasher hasher (Create<Hash::Function::Fnv1a> ());
+  NS_TEST_ASSERT_MSG_EQ (writer.GetChecksum (), hasher.GetHash32 (m_body), "Checksum does not depend on the pieces");
+  NS_TEST_ASSERT_MSG_EQ (writer.GetBytes (), m_body.size (), "Checksum counts the bytes");
+  std::ifstream out (file.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (out.is_open (), false, "Checksum does not create the outfile");
+
+  writer.Open (HttpDownloadWriter::TO_MEMORY, file);
+  NS_TEST_ASSERT_MSG_EQ (writer.NeedsData (), true, "Memory needs the bytes");
+  WriteBody (writer);
+  writer.Close ();
+  NS_TEST_ASSERT_MSG_EQ ((writer.GetData () == m_body), true, "Memory holds exactly the body");
+
+  writer.Open (HttpDownloadWriter::DISCARD, file);
+  NS_TEST_ASSERT_MSG_EQ (writer.NeedsData (), false, "Discard only counts");
+  WriteBody (writer);
+  writer.Close ();
+  NS_TEST_ASSERT_MSG_EQ (writer.GetBytes (), m_body.size (), "Discard counts the bytes");
+}
+
+static class HttpDownloadWriterTestSuite : public TestSuite
+{
+public:
+  HttpDownloadWriterTestSuite ()
+    : TestSuite ("http-download-writer", UNIT)
+  {
+    AddTestCase (new HttpDownloadWriterTestCase, TestCase::QUICK);
+  }
+} g_httpDownloadWriterTestSuite;
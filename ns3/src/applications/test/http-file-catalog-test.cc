@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <stdio.h>
+#include <fstream>
+#include "ns3/test.h"
+#include "ns3/http-file-catalog.h"
+
+using namespace ns3;
+
+/**
+ * Virtual and in-memory files are found with their size, files on disk are
+ * found once they exist and then remembered, anything else is missing.
+ */
+class HttpFileCatalogTestCase : public TestCase
+{
+public:
+  HttpFileCatalogTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+HttpFileCatalogTestCase::HttpFileCatalogTestCase ()
+  : TestCase ("Files served by an HTTP server")
+{
+}
+
+void
+HttpFileCatalogTestCase::DoRun (void)
+{
+  HttpFileCatalog catalog;
+
+  catalog.AddVirtualFile ("/content/vid1/repr_1_seg_0.264", 60160);
+  catalog.AddMemoryFile ("/content/mpds/vid1.mpd.gz", std::string ("mpd\0data", 8));
+
+  const HttpFileCatalog::Entry *file = catalog.Find ("/content/vid1/repr_1_seg_0.264");
+  NS_TEST_ASSERT_MSG_NE (file, 0, "Virtual file is found");
+  NS_TEST_EXPECT_MSG_EQ (file->source, HttpFileCatalog::VIRTUAL, "Body is generated");
+  NS_TEST_EXPECT_MSG_EQ (file->size, 60160, "Size of the virtual file");
+
+  file = catalog.Find ("/content/mpds/vid1.mpd.gz");
+  NS_TEST_ASSERT_MSG_NE (file, 0, "In-memory file is found");
+  NS_TEST_EXPECT_MSG_EQ (file->source, HttpFileCatalog::MEMORY, "Body is held in memory");
+  NS_TEST_EXPECT_MSG_EQ (file->size, 8, "Size includes the embedded NUL");
+  NS_TEST_EXPECT_MSG_EQ (file->content, std::string ("mpd\0data", 8), "Body of the in-memory file");
+
+  std::string path = CreateTempDirFilename ("http-file-catalog");
+  NS_TEST_EXPECT_MSG_EQ (catalog.Find (path), 0, "File not yet on disk");
+  std::ofstream out (path.c_str (), std::ios::binary);
+  out << std::string (1234, 'x');
+  out.close ();
+
+  file = catalog.Find (path);
+  NS_TEST_ASSERT_MSG_NE (file, 0, "File on disk is found");
+  NS_TEST_EXPECT_MSG_EQ (file->source, HttpFileCatalog::DISK, "Body is read from disk");
+  NS_TEST_EXPECT_MSG_EQ (file->size, 1234, "Size of the file on disk");
+  remove (path.c_str ());
+  NS_TEST_EXPECT_MSG_EQ (catalog.Find (path), file, "File on disk is remembered");
+  NS_TEST_EXPECT_MSG_EQ (catalog.GetNFiles (), 3, "Two added files and one from disk");
+
+  catalog.AddVirtualFile ("/content/vid1/repr_1_seg_0.264", 1000);
+  NS_TEST_EXPECT_MSG_EQ (catalog.Find ("/content/vid1/repr_1_seg_0.264")->size, 1000, "Adding a file again replaces it");
+  NS_TEST_EXPECT_MSG_EQ (catalog.GetNFiles (), 3, "Replaced, not added");
+
+  catalog.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (catalog.Find ("/content/mpds/vid1.mpd.gz"), 0, "Cleared catalog is empty");
+}
+
+static class HttpFileCatalogTestSuite : public TestSuite
+{
+public:
+  HttpFileCatalogTestSuite ()
+    : TestSuite ("http-file-catalog", UNIT)
+  {
+    AddTestCase (new HttpFileCatalogTestCase, TestCase::QUICK);
+  }
+} g_httpFileCatalogTestSuite;
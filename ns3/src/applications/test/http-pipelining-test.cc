@@ -0,0 +1,193 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <stdio.h>
+#include <fstream>
+#include "ns3/test.h"
+#include "ns3/hash.h"
+#include "ns3/config.h"
+#include "ns3/enum.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/http-helper.h"
+#include "ns3/http-client.h"
+
+using namespace ns3;
+
+/**
+ * Client that pipelines more requests right behind its first one and keeps
+ * the name and checksum of every download.
+ */
+class PipeliningClient : public HttpClientApplication
+{
+public:
+  PipeliningClient ()
+    : m_pipelineFull (false),
+      m_started (false)
+  {
+  }
+
+  std::vector<std::string> m_pipelined;
+  std::vector<std::string> m_received;
+  std::vector<uint32_t> m_checksums;
+  bool m_pipelineFull;
+
+  void OnDownloadStarted (Ptr<Application> app, std::string fileToRequest)
+  {
+    // right behind the first request
+    if (!m_started)
+      {
+        m_started = true;
+        Simulator::ScheduleNow (&PipeliningClient::PipelineAll, this);
+      }
+  }
+
+private:
+  bool m_started;
+
+  void PipelineAll (void)
+  {
+    for (size_t i = 0; i < m_pipelined.size (); i++)
+      {
+        PipelineRequest (m_pipelined[i]);
+      }
+    m_pipelineFull = !CanPipelineRequest ();
+  }
+
+protected:
+  virtual void OnFileReceived (unsigned status, unsigned length)
+  {
+    HttpClientApplication::OnFileReceived (status, length);
+    m_received.push_back (m_fileToRequest);
+    m_checksums.push_back (GetLastDownloadChecksum ());
+  }
+};
+
+/**
+ * Downloads three files over one keep-alive MPTCP connection, the last two
+ * requested before the first response has arrived, so that the responses
+ * follow each other back to back, and checks that every file arrives
+ * complete and in order.
+ */
+class HttpPipeliningTestCase : public TestCase
+{
+public:
+  HttpPipeliningTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+HttpPipeliningTestCase::HttpPipeliningTestCase ()
+  : TestCase ("Pipelined requests on a keep-alive connection")
+{
+}
+
+void
+HttpPipeliningTestCase::DoRun (void)
+{
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (MpTcpSocketBase::GetTypeId ()));
+
+  // the server looks the requested names up in the temp dir, whose path
+  // may contain spaces
+  std::string contentDir = CreateTempDirFilename ("");
+  contentDir.resize (contentDir.size () - 1);
+
+  const char *names[] = { "/http-pipelining-a", "/http-pipelining-b", "/http-pipelining-c" };
+  uint32_t sizes[] = { 200000, 1000, 50000 };
+  std::vector<std::string> files;
+  std::vector<uint32_t> checksums;
+  for (int i = 0; i < 3; i++)
+    {
+      std::string body;
+      for (uint32_t j = 0; j < sizes[i]; j++)
+        {
+          body.push_back ((char)(j * (i + 3) + j / 11));
+        }
+      files.push_back (names[i]);
+      std::ofstream out ((contentDir + names[i]).c_str (), std::ios::binary);
+      out << body;
+      checksums.push_back (Hasher (Create<Hash::Function::Fnv1a> ()).GetHash32 (body));
+    }
+
+  NodeContainer n;
+  n.Create (2);
+
+  InternetStackHelper internet;
+  internet.Install (n);
+
+  Ptr<SimpleNetDevice> clientDev = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> serverDev = CreateObject<SimpleNetDevice> ();
+  n.Get (0)->AddDevice (clientDev);
+  n.Get (1)->AddDevice (serverDev);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  clientDev->SetChannel (channel);
+  serverDev->SetChannel (channel);
+  NetDeviceContainer d;
+  d.Add (clientDev);
+  d.Add (serverDev);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer i = ipv4.Assign (d);
+
+  HttpServerHelper server (Ipv4Address::GetAny (), 80, contentDir, "localhost");
+  ApplicationContainer apps = server.Install (n.Get (1));
+  apps.Start (Seconds (0.5));
+
+  Ptr<PipeliningClient> client = CreateObject<PipeliningClient> ();
+  client->SetRemote (i.GetAddress (1), 80);
+  client->SetAttribute ("FileToRequest", StringValue (files[0]));
+  client->SetAttribute ("KeepAlive", BooleanValue (true));
+  client->SetAttribute ("PipelineDepth", UintegerValue (3));
+  client->SetAttribute ("OutfileMode", EnumValue (HttpDownloadWriter::CHECKSUM));
+  client->m_pipelined.push_back (files[1]);
+  client->m_pipelined.push_back (files[2]);
+  client->TraceConnectWithoutContext ("FileDownloadStarted", MakeCallback (&PipeliningClient::OnDownloadStarted, client));
+  n.Get (0)->AddApplication (client);
+  client->SetStartTime (Seconds (1.0));
+
+  Simulator::Stop (Seconds (10.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (client->m_pipelineFull, true, "Two pipelined requests fill a depth of 3");
+  NS_TEST_ASSERT_MSG_EQ (client->m_received.size (), 3, "Every file is received");
+  for (int i = 0; i < 3; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (client->m_received[i], files[i], "Responses in the order of the requests");
+      NS_TEST_EXPECT_MSG_EQ (client->m_checksums[i], checksums[i], "Body of " << files[i]);
+      remove ((contentDir + files[i]).c_str ());
+    }
+
+  Config::Reset ();
+}
+
+static class HttpPipeliningTestSuite : public TestSuite
+{
+public:
+  HttpPipeliningTestSuite ()
+    : TestSuite ("http-pipelining", SYSTEM)
+  {
+    AddTestCase (new HttpPipeliningTestCase, TestCase::QUICK);
+  }
+} g_httpPipeliningTestSuite;
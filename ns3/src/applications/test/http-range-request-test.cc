@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <stdio.h>
+#include <fstream>
+#include "ns3/test.h"
+#include "ns3/hash.h"
+#include "ns3/config.h"
+#include "ns3/enum.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/http-helper.h"
+#include "ns3/http-range-client.h"
+
+using namespace ns3;
+
+/**
+ * Fetches byte ranges of a file one after the other over one keep-alive
+ * MPTCP connection: from the start, up to the end, past the end and behind
+ * the end of the file, and checks status, size and bytes of each. Then
+ * asks for a file the server does not have, which is no range.
+ */
+class HttpRangeRequestTestCase : public TestCase
+{
+public:
+  HttpRangeRequestTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void FetchNext (void);
+  void OnFetched (Ptr<HttpRangeClientApplication> client);
+
+  static const int N_RANGES = 5;
+
+  Ptr<HttpRangeClientApplication> m_client;
+  std::string m_file;
+  int m_next;
+  int m_status[N_RANGES];
+  uint32_t m_bytes[N_RANGES];
+  uint32_t m_checksums[N_RANGES];
+  bool m_gotRange[N_RANGES];
+};
+
+static const int64_t g_ranges[][2] = { { 0, 99999 }, { 100000, -1 }, { 140000, 200000 }, { 150000, 160000 }, { 0, 99 } };
+
+HttpRangeRequestTestCase::HttpRangeRequestTestCase ()
+  : TestCase ("Byte ranges of a file")
+{
+}
+
+void
+HttpRangeRequestTestCase::FetchNext (void)
+{
+  std::string file = (m_next == N_RANGES - 1) ? "/http-range-request-missing" : m_file;
+  m_client->Fetch (file, g_ranges[m_next][0], g_ranges[m_next][1]);
+}
+
+void
+HttpRangeRequestTestCase::OnFetched (Ptr<HttpRangeClientApplication> client)
+{
+  m_status[m_next] = client->GetStatus ();
+  m_bytes[m_next] = client->GetBytes ();
+  m_checksums[m_next] = client->GetLastDownloadChecksum ();
+  m_gotRange[m_next] = client->GotRange ();
+  if (++m_next < N_RANGES)
+    {
+      Simulator::ScheduleNow (&HttpRangeRequestTestCase::FetchNext, this);
+    }
+}
+
+void
+HttpRangeRequestTestCase::DoRun (void)
+{
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (MpTcpSocketBase::GetTypeId ()));
+
+  // the server looks the requested name up in the temp dir, whose path
+  // may contain spaces
+  std::string contentDir = CreateTempDirFilename ("");
+  contentDir.resize (contentDir.size () - 1);
+  m_file = "/http-range-request";
+
+  std::string body;
+  for (uint32_t j = 0; j < 150000; j++)
+    {
+      body.push_back ((char)(j * 7 + j / 13));
+    }
+  std::ofstream out ((contentDir + m_file).c_str (), std::ios::binary);
+  out << body;
+  out.close ();
+
+  NodeContainer n;
+  n.Create (2);
+
+  InternetStackHelper internet;
+  internet.Install (n);
+
+  Ptr<SimpleNetDevice> clientDev = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> serverDev = CreateObject<SimpleNetDevice> ();
+  n.Get (0)->AddDevice (clientDev);
+  n.Get (1)->AddDevice (serverDev);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  clientDev->SetChannel (channel);
+  serverDev->SetChannel (channel);
+  NetDeviceContainer d;
+  d.Add (clientDev);
+  d.Add (serverDev);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer i = ipv4.Assign (d);
+
+  HttpServerHelper server (Ipv4Address::GetAny (), 80, contentDir, "localhost");
+  ApplicationContainer apps = server.Install (n.Get (1));
+  apps.Start (Seconds (0.5));
+
+  // not installed on the node, Fetch starts it
+  m_client = CreateObject<HttpRangeClientApplication> ();
+  m_client->SetNode (n.Get (0));
+  m_client->SetRemote (i.GetAddress (1), 80);
+  m_client->SetAttribute ("KeepAlive", BooleanValue (true));
+  m_client->SetAttribute ("OutfileMode", EnumValue (HttpDownloadWriter::CHECKSUM));
+  m_client->SetFetchedCallback (MakeCallback (&HttpRangeRequestTestCase::OnFetched, this));
+  m_next = 0;
+  Simulator::Schedule (Seconds (1.0), &HttpRangeRequestTestCase::FetchNext, this);
+
+  Simulator::Stop (Seconds (10.0));
+  Simulator::Run ();
+  m_client->Close ();
+  m_client = 0;
+  Simulator::Destroy ();
+  remove ((contentDir + m_file).c_str ());
+
+  NS_TEST_ASSERT_MSG_EQ (m_next, N_RANGES, "Every range is fetched");
+  for (int r = 0; r < 3; r++)
+    {
+      int64_t first = g_ranges[r][0];
+      std::string part = body.substr (first, g_ranges[r][1] < 0 ? std::string::npos : g_ranges[r][1] - first + 1);
+      NS_TEST_EXPECT_MSG_EQ (m_status[r], 206, "Partial content for range " << r);
+      NS_TEST_EXPECT_MSG_EQ (m_gotRange[r], true, "Range " << r << " fetched");
+      NS_TEST_EXPECT_MSG_EQ (m_bytes[r], part.size (), "Size of range " << r);
+      NS_TEST_EXPECT_MSG_EQ (m_checksums[r], Hasher (Create<Hash::Function::Fnv1a> ()).GetHash32 (part),
+                             "Bytes of range " << r);
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_status[3], 416, "Range behind the end of the file");
+  NS_TEST_EXPECT_MSG_EQ (m_bytes[3], 0, "No bytes behind the end of the file");
+  NS_TEST_EXPECT_MSG_EQ (m_gotRange[3], true, "An empty range is no failure");
+  NS_TEST_EXPECT_MSG_EQ (m_status[4], 404, "Missing file");
+  NS_TEST_EXPECT_MSG_EQ (m_gotRange[4], false, "A missing file is a failed range");
+
+  Config::Reset ();
+}
+
+static class HttpRangeRequestTestSuite : public TestSuite
+{
+public:
+  HttpRangeRequestTestSuite ()
+    : TestSuite ("http-range-request", SYSTEM)
+  {
+    AddTestCase (new HttpRangeRequestTestCase, TestCase::QUICK);
+  }
+} g_httpRangeRequestTestSuite;
@@ -27,6 +27,15 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux")
   ;
 
+size_t
+Ipv4EndPointDemux::FourTupleHash::operator() (const FourTuple &t) const
+{
+  uint64_t addresses = ((uint64_t) t.localAddress.Get () << 32) | t.peerAddress.Get ();
+  uint64_t h = addresses * 0x9E3779B97F4A7C15ULL;
+  h ^= (((uint64_t) t.localPort << 16) | t.peerPort) * 0xC2B2AE3D27D4EB4FULL;
+  return (size_t) (h ^ (h >> 29));
+}
+
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
   : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
 {
@@ -42,6 +51,8 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux ()
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_connected.clear ();
+  m_connectedTuple.clear ();
 }
 
 bool
@@ -162,6 +173,7 @@ Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
     {
       if (*i == endPoint)
         {
+          Uncache (endPoint);
           delete endPoint;
           m_endPoints.erase (i);
           break;
@@ -169,6 +181,29 @@ Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
     }
 }
 
+bool
+Ipv4EndPointDemux::Matches (Ipv4EndPoint *endPoint, const FourTuple &tuple)
+{
+  return endPoint->GetLocalPort () == tuple.localPort && endPoint->GetPeerPort () == tuple.peerPort
+         && endPoint->GetLocalAddress () == tuple.localAddress && endPoint->GetPeerAddress () == tuple.peerAddress;
+}
+
+void
+Ipv4EndPointDemux::Uncache (Ipv4EndPoint *endPoint)
+{
+  std::map<Ipv4EndPoint *, FourTuple>::iterator it = m_connectedTuple.find (endPoint);
+  if (it == m_connectedTuple.end ())
+    {
+      return;
+    }
+  sgi::hash_map<FourTuple, Ipv4EndPoint *, FourTupleHash>::iterator c = m_connected.find (it->second);
+  if (c != m_connected.end () && c->second == endPoint)
+    {
+      m_connected.erase (c);
+    }
+  m_connectedTuple.erase (it);
+}
+
 /*
  * return list of all available Endpoints
  */
@@ -199,6 +234,31 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
   
+  // A connected end point found before is still the most exact match, unless
+  // the packet is a subnet directed broadcast (see below)
+  FourTuple tuple (daddr, dport, saddr, sport);
+  sgi::hash_map<FourTuple, Ipv4EndPoint *, FourTupleHash>::iterator cached = m_connected.find (tuple);
+  if (cached != m_connected.end ())
+    {
+      Ipv4EndPoint *endP = cached->second;
+      bool subnetDirected = false;
+      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+        {
+          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+          if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
+              daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
+            {
+              subnetDirected = true;
+            }
+        }
+      if (Matches (endP, tuple) && !subnetDirected
+          && (!endP->GetBoundNetDevice () || endP->GetBoundNetDevice () == incomingInterface->GetDevice ()))
+        {
+          return EndPoints (1, endP);
+        }
+      Uncache (endP);
+    }
+
   EndPoints retval1; // Matches exact on local port, wildcards on others
   EndPoints retval2; // Matches exact on local port/adder, wildcards on others
   EndPoints retval3; // Matches all but local address
@@ -302,6 +362,12 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
     }
 
   // Here we find the most exact match
+  if (retval4.size () == 1 && Matches (retval4.front (), tuple))
+    {
+      Uncache (retval4.front ());
+      m_connected[tuple] = retval4.front ();
+      m_connectedTuple.insert (std::make_pair (retval4.front (), tuple));
+    }
   if (!retval4.empty ()) return retval4;
   if (!retval3.empty ()) return retval3;
   if (!retval2.empty ()) return retval2;
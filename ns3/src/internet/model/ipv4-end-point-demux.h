@@ -23,7 +23,9 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
 #include "ns3/ipv4-address.h"
+#include "ns3/sgi-hashmap.h"
 #include "ipv4-interface.h"
 
 namespace ns3 {
@@ -52,6 +54,34 @@ public:
    */
   typedef std::list<Ipv4EndPoint *>::iterator EndPointsI;
 
+  /**
+   * \brief Local and peer address/port of a connected end point.
+   */
+  struct FourTuple
+  {
+    FourTuple (Ipv4Address localAddress, uint16_t localPort, Ipv4Address peerAddress, uint16_t peerPort)
+      : localAddress (localAddress), peerAddress (peerAddress), localPort (localPort), peerPort (peerPort)
+    {
+    }
+    bool operator== (const FourTuple &o) const
+    {
+      return localPort == o.localPort && peerPort == o.peerPort
+             && localAddress == o.localAddress && peerAddress == o.peerAddress;
+    }
+    Ipv4Address localAddress; //!< local address
+    Ipv4Address peerAddress;  //!< peer address
+    uint16_t localPort;       //!< local port
+    uint16_t peerPort;        //!< peer port
+  };
+
+  /**
+   * \brief Hash function for FourTuple.
+   */
+  struct FourTupleHash
+  {
+    size_t operator() (const FourTuple &t) const;
+  };
+
   Ipv4EndPointDemux ();
   ~Ipv4EndPointDemux ();
 
@@ -174,10 +204,37 @@ private:
    */
   uint16_t m_portFirst;
 
+  /**
+   * \brief Check whether the four-tuple of an end point is still the given one.
+   * \param endPoint the end point
+   * \param tuple the four-tuple
+   * \return true if endPoint matches tuple exactly
+   */
+  static bool Matches (Ipv4EndPoint *endPoint, const FourTuple &tuple);
+
+  /**
+   * \brief Drop the cached four-tuple of an end point, if any.
+   * \param endPoint the end point
+   */
+  void Uncache (Ipv4EndPoint *endPoint);
+
   /**
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief Exact (connected) matches found by Lookup, so that the next
+   * packet of the connection is demultiplexed without a walk over all
+   * end points. Entries are checked against the end point before use, as
+   * the address and port of an end point may be changed after allocation.
+   */
+  sgi::hash_map<FourTuple, Ipv4EndPoint *, FourTupleHash> m_connected;
+
+  /**
+   * \brief The cached four-tuple of each end point in m_connected.
+   */
+  std::map<Ipv4EndPoint *, FourTuple> m_connectedTuple;
 };
 
 } // namespace ns3
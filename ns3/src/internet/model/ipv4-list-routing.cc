@@ -255,12 +255,34 @@ Ipv4ListRouting::AddRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol, i
   NS_LOG_FUNCTION (this << routingProtocol->GetInstanceTypeId () << priority);
   m_routingProtocols.push_back (std::make_pair (priority, routingProtocol));
   m_routingProtocols.sort ( Compare );
+  RoutingTableChanged ();
   if (m_ipv4 != 0)
     {
       routingProtocol->SetIpv4 (m_ipv4);
     }
 }
 
+uint32_t
+Ipv4ListRouting::GetRoutingTableVersion (void) const
+{
+  // Versions only ever grow and protocols are never removed, so the sum
+  // changes whenever one of the tables does
+  uint32_t version = Ipv4RoutingProtocol::GetRoutingTableVersion ();
+  for (Ipv4RoutingProtocolList::const_iterator rprotoIter =
+         m_routingProtocols.begin ();
+       rprotoIter != m_routingProtocols.end ();
+       rprotoIter++)
+    {
+      uint32_t protocolVersion = (*rprotoIter).second->GetRoutingTableVersion ();
+      if (protocolVersion == 0)
+        {
+          return 0;
+        }
+      version += protocolVersion;
+    }
+  return version;
+}
+
 uint32_t 
 Ipv4ListRouting::GetNRoutingProtocols (void) const
 {
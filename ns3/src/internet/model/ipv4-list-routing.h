@@ -91,6 +91,11 @@ public:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const;
+  /**
+   * \returns 0 if any of the routing protocols does not track its routing
+   *          table, else a version that changes whenever one of them changes
+   */
+  virtual uint32_t GetRoutingTableVersion (void) const;
 
 protected:
   void DoDispose (void);
@@ -36,4 +36,21 @@ TypeId Ipv4RoutingProtocol::GetTypeId (void)
   return tid;
 }
 
+Ipv4RoutingProtocol::Ipv4RoutingProtocol ()
+  : m_routingTableVersion (0)
+{
+}
+
+uint32_t
+Ipv4RoutingProtocol::GetRoutingTableVersion (void) const
+{
+  return m_routingTableVersion;
+}
+
+void
+Ipv4RoutingProtocol::RoutingTableChanged (void)
+{
+  m_routingTableVersion++;
+}
+
 } // namespace ns3
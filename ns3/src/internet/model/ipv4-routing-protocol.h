@@ -56,6 +56,8 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  Ipv4RoutingProtocol ();
+
   /// Callback for unicast packets to be forwarded
   typedef Callback<void, Ptr<Ipv4Route>, Ptr<const Packet>, const Ipv4Header &> UnicastForwardCallback;
 
@@ -163,6 +165,27 @@ public:
    * \param stream the ostream the Routing table is printed to
    */
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const = 0;
+
+  /**
+   * \brief Get the version of the routing table
+   *
+   * Protocols that track their table change the version whenever a route,
+   * an interface or an address of the node changes, so that the outcome of
+   * RouteOutput () may be cached for as long as it stays the same.
+   *
+   * \returns the routing table version, 0 if the protocol does not track it
+   *          and RouteOutput () results must not be cached
+   */
+  virtual uint32_t GetRoutingTableVersion (void) const;
+
+protected:
+  /**
+   * \brief Notify that the routing table changed, see GetRoutingTableVersion ()
+   */
+  void RoutingTableChanged (void);
+
+private:
+  uint32_t m_routingTableVersion; //!< 0 until RoutingTableChanged () is first called
 };
 
 } // namespace ns3
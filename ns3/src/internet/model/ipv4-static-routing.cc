@@ -73,6 +73,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  RoutingTableChanged ();
 }
 
 void 
@@ -87,6 +88,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  RoutingTableChanged ();
 }
 
 void 
@@ -128,6 +130,7 @@ Ipv4StaticRouting::AddMulticastRoute (Ipv4Address origin,
   *route = Ipv4MulticastRoutingTableEntry::CreateMulticastRoute (origin, group, 
                                                                  inputInterface, outputInterfaces);
   m_multicastRoutes.push_back (route);
+  RoutingTableChanged ();
 }
 
 // default multicast routes are stored as a network route
@@ -144,6 +147,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  RoutingTableChanged ();
 }
 
 uint32_t 
@@ -194,6 +198,7 @@ Ipv4StaticRouting::RemoveMulticastRoute (Ipv4Address origin,
         {
           delete *i;
           m_multicastRoutes.erase (i);
+          RoutingTableChanged ();
           return true;
         }
     }
@@ -213,6 +218,7 @@ Ipv4StaticRouting::RemoveMulticastRoute (uint32_t index)
         {
           delete *i;
           m_multicastRoutes.erase (i);
+          RoutingTableChanged ();
           return;
         }
       tmp++;
@@ -445,6 +451,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
         {
           delete j->first;
           m_networkRoutes.erase (j);
+          RoutingTableChanged ();
           return;
         }
       tmp++;
@@ -606,6 +613,7 @@ void
 Ipv4StaticRouting::NotifyInterfaceUp (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  RoutingTableChanged ();
   // If interface address and network mask have been set, add a route
   // to the network of the interface (like e.g. ifconfig does on a
   // Linux box)
@@ -625,6 +633,7 @@ void
 Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  RoutingTableChanged ();
   // Remove all static routes that are going through this interface
   uint32_t j = 0;
   while (j < GetNRoutes ())
@@ -645,6 +654,7 @@ void
 Ipv4StaticRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << " " << address.GetLocal ());
+  RoutingTableChanged ();
   if (!m_ipv4->IsUp (interface))
     {
       return;
@@ -663,6 +673,7 @@ void
 Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << " " << address.GetLocal ());
+  RoutingTableChanged ();
   if (!m_ipv4->IsUp (interface))
     {
       return;
@@ -0,0 +1,666 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "mp-tcp-congestion-control.h"
+
+NS_LOG_COMPONENT_DEFINE ("MpTcpCongestionControl");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (MpTcpCongestionControl);
+NS_OBJECT_ENSURE_REGISTERED (MpTcpCongestionUncoupled);
+NS_OBJECT_ENSURE_REGISTERED (MpTcpCongestionFullyCoupled);
+NS_OBJECT_ENSURE_REGISTERED (MpTcpCongestionLia);
+NS_OBJECT_ENSURE_REGISTERED (MpTcpCongestionOlia);
+NS_OBJECT_ENSURE_REGISTERED (MpTcpCongestionBalia);
+NS_OBJECT_ENSURE_REGISTERED (MpTcpCongestionWVegas);
+
+TypeId
+MpTcpCongestionControl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MpTcpCongestionControl")
+    .SetParent<Object> ()
+  ;
+  return tid;
+}
+
+MpTcpCongestionControl::MpTcpCongestionControl ()
+{
+}
+
+MpTcpCongestionControl::~MpTcpCongestionControl ()
+{
+}
+
+void
+MpTcpCongestionControl::PktsAcked (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes, Time rtt)
+{
+}
+
+void
+MpTcpCongestionControl::Timeout (const SubFlows &subflows, uint8_t sFlowIdx)
+{
+}
+
+void
+MpTcpCongestionControl::SubflowChanged (uint8_t sFlowIdx)
+{
+}
+
+uint32_t
+MpTcpCongestionControl::GetTotalCwnd (const SubFlows &subflows)
+{
+  uint32_t totalCwnd = 0;
+  for (uint32_t i = 0; i < subflows.size (); i++)
+    {
+      if (subflows[i]->m_inFastRec)
+        totalCwnd += subflows[i]->ssthresh;
+      else
+        totalCwnd += subflows[i]->cwnd.Get ();
+    }
+  return totalCwnd;
+}
+
+void
+MpTcpCongestionControl::RenoIncrease (Ptr<MpTcpSubFlow> sFlow)
+{
+  double adder = static_cast<double> (sFlow->MSS * sFlow->MSS) / sFlow->cwnd.Get ();
+  adder = std::max (1.0, adder);
+  sFlow->cwnd += static_cast<double> (adder);
+}
+
+/*
+ * Uncoupled
+ */
+
+TypeId
+MpTcpCongestionUncoupled::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MpTcpCongestionUncoupled")
+    .SetParent<MpTcpCongestionControl> ()
+    .AddConstructor<MpTcpCongestionUncoupled> ()
+  ;
+  return tid;
+}
+
+MpTcpCongestionUncoupled::MpTcpCongestionUncoupled ()
+{
+}
+
+std::string
+MpTcpCongestionUncoupled::GetName (void) const
+{
+  return "Uncoupled_TCPs";
+}
+
+Ptr<MpTcpCongestionControl>
+MpTcpCongestionUncoupled::Copy (void) const
+{
+  return CopyObject<MpTcpCongestionUncoupled> (this);
+}
+
+void
+MpTcpCongestionUncoupled::IncreaseWindow (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  RenoIncrease (subflows[sFlowIdx]);
+}
+
+uint32_t
+MpTcpCongestionUncoupled::GetSsThresh (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t bytesInFlight)
+{
+  return std::max (2 * subflows[sFlowIdx]->MSS, bytesInFlight / 2);
+}
+
+/*
+ * Fully coupled
+ */
+
+TypeId
+MpTcpCongestionFullyCoupled::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MpTcpCongestionFullyCoupled")
+    .SetParent<MpTcpCongestionControl> ()
+    .AddConstructor<MpTcpCongestionFullyCoupled> ()
+  ;
+  return tid;
+}
+
+MpTcpCongestionFullyCoupled::MpTcpCongestionFullyCoupled ()
+{
+}
+
+std::string
+MpTcpCongestionFullyCoupled::GetName (void) const
+{
+  return "Fully_Coupled";
+}
+
+Ptr<MpTcpCongestionControl>
+MpTcpCongestionFullyCoupled::Copy (void) const
+{
+  return CopyObject<MpTcpCongestionFullyCoupled> (this);
+}
+
+void
+MpTcpCongestionFullyCoupled::IncreaseWindow (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  double adder = static_cast<double> (sFlow->MSS * sFlow->MSS) / GetTotalCwnd (subflows);
+  adder = std::max (1.0, adder);
+  sFlow->cwnd += static_cast<double> (adder);
+}
+
+uint32_t
+MpTcpCongestionFullyCoupled::GetSsThresh (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t bytesInFlight)
+{
+  // The connection halves its total window, all of it taken from this subflow
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  int d = sFlow->cwnd.Get () - GetTotalCwnd (subflows) / 2;
+  if (d < 0)
+    d = 0;
+  return std::max (2 * sFlow->MSS, (uint32_t) d);
+}
+
+/*
+ * LIA
+ */
+
+TypeId
+MpTcpCongestionLia::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MpTcpCongestionLia")
+    .SetParent<MpTcpCongestionControl> ()
+    .AddConstructor<MpTcpCongestionLia> ()
+    .AddAttribute ("Capped",
+                   "Never increase a subflow faster than a single path TCP on its path would (RFC 6356 section 4.1)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MpTcpCongestionLia::m_capped),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+MpTcpCongestionLia::MpTcpCongestionLia ()
+  : m_capped (false),
+    m_totalCwnd (0),
+    m_alpha (0)
+{
+}
+
+std::string
+MpTcpCongestionLia::GetName (void) const
+{
+  return m_capped ? "RTT_Compensator" : "Linked_Increases";
+}
+
+Ptr<MpTcpCongestionControl>
+MpTcpCongestionLia::Copy (void) const
+{
+  return CopyObject<MpTcpCongestionLia> (this);
+}
+
+double
+MpTcpCongestionLia::ComputeAlpha (const SubFlows &subflows, uint32_t totalCwnd)
+{
+  double maxi = 0;
+  double sumi = 0;
+  for (uint32_t i = 0; i < subflows.size (); i++)
+    {
+      Ptr<MpTcpSubFlow> sFlow = subflows[i];
+      double rtt = sFlow->rtt->GetCurrentEstimate ().GetSeconds ();
+      double tmpi = sFlow->cwnd.Get () / (rtt * rtt);
+      if (maxi < tmpi)
+        maxi = tmpi;
+      sumi += sFlow->cwnd.Get () / rtt;
+    }
+  return (totalCwnd * maxi) / (sumi * sumi);
+}
+
+void
+MpTcpCongestionLia::SubflowChanged (uint8_t sFlowIdx)
+{
+  // Subflows not seen yet are computed when they first show up
+  if (sFlowIdx < m_terms.size () && !m_terms[sFlowIdx].changed)
+    {
+      m_terms[sFlowIdx].changed = true;
+      m_changed.push_back (sFlowIdx);
+    }
+}
+
+void
+MpTcpCongestionLia::Update (const SubFlows &subflows)
+{
+  while (m_terms.size () < subflows.size ())
+    {
+      Terms t;
+      t.changed = false;
+      t.window = 0;
+      m_terms.push_back (t);
+      SubflowChanged (m_terms.size () - 1);
+    }
+  if (m_changed.empty ())
+    return;
+
+  // Only the subflows the socket reported, mostly the one that was acked
+  for (uint32_t j = 0; j < m_changed.size (); j++)
+    {
+      Ptr<MpTcpSubFlow> sFlow = subflows[m_changed[j]];
+      Terms &t = m_terms[m_changed[j]];
+      uint32_t cwnd = sFlow->cwnd.Get ();
+      uint32_t window = sFlow->m_inFastRec ? sFlow->ssthresh : cwnd;
+      m_totalCwnd += window - t.window;
+      t.window = window;
+      double r = sFlow->rtt->GetCurrentEstimate ().GetSeconds ();
+      t.perRtt2 = cwnd / (r * r);
+      t.perRtt = cwnd / r;
+      t.changed = false;
+    }
+  m_changed.clear ();
+
+  // Summed in subflow order as ComputeAlpha does, a running sum of doubles would drift from it
+  double maxi = 0;
+  double sumi = 0;
+  for (uint32_t i = 0; i < subflows.size (); i++)
+    {
+      if (maxi < m_terms[i].perRtt2)
+        maxi = m_terms[i].perRtt2;
+      sumi += m_terms[i].perRtt;
+    }
+  m_alpha = (m_totalCwnd * maxi) / (sumi * sumi);
+}
+
+void
+MpTcpCongestionLia::IncreaseWindow (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  Update (subflows);
+  double alpha = m_alpha;
+  double adder = alpha * sFlow->MSS * sFlow->MSS / m_totalCwnd;
+  if (m_capped)
+    adder = std::min (adder, static_cast<double> (sFlow->MSS * sFlow->MSS) / sFlow->cwnd.Get ());
+  adder = std::max (1.0, adder);
+  sFlow->cwnd += static_cast<double> (adder);
+  SubflowChanged (sFlowIdx);
+  NS_LOG_LOGIC ("Subflow " << (int) sFlowIdx << " " << GetName () << ": alpha " << alpha << " increment is " << adder << " cwnd " << sFlow->cwnd);
+}
+
+uint32_t
+MpTcpCongestionLia::GetSsThresh (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t bytesInFlight)
+{
+  return std::max (2 * subflows[sFlowIdx]->MSS, bytesInFlight / 2);
+}
+
+/*
+ * OLIA
+ */
+
+TypeId
+MpTcpCongestionOlia::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MpTcpCongestionOlia")
+    .SetParent<MpTcpCongestionControl> ()
+    .AddConstructor<MpTcpCongestionOlia> ()
+  ;
+  return tid;
+}
+
+MpTcpCongestionOlia::MpTcpCongestionOlia ()
+{
+}
+
+std::string
+MpTcpCongestionOlia::GetName (void) const
+{
+  return "OLIA";
+}
+
+Ptr<MpTcpCongestionControl>
+MpTcpCongestionOlia::Copy (void) const
+{
+  return CopyObject<MpTcpCongestionOlia> (this);
+}
+
+MpTcpCongestionOlia::State &
+MpTcpCongestionOlia::GetState (uint8_t sFlowIdx)
+{
+  while (m_state.size () <= sFlowIdx)
+    {
+      State s;
+      s.lastLossInterval = 0;
+      s.sinceLoss = 0;
+      m_state.push_back (s);
+    }
+  return m_state[sFlowIdx];
+}
+
+void
+MpTcpCongestionOlia::Loss (uint8_t sFlowIdx)
+{
+  State &s = GetState (sFlowIdx);
+  s.lastLossInterval = s.sinceLoss;
+  s.sinceLoss = 0;
+}
+
+double
+MpTcpCongestionOlia::GetQuality (const SubFlows &subflows, uint8_t sFlowIdx)
+{
+  // l_r / rtt_r^2: the inter-loss distance of the path, over its RTT squared
+  State &s = GetState (sFlowIdx);
+  double rtt = subflows[sFlowIdx]->rtt->GetCurrentEstimate ().GetSeconds ();
+  return std::max (s.lastLossInterval, s.sinceLoss) / (rtt * rtt);
+}
+
+void
+MpTcpCongestionOlia::PktsAcked (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes, Time rtt)
+{
+  GetState (sFlowIdx).sinceLoss += ackedBytes;
+}
+
+void
+MpTcpCongestionOlia::IncreaseWindow (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  // Windows in packets, RTTs in seconds
+  uint32_t n = 0;
+  double sumRate = 0;
+  double maxWindow = 0;
+  double bestQuality = 0;
+  for (uint32_t i = 0; i < subflows.size (); i++)
+    {
+      double w = (double) subflows[i]->cwnd.Get () / subflows[i]->MSS;
+      double rtt = subflows[i]->rtt->GetCurrentEstimate ().GetSeconds ();
+      n++;
+      sumRate += w / rtt;
+      maxWindow = std::max (maxWindow, w);
+      bestQuality = std::max (bestQuality, GetQuality (subflows, i));
+    }
+
+  // M: subflows with the largest window, collected: best paths not in M
+  uint32_t nMax = 0;
+  uint32_t nCollected = 0;
+  bool rMax = false;
+  bool rCollected = false;
+  for (uint32_t i = 0; i < subflows.size (); i++)
+    {
+      double w = (double) subflows[i]->cwnd.Get () / subflows[i]->MSS;
+      bool inMax = (w == maxWindow);
+      bool inCollected = !inMax && GetQuality (subflows, i) == bestQuality;
+      nMax += inMax;
+      nCollected += inCollected;
+      if (i == sFlowIdx)
+        {
+          rMax = inMax;
+          rCollected = inCollected;
+        }
+    }
+  double alpha = 0;
+  if (nCollected > 0 && rCollected)
+    alpha = 1.0 / (n * nCollected);
+  else if (nCollected > 0 && rMax)
+    alpha = -1.0 / (n * nMax);
+
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  double w = (double) sFlow->cwnd.Get () / sFlow->MSS;
+  double rtt = sFlow->rtt->GetCurrentEstimate ().GetSeconds ();
+  double increase = (w / (rtt * rtt)) / (sumRate * sumRate) + alpha / w;
+  double cwnd = sFlow->cwnd.Get () + increase * sFlow->MSS;
+  sFlow->cwnd = (uint32_t) std::max (cwnd, (double) sFlow->MSS);
+  NS_LOG_LOGIC ("Subflow " << (int) sFlowIdx << " OLIA: alpha " << alpha << " increment is " << increase * sFlow->MSS << " cwnd " << sFlow->cwnd);
+}
+
+uint32_t
+MpTcpCongestionOlia::GetSsThresh (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t bytesInFlight)
+{
+  Loss (sFlowIdx);
+  return std::max (2 * subflows[sFlowIdx]->MSS, bytesInFlight / 2);
+}
+
+void
+MpTcpCongestionOlia::Timeout (const SubFlows &subflows, uint8_t sFlowIdx)
+{
+  Loss (sFlowIdx);
+}
+
+/*
+ * BALIA
+ */
+
+TypeId
+MpTcpCongestionBalia::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MpTcpCongestionBalia")
+    .SetParent<MpTcpCongestionControl> ()
+    .AddConstructor<MpTcpCongestionBalia> ()
+  ;
+  return tid;
+}
+
+MpTcpCongestionBalia::MpTcpCongestionBalia ()
+{
+}
+
+std::string
+MpTcpCongestionBalia::GetName (void) const
+{
+  return "BALIA";
+}
+
+Ptr<MpTcpCongestionControl>
+MpTcpCongestionBalia::Copy (void) const
+{
+  return CopyObject<MpTcpCongestionBalia> (this);
+}
+
+/// Rates in packets per second: of subflow sFlowIdx, the sum and the highest over all subflows
+static void
+GetBaliaRates (const MpTcpCongestionControl::SubFlows &subflows, uint8_t sFlowIdx,
+               double &rate, double &sumRate, double &maxRate)
+{
+  sumRate = 0;
+  maxRate = 0;
+  for (uint32_t i = 0; i < subflows.size (); i++)
+    {
+      double x = (double) subflows[i]->cwnd.Get () / subflows[i]->MSS / subflows[i]->rtt->GetCurrentEstimate ().GetSeconds ();
+      sumRate += x;
+      maxRate = std::max (maxRate, x);
+      if (i == sFlowIdx)
+        rate = x;
+    }
+}
+
+void
+MpTcpCongestionBalia::IncreaseWindow (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  double rate, sumRate, maxRate;
+  GetBaliaRates (subflows, sFlowIdx, rate, sumRate, maxRate);
+  double alpha = maxRate / rate;
+  double rtt = sFlow->rtt->GetCurrentEstimate ().GetSeconds ();
+  double increase = (rate / rtt) / (sumRate * sumRate) * (1 + alpha) / 2 * (4 + alpha) / 5;
+  double adder = std::max (1.0, increase * sFlow->MSS);
+  sFlow->cwnd += static_cast<double> (adder);
+  NS_LOG_LOGIC ("Subflow " << (int) sFlowIdx << " BALIA: alpha " << alpha << " increment is " << adder << " cwnd " << sFlow->cwnd);
+}
+
+uint32_t
+MpTcpCongestionBalia::GetSsThresh (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t bytesInFlight)
+{
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  double rate, sumRate, maxRate;
+  GetBaliaRates (subflows, sFlowIdx, rate, sumRate, maxRate);
+  double alpha = maxRate / rate;
+  uint32_t cwnd = sFlow->cwnd.Get ();
+  uint32_t decrease = (uint32_t) (cwnd / 2.0 * std::min (alpha, 1.5));
+  return std::max (2 * sFlow->MSS, cwnd > decrease ? cwnd - decrease : 0);
+}
+
+/*
+ * wVegas
+ */
+
+TypeId
+MpTcpCongestionWVegas::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MpTcpCongestionWVegas")
+    .SetParent<MpTcpCongestionControl> ()
+    .AddConstructor<MpTcpCongestionWVegas> ()
+    .AddAttribute ("Alpha",
+                   "Packets the connection keeps queued in the network, shared between the subflows by rate",
+                   DoubleValue (10),
+                   MakeDoubleAccessor (&MpTcpCongestionWVegas::m_alpha),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("Gamma",
+                   "Packets a subflow may queue before it leaves slow start",
+                   DoubleValue (1),
+                   MakeDoubleAccessor (&MpTcpCongestionWVegas::m_gamma),
+                   MakeDoubleChecker<double> (0))
+  ;
+  return tid;
+}
+
+MpTcpCongestionWVegas::MpTcpCongestionWVegas ()
+  : m_alpha (10),
+    m_gamma (1)
+{
+}
+
+std::string
+MpTcpCongestionWVegas::GetName (void) const
+{
+  return "wVegas";
+}
+
+Ptr<MpTcpCongestionControl>
+MpTcpCongestionWVegas::Copy (void) const
+{
+  return CopyObject<MpTcpCongestionWVegas> (this);
+}
+
+MpTcpCongestionWVegas::State &
+MpTcpCongestionWVegas::GetState (uint8_t sFlowIdx)
+{
+  while (m_state.size () <= sFlowIdx)
+    {
+      State s;
+      s.baseRtt = Time::Max ();
+      s.samples = 0;
+      s.roundAcked = 0;
+      s.roundBytes = 0;
+      s.rate = 0;
+      s.alpha = 2;
+      s.queueDelay = 0;
+      m_state.push_back (s);
+    }
+  return m_state[sFlowIdx];
+}
+
+void
+MpTcpCongestionWVegas::PktsAcked (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes, Time rtt)
+{
+  State &s = GetState (sFlowIdx);
+  if (rtt.IsStrictlyPositive ())
+    {
+      s.baseRtt = std::min (s.baseRtt, rtt);
+      s.sampledRtt += rtt;
+      s.samples++;
+    }
+  s.roundAcked += ackedBytes;
+  if (s.roundAcked >= s.roundBytes)
+    EndRound (subflows, sFlowIdx);
+}
+
+void
+MpTcpCongestionWVegas::EndRound (const SubFlows &subflows, uint8_t sFlowIdx)
+{
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  State &s = GetState (sFlowIdx);
+  uint32_t mss = sFlow->MSS;
+  if (s.samples <= 2)
+    { // As Vegas, trust a round only with more than two RTT samples, else fall back to NewReno,
+      // in slow start as in congestion avoidance, so a subflow short of samples is not held back
+      sFlow->cwnd += mss;
+    }
+  else
+    {
+      double rtt = s.sampledRtt.GetSeconds () / s.samples;
+      double baseRtt = s.baseRtt.GetSeconds ();
+      double w = (double) sFlow->cwnd.Get () / mss;
+      double target = w * baseRtt / rtt;
+      double diff = w - target;   // Packets this subflow has queued
+      if (sFlow->cwnd.Get () < sFlow->ssthresh)
+        {
+          if (diff > m_gamma)
+            { // Leave slow start before the queue builds up
+              sFlow->cwnd = std::max (2 * mss, std::min (sFlow->cwnd.Get (), (uint32_t) (target + 1) * mss));
+              sFlow->ssthresh = std::min (sFlow->ssthresh, sFlow->cwnd.Get () - mss);
+            }
+        }
+      else
+        {
+          if (diff >= s.alpha)
+            { // Take the share of Alpha this subflow's rate gives it
+              s.rate = w / rtt;
+              double sumRate = 0;
+              for (uint32_t i = 0; i < m_state.size (); i++)
+                sumRate += m_state[i].rate;
+              s.alpha = std::max (2.0, s.rate / sumRate * m_alpha);
+            }
+          if (diff > s.alpha)
+            {
+              if (sFlow->cwnd.Get () > 2 * mss)
+                sFlow->cwnd -= mss;
+              sFlow->ssthresh = std::min (sFlow->ssthresh, sFlow->cwnd.Get () - mss);
+            }
+          else if (diff < s.alpha)
+            {
+              sFlow->cwnd += mss;
+            }
+
+          // Drain the queue once its delay doubled since the lowest seen
+          double queueDelay = rtt - baseRtt;
+          if (s.queueDelay == 0 || s.queueDelay > queueDelay)
+            s.queueDelay = queueDelay;
+          if (queueDelay > 0 && queueDelay >= 2 * s.queueDelay)
+            {
+              sFlow->cwnd = std::max (2 * mss, (uint32_t) (sFlow->cwnd.Get () * baseRtt / (2 * rtt)));
+              s.queueDelay = 0;
+            }
+        }
+      NS_LOG_LOGIC ("Subflow " << (int) sFlowIdx << " wVegas: diff " << diff << " alpha " << s.alpha << " cwnd " << sFlow->cwnd);
+    }
+  s.roundAcked = 0;
+  s.roundBytes = sFlow->cwnd.Get ();
+  s.sampledRtt = Seconds (0);
+  s.samples = 0;
+}
+
+void
+MpTcpCongestionWVegas::IncreaseWindow (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes)
+{
+  // The window moves once per round, in EndRound
+}
+
+uint32_t
+MpTcpCongestionWVegas::GetSsThresh (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t bytesInFlight)
+{
+  return std::max (2 * subflows[sFlowIdx]->MSS, bytesInFlight / 2);
+}
+
+} // namespace ns3
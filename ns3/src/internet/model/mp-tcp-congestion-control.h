@@ -0,0 +1,265 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MP_TCP_CONGESTION_CONTROL_H
+#define MP_TCP_CONGESTION_CONTROL_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/mp-tcp-typedefs.h"
+#include "mp-tcp-subflow.h"
+
+namespace ns3 {
+
+/**
+ * \brief Congestion controller of an MPTCP connection
+ *
+ * MpTcpSocketBase owns one controller, chosen by its CongestionControlType
+ * (or CongestionControl) attribute, and asks it how the window of a subflow
+ * grows in congestion avoidance and where its slow start threshold goes on
+ * a loss. Slow start, fast recovery and timeouts stay in the socket. The
+ * controller sees all subflows of the connection, so it can couple them,
+ * and keeps its own per-subflow state indexed like the socket's subflows.
+ */
+class MpTcpCongestionControl : public Object
+{
+public:
+  typedef std::vector<Ptr<MpTcpSubFlow> > SubFlows;
+
+  static TypeId GetTypeId (void);
+  MpTcpCongestionControl ();
+  virtual ~MpTcpCongestionControl ();
+
+  virtual std::string GetName (void) const = 0;
+
+  /// Copy for a forked socket, its attributes and per-subflow state included
+  virtual Ptr<MpTcpCongestionControl> Copy (void) const = 0;
+
+  /**
+   * \brief New ACK on a subflow, before its window grows
+   * \param ackedBytes Bytes the ACK acknowledged for the first time
+   * \param rtt RTT sample taken from the ACK, zero if there is none
+   */
+  virtual void PktsAcked (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes, Time rtt);
+
+  /// Grows the cwnd of a subflow in congestion avoidance, once per new ACK
+  virtual void IncreaseWindow (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes) = 0;
+
+  /// Slow start threshold of a subflow entering fast recovery
+  virtual uint32_t GetSsThresh (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t bytesInFlight) = 0;
+
+  /// The retransmission timer of a subflow expired, the socket has already collapsed its window
+  virtual void Timeout (const SubFlows &subflows, uint8_t sFlowIdx);
+
+  /**
+   * \brief The cwnd, ssthresh, fast recovery state or smoothed RTT of a subflow changed
+   *
+   * The socket reports every such change made outside the controller, so
+   * that aggregates over the subflows are only updated when one changed.
+   */
+  virtual void SubflowChanged (uint8_t sFlowIdx);
+
+  /// Sum of the subflow windows, with ssthresh standing for the cwnd of those in fast recovery
+  static uint32_t GetTotalCwnd (const SubFlows &subflows);
+
+protected:
+  /// Increase of a single path TCP (RFC 5681), at least a byte per ACK
+  static void RenoIncrease (Ptr<MpTcpSubFlow> sFlow);
+};
+
+/**
+ * \brief Every subflow behaves as a separate NewReno connection
+ */
+class MpTcpCongestionUncoupled : public MpTcpCongestionControl
+{
+public:
+  static TypeId GetTypeId (void);
+  MpTcpCongestionUncoupled ();
+
+  virtual std::string GetName (void) const;
+  virtual Ptr<MpTcpCongestionControl> Copy (void) const;
+  virtual void IncreaseWindow (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes);
+  virtual uint32_t GetSsThresh (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t bytesInFlight);
+};
+
+/**
+ * \brief The subflows grow and shrink as a single window (EWTCP-like
+ * fully coupled control)
+ */
+class MpTcpCongestionFullyCoupled : public MpTcpCongestionControl
+{
+public:
+  static TypeId GetTypeId (void);
+  MpTcpCongestionFullyCoupled ();
+
+  virtual std::string GetName (void) const;
+  virtual Ptr<MpTcpCongestionControl> Copy (void) const;
+  virtual void IncreaseWindow (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes);
+  virtual uint32_t GetSsThresh (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t bytesInFlight);
+};
+
+/**
+ * \brief Linked Increases Algorithm (RFC 6356)
+ *
+ * The increase of every subflow is alpha * MSS^2 / cwnd_total, alpha
+ * depending on the windows and smoothed RTTs of all subflows. The terms of
+ * alpha are cached per subflow and only recomputed for the subflows the
+ * socket reported through SubflowChanged, the total window is kept as a
+ * running sum. The result is the one ComputeAlpha gives. With Capped a
+ * subflow never grows faster than a single path TCP would (RFC 6356
+ * section 4.1), which is the RTT_Compensator setting of
+ * MpTcpSocketBase::CongestionControl.
+ */
+class MpTcpCongestionLia : public MpTcpCongestionControl
+{
+public:
+  static TypeId GetTypeId (void);
+  MpTcpCongestionLia ();
+
+  virtual std::string GetName (void) const;
+  virtual Ptr<MpTcpCongestionControl> Copy (void) const;
+  virtual void IncreaseWindow (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes);
+  virtual uint32_t GetSsThresh (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t bytesInFlight);
+  virtual void SubflowChanged (uint8_t sFlowIdx);
+
+  /// alpha = cwnd_total * max(cwnd_i / rtt_i^2) / (sum(cwnd_i / rtt_i))^2, RFC 6356 formula (2)
+  static double ComputeAlpha (const SubFlows &subflows, uint32_t totalCwnd);
+
+private:
+  struct Terms
+  {
+    bool changed;         //!< Reported changed since the terms were computed
+    uint32_t window;      //!< Part of the total window, ssthresh in fast recovery
+    double perRtt2;       //!< cwnd / rtt^2
+    double perRtt;        //!< cwnd / rtt
+  };
+  /// Brings the total window and alpha up to date with the subflows
+  void Update (const SubFlows &subflows);
+
+  bool m_capped;
+  std::vector<Terms> m_terms;
+  std::vector<uint8_t> m_changed;   // Subflows whose terms are out of date
+  uint32_t m_totalCwnd;   // Sum of the Terms::window
+  double m_alpha;         // alpha for the current m_terms and m_totalCwnd
+};
+
+/**
+ * \brief Opportunistic Linked Increases Algorithm (Khalili et al., RFC
+ * draft-khalili-mptcp-congestion-control)
+ *
+ * On each ACK subflow r grows by
+ * (w_r / rtt_r^2) / (sum w_p / rtt_p)^2 + alpha_r / w_r packets. alpha_r
+ * moves window from the largest subflows to the best paths that do not
+ * have the largest window yet, the quality of a path being the bytes it
+ * delivered between its last two losses over its RTT squared. It is zero once the
+ * best paths have the largest windows.
+ */
+class MpTcpCongestionOlia : public MpTcpCongestionControl
+{
+public:
+  static TypeId GetTypeId (void);
+  MpTcpCongestionOlia ();
+
+  virtual std::string GetName (void) const;
+  virtual Ptr<MpTcpCongestionControl> Copy (void) const;
+  virtual void PktsAcked (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes, Time rtt);
+  virtual void IncreaseWindow (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes);
+  virtual uint32_t GetSsThresh (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t bytesInFlight);
+  virtual void Timeout (const SubFlows &subflows, uint8_t sFlowIdx);
+
+private:
+  struct State
+  {
+    uint64_t lastLossInterval;  //!< Bytes acknowledged between the last two losses
+    uint64_t sinceLoss;         //!< Bytes acknowledged since the last loss
+  };
+  State &GetState (uint8_t sFlowIdx);
+  /// How good the path of a subflow is, the best paths have the highest
+  double GetQuality (const SubFlows &subflows, uint8_t sFlowIdx);
+  void Loss (uint8_t sFlowIdx);
+
+  std::vector<State> m_state;
+};
+
+/**
+ * \brief Balanced Linked Adaptation (Peng, Walid, Hwang and Low)
+ *
+ * With x_r = w_r / rtt_r and alpha_r = max x_p / x_r, subflow r grows by
+ * (x_r / rtt_r) / (sum x_p)^2 * (1 + alpha_r) / 2 * (4 + alpha_r) / 5
+ * packets per ACK and loses w_r / 2 * min (alpha_r, 1.5) on a loss, which
+ * balances friendliness to single path TCP against responsiveness.
+ */
+class MpTcpCongestionBalia : public MpTcpCongestionControl
+{
+public:
+  static TypeId GetTypeId (void);
+  MpTcpCongestionBalia ();
+
+  virtual std::string GetName (void) const;
+  virtual Ptr<MpTcpCongestionControl> Copy (void) const;
+  virtual void IncreaseWindow (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes);
+  virtual uint32_t GetSsThresh (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t bytesInFlight);
+};
+
+/**
+ * \brief Weighted Vegas (Cao, Xu and Fu), delay based coupled control
+ *
+ * Once per round of one window every subflow compares its cwnd with what
+ * its base RTT would need, as Vegas does, and keeps its share of Alpha
+ * packets queued in the network, the share being its part of the
+ * connection's rate. A subflow whose queueing delay doubled since the
+ * lowest one seen backs off to drain the queue. Losses are handled as in
+ * NewReno.
+ */
+class MpTcpCongestionWVegas : public MpTcpCongestionControl
+{
+public:
+  static TypeId GetTypeId (void);
+  MpTcpCongestionWVegas ();
+
+  virtual std::string GetName (void) const;
+  virtual Ptr<MpTcpCongestionControl> Copy (void) const;
+  virtual void PktsAcked (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes, Time rtt);
+  virtual void IncreaseWindow (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t ackedBytes);
+  virtual uint32_t GetSsThresh (const SubFlows &subflows, uint8_t sFlowIdx, uint32_t bytesInFlight);
+
+private:
+  struct State
+  {
+    Time baseRtt;         //!< Lowest RTT seen
+    Time sampledRtt;      //!< Sum of the RTT samples of this round
+    uint32_t samples;     //!< Number of RTT samples of this round
+    uint32_t roundAcked;  //!< Bytes acknowledged in this round
+    uint32_t roundBytes;  //!< Bytes to acknowledge for this round to end, the cwnd when it began
+    double rate;          //!< Last rate, cwnd over RTT in packets per second
+    double alpha;         //!< Packets this subflow keeps queued
+    double queueDelay;    //!< Lowest queueing delay seen since the last drain, in seconds
+  };
+  State &GetState (uint8_t sFlowIdx);
+  void EndRound (const SubFlows &subflows, uint8_t sFlowIdx);
+
+  double m_alpha;         // Packets the connection keeps queued in the network
+  double m_gamma;         // Packets queued that end slow start
+  std::vector<State> m_state;
+};
+
+} // namespace ns3
+
+#endif /* MP_TCP_CONGESTION_CONTROL_H */
@@ -0,0 +1,301 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "mp-tcp-scheduler.h"
+#include "mp-tcp-socket-base.h"
+
+NS_LOG_COMPONENT_DEFINE ("MpTcpScheduler");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (MpTcpScheduler);
+NS_OBJECT_ENSURE_REGISTERED (MpTcpSchedulerRoundRobin);
+NS_OBJECT_ENSURE_REGISTERED (MpTcpSchedulerMinRtt);
+NS_OBJECT_ENSURE_REGISTERED (MpTcpSchedulerBlest);
+NS_OBJECT_ENSURE_REGISTERED (MpTcpSchedulerEcf);
+
+TypeId
+MpTcpScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MpTcpScheduler")
+    .SetParent<Object> ()
+  ;
+  return tid;
+}
+
+MpTcpScheduler::MpTcpScheduler ()
+{
+}
+
+MpTcpScheduler::~MpTcpScheduler ()
+{
+}
+
+bool
+MpTcpScheduler::IsRttAware (void) const
+{
+  return false;
+}
+
+uint32_t
+MpTcpScheduler::AvailableWindow (Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx)
+{
+  return socket->AvailableWindow (sFlowIdx);
+}
+
+uint32_t
+MpTcpScheduler::RemoteWindow (Ptr<MpTcpSocketBase> socket)
+{
+  return socket->remoteRecvWnd;
+}
+
+uint32_t
+MpTcpScheduler::BytesInFlight (Ptr<MpTcpSocketBase> socket)
+{
+  return socket->BytesInFlight ();
+}
+
+uint32_t
+MpTcpScheduler::PendingData (Ptr<MpTcpSocketBase> socket)
+{
+  return socket->sendingBuffer.PendingData ();
+}
+
+TypeId
+MpTcpSchedulerRoundRobin::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MpTcpSchedulerRoundRobin")
+    .SetParent<MpTcpScheduler> ()
+    .AddConstructor<MpTcpSchedulerRoundRobin> ()
+  ;
+  return tid;
+}
+
+MpTcpSchedulerRoundRobin::MpTcpSchedulerRoundRobin ()
+{
+}
+
+std::string
+MpTcpSchedulerRoundRobin::GetName (void) const
+{
+  return "Round_Robin";
+}
+
+Ptr<MpTcpScheduler>
+MpTcpSchedulerRoundRobin::Copy (void) const
+{
+  return CopyObject<MpTcpSchedulerRoundRobin> (this);
+}
+
+uint8_t
+MpTcpSchedulerRoundRobin::GetSubflowToUse (Ptr<MpTcpSocketBase> socket, const SubFlows &subflows, uint8_t lastUsed)
+{
+  return (lastUsed + 1) % subflows.size ();
+}
+
+TypeId
+MpTcpSchedulerMinRtt::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MpTcpSchedulerMinRtt")
+    .SetParent<MpTcpScheduler> ()
+    .AddConstructor<MpTcpSchedulerMinRtt> ()
+  ;
+  return tid;
+}
+
+MpTcpSchedulerMinRtt::MpTcpSchedulerMinRtt ()
+{
+}
+
+std::string
+MpTcpSchedulerMinRtt::GetName (void) const
+{
+  return "Min_RTT";
+}
+
+Ptr<MpTcpScheduler>
+MpTcpSchedulerMinRtt::Copy (void) const
+{
+  return CopyObject<MpTcpSchedulerMinRtt> (this);
+}
+
+bool
+MpTcpSchedulerMinRtt::IsRttAware (void) const
+{
+  return true;
+}
+
+uint8_t
+MpTcpSchedulerMinRtt::GetSubflowToUse (Ptr<MpTcpSocketBase> socket, const SubFlows &subflows, uint8_t lastUsed)
+{
+  NS_LOG_FUNCTION (this << (int) lastUsed);
+  uint8_t fast = GetFastestSubflow (socket, subflows, false);
+  if (fast == subflows.size ())
+    { // Nothing established yet, keep rotating so that the socket finds the subflow once it is
+      return (lastUsed + 1) % subflows.size ();
+    }
+  return PickSubflow (socket, subflows, fast, GetFastestSubflow (socket, subflows, true));
+}
+
+uint8_t
+MpTcpSchedulerMinRtt::PickSubflow (Ptr<MpTcpSocketBase> socket, const SubFlows &subflows, uint8_t fast, uint8_t slow)
+{
+  // If no subflow has space the fastest one is the one to wait for
+  return (slow == subflows.size ()) ? fast : slow;
+}
+
+uint8_t
+MpTcpSchedulerMinRtt::GetFastestSubflow (Ptr<MpTcpSocketBase> socket, const SubFlows &subflows, bool withWindow)
+{
+  uint8_t fastest = subflows.size ();
+  Time minRtt = Time::Max ();
+  for (uint8_t i = 0; i < subflows.size (); i++)
+    {
+      Ptr<MpTcpSubFlow> sFlow = subflows[i];
+      if (sFlow->state != TcpSocket::ESTABLISHED || (withWindow && AvailableWindow (socket, i) == 0))
+        continue;
+      Time rtt = sFlow->rtt->GetCurrentEstimate ();
+      if (rtt < minRtt)
+        {
+          minRtt = rtt;
+          fastest = i;
+        }
+    }
+  return fastest;
+}
+
+TypeId
+MpTcpSchedulerBlest::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MpTcpSchedulerBlest")
+    .SetParent<MpTcpSchedulerMinRtt> ()
+    .AddConstructor<MpTcpSchedulerBlest> ()
+  ;
+  return tid;
+}
+
+MpTcpSchedulerBlest::MpTcpSchedulerBlest ()
+{
+}
+
+std::string
+MpTcpSchedulerBlest::GetName (void) const
+{
+  return "BLEST";
+}
+
+Ptr<MpTcpScheduler>
+MpTcpSchedulerBlest::Copy (void) const
+{
+  return CopyObject<MpTcpSchedulerBlest> (this);
+}
+
+uint8_t
+MpTcpSchedulerBlest::PickSubflow (Ptr<MpTcpSocketBase> socket, const SubFlows &subflows, uint8_t fast, uint8_t slow)
+{
+  NS_LOG_FUNCTION (this << (int) fast << (int) slow);
+  if (slow == fast || slow == subflows.size ())
+    return fast;
+  Ptr<MpTcpSubFlow> fFlow = subflows[fast];
+  Ptr<MpTcpSubFlow> sFlow = subflows[slow];
+  double rttF = fFlow->rtt->GetCurrentEstimate ().GetSeconds ();
+  double rttS = sFlow->rtt->GetCurrentEstimate ().GetSeconds ();
+  if (rttF <= 0)
+    return slow;
+  double ratio = rttS / rttF;
+  uint32_t sendWindow = RemoteWindow (socket);
+  double cwndF = (double) std::min (fFlow->cwnd.Get (), sendWindow) / fFlow->MSS;
+  double x = fFlow->MSS * (cwndF + (ratio - 1) / 2) * ratio;
+
+  double freeWindow = (double) sendWindow - BytesInFlight (socket);
+  if (x > freeWindow)
+    {
+      NS_LOG_LOGIC ("BLEST -> X " << x << " > free send window " << freeWindow << ", wait for subflow " << (int) fast);
+      return fast;
+    }
+  return slow;
+}
+
+TypeId
+MpTcpSchedulerEcf::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MpTcpSchedulerEcf")
+    .SetParent<MpTcpSchedulerMinRtt> ()
+    .AddConstructor<MpTcpSchedulerEcf> ()
+    .AddAttribute ("Beta",
+                   "Hysteresis applied to the decision while waiting for the fastest subflow",
+                   DoubleValue (0.25),
+                   MakeDoubleAccessor (&MpTcpSchedulerEcf::m_beta),
+                   MakeDoubleChecker<double> (0))
+  ;
+  return tid;
+}
+
+MpTcpSchedulerEcf::MpTcpSchedulerEcf ()
+  : m_beta (0.25),
+    m_waiting (false)
+{
+}
+
+std::string
+MpTcpSchedulerEcf::GetName (void) const
+{
+  return "ECF";
+}
+
+Ptr<MpTcpScheduler>
+MpTcpSchedulerEcf::Copy (void) const
+{
+  return CopyObject<MpTcpSchedulerEcf> (this);
+}
+
+uint8_t
+MpTcpSchedulerEcf::PickSubflow (Ptr<MpTcpSocketBase> socket, const SubFlows &subflows, uint8_t fast, uint8_t slow)
+{
+  NS_LOG_FUNCTION (this << (int) fast << (int) slow);
+  if (slow == fast || slow == subflows.size ())
+    {
+      m_waiting = false;
+      return fast;
+    }
+  Ptr<MpTcpSubFlow> fFlow = subflows[fast];
+  Ptr<MpTcpSubFlow> sFlow = subflows[slow];
+  double rttF = fFlow->rtt->GetCurrentEstimate ().GetSeconds ();
+  double rttS = sFlow->rtt->GetCurrentEstimate ().GetSeconds ();
+  double delta = std::max (fFlow->rtt->GetVariance (), sFlow->rtt->GetVariance ()).GetSeconds ();
+  double k = (double) PendingData (socket) / fFlow->MSS;
+  double cwndF = std::max ((double) fFlow->cwnd.Get () / fFlow->MSS, 1.0);
+  double cwndS = std::max ((double) sFlow->cwnd.Get () / sFlow->MSS, 1.0);
+  double n = 1 + k / cwndF;
+
+  if (n * rttF < (1 + (m_waiting ? m_beta : 0)) * (rttS + delta))
+    {
+      if (k / cwndS * rttS >= 2 * rttF + delta)
+        {
+          NS_LOG_LOGIC ("ECF -> wait for subflow " << (int) fast << " pending segments " << k);
+          m_waiting = true;
+          return fast;
+        }
+    }
+  m_waiting = false;
+  return slow;
+}
+
+} // namespace ns3
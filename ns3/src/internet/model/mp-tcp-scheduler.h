@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MP_TCP_SCHEDULER_H
+#define MP_TCP_SCHEDULER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/mp-tcp-typedefs.h"
+#include "mp-tcp-subflow.h"
+
+namespace ns3 {
+
+class MpTcpSocketBase;
+
+/**
+ * \brief Scheduler of an MPTCP connection
+ *
+ * MpTcpSocketBase owns one scheduler, chosen by its SchedulerType (or
+ * SchedulingAlgorithm) attribute, and asks it on which subflow the next
+ * segment goes. The socket still checks the window of the subflow it gets
+ * and moves on to the next one if it is closed. A scheduler may return a
+ * subflow without window on purpose, to wait for it, and the socket then
+ * stops sending until the next ACK.
+ */
+class MpTcpScheduler : public Object
+{
+public:
+  typedef std::vector<Ptr<MpTcpSubFlow> > SubFlows;
+
+  static TypeId GetTypeId (void);
+  MpTcpScheduler ();
+  virtual ~MpTcpScheduler ();
+
+  virtual std::string GetName (void) const = 0;
+
+  /// Copy for a forked socket, its attributes and state included
+  virtual Ptr<MpTcpScheduler> Copy (void) const = 0;
+
+  /**
+   * \brief Subflow to send the next segment on
+   * \param socket The connection, for its windows and send buffer
+   * \param lastUsed Subflow the socket used or tried last
+   */
+  virtual uint8_t GetSubflowToUse (Ptr<MpTcpSocketBase> socket, const SubFlows &subflows, uint8_t lastUsed) = 0;
+
+  /// The socket asks before every segment, not only after it used a subflow
+  virtual bool IsRttAware (void) const;
+
+protected:
+  /// Bytes a subflow may send now, within its cwnd and the peer window
+  static uint32_t AvailableWindow (Ptr<MpTcpSocketBase> socket, uint8_t sFlowIdx);
+  /// Peer window of the connection, shared by all subflows
+  static uint32_t RemoteWindow (Ptr<MpTcpSocketBase> socket);
+  /// Unacknowledged bytes of all subflows
+  static uint32_t BytesInFlight (Ptr<MpTcpSocketBase> socket);
+  /// Bytes in the send buffer that were not sent yet
+  static uint32_t PendingData (Ptr<MpTcpSocketBase> socket);
+};
+
+/**
+ * \brief Every subflow in turn
+ */
+class MpTcpSchedulerRoundRobin : public MpTcpScheduler
+{
+public:
+  static TypeId GetTypeId (void);
+  MpTcpSchedulerRoundRobin ();
+
+  virtual std::string GetName (void) const;
+  virtual Ptr<MpTcpScheduler> Copy (void) const;
+  virtual uint8_t GetSubflowToUse (Ptr<MpTcpSocketBase> socket, const SubFlows &subflows, uint8_t lastUsed);
+};
+
+/**
+ * \brief The established subflow with the lowest smoothed RTT and free
+ * window
+ *
+ * Also the base of the schedulers that decide between the fastest subflow
+ * and the fastest one that has window, when they differ, in PickSubflow.
+ * As long as no subflow is established they rotate like round robin, so
+ * that the socket finds the first one that is.
+ */
+class MpTcpSchedulerMinRtt : public MpTcpScheduler
+{
+public:
+  static TypeId GetTypeId (void);
+  MpTcpSchedulerMinRtt ();
+
+  virtual std::string GetName (void) const;
+  virtual Ptr<MpTcpScheduler> Copy (void) const;
+  virtual uint8_t GetSubflowToUse (Ptr<MpTcpSocketBase> socket, const SubFlows &subflows, uint8_t lastUsed);
+  virtual bool IsRttAware (void) const;
+
+protected:
+  /**
+   * \param fast Established subflow with the lowest smoothed RTT
+   * \param slow Fastest subflow with free window, subflows.size () if none has
+   * \return slow, or fast to wait for it
+   */
+  virtual uint8_t PickSubflow (Ptr<MpTcpSocketBase> socket, const SubFlows &subflows, uint8_t fast, uint8_t slow);
+
+  /// Established subflow with the lowest smoothed RTT, subflows.size () if none
+  static uint8_t GetFastestSubflow (Ptr<MpTcpSocketBase> socket, const SubFlows &subflows, bool withWindow);
+};
+
+/**
+ * \brief Blocking estimation (Ferlin et al., 2016)
+ *
+ * Before sending on the slower subflow, estimates how many bytes the
+ * fastest subflow could send while one segment is in flight on the slower
+ * one,
+ *   X = MSS_f * (CWND_f + (rtt_s/rtt_f - 1) / 2) * rtt_s/rtt_f   (CWND_f in segments)
+ * and leaves the slower subflow idle if X does not fit into what remains
+ * of the peer window. Lambda is kept at 1.
+ */
+class MpTcpSchedulerBlest : public MpTcpSchedulerMinRtt
+{
+public:
+  static TypeId GetTypeId (void);
+  MpTcpSchedulerBlest ();
+
+  virtual std::string GetName (void) const;
+  virtual Ptr<MpTcpScheduler> Copy (void) const;
+
+protected:
+  virtual uint8_t PickSubflow (Ptr<MpTcpSocketBase> socket, const SubFlows &subflows, uint8_t fast, uint8_t slow);
+};
+
+/**
+ * \brief Earliest completion first (Lim et al., 2017)
+ *
+ * Sends on the slower subflow only if the data still queued would complete
+ * earlier that way than by waiting for the fastest subflow. With k
+ * segments pending, n = 1 + k / CWND_f, the fast subflow is waited for when
+ *   n * rtt_f < (1 + waiting * beta) * (rtt_s + delta)
+ * and the slower subflow would still be busy after two fast round trips,
+ *   k / CWND_s * rtt_s >= 2 * rtt_f + delta.
+ * Delta is the larger RTT deviation of the two and beta the hysteresis
+ * applied while waiting.
+ */
+class MpTcpSchedulerEcf : public MpTcpSchedulerMinRtt
+{
+public:
+  static TypeId GetTypeId (void);
+  MpTcpSchedulerEcf ();
+
+  virtual std::string GetName (void) const;
+  virtual Ptr<MpTcpScheduler> Copy (void) const;
+
+protected:
+  virtual uint8_t PickSubflow (Ptr<MpTcpSocketBase> socket, const SubFlows &subflows, uint8_t fast, uint8_t slow);
+
+private:
+  double m_beta;  //!< Hysteresis while waiting for the fastest subflow
+  bool m_waiting; //!< Decided to wait for the fastest subflow last time
+};
+
+} // namespace ns3
+
+#endif /* MP_TCP_SCHEDULER_H */
@@ -38,8 +38,8 @@
 #include "ns3/pointer.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/object-vector.h"
+#include "ns3/object-factory.h"
 
-//#define PLOT
 #define RAND_GAP
 
 NS_LOG_COMPONENT_DEFINE("MpTcpSocketBase");
@@ -68,11 +68,28 @@ MpTcpSocketBase::GetTypeId(void)
                           COUPLED_FULLY, "COUPLED_FULLY",
                           UNCOUPLED, "UNCOUPLED"))
 
+      .AddAttribute("CongestionControlType",
+                    "Congestion controller, any subclass of ns3::MpTcpCongestionControl such as ns3::MpTcpCongestionOlia; "
+                    "overrides CongestionControl unless left to the base class",
+          TypeIdValue(MpTcpCongestionControl::GetTypeId()),
+          MakeTypeIdAccessor(&MpTcpSocketBase::SetCongestionControlType),
+          MakeTypeIdChecker())
+
       .AddAttribute("SchedulingAlgorithm",
                     "Algorithm for data distribution between sub-flows",
           EnumValue(Round_Robin),
           MakeEnumAccessor(&MpTcpSocketBase::SetDataDistribAlgo),
-          MakeEnumChecker(Round_Robin, "Round_Robin"))
+          MakeEnumChecker(Round_Robin, "Round_Robin",
+                          Min_RTT,     "Min_RTT",
+                          BLEST,       "BLEST",
+                          ECF,         "ECF"))
+
+      .AddAttribute("SchedulerType",
+                    "Scheduler, any subclass of ns3::MpTcpScheduler such as ns3::MpTcpSchedulerEcf; "
+                    "overrides SchedulingAlgorithm unless left to the base class",
+          TypeIdValue(MpTcpScheduler::GetTypeId()),
+          MakeTypeIdAccessor(&MpTcpSocketBase::SetSchedulerType),
+          MakeTypeIdChecker())
 
       .AddAttribute("PathManagement",
                      "Mechanism for establishing new sub-flows",
@@ -88,6 +105,12 @@ MpTcpSocketBase::GetTypeId(void)
           MakeUintegerAccessor(&MpTcpSocketBase::maxSubflows),
           MakeUintegerChecker<uint8_t>())
 
+      .AddAttribute("UnOrderedMaxSize",
+                    "Maximum number of bytes held for out of sequence reassembly",
+          UintegerValue(50000000),
+          MakeUintegerAccessor(&MpTcpSocketBase::unOrdMaxSize),
+          MakeUintegerChecker<uint32_t>())
+
      .AddAttribute("RandomGap",
           "Random gap between subflows setup",
           UintegerValue(50),
@@ -105,6 +128,20 @@ MpTcpSocketBase::GetTypeId(void)
           MakeBooleanAccessor (&MpTcpSocketBase::m_shortFlowTCP),
           MakeBooleanChecker())
 
+      .AddAttribute ("WindowScaling",
+          "Negotiate the window scale option (RFC 7323) on the SYN of every subflow, "
+          "so the peer is not limited to 64 KB in flight",
+          BooleanValue (true),
+          MakeBooleanAccessor (&MpTcpSocketBase::m_winScaling),
+          MakeBooleanChecker())
+
+      .AddAttribute ("Sack",
+          "Negotiate selective acknowledgments (RFC 2018) on the SYN of every subflow and "
+          "recover from losses with the SACK scoreboard (RFC 6675) instead of NewReno",
+          BooleanValue (true),
+          MakeBooleanAccessor (&MpTcpSocketBase::m_sack),
+          MakeBooleanChecker())
+
       .AddAttribute ("AlphaPerAck", " Update alpha per ACK ",
           BooleanValue (false),
           MakeBooleanAccessor (&MpTcpSocketBase::m_alphaPerAck),
@@ -118,7 +155,38 @@ MpTcpSocketBase::GetTypeId(void)
       .AddAttribute ("LargePlotting", " Activate short flow plotting ",
           BooleanValue (false),
           MakeBooleanAccessor (&MpTcpSocketBase::m_largePlotting),
-          MakeBooleanChecker());
+          MakeBooleanChecker())
+
+      .AddAttribute ("TraceFile",
+          "Binary file to stream cwnd, RTT and segment events to, none if empty. "
+          "Connections using the same file share it. If ShortPlotting or LargePlotting "
+          "is set, only flows of that type are traced",
+          StringValue (""),
+          MakeStringAccessor (&MpTcpSocketBase::m_traceFile),
+          MakeStringChecker())
+
+      .AddAttribute ("TraceRingRecords",
+          "Keep only the last records in TraceFile (24 bytes each), 0 to keep all of them",
+          UintegerValue (0),
+          MakeUintegerAccessor (&MpTcpSocketBase::m_traceRingRecords),
+          MakeUintegerChecker<uint32_t> ())
+
+      .AddTraceSource("UnOrderedOccupancy",
+                      "Number of bytes waiting in the out of sequence buffer",
+          MakeTraceSourceAccessor(&MpTcpSocketBase::m_unOrdOccupancy))
+
+      .AddTraceSource("ReorderDistance",
+                      "Distance in bytes from nextRxSequence of each segment stored out of sequence",
+          MakeTraceSourceAccessor(&MpTcpSocketBase::m_reorderDistance))
+
+      .AddTraceSource("RecoveryTime",
+                      "Subflow index and time from the fast retransmission to the full ACK of each fast recovery",
+          MakeTraceSourceAccessor(&MpTcpSocketBase::m_recoveryTime))
+
+      .AddTraceSource("SpuriousRetransmission",
+                      "Subflow index, sequence number and length of a retransmitted segment the peer "
+                      "reported to have received twice (D-SACK, RFC 2883)",
+          MakeTraceSourceAccessor(&MpTcpSocketBase::m_spuriousRetx));
 
   return tid;
 }
@@ -148,7 +216,6 @@ MpTcpSocketBase::MpTcpSocketBase():
   segmentSize = 0;
   nextTxSequence = 1;
   nextRxSequence = 1;
-  //gnu.SetOutFile("allPlots.pdf");
   mod = 60;
   // --------------
   fLowStartTime = 0;
@@ -161,6 +228,7 @@ MpTcpSocketBase::MpTcpSocketBase():
   //TxBytes = 0;
   flowType = "NULL";
   outputFileName = "NULL";
+  m_traceConnection = 0;
 
   alpha = 1; // alpha is 1 by default
   _e = 1;    // epsilon 1 by default
@@ -249,14 +317,16 @@ MpTcpSocketBase::EstimateRtt(uint8_t sFlowIdx, const TcpHeader& mptcpHeader)
   NS_LOG_FUNCTION(this << (int)sFlowIdx);
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
   sFlow->lastMeasuredRtt = sFlow->rtt->AckSeq(mptcpHeader.GetAckNumber());
+  SubflowChanged(sFlowIdx);
   //sFlow->measuredRTT.insert(sFlow->measuredRTT.end(), sFlow->rtt->GetCurrentEstimate().GetSeconds());
 
   // Plotting
-#ifdef PLOT
-  sFlow->_RTT.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->lastMeasuredRtt.GetMilliSeconds()));
-  sFlow->_AvgRTT.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->rtt->GetCurrentEstimate().GetMilliSeconds()));
-  sFlow->_RTO.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->rtt->RetransmitTimeout().GetMilliSeconds()));
-#endif
+  if (IsTracing())
+    {
+      Trace(sFlowIdx, MpTcpTraceSink::RTT, sFlow->lastMeasuredRtt.GetMilliSeconds());
+      Trace(sFlowIdx, MpTcpTraceSink::AVG_RTT, sFlow->rtt->GetCurrentEstimate().GetMilliSeconds());
+      Trace(sFlowIdx, MpTcpTraceSink::RTO, sFlow->rtt->RetransmitTimeout().GetMilliSeconds());
+    }
 }
 
 /* Read options from incoming packets */
@@ -265,18 +335,16 @@ MpTcpSocketBase::ReadOptions(Ptr<Packet> pkt, const TcpHeader& mptcpHeader)
 { // Any packet without SYN and MP_CAPABLE is not being processed!
   NS_LOG_FUNCTION(this << mptcpHeader);
   NS_ASSERT(remoteToken == 0 && mpEnabled == false);
-  vector<TcpOptions*> mp_options = mptcpHeader.GetOptions();
   uint8_t flags = mptcpHeader.GetFlags();
-  TcpOptions *opt;
   bool hasSyn = flags & TcpHeader::SYN;
-  for (uint32_t j = 0; j < mp_options.size(); j++)
+  for (uint8_t j = 0; j < mptcpHeader.GetNOptions(); j++)
     {
-      opt = mp_options[j];
+      const TcpOptions *opt = &mptcpHeader.GetOption(j);
       if ((opt->optName == OPT_MPC) && hasSyn && (mpRecvState == MP_NONE))
         { // SYN+ACK would be send later on by ProcessSynRcvd(...)
           mpRecvState = MP_MPC;
           mpEnabled = true;
-          remoteToken = ((OptMultipathCapable *) opt)->senderToken;
+          remoteToken = opt->mpc.senderToken;
           if (remoteToken == 0)
             NS_ASSERT(remoteToken != 0); // Correct condition
           return true;
@@ -295,26 +363,23 @@ MpTcpSocketBase::ReadOptions(uint8_t sFlowIdx, Ptr<Packet> pkt, const TcpHeader&
 {
   NS_LOG_FUNCTION(this << (int)sFlowIdx << mptcpHeader);
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-  vector<TcpOptions*> options = mptcpHeader.GetOptions();
   uint8_t flags = mptcpHeader.GetFlags();
-  TcpOptions *opt;
   bool hasSyn = flags & TcpHeader::SYN;
   bool TxAddr = false;
-  for (uint32_t j = 0; j < options.size(); j++)
+  for (uint8_t j = 0; j < mptcpHeader.GetNOptions(); j++)
     {
-      opt = options[j];
+      const TcpOptions *opt = &mptcpHeader.GetOption(j);
       if ((opt->optName == OPT_MPC) && hasSyn && (mpRecvState == MP_NONE))
         { // SYN+ACK would be send later on by ProcessSynRcvd(...)
           mpRecvState = MP_MPC;
           mpEnabled = true;
-          remoteToken = ((OptMultipathCapable *) opt)->senderToken;
+          remoteToken = opt->mpc.senderToken;
           NS_ASSERT(remoteToken != 0);
           NS_ASSERT(client);
         }
       else if ((opt->optName == OPT_JOIN) && hasSyn)
         {
-          OptJoinConnection * optJoin = (OptJoinConnection *) opt;
-          if ((mpSendState == MP_ADDR) && (localToken == optJoin->receiverToken))
+          if ((mpSendState == MP_ADDR) && (localToken == opt->join.receiverToken))
             { // SYN+ACK would be send later on by ProcessSynRcvd(...)
               // Join option is sent over the path (couple of addresses) not already in use
               NS_LOG_UNCOND("Server receive new subflow!");
@@ -325,8 +390,8 @@ MpTcpSocketBase::ReadOptions(uint8_t sFlowIdx, Ptr<Packet> pkt, const TcpHeader&
           // Receiver store sender's addresses information and send back its addresses.
           // If there are several addresses to advertise then multiple OPT_ADDR would be attached to the TCP Options.
           MpTcpAddressInfo * addrInfo = new MpTcpAddressInfo();
-          addrInfo->addrID = ((OptAddAddress *) opt)->addrID;
-          addrInfo->ipv4Addr = ((OptAddAddress *) opt)->addr;
+          addrInfo->addrID = opt->addAddr.addrID;
+          addrInfo->ipv4Addr = Ipv4Address(opt->addAddr.addr);
           remoteAddrs.insert(remoteAddrs.end(), addrInfo);
           TxAddr = true;
         }
@@ -469,6 +534,7 @@ MpTcpSocketBase::CompleteFork(Ptr<Packet> p, const TcpHeader& mptcpHeader, const
   sFlow->dAddr = m_remoteAddress;
   sFlow->dPort = m_remotePort;   // TODO ? I guess m_remotePort would be used here!
   sFlow->MSS = segmentSize;
+  sFlow->ssthresh = m_ssThresh;
   sFlow->state = SYN_RCVD;
   sFlow->cnTimeout = m_cnTimeout;
   sFlow->cnRetries = m_cnRetries;
@@ -476,7 +542,10 @@ MpTcpSocketBase::CompleteFork(Ptr<Packet> p, const TcpHeader& mptcpHeader, const
   sFlow->m_endPoint = m_endPoint; // This is master subsock, its endpoint is the same as connection endpoint.
   NS_LOG_INFO ("("<< (int)sFlow->routeId<<") LISTEN -> SYN_RCVD");
   subflows.insert(subflows.end(), sFlow);
+  if (IsTracing())
+    sFlow->StartTracing(m_traceSink, m_traceConnection);
   sFlow->RxSeqNumber = (mptcpHeader.GetSequenceNumber()).GetValue() + 1; //Set the subflow sequence number and send SYN+ACK
+  ReadSynOptions(sFlow->routeId, mptcpHeader);
   NS_LOG_DEBUG("CompleteFork -> RxSeqNb: " << sFlow->RxSeqNumber << " highestAck: " << sFlow->highestAck);
   SendEmptyPacket(sFlow->routeId, TcpHeader::SYN | TcpHeader::ACK);
 
@@ -505,6 +574,7 @@ MpTcpSocketBase::ProcessListen(uint8_t sFlowIdx, Ptr<Packet> packet, const TcpHe
       sFlow->state = SYN_RCVD;
       sFlow->RxSeqNumber = (mptcpHeader.GetSequenceNumber()).GetValue() + 1;
       NS_ASSERT(sFlow->highestAck == mptcpHeader.GetAckNumber().GetValue());
+      ReadSynOptions(sFlowIdx, mptcpHeader);
       SendEmptyPacket(sFlowIdx, TcpHeader::SYN | TcpHeader::ACK);
     }
   else if (tcpflags == TcpHeader::ACK)
@@ -552,8 +622,7 @@ MpTcpSocketBase::ProcessSynSent(uint8_t sFlowIdx, Ptr<Packet> packet, const TcpH
         }NS_LOG_INFO("(" << sFlow->routeId << ") "<< TcpStateName[sFlow->state] << " -> ESTABLISHED");
       sFlow->state = ESTABLISHED;
       sFlow->retxEvent.Cancel();
-      if ((m_largePlotting && (flowType.compare("Large") == 0)) || (m_shortPlotting && (flowType.compare("Short") == 0)))
-        sFlow->StartTracing("cWindow");
+      ReadSynOptions(sFlowIdx, mptcpHeader);
       sFlow->rtt->Init(mptcpHeader.GetAckNumber());
       sFlow->initialSequnceNumber = (mptcpHeader.GetAckNumber().GetValue());
       NS_LOG_INFO("(" <<sFlow->routeId << ") InitialSeqNb of data packet should be --->>> " << sFlow->initialSequnceNumber << " Cwnd: " << sFlow->cwnd);
@@ -565,6 +634,7 @@ MpTcpSocketBase::ProcessSynSent(uint8_t sFlowIdx, Ptr<Packet> packet, const TcpH
       Time estimate;
       estimate = Seconds(1.5);
       sFlow->rtt->SetCurrentEstimate(estimate);
+      SubflowChanged(sFlowIdx);
 
       SendEmptyPacket(sFlowIdx, TcpHeader::ACK);
 
@@ -642,6 +712,7 @@ MpTcpSocketBase::ProcessSynRcvd(uint8_t sFlowIdx, Ptr<Packet> packet, const TcpH
       // NS_LOG_INFO ("flowid: " << sFlow << "| " << "unacked: " << bbb 
       //       << "| available ack: " << ccc << "\n"); //Vitalii
       sFlow->cwnd = sFlow->MSS; // Vitalii: If it's not initialized, the server won't transmit.
+      SubflowChanged(sFlowIdx);
       NS_ASSERT(sFlow->TxSeqNumber == mptcpHeader.GetAckNumber().GetValue());
 
       // Check MPTCP Connection status. If it is not yet ESTABLISHED then change it to true to indicate that.
@@ -841,27 +912,25 @@ MpTcpSocketBase::ReceivedData(uint8_t sFlowIdx, Ptr<Packet> p, const TcpHeader&
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
   uint32_t expectedSeq = sFlow->RxSeqNumber;
   //uint32_t Seq = mptcpHeader.GetSequenceNumber().GetValue();
-  vector<TcpOptions*> options = mptcpHeader.GetOptions();
-  TcpOptions* opt;
   bool stored = true;
-  for (uint32_t i = 0; i < options.size(); i++)
+  for (uint8_t i = 0; i < mptcpHeader.GetNOptions(); i++)
     {
-      opt = options[i];
-      if (opt->optName == OPT_DSN)
+      const TcpOptions &opt = mptcpHeader.GetOption(i);
+      if (opt.optName == OPT_DSN)
         {
-          OptDataSeqMapping* optDSN = (OptDataSeqMapping*) opt;
-          //NS_ASSERT(optDSN->subflowSeqNumber == Seq);
-          if (optDSN->subflowSeqNumber == sFlow->RxSeqNumber)
+          const TcpOptions *optDSN = &opt;
+          //NS_ASSERT(optDSN->dsn.subflowSeqNumber == Seq);
+          if (optDSN->dsn.subflowSeqNumber == sFlow->RxSeqNumber)
             { /* Received packet is in-sequence at sub-flow level. Now check connection level? */
-              if (optDSN->dataSeqNumber == nextRxSequence)
+              if (optDSN->dsn.dataSeqNumber == nextRxSequence)
                 {/** Received packet is in-sequence at connection level but (wtf? maybe "and"?) in-order at sub-flow level **/
-                  uint32_t amountRead = recvingBuffer.ReadPacket(p, optDSN->dataLevelLength);
+                  uint32_t amountRead = recvingBuffer.ReadPacket(p, optDSN->dsn.dataLevelLength);
                   if (amountRead == 0)
                     {
                       NS_FATAL_ERROR("I don't see any reason to trigger this condition, at least in current implementation");
                       return;
                     }
-                  NS_ASSERT(amountRead == optDSN->dataLevelLength && optDSN->dataLevelLength == p->GetSize());
+                  NS_ASSERT(amountRead == optDSN->dsn.dataLevelLength && optDSN->dsn.dataLevelLength == p->GetSize());
                   sFlow->RxSeqNumber += amountRead;
                   // Increasing it would not hurt but it is essential for MMPTCP
                   sFlow->highestAck = std::max(sFlow->highestAck, (mptcpHeader.GetAckNumber()).GetValue() - 1);
@@ -881,18 +950,18 @@ MpTcpSocketBase::ReceivedData(uint8_t sFlowIdx, Ptr<Packet> p, const TcpHeader&
                       return;
                     }
                 }
-              else if (optDSN->dataSeqNumber > nextRxSequence) // there is a gap in dataSeqNumber
+              else if (optDSN->dsn.dataSeqNumber > nextRxSequence) // there is a gap in dataSeqNumber
                 { /** Received packet is out of sequence at connection level 
                     but in-order at sub-flow level **/
 
                   stored = StoreUnOrderedData(
-                      new DSNMapping(sFlowIdx, optDSN->dataSeqNumber, optDSN->dataLevelLength, optDSN->subflowSeqNumber,
+                      DSNMapping(sFlowIdx, optDSN->dsn.dataSeqNumber, optDSN->dsn.dataLevelLength, optDSN->dsn.subflowSeqNumber,
                           mptcpHeader.GetAckNumber().GetValue(), p));
                   // For allowing sub-flow to progress, RxSeqNb should be advanced even though packet is not in-order of connection level.
                   if (stored)
                     {
-                      NS_ASSERT(optDSN->subflowSeqNumber == sFlow->RxSeqNumber);
-                      sFlow->RxSeqNumber += optDSN->dataLevelLength;
+                      NS_ASSERT(optDSN->dsn.subflowSeqNumber == sFlow->RxSeqNumber);
+                      sFlow->RxSeqNumber += optDSN->dsn.dataLevelLength;
                       sFlow->highestAck = std::max(sFlow->highestAck, (mptcpHeader.GetAckNumber()).GetValue() - 1);
 
                     }
@@ -901,26 +970,37 @@ MpTcpSocketBase::ReceivedData(uint8_t sFlowIdx, Ptr<Packet> p, const TcpHeader&
                 }
               else
                 { /** Received packet is duplicated in connection level! */
-                  NS_ASSERT(optDSN->dataSeqNumber < nextRxSequence);
+                  NS_ASSERT(optDSN->dsn.dataSeqNumber < nextRxSequence);
                   NS_FATAL_ERROR("This functionality is not yet implemented!");
                   NS_LOG_WARN(this << "Duplicated segment received at connection level so it should be rejected!");
                   SendEmptyPacket(sFlowIdx, TcpHeader::ACK);
                 }
             }
-          else if (optDSN->subflowSeqNumber > sFlow->RxSeqNumber)
+          else if (optDSN->dsn.subflowSeqNumber > sFlow->RxSeqNumber)
             { /* Received packet is out of order at sub-flow level */
               // This condition might occurs when a packet get drop...Does this condition mean that packet should be 
               // out of order at connection level? YES
-              NS_ASSERT(optDSN->dataSeqNumber > nextRxSequence);
-              StoreUnOrderedData(
-                  new DSNMapping(sFlowIdx, optDSN->dataSeqNumber, optDSN->dataLevelLength, optDSN->subflowSeqNumber,
-                      mptcpHeader.GetAckNumber().GetValue(), p));
+              NS_ASSERT(optDSN->dsn.dataSeqNumber > nextRxSequence);
+              bool duplicate = unOrdered.IsAhead(sFlowIdx, optDSN->dsn.subflowSeqNumber);
+              if (duplicate)
+                { // Already held, report it as a D-SACK block
+                  sFlow->dsackLeft = optDSN->dsn.subflowSeqNumber;
+                  sFlow->dsackRight = optDSN->dsn.subflowSeqNumber + optDSN->dsn.dataLevelLength;
+                }
+              if (duplicate || StoreUnOrderedData(
+                  DSNMapping(sFlowIdx, optDSN->dsn.dataSeqNumber, optDSN->dsn.dataLevelLength, optDSN->dsn.subflowSeqNumber,
+                      mptcpHeader.GetAckNumber().GetValue(), p)))
+                {
+                  sFlow->lastRcvdSeq = optDSN->dsn.subflowSeqNumber;
+                }
               SendEmptyPacket(sFlowIdx, TcpHeader::ACK); // We need to send ACK regardless of whether segment has 
                                                          //already stored in unOrdered or not!
             }
-          else if (optDSN->subflowSeqNumber < sFlow->RxSeqNumber)
+          else if (optDSN->dsn.subflowSeqNumber < sFlow->RxSeqNumber)
             { /* Received packet is duplicated at sub-flow level. It should be rejected!*/
-              NS_LOG_INFO("Data received is duplicated in Subflow Layer so it has been rejected! subflowSeq: " << optDSN->subflowSeqNumber << " dataSeq: " << optDSN->dataSeqNumber);
+              NS_LOG_INFO("Data received is duplicated in Subflow Layer so it has been rejected! subflowSeq: " << optDSN->dsn.subflowSeqNumber << " dataSeq: " << optDSN->dsn.dataSeqNumber);
+              sFlow->dsackLeft = optDSN->dsn.subflowSeqNumber;
+              sFlow->dsackRight = optDSN->dsn.subflowSeqNumber + optDSN->dsn.dataLevelLength;
               SendEmptyPacket(sFlowIdx, TcpHeader::ACK);  // Ask for next expected sub-flow sequence number to receive.
             }
           else
@@ -956,10 +1036,13 @@ MpTcpSocketBase::ReceivedAck(uint8_t sFlowIdx, Ptr<Packet> packet, const TcpHead
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
   uint32_t ack = (mptcpHeader.GetAckNumber()).GetValue();
 
-#ifdef PLOT
-  uint32_t tmp = ((ack - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->ACK.push_back(make_pair(Simulator::Now().GetSeconds(), tmp));
-#endif
+  if (IsTracing())
+    Trace(sFlowIdx, MpTcpTraceSink::ACK, ((ack - sFlow->initialSequnceNumber) / sFlow->MSS) % mod);
+
+  if ((mptcpHeader.GetFlags() & TcpHeader::ACK) && sFlow->sackEnabled)
+    { // Scoreboard first, so the dupACK or new ACK below sees what this ACK reports
+      ReadSack(sFlowIdx, mptcpHeader);
+    }
 
   // Stop execution if TCPheader is not ACK at all.
   if (0 == (mptcpHeader.GetFlags() & TcpHeader::ACK))
@@ -970,39 +1053,26 @@ MpTcpSocketBase::ReceivedAck(uint8_t sFlowIdx, Ptr<Packet> packet, const TcpHead
   else if (ack <= sFlow->highestAck + 1)
     {
       NS_LOG_LOGIC ("This acknowlegment" << mptcpHeader.GetAckNumber () << "do not ack the latest data in subflow level");
-      list<DSNMapping *>::iterator current = sFlow->mapDSN.begin();
-      list<DSNMapping *>::iterator next = sFlow->mapDSN.begin();
-      while (current != sFlow->mapDSN.end())
-        {
-          ++next;
-          DSNMapping *ptrDSN = *current;
-          // All segments before ackSeqNum should be removed from the mapDSN list.
-          if (ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength <= ack)
-            { // Optional task ...
-              //next = sFlow->mapDSN.erase(current);
-              //delete ptrDSN;
-            }
-          // There is a sent segment with subflowSN equal to ack but the ack is smaller than already receveid acked!
-          else if ((ptrDSN->subflowSeqNumber == ack) && (ack < sFlow->highestAck + 1))
-            { // Case 1: Old ACK, ignored.
-              NS_LOG_WARN ("Ignored ack of " << mptcpHeader.GetAckNumber());
-              NS_ASSERT(3!=3);
-              break;
+      // Segments before ackSeqNum are already discarded from mapDSN by NewAck, only the one at ack matters here.
+      DSNMapping *ptrDSN = sFlow->mapDSN.Find(ack);
+      // There is a sent segment with subflowSN equal to ack but the ack is smaller than already receveid acked!
+      if (ptrDSN != 0 && ack < sFlow->highestAck + 1)
+        { // Case 1: Old ACK, ignored.
+          NS_LOG_WARN ("Ignored ack of " << mptcpHeader.GetAckNumber());
+          NS_ASSERT(3!=3);
+        }
+      // There is a sent segment with requested SequenceNumber and ack is for first unacked byte!!
+      else if (ptrDSN != 0 && ack == sFlow->highestAck + 1)
+        { // Case 2: Potentially a duplicated ACK, so ack should be smaller than nextExpectedSN to send.
+          if (ack < sFlow->TxSeqNumber)
+            {
+              //NS_LOG_ERROR(Simulator::Now().GetSeconds()<< " [" << m_node->GetId()<< "] Duplicated ack received for SeqgNb: " << ack << " DUPACKs: " << sFlow->m_dupAckCount + 1);
+              DupAck(sFlowIdx, ptrDSN);
             }
-          // There is a sent segment with requested SequenceNumber and ack is for first unacked byte!!
-          else if ((ptrDSN->subflowSeqNumber == ack) && (ack == sFlow->highestAck + 1))
-            { // Case 2: Potentially a duplicated ACK, so ack should be smaller than nextExpectedSN to send.
-              if (ack < sFlow->TxSeqNumber)
-                {
-                  //NS_LOG_ERROR(Simulator::Now().GetSeconds()<< " [" << m_node->GetId()<< "] Duplicated ack received for SeqgNb: " << ack << " DUPACKs: " << sFlow->m_dupAckCount + 1);
-                  DupAck(sFlowIdx, ptrDSN);
-                  break;
-                }
-              // otherwise, the ACK is precisely equal to the nextTxSequence
+          else
+            { // otherwise, the ACK is precisely equal to the nextTxSequence
               NS_ASSERT(ack <= sFlow->TxSeqNumber);
-              break;
             }
-          current = next;
         }
     }
   else if (ack > sFlow->highestAck + 1)
@@ -1056,21 +1126,15 @@ MpTcpSocketBase::SendDataPacket(uint8_t sFlowIdx, uint32_t size, bool withAck)
    */
   if (sFlow->maxSeqNb > sFlow->TxSeqNumber -1)
     {
-      uint32_t IterNumber = 0;
-      for (list<DSNMapping *>::iterator it = sFlow->mapDSN.begin(); (it != sFlow->mapDSN.end() && guard == false); ++it)
-        { // Look for match a segment from subflow's buffer where it is matched with TxSeqNumber
-          IterNumber++;
-          DSNMapping * ptr = *it;
-          if (ptr->subflowSeqNumber == sFlow->TxSeqNumber)
-            {
-              // NS_FATAL_ERROR ("VITALII: timeout");
-              ptrDSN = ptr;
-              p = Create<Packet>(ptrDSN->dataLevelLength);
-              packetSize = ptrDSN->dataLevelLength;
-              guard = true;
-              NS_LOG_LOGIC(Simulator::Now().GetSeconds() <<" A segment matched from subflow buffer. Its size is "<< packetSize << " IterNumInMapDSN: " << IterNumber <<" maxSeqNb: " << sFlow->maxSeqNb << " TxSeqNb: " << sFlow->TxSeqNumber << " FastRecovery: " << sFlow->m_inFastRec << " SegNb: " << ptrDSN->subflowSeqNumber); //
-              break;
-            }
+      // Look for match a segment from subflow's buffer where it is matched with TxSeqNumber
+      DSNMapping * ptr = sFlow->mapDSN.Find(sFlow->TxSeqNumber);
+      if (ptr != 0)
+        {
+          ptrDSN = ptr;
+          p = ptrDSN->payload->Copy();
+          packetSize = ptrDSN->dataLevelLength;
+          guard = true;
+          NS_LOG_LOGIC(Simulator::Now().GetSeconds() <<" A segment matched from subflow buffer. Its size is "<< packetSize << " maxSeqNb: " << sFlow->maxSeqNb << " TxSeqNb: " << sFlow->TxSeqNumber << " FastRecovery: " << sFlow->m_inFastRec << " SegNb: " << ptrDSN->subflowSeqNumber); //
         }
       if (p == 0)
         {
@@ -1139,7 +1203,7 @@ MpTcpSocketBase::SendDataPacket(uint8_t sFlowIdx, uint32_t size, bool withAck)
   header.SetAckNumber(SequenceNumber32(sFlow->RxSeqNumber));
   header.SetSourcePort(sFlow->sPort);
   header.SetDestinationPort(sFlow->dPort);
-  header.SetWindowSize(AdvertisedWindowSize());
+  header.SetWindowSize(WindowField(sFlowIdx, header.GetFlags()));
   if (!guard)
     { // If packet is made from sendingBuffer, then we got to add the packet and its info to subflow's mapDSN.
       sFlow->AddDSNMapping(sFlowIdx, nextTxSequence, packetSize, sFlow->TxSeqNumber, sFlow->RxSeqNumber, p->Copy());
@@ -1199,16 +1263,16 @@ MpTcpSocketBase::SendDataPacket(uint8_t sFlowIdx, uint32_t size, bool withAck)
   if (!guard)
     sFlow->PktCount++;
 
-#ifdef PLOT
-  uint32_t tmp = (((sFlow->TxSeqNumber + packetSize) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->DATA.push_back(make_pair(Simulator::Now().GetSeconds(), tmp));
-#endif
+  if (IsTracing())
+    Trace(sFlowIdx, MpTcpTraceSink::DATA, (((sFlow->TxSeqNumber + packetSize) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod);
 
   NS_LOG_LOGIC(Simulator::Now().GetSeconds() << " ["<< m_node->GetId()<< "] SendDataPacket->  " << header <<" dSize: " << packetSize<< " sFlow: " << sFlow->routeId);
 
   // Do some updates.....
   sFlow->rtt->SentSeq(SequenceNumber32(sFlow->TxSeqNumber), packetSize); // Notify the RTT of a data packet sent
   sFlow->TxSeqNumber += packetSize; // Update subflow's nextSeqNum to send.
+  if (sFlow->m_inFastRec && sFlow->sackEnabled)
+    sFlow->pipe += packetSize;
   sFlow->maxSeqNb = std::max(sFlow->maxSeqNb, sFlow->TxSeqNumber - 1);
   if (!guard)
     {
@@ -1327,15 +1391,14 @@ MpTcpSocketBase::DoRetransmit(uint8_t sFlowIdx)
   NS_ASSERT(ptrDSN->subflowSeqNumber == sFlow->highestAck +1);
 
   // we retransmit only one lost pkt
-  //Ptr<Packet> pkt = Create<Packet>(ptrDSN->packet, ptrDSN->dataLevelLength);
-  Ptr<Packet> pkt = Create<Packet>(ptrDSN->dataLevelLength);
+  Ptr<Packet> pkt = ptrDSN->payload->Copy();
   TcpHeader header;
   header.SetSourcePort(sFlow->sPort);
   header.SetDestinationPort(sFlow->dPort);
   header.SetFlags(TcpHeader::NONE);  // Change to NONE Flag
   header.SetSequenceNumber(SequenceNumber32(ptrDSN->subflowSeqNumber));
   header.SetAckNumber(SequenceNumber32(sFlow->RxSeqNumber));  // for the acknowledgment, we ACK the sFlow last received data
-  header.SetWindowSize(AdvertisedWindowSize());
+  header.SetWindowSize(WindowField(sFlowIdx, header.GetFlags()));
 
   header.AddOptDSN(OPT_DSN, ptrDSN->dataSeqNumber, ptrDSN->dataLevelLength, ptrDSN->subflowSeqNumber);
 
@@ -1355,14 +1418,8 @@ MpTcpSocketBase::DoRetransmit(uint8_t sFlowIdx)
   SetReTxTimeout(sFlowIdx);
 
 
-#ifdef PLOT
-  uint32_t tmp = (((ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->RETRANSMIT.push_back(make_pair(Simulator::Now().GetSeconds(), tmp));
-  if (!sFlow->m_inFastRec)
-    {
-      timeOutTrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
-    }
-#endif
+  if (IsTracing())
+    Trace(sFlowIdx, MpTcpTraceSink::RETRANSMIT, (((ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod);
 
   //TxBytes += ptrDSN->dataLevelLength + 62;
 
@@ -1386,8 +1443,7 @@ MpTcpSocketBase::DoRetransmit(uint8_t sFlowIdx, DSNMapping* ptrDSN)
   SetReTxTimeout(sFlowIdx); // reset RTO
 
   // we retransmit only one lost pkt
-  //Ptr<Packet> pkt = Create<Packet>(ptrDSN->packet, ptrDSN->dataLevelLength);
-  Ptr<Packet> pkt = Create<Packet>(ptrDSN->dataLevelLength);
+  Ptr<Packet> pkt = ptrDSN->payload->Copy();
   if (pkt == 0)
     NS_ASSERT(3!=3);
 
@@ -1397,7 +1453,7 @@ MpTcpSocketBase::DoRetransmit(uint8_t sFlowIdx, DSNMapping* ptrDSN)
   header.SetFlags(TcpHeader::NONE);  // Change to NONE Flag
   header.SetSequenceNumber(SequenceNumber32(ptrDSN->subflowSeqNumber));
   header.SetAckNumber(SequenceNumber32(sFlow->RxSeqNumber));
-  header.SetWindowSize(AdvertisedWindowSize());
+  header.SetWindowSize(WindowField(sFlowIdx, header.GetFlags()));
   // Make sure info here comes from ptrDSN...
   header.AddOptDSN(OPT_DSN, ptrDSN->dataSeqNumber, ptrDSN->dataLevelLength, ptrDSN->subflowSeqNumber);
 
@@ -1414,15 +1470,15 @@ MpTcpSocketBase::DoRetransmit(uint8_t sFlowIdx, DSNMapping* ptrDSN)
 
   // Send Segment to lower layer
   m_tcp->SendPacket(pkt, header, sFlow->sAddr, sFlow->dAddr, FindOutputNetDevice(sFlow->sAddr));
-#ifdef PLOT
-  uint32_t tmp = (((ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->RETRANSMIT.push_back(make_pair(Simulator::Now().GetSeconds(), tmp));
-#endif
+  if (IsTracing())
+    Trace(sFlowIdx, MpTcpTraceSink::RETRANSMIT, (((ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod);
 
   //TxBytes += ptrDSN->dataLevelLength + 62;
 
   // Notify RTT
   sFlow->rtt->SentSeq(SequenceNumber32(ptrDSN->subflowSeqNumber), ptrDSN->dataLevelLength);
+  if (sFlow->m_inFastRec && sFlow->sackEnabled)
+    sFlow->pipe += ptrDSN->dataLevelLength;
 
   // In case of RTO, advance m_nextTxSequence
   sFlow->TxSeqNumber = std::max(sFlow->TxSeqNumber, ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength);
@@ -1436,24 +1492,89 @@ void
 MpTcpSocketBase::DiscardUpTo(uint8_t sFlowIdx, uint32_t ack)
 {
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-  list<DSNMapping *>::iterator current = sFlow->mapDSN.begin();
-  list<DSNMapping *>::iterator next = sFlow->mapDSN.begin();
-  while (current != sFlow->mapDSN.end())
+  sFlow->mapDSN.DiscardUpTo(ack);
+}
+
+/*
+ * Marks the segments of mapDSN that the SACK blocks of an ACK cover. A first block below the
+ * cumulative ACK or within another block is a D-SACK (RFC 2883): the peer got that segment twice.
+ */
+void
+MpTcpSocketBase::ReadSack(uint8_t sFlowIdx, const TcpHeader& mptcpHeader)
+{
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  uint32_t ack = mptcpHeader.GetAckNumber().GetValue();
+  for (uint8_t i = 0; i < mptcpHeader.GetNOptions(); i++)
     {
-      ++next;
-      DSNMapping *ptrDSN = *current;
-      // All segments before ackSeqNum should be removed from the mapDSN list. Maybe equal part never run due to if condition above.
-      if (ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength <= ack)
+      const TcpOptions &opt = mptcpHeader.GetOption(i);
+      if (opt.optName != OPT_SACK)
+        continue;
+      for (uint8_t k = 0; k < opt.sack.nBlocks; k++)
         {
-//          if (sFlowIdx == 0)
-//            NS_LOG_UNCOND("DiscardUp-> SeqNb: " << ptrDSN->subflowSeqNumber << " DSNMappingSize: " << sFlow->mapDSN.size() - 1 << " Subflow(" << (int)sFlow->routeId << ")");
-          //delete ptrDSN->packet;
-          //ptrDSN->packet = 0;
-          next = sFlow->mapDSN.erase(current);
-          // delete[] ptrDSN->payload;
-          delete ptrDSN;
+          uint32_t left = opt.sack.left[k];
+          uint32_t right = opt.sack.right[k];
+          bool dsack = (k == 0 && right <= ack);
+          for (uint8_t j = 1; k == 0 && j < opt.sack.nBlocks && !dsack; j++)
+            dsack = (left >= opt.sack.left[j] && right <= opt.sack.right[j]);
+          if (dsack)
+            {
+              NS_LOG_INFO("(" << (int)sFlowIdx << ") D-SACK " << left << "-" << right << ", the retransmission was spurious");
+              m_spuriousRetx(sFlowIdx, left, right - left);
+              continue;
+            }
+          sFlow->mapDSN.MarkSacked(left, right);
         }
-      current = next;
+    }
+}
+
+/*
+ * RFC 6675 SetPipe(): every sent segment that is neither SACKed nor lost is in the network, and so
+ * is the retransmission of every segment up to HighRxt.
+ */
+uint32_t
+MpTcpSocketBase::SetPipe(uint8_t sFlowIdx)
+{
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  uint32_t lostBelow = 0;
+  bool lost = sFlow->mapDSN.LossBoundary(sFlow->m_retxThresh, lostBelow);
+  uint32_t pipe = 0;
+  for (DSNMappingTable::iterator it = sFlow->mapDSN.begin();
+      it != sFlow->mapDSN.end() && (*it)->subflowSeqNumber < sFlow->TxSeqNumber; ++it)
+    {
+      DSNMapping* ptrDSN = *it;
+      if (ptrDSN->sacked)
+        continue;
+      if (!lost || ptrDSN->subflowSeqNumber >= lostBelow)
+        pipe += ptrDSN->dataLevelLength;
+      if (ptrDSN->subflowSeqNumber <= sFlow->highRxt)
+        pipe += ptrDSN->dataLevelLength;
+    }
+  sFlow->pipe = pipe;
+  return pipe;
+}
+
+/*
+ * RFC 6675 NextSeg() rule 1: retransmit, in sequence order, the segments above HighRxt that
+ * are lost and not SACKed while cwnd leaves room for a segment over the pipe. New data
+ * (rule 2) is left to SendPendingData(), which uses the pipe as the data in flight.
+ */
+void
+MpTcpSocketBase::RetransmitLost(uint8_t sFlowIdx)
+{
+  NS_LOG_FUNCTION(this << (int)sFlowIdx);
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  SetPipe(sFlowIdx);
+  uint32_t lostBelow = 0;
+  if (!sFlow->mapDSN.LossBoundary(sFlow->m_retxThresh, lostBelow))
+    return;
+  for (DSNMappingTable::iterator it = sFlow->mapDSN.begin();
+      it != sFlow->mapDSN.end() && (*it)->subflowSeqNumber < lostBelow && sFlow->cwnd.Get() >= sFlow->pipe + sFlow->MSS; ++it)
+    {
+      DSNMapping* ptrDSN = *it;
+      if (ptrDSN->sacked || ptrDSN->subflowSeqNumber <= sFlow->highRxt)
+        continue;
+      DoRetransmit(sFlowIdx, ptrDSN); // adds the segment to the pipe
+      sFlow->highRxt = ptrDSN->subflowSeqNumber;
     }
 }
 
@@ -1502,7 +1623,12 @@ Ptr<TcpSocketBase>
 MpTcpSocketBase::Fork(void)
 {
   NS_LOG_FUNCTION_NOARGS();
-  return CopyObject<MpTcpSocketBase>(this);
+  Ptr<MpTcpSocketBase> sock = CopyObject<MpTcpSocketBase>(this);
+  // The controller keeps per-connection state, a fork must not share it with the listener
+  if (m_congestionControl != 0)
+    sock->m_congestionControl = m_congestionControl->Copy();
+  sock->m_scheduler = m_scheduler->Copy();
+  return sock;
 }
 
 /** Cut cwnd and enter fast recovery mode upon triple dupack */
@@ -1575,15 +1701,19 @@ MpTcpSocketBase::Connect(Ipv4Address servAddr, uint16_t servPort)
   sFlow->sAddr = m_endPoint->GetLocalAddress();
   sFlow->sPort = m_endPoint->GetLocalPort();
   sFlow->MSS = segmentSize;
+  sFlow->ssthresh = m_ssThresh;
   sFlow->cwnd = sFlow->MSS;
   NS_LOG_UNCOND ("Connect -> SegmentSize: " << sFlow->MSS << " tcpSegmentSize: " << m_segmentSize << " segmentSize: " << segmentSize << "SendingBufferSize: " << sendingBuffer.bufMaxSize);
 
   // This is master subsocket (master subflow) then its endpoint is the same as connection endpoint.
   sFlow->m_endPoint = m_endPoint;
   subflows.insert(subflows.end(), sFlow);
+  if (IsTracing())
+    sFlow->StartTracing(m_traceSink, m_traceConnection);
 //  m_tcp->m_sockets.push_back(this); //TMP REMOVE
 
   sFlow->rtt->Reset(); // Dangerous ?!?!?! Not really?
+  SubflowChanged(subflows.size() - 1);
   sFlow->cnTimeout = m_cnTimeout;
   sFlow->cnRetries = m_cnRetries;
   sFlow->cnCount = sFlow->cnRetries;
@@ -1728,6 +1858,13 @@ MpTcpSocketBase::FillBuffer(uint8_t* data, uint32_t size)
   return sendingBuffer.AddRealData(data, size);
 }
 
+int
+MpTcpSocketBase::FillBuffer(Ptr<Packet> pkt)
+{
+  NS_LOG_FUNCTION(this << pkt->GetSize());
+  return sendingBuffer.AddPacket(pkt);
+}
+
 /**
  * Sending data via subflows with available window size. It sends data only to ESTABLISHED subflows.
  * It sends data by calling SendDataPacket() function.
@@ -1782,6 +1919,9 @@ MpTcpSocketBase::SendPendingData(uint8_t sFlowIdx)
   while (!sendingBuffer.Empty())
     {
       uint32_t window = 0;
+      // Rtt aware schedulers decide on the current state of the subflows, not on the last one used
+      if (m_scheduler->IsRttAware())
+        lastUsedsFlowIdx = getSubflowToUse();
       // Search for a subflow with available windows
       for (uint32_t i = 0; i < subflows.size(); i++)
         {
@@ -1842,16 +1982,7 @@ uint8_t
 MpTcpSocketBase::getSubflowToUse()
 {
   NS_LOG_FUNCTION(this);
-  uint8_t nextSubFlow = 0;
-  switch (distribAlgo)
-    {
-  case Round_Robin:
-    nextSubFlow = (lastUsedsFlowIdx + 1) % subflows.size();
-    break;
-  default:
-    break;
-    }
-  return nextSubFlow;
+  return m_scheduler->GetSubflowToUse(this, subflows, lastUsedsFlowIdx);
 }
 
 /**
@@ -1895,58 +2026,66 @@ MpTcpSocketBase::ReduceCWND(uint8_t sFlowIdx, DSNMapping* ptrDSN)
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
   uint32_t mss = sFlow->MSS;
   int d = 0;
-  calculateTotalCWND();
 
-  switch (AlgoCC)
+  if (m_congestionControl != 0)
     {
-  case Uncoupled_TCPs:
-  case Linked_Increases:
-  case RTT_Compensator:
-  case COUPLED_INC:
-  case COUPLED_EPSILON:
-  case UNCOUPLED:
-    sFlow->ssthresh = std::max(2 * mss, BytesInFlight(sFlowIdx) / 2);
-    sFlow->cwnd = sFlow->ssthresh + 3 * mss;
-    break;
-
-  case COUPLED_SCALABLE_TCP:
-      d = (int) sFlow->cwnd.Get() - (compute_total_window() >> 3);
-      if (d < 0)
-        d = 0;
-      sFlow->ssthresh = max(2 * mss, (uint32_t) d);
+      sFlow->ssthresh = m_congestionControl->GetSsThresh(subflows, sFlowIdx, BytesInFlight(sFlowIdx));
       sFlow->cwnd = sFlow->ssthresh + 3 * mss;
-      break;
-
-  case COUPLED_FULLY:
-    d = (int) sFlow->cwnd.Get() - compute_total_window() / B_MP;
-    if (d < 0)
-      d = 0;
-    sFlow->ssthresh = max(2 * mss, (uint32_t) d);
-    sFlow->cwnd = sFlow->ssthresh + 3 * mss;
-    break;
+    }
+  else
+    {
+      switch (AlgoCC)
+        {
+      case COUPLED_INC:
+      case COUPLED_EPSILON:
+      case UNCOUPLED:
+        sFlow->ssthresh = std::max(2 * mss, BytesInFlight(sFlowIdx) / 2);
+        sFlow->cwnd = sFlow->ssthresh + 3 * mss;
+        break;
 
-  case Fully_Coupled:
-    d = sFlow->cwnd.Get() - totalCwnd / 2;
-    if (d < 0)
-      d = 0;
-    sFlow->ssthresh = std::max(2 * mss, (uint32_t) d);
-    sFlow->cwnd = sFlow->ssthresh + 3 * mss;
-    break;
+      case COUPLED_SCALABLE_TCP:
+          d = (int) sFlow->cwnd.Get() - (compute_total_window() >> 3);
+          if (d < 0)
+            d = 0;
+          sFlow->ssthresh = max(2 * mss, (uint32_t) d);
+          sFlow->cwnd = sFlow->ssthresh + 3 * mss;
+          break;
 
-  default:
-    NS_ASSERT(3!=3);
-    break;
+      case COUPLED_FULLY:
+        d = (int) sFlow->cwnd.Get() - compute_total_window() / B_MP;
+        if (d < 0)
+          d = 0;
+        sFlow->ssthresh = max(2 * mss, (uint32_t) d);
+        sFlow->cwnd = sFlow->ssthresh + 3 * mss;
+        break;
+
+      default:
+        NS_ASSERT(3!=3);
+        break;
+        }
     }
   // update
   sFlow->m_recover = SequenceNumber32(sFlow->maxSeqNb + 1);
   sFlow->m_inFastRec = true;
+  sFlow->recoveryStart = Simulator::Now();
+  if (sFlow->sackEnabled)
+    { // RFC 6675: no window inflation, the pipe clocks out what is sent during the recovery
+      sFlow->cwnd = sFlow->ssthresh;
+      sFlow->highRxt = ptrDSN->subflowSeqNumber;
+    }
+  SubflowChanged(sFlowIdx);
 
   // Retrasnmit a specific packet (lost segment)
   DoRetransmit(sFlowIdx, ptrDSN);
-#ifdef PLOT
-  reTxTrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
-  sFlow->ssthreshtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->ssthresh));
-#endif
+  if (sFlow->sackEnabled)
+    RetransmitLost(sFlowIdx);
+}
+
+void
+MpTcpSocketBase::SubflowChanged(uint8_t sFlowIdx)
+{
+  if (m_congestionControl != 0)
+    m_congestionControl->SubflowChanged(sFlowIdx);
 }
 
 /** Retransmit timeout */
@@ -1962,18 +2101,21 @@ MpTcpSocketBase::Retransmit(uint8_t sFlowIdx)
   // TCP back to slow start
   sFlow->ssthresh = std::max(2 * sFlow->MSS, BytesInFlight(sFlowIdx) / 2);
   sFlow->cwnd = sFlow->MSS; //  sFlow->cwnd = 1.0;
+  SubflowChanged(sFlowIdx);
   sFlow->TxSeqNumber = sFlow->highestAck + 1; // m_nextTxSequence = m_txBuffer.HeadSequence(); // Restart from highest Ack
+  sFlow->mapDSN.ClearSacked(); // RFC 2018: the peer may have discarded what it SACKed
   // TODO TEMP
   //if (!(sendingBuffer->Empty() && sFlow->mapDSN.size() > 0))
   sFlow->rtt->IncreaseMultiplier();  // Double the next RTO
 
-  if (AlgoCC >= COUPLED_EPSILON)
-      window_changed();
+  if (m_congestionControl != 0)
+    m_congestionControl->Timeout(subflows, sFlowIdx);
+  else if (AlgoCC >= COUPLED_EPSILON)
+    window_changed();
 
   DoRetransmit(sFlowIdx);  // Retransmit the packet
-#ifdef PLOT
-  sFlow->_TimeOut.push_back(make_pair(Simulator::Now().GetSeconds(), TimeScale));
-#endif
+  if (IsTracing())
+    Trace(sFlowIdx, MpTcpTraceSink::TIMEOUT, sFlow->cwnd);
   TimeOuts++;
   // rfc 3782 - Recovering from timeOut
   //sFlow->m_recover = SequenceNumber32(sFlow->maxSeqNb + 1);
@@ -1993,35 +2135,13 @@ MpTcpSocketBase::SetReTxTimeout(uint8_t sFlowIdx)
 DSNMapping*
 MpTcpSocketBase::getAckedSegment(uint8_t sFlowIdx, uint32_t ack)
 {
-  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-  DSNMapping* ptrDSN = 0;
-  for (list<DSNMapping *>::iterator it = sFlow->mapDSN.begin(); it != sFlow->mapDSN.end(); ++it)
-    {
-      DSNMapping* dsn = *it;
-      if (dsn->subflowSeqNumber + dsn->dataLevelLength == ack)
-        {
-          ptrDSN = dsn;
-          break;
-        }
-    }
-  return ptrDSN;
+  return subflows[sFlowIdx]->mapDSN.FindEndingAt(ack);
 }
 
 DSNMapping*
 MpTcpSocketBase::getSegmentOfACK(uint8_t sFlowIdx, uint32_t ack)
 {
-  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-  DSNMapping* ptrDSN = 0;
-  for (list<DSNMapping *>::iterator it = sFlow->mapDSN.begin(); it != sFlow->mapDSN.end(); ++it)
-    {
-      DSNMapping* dsn = *it;
-      if (dsn->subflowSeqNumber == ack)
-        {
-          ptrDSN = dsn;
-          break;
-        }
-    }
-  return ptrDSN;
+  return subflows[sFlowIdx]->mapDSN.Find(ack);
 }
 void
 MpTcpSocketBase::NewAckNewReno(uint8_t sFlowIdx, const TcpHeader& mptcpHeader, TcpOptions* opt)
@@ -2033,18 +2153,32 @@ MpTcpSocketBase::NewAckNewReno(uint8_t sFlowIdx, const TcpHeader& mptcpHeader, T
 
   NS_LOG_LOGIC ("TcpNewReno receieved ACK for seq " << ack <<" cwnd " << sFlow->cwnd <<" ssthresh " << sFlow->ssthresh);
   // Check for exit condition of fast recovery
-  if (sFlow->m_inFastRec && ack < sFlow->m_recover)
+  if (sFlow->m_inFastRec && ack < sFlow->m_recover && sFlow->sackEnabled)
+    { // Partial ACK in SACK recovery (RFC 6675): no window deflation, the scoreboard tells what to retransmit
+      DiscardUpTo(sFlowIdx, ack.GetValue());
+      DSNMapping* ptrDSN = getSegmentOfACK(sFlowIdx, ack.GetValue());
+      if (ptrDSN != 0 && !ptrDSN->sacked && ptrDSN->subflowSeqNumber > sFlow->highRxt)
+        { // As in NewReno the segment at a partial ACK is lost, even with less than DupThresh segments SACKed above it
+          DoRetransmit(sFlowIdx, ptrDSN);
+          sFlow->highRxt = ptrDSN->subflowSeqNumber;
+        }
+      RetransmitLost(sFlowIdx);
+      if (IsTracing())
+        Trace(sFlowIdx, MpTcpTraceSink::FR_PARTIAL_ACK, sFlow->cwnd);
+      NewACK(sFlowIdx, mptcpHeader, opt); // update m_nextTxSequence and send new data if allowed by the pipe
+      pAck++;
+      return;
+    }
+  else if (sFlow->m_inFastRec && ack < sFlow->m_recover)
     { // Partial ACK, partial window deflation (RFC2582 sec.3 bullet #5 paragraph 3)
       NS_LOG_WARN("NewAckNewReno -> ");
       sFlow->cwnd -= ack.GetValue() - (sFlow->highestAck + 1); // data bytes where acked
       // RFC3782 sec.5, partialAck condition for inflating.
       sFlow->cwnd += sFlow->MSS; // increase cwnd
-#ifdef PLOT
+      SubflowChanged(sFlowIdx);
       NS_LOG_LOGIC ("Partial ACK in fast recovery: cwnd set to " << sFlow->cwnd.Get());
-      PartialAck.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd.Get()));
-      sFlow->ssthreshtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->ssthresh));
-      sFlow->_FR_PA.push_back(make_pair(Simulator::Now().GetSeconds(), TimeScale));
-#endif
+      if (IsTracing())
+        Trace(sFlowIdx, MpTcpTraceSink::FR_PARTIAL_ACK, sFlow->cwnd);
       DiscardUpTo(sFlowIdx, ack.GetValue());
       DSNMapping* ptrDSN = getSegmentOfACK(sFlowIdx, ack.GetValue());
       NS_ASSERT(ptrDSN != 0);
@@ -2062,12 +2196,11 @@ MpTcpSocketBase::NewAckNewReno(uint8_t sFlowIdx, const TcpHeader& mptcpHeader, T
 
       // Exit from Fast recovery
       sFlow->m_inFastRec = false;
+      SubflowChanged(sFlowIdx);
+      m_recoveryTime(sFlowIdx, Simulator::Now() - sFlow->recoveryStart);
       FullAcks++;
-#ifdef PLOT
-      FullAck.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd.Get()));
-      sFlow->ssthreshtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->ssthresh));
-      sFlow->_FR_FA.push_back(make_pair(Simulator::Now().GetSeconds(), TimeScale));
-#endif
+      if (IsTracing())
+        Trace(sFlowIdx, MpTcpTraceSink::FR_FULL_ACK, sFlow->cwnd);
     }
 
   if (!(sFlow->mapDSN.size() == 0 && sendingBuffer.Empty() && sFlow->state == FIN_WAIT_1))
@@ -2156,7 +2289,7 @@ MpTcpSocketBase::SendEmptyPacket(uint8_t sFlowIdx, uint8_t flags)
   header.SetFlags(flags);
   header.SetSequenceNumber(s);
   header.SetAckNumber(SequenceNumber32(sFlow->RxSeqNumber));
-  header.SetWindowSize(AdvertisedWindowSize());
+  header.SetWindowSize(WindowField(sFlowIdx, flags));
 
   bool hasSyn = flags & TcpHeader::SYN;
   bool hasFin = flags & TcpHeader::FIN;
@@ -2190,6 +2323,12 @@ MpTcpSocketBase::SendEmptyPacket(uint8_t sFlowIdx, uint8_t flags)
           RTO = Seconds(sFlow->cnTimeout.GetSeconds() * backoffCount);
           sFlow->cnCount = sFlow->cnCount - 1;
           NS_LOG_UNCOND(Simulator::Now().GetSeconds() << " ["<< m_node->GetId() << "] ("<< (int)sFlow->routeId<< ") " << flowType << " SendEmptyPacket -> backoffCount: " << backoffCount << " RTO: " << RTO.GetSeconds() << " cnTimeout: " << sFlow->cnTimeout.GetSeconds() <<" cnCount: "<< sFlow->cnCount);
+          if (flags & TcpHeader::ACK)
+            { // Time the SYN/ACK so that the passive side has an RTT sample before its first data ACK (a resent SYN/ACK is not sampled)
+              if (sFlow->cnCount == sFlow->cnRetries - 1)
+                sFlow->rtt->Init(s);
+              sFlow->rtt->SentSeq(s, 1);
+            }
         }
     }
   if (((sFlow->state == SYN_SENT) || (sFlow->state == SYN_RCVD && mpEnabled == true)) && mpSendState == MP_NONE)
@@ -2216,6 +2355,37 @@ MpTcpSocketBase::SendEmptyPacket(uint8_t sFlowIdx, uint8_t flags)
       header.AddOptJOIN(OPT_JOIN, remoteToken, 0); // addID should be zero?
       olen += 6;
     }
+  if (hasSyn && ((flags & TcpHeader::ACK) ? sFlow->winScaling : m_winScaling))
+    { // A SYN offers window scaling, a SYN+ACK only answers the offer of the peer (RFC 7323)
+      sFlow->rcvWScale = LocalWindowScale();
+      header.AddOptWSCALE(OPT_WSCALE, sFlow->rcvWScale);
+      olen += 2;
+    }
+  if (hasSyn && ((flags & TcpHeader::ACK) ? sFlow->sackEnabled : m_sack))
+    {
+      header.AddOptSACKPERM(OPT_SACK_PERMITTED);
+      olen += 1;
+    }
+  if (isAck && sFlow->sackEnabled)
+    { // Report what is held beyond RxSeqNumber, a pending D-SACK block first (RFC 2018, RFC 2883)
+      uint32_t left[TcpOptions::MAX_SACK_BLOCKS];
+      uint32_t right[TcpOptions::MAX_SACK_BLOCKS];
+      uint8_t nBlocks = 0;
+      if (sFlow->dsackLeft != sFlow->dsackRight)
+        {
+          left[0] = sFlow->dsackLeft;
+          right[0] = sFlow->dsackRight;
+          nBlocks = 1;
+          sFlow->dsackLeft = sFlow->dsackRight = 0;
+        }
+      nBlocks += unOrdered.SackBlocks(sFlowIdx, sFlow->lastRcvdSeq, left + nBlocks, right + nBlocks,
+          TcpOptions::MAX_SACK_BLOCKS - nBlocks);
+      if (nBlocks > 0)
+        {
+          header.AddOptSACK(OPT_SACK, nBlocks, left, right);
+          olen += 2 + 8 * nBlocks;
+        }
+    }
 
   uint8_t plen = (4 - (olen % 4)) % 4;
   olen = (olen + plen) / 4;
@@ -2257,7 +2427,7 @@ uint32_t
 MpTcpSocketBase::GetSndBufSize(void) const
 {
   //return m_txBuffer.MaxBufferSize();
-  return 0;
+  return sendingBuffer.bufMaxSize;
 }
 void
 MpTcpSocketBase::SetRcvBufSize(uint32_t size)
@@ -2288,12 +2458,21 @@ MpTcpSocketBase::Recv()
   NS_LOG_FUNCTION (this);
   // Vitalii: better to check if 1400 bytes is a good amount to transmit each time
   // std::cout << "Need to check what's the max size to retreive at mp-tcp-socket-base!\n";
-  uint32_t toRead = std::min(recvingBuffer.PendingData(), uint32_t(1400));
-  uint8_t *rcvd = recvingBuffer.RetrieveRealData(toRead);
-  Ptr<Packet> outPacket = Create<Packet> (rcvd, toRead);
-  delete[] rcvd; //needs to be done as *rcvd was allocated with 'new' 
-  // std::cout << "\n\n has data after: " << recvingBuffer.PendingData() << "\n";
+  return RecvPacket(1400);
+}
 
+/** Hand out the next maxSize bytes of the receive buffer. The returned packet
+ references the received payload, no bytes are copied. An empty packet means
+ that there is nothing to read. */
+Ptr<Packet>
+MpTcpSocketBase::RecvPacket(uint32_t maxSize)
+{
+  NS_LOG_FUNCTION (this << maxSize);
+  Ptr<Packet> outPacket = recvingBuffer.CreatePacket(maxSize);
+  if (outPacket == 0)
+    {
+      return Create<Packet> ();
+    }
   return outPacket;
 }
 
@@ -2376,6 +2555,8 @@ MpTcpSocketBase::DoForwardUp(Ptr<Packet> p, Ipv4Header header, uint16_t port, Pt
 
   //uint32_t dataLen;   // packet's payload length
   remoteRecvWnd = (uint32_t) mptcpHeader.GetWindowSize(); //update the flow control window
+  if (sFlow->winScaling && (mptcpHeader.GetFlags() & TcpHeader::SYN) == 0)
+    remoteRecvWnd <<= sFlow->sndWScale;
 
   if (mptcpHeader.GetFlags() & TcpHeader::ACK)
     { // This function update subflow's lastMeasureRtt variable.
@@ -2411,7 +2592,7 @@ MpTcpSocketBase::DoForwardUp(Ptr<Packet> p, Ipv4Header header, uint16_t port, Pt
         h.SetAckNumber(SequenceNumber32(sFlow->RxSeqNumber));
         h.SetSourcePort(sFlow->sPort);
         h.SetDestinationPort(sFlow->dPort);
-        h.SetWindowSize(AdvertisedWindowSize());
+        h.SetWindowSize(WindowField(sFlowIdx, h.GetFlags()));
         m_tcp->SendPacket(Create<Packet>(), h, header.GetDestination(), header.GetSource(),
             FindOutputNetDevice(header.GetDestination()));
       }
@@ -2476,6 +2657,7 @@ MpTcpSocketBase::InitiateSubflows()
         sFlow->dAddr = remote;
         sFlow->dPort = m_remotePort; // TODO Is this right?
         sFlow->MSS = segmentSize;
+        sFlow->ssthresh = m_ssThresh;
         sFlow->cwnd = sFlow->MSS;               // We should do this ... since cwnd is 0
         sFlow->state = SYN_SENT;
         sFlow->cnTimeout = m_cnTimeout;
@@ -2486,6 +2668,8 @@ MpTcpSocketBase::InitiateSubflows()
           return -1;
         sFlow->m_endPoint->SetRxCallback(MakeCallback(&MpTcpSocketBase::ForwardUp, Ptr<MpTcpSocketBase>(this)));
         subflows.insert(subflows.end(), sFlow);
+        if (IsTracing())
+          sFlow->StartTracing(m_traceSink, m_traceConnection);
 
         // Create packet and add MP_JOIN option to it.
         Ptr<Packet> pkt = Create<Packet>();
@@ -2495,9 +2679,20 @@ MpTcpSocketBase::InitiateSubflows()
         header.SetAckNumber(SequenceNumber32(sFlow->RxSeqNumber));
         header.SetSourcePort(sFlow->sPort);
         header.SetDestinationPort(sFlow->dPort);
-        header.SetWindowSize(AdvertisedWindowSize());
+        header.SetWindowSize(WindowField(subflows.size() - 1, TcpHeader::SYN));
         header.AddOptJOIN(OPT_JOIN, remoteToken, addrID);
         uint8_t olen = 6;
+        if (m_winScaling)
+          {
+            sFlow->rcvWScale = LocalWindowScale();
+            header.AddOptWSCALE(OPT_WSCALE, sFlow->rcvWScale);
+            olen += 2;
+          }
+        if (m_sack)
+          {
+            header.AddOptSACKPERM(OPT_SACK_PERMITTED);
+            olen += 1;
+          }
         uint8_t plen = (4 - (olen % 4)) % 4;
         olen = (olen + plen) / 4;
         uint8_t hlen = 5 + olen;
@@ -2532,6 +2727,7 @@ MpTcpSocketBase::InitiateSingleSubflows(uint16_t randomPort)
   sFlow->dAddr = m_endPoint->GetPeerAddress();
   sFlow->dPort = m_endPoint->GetPeerPort();
   sFlow->MSS = segmentSize;
+  sFlow->ssthresh = m_ssThresh;
   sFlow->cwnd = sFlow->MSS;
   sFlow->state = SYN_SENT;
   sFlow->cnTimeout = m_cnTimeout;
@@ -2542,6 +2738,8 @@ MpTcpSocketBase::InitiateSingleSubflows(uint16_t randomPort)
     return -1;
   sFlow->m_endPoint->SetRxCallback(MakeCallback(&MpTcpSocketBase::ForwardUp, Ptr<MpTcpSocketBase>(this)));
   subflows.insert(subflows.end(), sFlow);
+  if (IsTracing())
+    sFlow->StartTracing(m_traceSink, m_traceConnection);
 
   // Create packet and add MP_JOIN option to it.
   Ptr<Packet> pkt = Create<Packet>();
@@ -2551,9 +2749,20 @@ MpTcpSocketBase::InitiateSingleSubflows(uint16_t randomPort)
   header.SetAckNumber(SequenceNumber32(sFlow->RxSeqNumber));
   header.SetSourcePort(sFlow->sPort);
   header.SetDestinationPort(sFlow->dPort);
-  header.SetWindowSize(AdvertisedWindowSize());
+  header.SetWindowSize(WindowField(subflows.size() - 1, TcpHeader::SYN));
   header.AddOptJOIN(OPT_JOIN, remoteToken, /*addrID*/0);
   uint8_t olen = 6;
+  if (m_winScaling)
+    {
+      sFlow->rcvWScale = LocalWindowScale();
+      header.AddOptWSCALE(OPT_WSCALE, sFlow->rcvWScale);
+      olen += 2;
+    }
+  if (m_sack)
+    {
+      header.AddOptSACKPERM(OPT_SACK_PERMITTED);
+      olen += 1;
+    }
   uint8_t plen = (4 - (olen % 4)) % 4;
   olen = (olen + plen) / 4;
   uint8_t hlen = 5 + olen;
@@ -2667,63 +2876,42 @@ void
 MpTcpSocketBase::ReadUnOrderedData(Ptr<Packet> packet)
 {
   NS_LOG_FUNCTION (this);
-  //NS_LOG_WARN("ReadUnOrderedData()-> Size: " << unOrdered.size());
-  list<DSNMapping *>::iterator current = unOrdered.begin();
-  list<DSNMapping *>::iterator next = unOrdered.begin();
+  //NS_LOG_WARN("ReadUnOrderedData()-> Size: " << unOrdered.Size());
 
-  // I changed this method, now whenever a segment is readed it get dropped from that list
-  while (next != unOrdered.end())
+  // Stored data that is now in-order at connection level, coalesced into one range
+  list<Ptr<Packet> > chunks;
+  if (unOrdered.Drain(nextRxSequence, chunks) > 0)
     {
-      ++next;
-      DSNMapping *ptrDSN = *current;
-      uint32_t sFlowIdx = ptrDSN->subflowIndex;
-      Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-      if ((ptrDSN->dataSeqNumber <= nextRxSequence) /*&& (ptrDSN->subflowSeqNumber == sFlow->RxSeqNumber)*/)
-        { /* Stored segment is in-order at connection level */
-          NS_ASSERT(ptrDSN->dataSeqNumber == nextRxSequence);
-
-          //uint32_t amount = recvingBuffer->Add(ptrDSN->packet, ptrDSN->dataLevelLength);
-          // uint8_t* _buf = (uint8_t*) malloc ((size_t) ptrDSN->dataLevelLength+1); // Vitalii: I shouldn't use my packet here!
-          // uint8_t *_buf = new uint8_t[ptrDSN->dataLevelLength+1];
-          // uint32_t _siz = packet->CopyData(_buf, ptrDSN->dataLevelLength);
-          // _buf = ptrDSN->payload;
-          // uint32_t amount = recvingBuffer.Add(ptrDSN->dataLevelLength); //dude, WTF? Why handicap the implementation?
-          uint32_t amount = recvingBuffer.AddRealData(ptrDSN->payload, ptrDSN->dataLevelLength); // Vitalii: We need to add real data, not a default alphabet!
-          // free(_buf);
+      for (list<Ptr<Packet> >::iterator it = chunks.begin(); it != chunks.end(); ++it)
+        {
+          uint32_t amount = recvingBuffer.ReadPacket(*it, (*it)->GetSize());
           if (amount == 0)
             { // Receive buffer is full.
               NS_FATAL_ERROR("In our model receive buffer never get full");
               break;
             }
-          NS_ASSERT(amount == ptrDSN->dataLevelLength);
+          NS_ASSERT(amount == (*it)->GetSize());
           nextRxSequence += amount;
-
-          if (ptrDSN->subflowSeqNumber == sFlow->RxSeqNumber)
-            { /** Stored segment is also in-order at sub-flow level */
-              sFlow->RxSeqNumber += amount;
-              sFlow->highestAck = std::max(sFlow->highestAck, ptrDSN->acknowledgement - 1);
-              //SendEmptyPacket(sFlowIdx, TcpHeader::ACK);
-              sFlow->AccumulativeAck = true; //TODO TEMP
-            }
-          else
-            NS_ASSERT(ptrDSN->subflowSeqNumber < sFlow->RxSeqNumber);
-
-          NotifyDataRecv();
-          unOrdered.erase(current);
-          delete ptrDSN;
         }
-      else if (ptrDSN->subflowSeqNumber == sFlow->RxSeqNumber)
-        { /* Stored segment is in-order only at sub-flow level! */
-          NS_ASSERT((ptrDSN->dataSeqNumber > nextRxSequence));
+      m_unOrdOccupancy = unOrdered.Size();
+      NotifyDataRecv();
+    }
+
+  // Stored segments that are now in-order at sub-flow level
+  for (uint32_t i = 0; i < subflows.size(); i++)
+    {
+      Ptr<MpTcpSubFlow> sFlow = subflows[i];
+      uint16_t length;
+      uint32_t ack;
+      while (unOrdered.AdvanceSubflow(i, sFlow->RxSeqNumber, length, ack))
+        {
           //NS_LOG_UNCOND("ReadUnOrderedData()-> sub-flow is in-order but connection is out of order " << (int)sFlow->routeId);
-          sFlow->RxSeqNumber += ptrDSN->dataLevelLength;
-          sFlow->highestAck = std::max(sFlow->highestAck, ptrDSN->acknowledgement - 1);
+          sFlow->RxSeqNumber += length;
+          sFlow->highestAck = std::max(sFlow->highestAck, ack - 1);
           // TODO Should let sender know about this update ?!?!
           // ACK should be sent per packet basis! If we send any ACK here it would break this rule? Could we solve this via DATA-ACK?
           sFlow->AccumulativeAck = true;  // TODO TEMP
-          //SendEmptyPacket(sFlowIdx, TcpHeader::ACK);
         }
-      current = next;
     }
 }
 
@@ -2750,10 +2938,8 @@ MpTcpSocketBase::DupAck(uint8_t sFlowIdx, DSNMapping* ptrDSN)
   uint32_t segmentSize = sFlow->MSS;
   //calculateTotalCWND();
 
-#ifdef PLOT
-  uint32_t tmp = (((ptrDSN->subflowSeqNumber) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod;
-  sFlow->DUPACK.push_back(make_pair(Simulator::Now().GetSeconds(), tmp));
-#endif
+  if (IsTracing())
+    Trace(sFlowIdx, MpTcpTraceSink::DUPACK, (((ptrDSN->subflowSeqNumber) - sFlow->initialSequnceNumber) / sFlow->MSS) % mod);
 
   // Congestion control algorithms
   if (sFlow->m_dupAckCount == 3 && !sFlow->m_inFastRec)
@@ -2763,20 +2949,26 @@ MpTcpSocketBase::DupAck(uint8_t sFlowIdx, DSNMapping* ptrDSN)
       // Cut the window to the half
       ReduceCWND(sFlowIdx, ptrDSN);
 
-#ifdef PLOT
-      sFlow->_FReTx.push_back(make_pair(Simulator::Now().GetSeconds(), TimeScale));
-#endif
+      if (IsTracing())
+        Trace(sFlowIdx, MpTcpTraceSink::FAST_RETX, sFlow->cwnd);
       FastReTxs++;
     }
+  else if (sFlow->m_inFastRec && sFlow->sackEnabled)
+    { // SACK recovery (RFC 6675): repair the holes the scoreboard marks lost, then new data as far as the pipe allows
+      RetransmitLost(sFlowIdx);
+      if (IsTracing())
+        Trace(sFlowIdx, MpTcpTraceSink::FR_DUPACK, sFlow->cwnd);
+      FastRecoveries++;
+      SendPendingData(sFlow->routeId);
+    }
   else if (sFlow->m_inFastRec)
     { // Fast Recovery
 // Increase cwnd for every additional DupACK (RFC2582, sec.3 bullet #3)
       sFlow->cwnd += segmentSize;
+      SubflowChanged(sFlowIdx);
 
-#ifdef PLOT
-      DupAcks.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
-      sFlow->ssthreshtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->ssthresh));
-#endif
+      if (IsTracing())
+        Trace(sFlowIdx, MpTcpTraceSink::FR_DUPACK, sFlow->cwnd);
       NS_LOG_WARN ("DupAck-> FastRecovery. Increase cwnd by one MSS, from " << sFlow->cwnd.Get() <<" -> " << sFlow->cwnd << " AvailableWindow: " << AvailableWindow(sFlowIdx));
       FastRecoveries++;
       // Send more data into pipe if possible to get ACK clock going
@@ -2846,220 +3038,6 @@ MpTcpSocketBase::PrintCC(uint32_t cc)
   return "Unknown";
 }
 
-std::string
-MpTcpSocketBase::GeneratePlotDetail(void)
-{
-
-  stringstream oss;
-  oss << "Node["<<m_node->GetId() << "]  FlowId[" << flowId << "]  FlowType[" << flowType << "]  CC[" << PrintCC(AlgoCC) <<"] RandomGap[" << m_rGap << "]";
-  string tmp = oss.str();
-  oss.str("");
-  return tmp;
-  //stringstream detail;
-  //detail << "CC:" << PrintCC(AlgoCC) << "  sF:" << subflows.size() << " C:" << LinkCapacity / 1000 << "Kbps  RTT:" << RTT
-  //    << "Ms  D:" << totalBytes / 1000 << "Kb  dtQ(" << lostRate << ")  MSS:" << segmentSize << "B";
-  //return detail.str();
-}
-
-
-
-void
-MpTcpSocketBase::GenerateCwndTracer()
-{
-  Gnuplot cwndTracerGraph;
-  cwndTracerGraph.AppendExtra("set terminal postscript eps enhanced color solid font 'Times-Bold,15'\n"
-                              "set output \"cwnd.eps\"\n"
-                              "set xlabel \"Time (s)\" offset 0,-1\n"
-                              "set ylabel \"Cwnd (pkts)\" offset 0,0\n"
-                              "set grid\n"
-                              "set lmargin 10.0\n"
-                              "set rmargin 5.0\n"
-                              "set key bmargin center horizontal Left reverse noenhanced autotitles columnhead nobox\n");
-  cwndTracerGraph.SetTitle("Congestion Window vs Time \\n\\n" + GeneratePlotDetail());
-  // cwnd
-  for (uint16_t idx = 0; idx < subflows.size(); idx++)
-    {
-      Ptr<MpTcpSubFlow> sFlow = subflows[idx];
-      Gnuplot2dDataset dataSet;
-      dataSet.SetStyle(Gnuplot2dDataset::LINES_POINTS);
-      std::stringstream title;
-      title << "SF " << idx;
-      dataSet.SetTitle(title.str());
-      vector<pair<double, uint32_t> >::iterator it = sFlow->cwndTracer.begin();
-      while (it != sFlow->cwndTracer.end())
-        {
-          dataSet.Add(it->first, it->second / sFlow->MSS);
-          it++;
-        }
-      if (sFlow->cwndTracer.size() > 0)
-        cwndTracerGraph.AddDataset(dataSet);
-    }
-
-  // ssthreshold
-  Gnuplot sstGraph;
-  sstGraph.AppendExtra(
-                         "set terminal postscript eps enhanced color solid font 'Times-Bold,15'\n"
-                         "set output \"sst.eps\"\n"
-                         "set xlabel\"Time (s)\" offset 0,-1\n"
-                         "set ylabel\"ssthreshold (bytes)\" offset 0,0\n"
-                         "set grid\n"
-                         "set lmargin 10.0\n"
-                         "set rmargin 5.0\n"
-                         "set key bmargin center horizontal Left reverse noenhanced autotitles columnhead nobox\n");
-  sstGraph.SetTitle("Slow Start Threshold vs Time\\n\\n" + GeneratePlotDetail());
-  for (uint16_t idx = 0; idx < subflows.size(); idx++)
-    {
-      Ptr<MpTcpSubFlow> sFlow = subflows[idx];
-      Gnuplot2dDataset dataSet;
-      dataSet.SetStyle(Gnuplot2dDataset::LINES);
-      std::stringstream title;
-      title << "SST " << idx;
-      dataSet.SetTitle(title.str());
-      vector<pair<double, uint32_t> >::iterator it = sFlow->sstTracer.begin();
-      while (it != sFlow->sstTracer.end())
-        {
-          dataSet.Add(it->first, it->second);
-          it++;
-        }
-      if (sFlow->sstTracer.size() > 0)
-        sstGraph.AddDataset(dataSet);
-    }
-  gnu.AddPlot(cwndTracerGraph);
-  gnu.AddPlot(sstGraph);
-}
-
-void
-MpTcpSocketBase::GenerateRTT()
-{
-  // RTT
-  Gnuplot rttGraph;
-  rttGraph.AppendExtra(
-                       "set terminal postscript eps enhanced color solid font 'Times-Bold,15'\n"
-                       "set output \"rtt.eps\"\n"
-                       "set xlabel \"Time (s)\" offset 0,-1\n"
-                       "set ylabel \"RTT (ms)\" offset 0,0 \n"
-                       "set grid\n"
-                       "set lmargin 10.0\n"
-                       "set rmargin 5.0\n"
-                       "set key bmargin center horizontal Left reverse noenhanced autotitles columnhead nobox\n");
-  rttGraph.SetTitle("RTT vs Time\\n\\n" + GeneratePlotDetail());
-  for (uint16_t idx = 0; idx < subflows.size(); idx++)
-    {
-      Ptr<MpTcpSubFlow> sFlow = subflows[idx];
-
-      Gnuplot2dDataset dataSet;
-      dataSet.SetStyle(Gnuplot2dDataset::LINES_POINTS);
-
-      std::stringstream title;
-      title << "RTT " << idx;
-
-      dataSet.SetTitle(title.str());
-
-      vector<pair<double, double> >::iterator it = sFlow->rttTracer.begin();
-
-      while (it != sFlow->rttTracer.end())
-        {
-          dataSet.Add(it->first, it->second);
-          it++;
-        }
-      if (sFlow->rttTracer.size() > 0)
-        rttGraph.AddDataset(dataSet);
-    }
-
-  // RTO Plot
-  Gnuplot rtoGraph;
-  rtoGraph.AppendExtra("set terminal postscript eps enhanced color solid font 'Times-Bold,15'\n"
-                       "set output \"rto.eps\"\n"
-                       "set xlabel \"Time (s)\" offset 0,-1\n"
-                       "set ylabel \"RTO (ms)\" offset 0,0 \n"
-                       "set grid\n"
-                       "set lmargin 10.0\n"
-                       "set rmargin 5.0\n"
-                       "set key bmargin center horizontal Left reverse noenhanced autotitles columnhead nobox\n");
-  rtoGraph.SetTitle("RTO vs Time\\n\\n" + GeneratePlotDetail());
-  for (uint16_t idx = 0; idx < subflows.size(); idx++)
-    {
-      Ptr<MpTcpSubFlow> sFlow = subflows[idx];
-
-      Gnuplot2dDataset dataSet;
-      dataSet.SetStyle(Gnuplot2dDataset::LINES_POINTS);
-
-      std::stringstream title;
-      title << "RTO " << idx;
-
-      dataSet.SetTitle(title.str());
-
-      vector<pair<double, double> >::iterator it = sFlow->rtoTracer.begin();
-
-      while (it != sFlow->rtoTracer.end())
-        {
-          dataSet.Add(it->first, it->second);
-          it++;
-        }
-      if (sFlow->rtoTracer.size() > 0)
-        rtoGraph.AddDataset(dataSet);
-    }
-
-  //TxQueue
-  /*
-  for (uint16_t idx = 0; idx < subflows.size(); idx++)
-    {
-      Ptr<MpTcpSubFlow> sFlow = subflows[idx];
-
-      Gnuplot2dDataset dataSet;
-      dataSet.SetStyle(Gnuplot2dDataset::LINES_POINTS);
-
-      std::stringstream title;
-      title << "TxQueue " << idx;
-
-      dataSet.SetTitle(title.str());
-
-      vector<pair<double, double> >::iterator it = TxQueue.begin();
-
-      while (it != TxQueue.end())
-        {
-          dataSet.Add(it->first, it->second);
-          it++;
-        }
-      rttGraph.AddDataset(dataSet);
-    }
-    */
-  gnu.AddPlot(rttGraph);
-  gnu.AddPlot(rtoGraph);
-}
-
-void
-MpTcpSocketBase::GeneratePktCount()
-{
-  Gnuplot pktCountGraph;
-  pktCountGraph.AppendExtra("set terminal postscript eps enhanced color solid font 'Times-Bold,15'\n"
-                            "set output \"pkt.eps\"\n"
-                            "set style data histogram\n"
-                            "set style histogram cluster gap 3.0\n"
-                            "set style fill solid\n"
-                            "set boxwidth 2.0\n"
-                            "set xlabel \"Subflow Id\\n\" offset 0,-1\n"
-                            "set ylabel \"Packets\" offset 0,0\n"
-                            "#set grid\n"
-                            "set lmargin 10.0\n"
-                            "set rmargin 5.0\n"
-                            "unset key\n"
-                            "#set key bmargin center horizontal Left reverse noenhanced autotitles columnhead nobox\n");
-  pktCountGraph.SetTitle("Sent Packets per Subflow\\n\\n" + GeneratePlotDetail());
-  Gnuplot2dDataset dataSetPKt;
-  dataSetPKt.SetStyle(Gnuplot2dDataset::MKS);
-  dataSetPKt.SetTitle("");
-  dataSetPKt.SetExtra(" using 2:xtic(1) lc 62\n");
-
-  for (uint16_t idx = 0; idx < subflows.size(); idx++)
-    {
-      Ptr<MpTcpSubFlow> sFlow = subflows[idx];
-      dataSetPKt.Add(idx, sFlow->PktCount);
-    }
-  pktCountGraph.AddDataset(dataSetPKt);
-  gnu.AddPlot(pktCountGraph);
-}
-
 /*
  * Segments are stored in this buffer based on mptcp connection sequence number.
  * So if a sub-flow's segment get delayed then other subflow's segments would be 
@@ -3067,38 +3045,23 @@ MpTcpSocketBase::GeneratePktCount()
  * This function returns false only when incoming packet is already stored before!
  */
 bool
-MpTcpSocketBase::StoreUnOrderedData(DSNMapping *toStore)
+MpTcpSocketBase::StoreUnOrderedData(const DSNMapping &toStore)
 {
   NS_LOG_FUNCTION (this);
-  for (list<DSNMapping *>::iterator it = unOrdered.begin(); it != unOrdered.end(); ++it)
+  if (unOrdered.Size() + toStore.dataLevelLength > unOrdMaxSize)
     {
-      DSNMapping *stored = *it;
-      if (toStore->dataSeqNumber == stored->dataSeqNumber)
-        {
-          return false;
-        }
-      else if (toStore->dataSeqNumber < stored->dataSeqNumber)
-        {
-    /*
-          std::cout << "\n Subflows to store:" << int(toStore->subflowIndex) << "; Subflow stored: " 
-                    << int(stored->subflowIndex) << ";\n";
-          std::cout << "DSN to store: " << toStore->dataSeqNumber << "; DSN stored: " 
-                    << stored->dataSeqNumber << ";\n";
-          std::cout << "SSN to store: " << toStore->subflowSeqNumber << "; SSN stored: "
-                    << stored->subflowSeqNumber << ";\n";
-    */
-          // This assertion is to make sure un-ordered segments are stored in-order of subflow & connection level.
-          // Vitalii: for some reason I sometimes get this assert violated, though it seems that it should not 
-          // happen; however, if I just comment it out, everything still goes well.
-
-          // if (toStore->subflowIndex == stored->subflowIndex)
-          //   NS_ASSERT(toStore->subflowSeqNumber < stored->subflowSeqNumber);
-
-          unOrdered.insert(it, toStore);
-          return true;
-        }
+      NS_LOG_WARN(this << " StoreUnOrderedData -> out of sequence buffer is full, segment is dropped");
+      return false;
+    }
+  // Sub-flow still has to pass this segment later if it is not the next one expected on it
+  bool aheadOfSubflow = toStore.subflowSeqNumber > subflows[toStore.subflowIndex]->RxSeqNumber;
+  if (!unOrdered.Store(toStore.subflowIndex, toStore.dataSeqNumber, toStore.dataLevelLength, toStore.subflowSeqNumber,
+      toStore.acknowledgement, toStore.payload, aheadOfSubflow))
+    {
+      return false;
     }
-  unOrdered.insert(unOrdered.end(), toStore);
+  m_reorderDistance(toStore.dataSeqNumber - nextRxSequence);
+  m_unOrdOccupancy = unOrdered.Size();
   return true;
 }
 
@@ -3220,20 +3183,7 @@ bool
 MpTcpSocketBase::FindPacketFromUnOrdered(uint8_t sFlowIdx)
 {
   NS_LOG_FUNCTION((int)sFlowIdx);
-  bool reValue = false;
-  list<DSNMapping *>::iterator current = unOrdered.begin();
-  while (current != unOrdered.end())
-    {
-      DSNMapping* ptrDSN = *current;
-      if (ptrDSN->subflowIndex == sFlowIdx)
-        {
-          reValue = true;
-          NS_LOG_LOGIC("(" << (int)sFlowIdx << ") FindPacketFromUnOrdered -> SeqNb" << ptrDSN->subflowSeqNumber << " pSize: " << ptrDSN->dataLevelLength);
-          break;
-        }
-      current++;
-    }
-  return reValue;
+  return unOrdered.HasData(sFlowIdx);
 }
 
 /** This function closes the endpoint completely. Called upon RST_TX action. */
@@ -3288,13 +3238,13 @@ MpTcpSocketBase::Close(uint8_t sFlowIdx)
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
 
   // First we check to see if there is any unread rx data. Bug number 426 claims we should send reset in this case.
-  if (unOrdered.size() > 0 && FindPacketFromUnOrdered(sFlowIdx) && !sFlow->Finished()) /* && recvingBuffer->PendingData() != 0 */
+  if (!unOrdered.Empty() && FindPacketFromUnOrdered(sFlowIdx) && !sFlow->Finished()) /* && recvingBuffer->PendingData() != 0 */
     {  // I don't expect this to happens in normal scenarios!
       // NS_ASSERT(server); // Vitalii: It was preventing my app to stop. What's the point of throwing it? 
       //NS_FATAL_ERROR("Receiver called close() when there are some unread packets in its buffer");
       //SendRST(sFlowIdx); //?
       //CloseAndNotify(sFlowIdx);
-      NS_LOG_UNCOND("unOrderedBuffer: " << unOrdered.size() << " currentSubflow: " << sFlow->routeId);
+      NS_LOG_UNCOND("unOrderedBuffer: " << unOrdered.Size() << " currentSubflow: " << sFlow->routeId);
       CancelAllSubflowTimers(); // Danger?!?!
       return 0;
     }
@@ -3402,9 +3352,9 @@ MpTcpSocketBase::Close(void)
       m_state = CLOSED;
       NotifyNormalClose();
       m_endPoint->SetDestroyCallback(MakeNullCallback<void>());
+      RemoveLocalToken();
       m_tcp->DeAllocate(m_endPoint);
       m_endPoint = 0;
-      //m_tcp->RemoveLocalToken(localToken);
       std::vector<Ptr<TcpSocketBase> >::iterator it = std::find(m_tcp->m_sockets.begin(), m_tcp->m_sockets.end(), this);
       if (it != m_tcp->m_sockets.end())
         {
@@ -3451,11 +3401,11 @@ MpTcpSocketBase::CloseMultipathConnection()
           m_state = CLOSED;
           NotifyNormalClose();
           m_endPoint->SetDestroyCallback(MakeNullCallback<void>()); // Remove callback to destroy()
+          RemoveLocalToken();
           m_tcp->DeAllocate(m_endPoint);  // Deallocating the endPoint
           m_endPoint = 0;
           if (subflows.size() > 0)
             subflows[0]->m_endPoint = 0;
-          //m_tcp->RemoveLocalToken(localToken);
           std::vector<Ptr<TcpSocketBase> >::iterator it = std::find(m_tcp->m_sockets.begin(), m_tcp->m_sockets.end(), this);
           if (it != m_tcp->m_sockets.end())
             {
@@ -3513,7 +3463,7 @@ MpTcpSocketBase::AdvertiseAvailableAddresses()
           localAddrs.insert(localAddrs.end(), addrInfo);
         }
       uint8_t plen = (4 - (olen % 4)) % 4;
-      header.SetWindowSize(AdvertisedWindowSize());
+      header.SetWindowSize(WindowField(0, header.GetFlags()));
       olen = (olen + plen) / 4;
       hlen = 5 + olen;
       header.SetLength(hlen);
@@ -3539,44 +3489,53 @@ MpTcpSocketBase::IsThereRoute(Ipv4Address src, Ipv4Address dst)
   // Look up the source address
 //  Ptr<Ipv4> ipv4 = m_node->GetObject<Ipv4>();
   Ptr<Ipv4L3Protocol> ipv4 = m_node->GetObject<Ipv4L3Protocol>();
-  if (ipv4->GetRoutingProtocol() != 0)
+  Ptr<Ipv4RoutingProtocol> routing = ipv4->GetRoutingProtocol();
+  if (routing != 0)
     {
+      // Route checks of this node stay valid until its routing table changes
+      uint32_t version = routing->GetRoutingTableVersion();
+      if (version != 0)
+        {
+          if (version != m_tcp->m_routeCacheVersion || routing != m_tcp->m_routeCacheProtocol)
+            {
+              m_tcp->m_routeCache.clear();
+              m_tcp->m_routeCacheVersion = version;
+              m_tcp->m_routeCacheProtocol = routing;
+            }
+          TcpL4Protocol::RouteCache::const_iterator it = m_tcp->m_routeCache.find(std::make_pair(src, dst));
+          if (it != m_tcp->m_routeCache.end())
+            {
+              return it->second;
+            }
+        }
+
       Ipv4Header l3Header;
       Socket::SocketErrno errno_;
       Ptr<Ipv4Route> route;
       //.....................................................................................
-      //NS_LOG_INFO("----------------------------------------------------");NS_LOG_INFO("IsThereRoute() -> src: " << src << " dst: " << dst);
       // Get interface number from IPv4Address via ns3::Ipv4::GetInterfaceForAddress(Ipv4Address address);
       int32_t interface = ipv4->GetInterfaceForAddress(src);        // Morteza uses sign integers
-
-      std::stringstream _addr;
-      src.Print (_addr);
-      std::stringstream _addr1;
-      dst.Print (_addr1);
-
-      // NS_LOG_DEBUG ("\n\n\n interface: " << interface << "; src: " << _addr.str () << "; dst: " << _addr1.str ());
-      // NS_FATAL_ERROR ("stop stop stop");
-
-      Ptr<Ipv4Interface> v4Interface = ipv4->GetRealInterfaceForAddress(src);
-      Ptr<NetDevice> v4NetDevice = v4Interface->GetDevice();
-      //PrintIpv4AddressFromIpv4Interface(v4Interface, interface);
       NS_ASSERT_MSG(interface != -1, "There is no interface object for the the src address");
       // Get NetDevice from Interface via ns3::Ipv4::GetNetDevice(uint32_t interface);
       Ptr<NetDevice> oif = ipv4->GetNetDevice(interface);
-      NS_ASSERT(oif == v4NetDevice);
+      NS_ASSERT(oif == ipv4->GetRealInterfaceForAddress(src)->GetDevice());
 
       //.....................................................................................
       l3Header.SetSource(src);
       l3Header.SetDestination(dst);
-      route = ipv4->GetRoutingProtocol()->RouteOutput(Ptr<Packet>(), l3Header, oif, errno_);
+      route = routing->RouteOutput(Ptr<Packet>(), l3Header, oif, errno_);
       if ((route != 0)/* && (src == route->GetSource())*/)
         {
-          // NS_LOG_DEBUG ("IsThereRoute -> Route from src "<< src << " to dst " << dst << " oit ["<< oif->GetIfIndex()<<"], exist  Gateway: " << route->GetGateway());
+          NS_LOG_LOGIC ("IsThereRoute -> Route from src " << src << " to dst " << dst << " oif [" << oif->GetIfIndex() << "], exists, gateway: " << route->GetGateway());
           found = true;
         }
       else
         {
-          // NS_LOG_DEBUG ("IsThereRoute -> No Route from srcAddr "<< src << " to dstAddr " << dst << " oit ["<<oif->GetIfIndex()<<"], exist Gateway: " << route->GetGateway());
+          NS_LOG_LOGIC ("IsThereRoute -> No route from src " << src << " to dst " << dst << " oif [" << oif->GetIfIndex() << "]");
+        }
+      if (version != 0)
+        {
+          m_tcp->m_routeCache[std::make_pair(src, dst)] = found;
         }
     }
   return found;
@@ -3651,10 +3610,72 @@ MpTcpSocketBase::BytesInFlight(uint8_t sFlowIdx)
   return sFlow->maxSeqNb - sFlow->highestAck;        //m_highTxMark - m_highestRxAck;
 }
 
+uint32_t
+MpTcpSocketBase::BytesInFlight()
+{
+  NS_LOG_FUNCTION(this);
+  uint32_t inFlight = 0;
+  for (uint32_t i = 0; i < subflows.size(); i++)
+    {
+      Ptr<MpTcpSubFlow> sFlow = subflows[i];
+      if (sFlow->state >= ESTABLISHED && sFlow->TxSeqNumber > sFlow->highestAck + 1)
+        inFlight += sFlow->TxSeqNumber - (sFlow->highestAck + 1);
+    }
+  return inFlight;
+}
+
+uint32_t
+MpTcpSocketBase::ReceiveWindow()
+{ // In-order data waits in recvingBuffer until the application reads it, the rest in unOrdered
+  uint32_t held = recvingBuffer.bufSize + unOrdered.Size();
+  return (held < recvingBuffer.bufMaxSize) ? (recvingBuffer.bufMaxSize - held) : 0;
+}
+
 uint16_t
-MpTcpSocketBase::AdvertisedWindowSize()
+MpTcpSocketBase::WindowField(uint8_t sFlowIdx, uint8_t flags)
 {
-  return (uint16_t) 65535;
+  uint32_t window = ReceiveWindow();
+  if (subflows[sFlowIdx]->winScaling && (flags & TcpHeader::SYN) == 0)
+    window >>= subflows[sFlowIdx]->rcvWScale; // The window of a SYN is never scaled
+  return (uint16_t) std::min(window, (uint32_t) 65535);
+}
+
+uint8_t
+MpTcpSocketBase::LocalWindowScale()
+{
+  uint8_t scale = 0;
+  while (scale < 14 && ((uint32_t) 65535 << scale) < recvingBuffer.bufMaxSize)
+    scale++;
+  return scale;
+}
+
+/*
+ * RFC 7323: the windows of a subflow are scaled once both ends sent the window scale option on its
+ * SYN exchange, each end by the shift it announced. A peer's shift above 14 is taken as 14.
+ * RFC 2018: likewise SACK is used on a subflow once both ends sent SACK permitted.
+ */
+void
+MpTcpSocketBase::ReadSynOptions(uint8_t sFlowIdx, const TcpHeader& mptcpHeader)
+{
+  NS_LOG_FUNCTION(this << (int)sFlowIdx);
+  Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  sFlow->winScaling = false;
+  sFlow->sackEnabled = false;
+  for (uint8_t j = 0; j < mptcpHeader.GetNOptions(); j++)
+    {
+      const TcpOptions &opt = mptcpHeader.GetOption(j);
+      if (opt.optName == OPT_WSCALE && m_winScaling)
+        {
+          sFlow->winScaling = true;
+          sFlow->sndWScale = std::min(opt.wscale.shift, (uint8_t) 14);
+          sFlow->rcvWScale = LocalWindowScale();
+        }
+      else if (opt.optName == OPT_SACK_PERMITTED && m_sack)
+        {
+          sFlow->sackEnabled = true;
+        }
+    }
+  NS_LOG_INFO("(" << (int)sFlowIdx << ") WindowScaling: " << sFlow->winScaling << " snd: " << (int)sFlow->sndWScale << " rcv: " << (int)sFlow->rcvWScale << " SACK: " << sFlow->sackEnabled);
 }
 
 uint32_t
@@ -3663,10 +3684,15 @@ MpTcpSocketBase::AvailableWindow(uint8_t sFlowIdx)
   NS_LOG_FUNCTION(this << (int)sFlowIdx);
 
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
-  uint32_t window = std::min(remoteRecvWnd, sFlow->cwnd.Get());
   uint32_t unAcked = (sFlow->TxSeqNumber - (sFlow->highestAck + 1));
-  uint32_t freeCWND = (window < unAcked) ? 0 : (window - unAcked);
-  // NS_LOG_UNCOND ("\n\n window: " << window << "; unacked: " << unAcked << "; free: " << freeCWND << ";\n\n");
+  if (sFlow->m_inFastRec && sFlow->sackEnabled)
+    unAcked = sFlow->pipe; // RFC 6675: SACKed and lost segments are no longer in the network
+  uint32_t freeCWND = (sFlow->cwnd.Get() < unAcked) ? 0 : (sFlow->cwnd.Get() - unAcked);
+  // The peer's window is shared by all subflows of the connection
+  uint32_t inFlight = BytesInFlight();
+  uint32_t freeRWND = (remoteRecvWnd < inFlight) ? 0 : (remoteRecvWnd - inFlight);
+  freeCWND = std::min(freeCWND, freeRWND);
+  // NS_LOG_UNCOND ("\n\n unacked: " << unAcked << "; inFlight: " << inFlight << "; free: " << freeCWND << ";\n\n");
   if (freeCWND < sFlow->MSS && sendingBuffer.PendingData() >= sFlow->MSS)
     {
       NS_LOG_WARN("AvailableWindow: ("<< (int)sFlowIdx <<") -> " << freeCWND << " => 0" << " MSS: " << sFlow->MSS);
@@ -3718,6 +3744,16 @@ MpTcpSocketBase::LookupSubflow(Ipv4Address src, uint32_t srcPort, Ipv4Address ds
   Ptr<MpTcpSubFlow> sFlow = 0;
   uint8_t sFlowIdx = maxSubflows;
 
+  // Subflows are never removed from the container, so an index found before stays valid as long as its 4-tuple matches
+  Ipv4EndPointDemux::FourTuple tuple(src, srcPort, dst, dstPort);
+  sgi::hash_map<Ipv4EndPointDemux::FourTuple, uint8_t, Ipv4EndPointDemux::FourTupleHash>::iterator it = subflowIdx.find(tuple);
+  if (it != subflowIdx.end())
+    {
+      sFlow = subflows[it->second];
+      if (sFlow->sAddr == src && sFlow->dAddr == dst && sFlow->sPort == srcPort && sFlow->dPort == dstPort)
+        return it->second;
+    }
+
   // Walk through the existing subflow container and try to find one with 4-tuple match!
   for (uint32_t i = 0; i < subflows.size(); i++)
     {
@@ -3725,6 +3761,7 @@ MpTcpSocketBase::LookupSubflow(Ipv4Address src, uint32_t srcPort, Ipv4Address ds
       if (sFlow->sAddr == src && sFlow->dAddr == dst && sFlow->sPort == srcPort && sFlow->dPort == dstPort)
         {
           sFlowIdx = i;
+          subflowIdx[tuple] = sFlowIdx;
           return sFlowIdx;
         }
     }
@@ -3745,6 +3782,7 @@ MpTcpSocketBase::LookupSubflow(Ipv4Address src, uint32_t srcPort, Ipv4Address ds
   sFlow->sAddr = src;
   sFlow->sPort = srcPort;
   sFlow->MSS = segmentSize;
+  sFlow->ssthresh = m_ssThresh;
   sFlow->cwnd = sFlow->MSS;
   sFlow->state = LISTEN;
   sFlow->cnTimeout = m_cnTimeout;
@@ -3755,6 +3793,9 @@ MpTcpSocketBase::LookupSubflow(Ipv4Address src, uint32_t srcPort, Ipv4Address ds
     return -1;
   sFlow->m_endPoint->SetRxCallback(MakeCallback(&MpTcpSocketBase::ForwardUp, Ptr<MpTcpSocketBase>(this)));
   subflows.insert(subflows.end(), sFlow);
+  if (IsTracing())
+    sFlow->StartTracing(m_traceSink, m_traceConnection);
+  subflowIdx[tuple] = sFlowIdx;
   NS_LOG_UNCOND(this << " LookupSubflow -> Subflow(" << (int) sFlowIdx <<") has created its (src,dst) = (" << sFlow->sAddr << ":" << sFlow->sPort << " , "<< sFlow->dAddr << ":" << sFlow->dPort<< ")" );
 
   return sFlowIdx;
@@ -3842,18 +3883,19 @@ MpTcpSocketBase::OpenCWND(uint8_t sFlowIdx, uint32_t ackedBytes)
 {
   NS_LOG_FUNCTION(this << (int) sFlowIdx << ackedBytes);
   Ptr<MpTcpSubFlow> sFlow = subflows[sFlowIdx];
+  if (m_congestionControl != 0)
+    m_congestionControl->PktsAcked(subflows, sFlowIdx, ackedBytes, sFlow->lastMeasuredRtt);
 
-  double adder = 0;
   uint32_t cwnd = sFlow->cwnd.Get();
   uint32_t ssthresh = sFlow->ssthresh;
   uint32_t mss = sFlow->MSS;
 
   // params used only for COUPLED_INC and COUPLED_EPS only
-  int tcp_inc, tt;
+  int tcp_inc = 0, tt;
   int tmp, total_cwnd, tmp2;
   double tmp_float;
 
-  if (AlgoCC >= COUPLED_SCALABLE_TCP)
+  if (m_congestionControl == 0 && AlgoCC >= COUPLED_SCALABLE_TCP)
     {
       if (ackedBytes > mss)
         ackedBytes = mss;
@@ -3871,72 +3913,35 @@ MpTcpSocketBase::OpenCWND(uint8_t sFlowIdx, uint32_t ackedBytes)
         }
     }
 
-  calculateTotalCWND();
+  if (IsTracing())
+    calculateTotalCWND(); // Only traced, the controllers keep their own total
   if (cwnd < ssthresh)
     {
       sFlow->cwnd += sFlow->MSS;
-#ifdef PLOT
-      sFlow->ssthreshtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->ssthresh));
-      sFlow->CWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
-      totalCWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), totalCwnd));
-      sFlow->_ss.push_back(make_pair(Simulator::Now().GetSeconds(), TimeScale));
-#endif
+      SubflowChanged(sFlowIdx);
+      if (IsTracing())
+        {
+          Trace(sFlowIdx, MpTcpTraceSink::TOTAL_CWND, totalCwnd);
+          Trace(sFlowIdx, MpTcpTraceSink::SLOW_START, sFlow->cwnd);
+        }
       NS_LOG_WARN ("Congestion Control (Slow Start) increment by one segmentSize");
     }
-  else
+  else if (m_congestionControl != 0)
     {
+      m_congestionControl->IncreaseWindow(subflows, sFlowIdx, ackedBytes);
+      if (IsTracing())
+        {
+          Trace(sFlowIdx, MpTcpTraceSink::TOTAL_CWND, totalCwnd);
+          Trace(sFlowIdx, MpTcpTraceSink::CONG_AVOID, sFlow->cwnd);
+        }
+    }
+  else
+    { // COUPLED_* and UNCOUPLED variants
       switch (AlgoCC)
         {
-      case RTT_Compensator:
-        calculateAlpha(); // Calculate alpha per drop or RTT...RFC 6356 (Section 4.1)
-        adder = std::min(alpha * sFlow->MSS * sFlow->MSS / totalCwnd, static_cast<double>(sFlow->MSS * sFlow->MSS) / cwnd);
-        adder = std::max(1.0, adder);
-        sFlow->cwnd += static_cast<double>(adder);
-#ifdef PLOT
-        sFlow->ssthreshtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->ssthresh));
-        sFlow->CWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
-        totalCWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), totalCwnd));
-#endif
-        NS_LOG_ERROR ("Congestion Control (RTT_Compensator): alpha "<<alpha<<" ackedBytes (" << ackedBytes << ") totalCwnd ("<< totalCwnd / sFlow->MSS<<" packets) -> increment is "<<adder << " cwnd: " << sFlow->cwnd);
-        break;
-      case Linked_Increases:
-        calculateAlpha();
-        adder = alpha * sFlow->MSS * sFlow->MSS / totalCwnd;
-        adder = std::max(1.0, adder);
-        sFlow->cwnd += static_cast<double>(adder);
-#ifdef PLOT
-        sFlow->ssthreshtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->ssthresh));
-        sFlow->CWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
-        totalCWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), totalCwnd));
-#endif
-        NS_LOG_ERROR ("Subflow "<<(int)sFlowIdx<<" Congestion Control (Linked_Increases): alpha "<<alpha<<" increment is "<<adder<<" ssthresh "<< ssthresh << " cwnd "<<cwnd );
-        break;
-      case Uncoupled_TCPs:
-        adder = static_cast<double>(sFlow->MSS * sFlow->MSS) / cwnd;
-        adder = std::max(1.0, adder);
-        sFlow->cwnd += static_cast<double>(adder);
-#ifdef PLOT
-        sFlow->ssthreshtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->ssthresh));
-        sFlow->CWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
-        totalCWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), totalCwnd));
-#endif
-        NS_LOG_WARN ("Subflow "<<(int)sFlowIdx<<" Congestion Control (Uncoupled_TCPs) increment is "<<adder<<" ssthresh "<< ssthresh << " cwnd "<<cwnd);
-        break;
       case UNCOUPLED:
         sFlow->cwnd += tcp_inc;
         break;
-      case Fully_Coupled:
-        adder = static_cast<double>(sFlow->MSS * sFlow->MSS) / totalCwnd;
-        adder = std::max(1.0, adder);
-        sFlow->cwnd += static_cast<double>(adder);
-#ifdef PLOT
-        sFlow->ssthreshtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->ssthresh));
-        sFlow->CWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), sFlow->cwnd));
-        totalCWNDtrack.push_back(make_pair(Simulator::Now().GetSeconds(), totalCwnd));
-#endif
-        NS_LOG_ERROR ("Subflow "<<(int)sFlowIdx<<" Congestion Control (Fully_Coupled) increment is "<<adder<<" ssthresh "<< ssthresh << " cwnd "<<cwnd);
-        break;
-
       case COUPLED_INC:
         total_cwnd = compute_total_window();
         tmp2 = (ackedBytes * mss * a) / total_cwnd;
@@ -3996,38 +4001,11 @@ MpTcpSocketBase::OpenCWND(uint8_t sFlowIdx, uint32_t ackedBytes)
       default:
         break;
         }
-#ifdef PLOT
-      sFlow->_ca.push_back(make_pair(Simulator::Now().GetSeconds(), TimeScale));
-#endif
+      if (IsTracing())
+        Trace(sFlowIdx, MpTcpTraceSink::CONG_AVOID, sFlow->cwnd);
     }
 }
 
-void
-MpTcpSocketBase::calculateAlpha()
-{
-  // this method is called whenever a congestion happen in order to regulate the agressivety of subflows
-  // alpha = cwnd_total * MAX(cwnd_i / rtt_i^2) / {SUM(cwnd_i / rtt_i))^2}   //RFC 6356 formula (2)
-
-  NS_LOG_FUNCTION_NOARGS ();
-  alpha = 0;
-  double maxi = 0;
-  double sumi = 0;
-
-  for (uint32_t i = 0; i < subflows.size(); i++)
-    {
-      Ptr<MpTcpSubFlow> sFlow = subflows[i];
-
-      Time time = sFlow->rtt->GetCurrentEstimate();
-      double rtt = time.GetSeconds();
-      double tmpi = sFlow->cwnd.Get() / (rtt * rtt);
-      if (maxi < tmpi)
-        maxi = tmpi;
-
-      sumi += sFlow->cwnd.Get() / rtt;
-    }
-  alpha = (totalCwnd * maxi) / (sumi * sumi);
-}
-
 void
 MpTcpSocketBase::DestroySubflowMapDSN()
 {
@@ -4035,11 +4013,7 @@ MpTcpSocketBase::DestroySubflowMapDSN()
   for (uint32_t i = 0; i < subflows.size(); i++)
     {
       Ptr<MpTcpSubFlow> sFlow = subflows[i];
-      for (std::list<DSNMapping *>::iterator i = sFlow->mapDSN.begin(); i != sFlow->mapDSN.end(); i++)
-        {
-          i = sFlow->mapDSN.erase(i);
-        }
-      sFlow->mapDSN.clear();
+      sFlow->mapDSN.Clear();
     }
 }
 
@@ -4047,11 +4021,8 @@ void
 MpTcpSocketBase::DestroyUnOrdered()
 {
   NS_LOG_FUNCTION_NOARGS();
-  for (std::list<DSNMapping*>::iterator i = unOrdered.begin(); i != unOrdered.end(); i++)
-    {
-      i = unOrdered.erase(i);
-    }
-  unOrdered.clear();
+  unOrdered.Clear();
+  m_unOrdOccupancy = 0;
 }
 
 /** Kill this socket. This is a callback function configured to m_endpoint in
@@ -4061,6 +4032,8 @@ MpTcpSocketBase::Destroy(void)
 {
   NS_LOG_FUNCTION(this);//
   NS_LOG_INFO("Enter Destroy(" << this << ") m_sockets:  " << m_tcp->m_sockets.size()<< ")");
+  if (m_tcp != 0)
+    RemoveLocalToken();
   m_endPoint = 0;
   if (m_tcp != 0)
     {
@@ -4074,6 +4047,16 @@ MpTcpSocketBase::Destroy(void)
   NS_LOG_INFO("Leave Destroy(" << this << ") m_sockets:  " << m_tcp->m_sockets.size()<< ")");
 }
 
+/** Called before the connection endpoint goes away, so that a later MP_JOIN with this token is not forwarded to it */
+void
+MpTcpSocketBase::RemoveLocalToken()
+{
+  NS_LOG_FUNCTION(this << localToken);
+  TcpL4Protocol::TokenMaps::iterator it = m_tcp->m_TokenMap.find(localToken);
+  if (localToken != 0 && it != m_tcp->m_TokenMap.end() && it->second == m_endPoint)
+    m_tcp->m_TokenMap.erase(it);
+}
+
 /** Deallocate the end point and cancel all the timers */
 void
 MpTcpSocketBase::DeallocateEndPoint(uint8_t sFlowIdx)
@@ -4110,12 +4093,80 @@ void
 MpTcpSocketBase::SetCongestionCtrlAlgo(CongestionCtrl_t ccalgo)
 {
   AlgoCC = ccalgo;
+  switch (ccalgo)
+    {
+  case Uncoupled_TCPs:
+    m_congestionControl = CreateObject<MpTcpCongestionUncoupled>();
+    break;
+  case Linked_Increases:
+    m_congestionControl = CreateObject<MpTcpCongestionLia>();
+    break;
+  case RTT_Compensator:
+    m_congestionControl = CreateObject<MpTcpCongestionLia>();
+    m_congestionControl->SetAttribute("Capped", BooleanValue(true));
+    break;
+  case Fully_Coupled:
+    m_congestionControl = CreateObject<MpTcpCongestionFullyCoupled>();
+    break;
+  default:
+    m_congestionControl = 0; // OpenCWND and ReduceCWND run these themselves
+    break;
+    }
+}
+
+void
+MpTcpSocketBase::SetCongestionControlType(TypeId tid)
+{
+  if (tid == MpTcpCongestionControl::GetTypeId())
+    return; // Keep the one CongestionControl chose
+  ObjectFactory factory;
+  factory.SetTypeId(tid);
+  m_congestionControl = factory.Create<MpTcpCongestionControl>();
+  NS_ABORT_MSG_IF(m_congestionControl == 0, tid.GetName() << " is not an MpTcpCongestionControl");
+}
+
+Ptr<MpTcpCongestionControl>
+MpTcpSocketBase::GetCongestionControl() const
+{
+  return m_congestionControl;
 }
 
 void
 MpTcpSocketBase::SetDataDistribAlgo(DataDistribAlgo_t ddalgo)
 {
   distribAlgo = ddalgo;
+  switch (ddalgo)
+    {
+  case Min_RTT:
+    m_scheduler = CreateObject<MpTcpSchedulerMinRtt>();
+    break;
+  case BLEST:
+    m_scheduler = CreateObject<MpTcpSchedulerBlest>();
+    break;
+  case ECF:
+    m_scheduler = CreateObject<MpTcpSchedulerEcf>();
+    break;
+  default:
+    m_scheduler = CreateObject<MpTcpSchedulerRoundRobin>();
+    break;
+    }
+}
+
+void
+MpTcpSocketBase::SetSchedulerType(TypeId tid)
+{
+  if (tid == MpTcpScheduler::GetTypeId())
+    return; // Keep the one SchedulingAlgorithm chose
+  ObjectFactory factory;
+  factory.SetTypeId(tid);
+  m_scheduler = factory.Create<MpTcpScheduler>();
+  NS_ABORT_MSG_IF(m_scheduler == 0, tid.GetName() << " is not an MpTcpScheduler");
+}
+
+Ptr<MpTcpScheduler>
+MpTcpSocketBase::GetScheduler() const
+{
+  return m_scheduler;
 }
 
 void
@@ -4171,25 +4222,9 @@ MpTcpSocketBase::getQueuePkt(Ipv4Address addr)
   PointerValue ptr;
   net0->GetAttribute("TxQueue", ptr);
   Ptr<Queue> txQueue = ptr.Get<Queue>();
-  TxQueue.push_back(make_pair(Simulator::Now().GetSeconds(), txQueue->GetNPackets()));
-}
-// PLOT_CI_5_8_MPTCP_0_1
-void
-MpTcpSocketBase::GeneratePlotsOutput()
-{
-  stringstream oss;
-  //oss << "PLOT_" << m_node->GetId() << "_" << flowId << "_" << GetTypeIdName() <<"_"<< PrintCC(AlgoCC) <<"_"<< (int)maxSubflows << "_" << (uint32_t)Simulator::Now().GetSeconds();
-  oss << "PLOT_" << PrintCC(AlgoCC) << "_" << (uint32_t)Simulator::Now().GetSeconds() <<"_"<< (int)maxSubflows << "_" << GetTypeIdName() <<"_" << m_node->GetId() << "_" << flowId <<"_" << m_rGap;
-  string tmp = oss.str();
-  oss.clear();
-//  std::ofstream outfile(oss.str().c_str());
-  Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper>(tmp.c_str(), std::ios::out);
-  ostream* os = stream->GetStream();
-  gnu.GenerateOutput(*os);
-//  oss.str("");
-//  outfile.close();
+  if (IsTracing())
+    Trace(0, MpTcpTraceSink::TX_QUEUE, txQueue->GetNPackets());
 }
-
 uint16_t
 MpTcpSocketBase::GetRandom16()
 {
@@ -4261,15 +4296,32 @@ MpTcpSocketBase::GetTypeIdName()
 void
 MpTcpSocketBase::GeneratePlots()
 {
-  if ((m_largePlotting && (flowType.compare("Large") == 0)) || (m_shortPlotting && (flowType.compare("Short") == 0)))
-    {
-      GenerateCwndTracer();
-      GenerateRTT();
-      GeneratePktCount();
-      GeneratePlotsOutput();
-    }
+  if (m_traceSink != 0)
+    m_traceSink->Flush();
 }
 
+bool
+MpTcpSocketBase::IsTracing()
+{
+  if (m_traceSink != 0)
+    return true;
+  if (m_traceFile.empty())
+    return false;
+  if ((m_largePlotting || m_shortPlotting)
+      && !((m_largePlotting && (flowType.compare("Large") == 0)) || (m_shortPlotting && (flowType.compare("Short") == 0))))
+    return false;
+  m_traceSink = MpTcpTraceSink::Open(m_traceFile, m_traceRingRecords);
+  m_traceConnection = m_traceSink->AddConnection(m_node->GetId());
+  for (uint32_t i = 0; i < subflows.size(); i++)
+    subflows[i]->StartTracing(m_traceSink, m_traceConnection);
+  return true;
+}
+
+void
+MpTcpSocketBase::Trace(uint8_t sFlowIdx, MpTcpTraceSink::Record_t type, double value)
+{
+  m_traceSink->Write(m_traceConnection, sFlowIdx, type, value);
+}
 
 void
 MpTcpSocketBase::IsLastAck()
@@ -23,9 +23,14 @@
 
 #include "ns3/mp-tcp-typedefs.h"
 #include "ns3/tcp-socket-base.h"
-#include "ns3/gnuplot.h"
 #include "mp-tcp-subflow.h"
+#include "mp-tcp-congestion-control.h"
+#include "mp-tcp-scheduler.h"
+#include "ns3/mp-tcp-trace-sink.h"
 #include "ns3/output-stream-wrapper.h"
+#include "ns3/traced-callback.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/sgi-hashmap.h"
 
 #define A_MP 1
 #define B_MP 2
@@ -62,8 +67,10 @@ public: // public methods
   //int FillBuffer(uint8_t* buf, uint32_t size);// Fill sending buffer with data - TcpTxBuffer API need to be used in future!
   int FillBuffer(uint32_t size);
   int FillBuffer(uint8_t* data, uint32_t size);
+  int FillBuffer(Ptr<Packet> pkt);            // Queue an application packet for sending without copying its payload
   //uint32_t Recv(uint8_t* buf, uint32_t size); // Receive data from receiveing buffer - TcpRxBuffe API need to be used in future!
   Ptr<Packet> Recv();
+  Ptr<Packet> RecvPacket(uint32_t maxSize);   // Receive up to maxSize bytes as a packet sharing the received payload
   uint32_t Recv(uint32_t size); // Receive data from receiveing buffer - TcpRxBuffe API need to be used in future!
 
   //void allocateSendingBuffer(uint32_t size);  // Can be removed now as SetSndBufSize() is implemented instead!
@@ -79,7 +86,11 @@ public: // public methods
 
   // Setter for congestion Control and data distribution algorithm
   void SetCongestionCtrlAlgo(CongestionCtrl_t ccalgo);  // This would be used by attribute system for setting congestion control
-  void SetDataDistribAlgo(DataDistribAlgo_t ddalgo);    // Round Robin is only algorithms used.
+  void SetCongestionControlType(TypeId tid);            // Any MpTcpCongestionControl, overrides SetCongestionCtrlAlgo
+  Ptr<MpTcpCongestionControl> GetCongestionControl() const;
+  void SetDataDistribAlgo(DataDistribAlgo_t ddalgo);    // Round_Robin, Min_RTT, BLEST or ECF
+  void SetSchedulerType(TypeId tid);                    // Any MpTcpScheduler, overrides SetDataDistribAlgo
+  Ptr<MpTcpScheduler> GetScheduler() const;
   void SetPathManager (PathManager_t);
 
 
@@ -110,23 +121,16 @@ public: // public variables
   bool m_alphaPerAck;
   uint32_t m_rGap;
   bool m_shortFlowTCP;
+  bool m_winScaling;      // Offer and accept the window scale option (RFC 7323) on the SYN of every subflow
+  bool m_sack;            // Offer and accept SACK (RFC 2018) on the SYN of every subflow
   //
-  GnuplotCollection gnu;
   std::list<uint32_t> sampleList;
 
-  vector<pair<double, double> > totalCWNDtrack;
-  vector<pair<double, double> > reTxTrack;
-  vector<pair<double, double> > timeOutTrack;
-  vector<pair<double, double> > PartialAck;
-  vector<pair<double, double> > FullAck;
-  vector<pair<double, double> > DupAcks;
-  vector<pair<double, double> > PacketDrop;
-  vector<pair<double, double> > TxQueue;
-
 
 protected: // protected methods
 
   friend class Tcp;
+  friend class MpTcpScheduler;
 
   // Implementing some inherited methods from ns3::TcpSocket. No need to comment them!
   virtual void SetSndBufSize (uint32_t size);
@@ -167,6 +171,7 @@ protected: // protected methods
   void DestroyUnOrdered();
   void CancelAllTimers(uint8_t sFlowIdx);
   void DeallocateEndPoint(uint8_t sFlowIdx);
+  void RemoveLocalToken(void);          // Drop localToken from the token map of TcpL4Protocol
   void CancelAllSubflowTimers(void);
   void TimeWait(uint8_t sFlowIdx);
 
@@ -183,7 +188,11 @@ protected: // protected methods
 
   // Window Management
   virtual uint32_t BytesInFlight(uint8_t sFlowIdx);  // Return total bytes in flight of a subflow
-  uint16_t AdvertisedWindowSize();
+  virtual uint32_t BytesInFlight(void);              // Return unacknowledged bytes of all subflows, limited by remoteRecvWnd
+  uint32_t ReceiveWindow();                          // Free space of the connection level receive buffers
+  uint16_t WindowField(uint8_t sFlowIdx, uint8_t flags); // ReceiveWindow() as put in the header of a subflow's segment
+  uint8_t LocalWindowScale();                        // Shift that lets the window field cover the receive buffer
+  void ReadSynOptions(uint8_t sFlowIdx, const TcpHeader&); // Window scale and SACK permitted options of a SYN or SYN+ACK
   uint32_t AvailableWindow(uint8_t sFlowIdx);
 
   // Manage data Tx/Rx
@@ -206,26 +215,35 @@ protected: // protected methods
   void LastAckTimeout(uint8_t sFlowIdx);
   void DiscardUpTo(uint8_t sFlowIdx, uint32_t ack);
 
+  // SACK loss recovery (RFC 6675)
+  void ReadSack(uint8_t sFlowIdx, const TcpHeader&);  // Update the scoreboard from the SACK blocks of an ACK
+  uint32_t SetPipe(uint8_t sFlowIdx);                 // Recompute the subflow's pipe from its scoreboard
+  void RetransmitLost(uint8_t sFlowIdx);              // Retransmit the segments the scoreboard marks lost, as far as the pipe allows
+
   // Re-ordering buffer
-  bool StoreUnOrderedData(DSNMapping *ptr);
+  bool StoreUnOrderedData(const DSNMapping &toStore);
   void ReadUnOrderedData(Ptr<Packet> packet);
   bool FindPacketFromUnOrdered(uint8_t sFlowIdx);
 
   // Congestion control
   virtual void OpenCWND(uint8_t sFlowIdx, uint32_t ackedBytes);
   void ReduceCWND(uint8_t sFlowIdx, DSNMapping* ptrDSN);
-  virtual void calculateAlpha();
+  void SubflowChanged(uint8_t sFlowIdx);   // Tells the congestion controller that cwnd, ssthresh, fast recovery or srtt of a subflow changed
   virtual void calculateTotalCWND();
   uint32_t compute_total_window();
   uint32_t compute_a_scaled();
   double compute_alfa();
   void window_changed();
 
+  // Evaluation traces
+  bool IsTracing();           // Opens the sink of TraceFile on first use if this flow type is plotted
+  void Trace(uint8_t sFlowIdx, MpTcpTraceSink::Record_t type, double value);
+
   // Helper functions -> main operations
   uint8_t LookupByAddrs(Ipv4Address src, Ipv4Address dst); // Called by Forwardup() to find the right subflow for incoing packet
   virtual int LookupSubflow(Ipv4Address src, uint32_t sPort, Ipv4Address dst , uint32_t dPort); // LookupBy4-Tuple
 
-  virtual uint8_t getSubflowToUse();  // Called by SendPendingData() to get a subflow based on round robin algorithm
+  virtual uint8_t getSubflowToUse();  // Called by SendPendingData() to get a subflow from m_scheduler
   bool IsThereRoute(Ipv4Address src, Ipv4Address dst);     // Called by InitiateSubflow & LookupByAddrs and Connect to check whether there is route between a pair of addresses.
   bool IsLocalAddress(Ipv4Address addr);
   bool IsRemoteAddress(Ipv4Address addr);
@@ -240,15 +258,10 @@ protected: // protected methods
 
 
   // Helper functions -> plotting
-  std::string GeneratePlotDetail();
   void GenerateCWNDPlot();
   void GenerateSendvsACK();
-  void GenerateRTT();
-  void GenerateCwndTracer();
-  void GeneratePktCount();
-  void GeneratePlots();
+  void GeneratePlots();                                   // Flushes the trace file, see utils/mptcp-trace-to-gnuplot
   void IsLastAck();
-  virtual void GeneratePlotsOutput();
 //  virtual void DoGenerateOutPutFile();
   virtual string GetTypeIdName();
   string TcpFlagPrinter(uint8_t);
@@ -281,17 +294,27 @@ protected: // protected variables
   bool addrAdvertised;
   uint32_t localToken;
   uint32_t remoteToken;
-  uint32_t unOrdMaxSize;
+  uint32_t unOrdMaxSize;      // Bytes the out of sequence buffer may hold
   uint8_t  maxSubflows;
   uint8_t  lastUsedsFlowIdx;
 
   // MPTCP containers
   vector<Ptr<MpTcpSubFlow> > subflows;
+  sgi::hash_map<Ipv4EndPointDemux::FourTuple, uint8_t, Ipv4EndPointDemux::FourTupleHash> subflowIdx; // 4-tuple -> index in subflows, filled by LookupSubflow()
   vector<MpTcpAddressInfo *> localAddrs;
   vector<MpTcpAddressInfo *> remoteAddrs;
-  list<DSNMapping *> unOrdered;  // buffer that hold the out of sequence received packet
+  UnOrderedBuffer unOrdered;  // buffer that hold the out of sequence received packet
+  TracedValue<uint32_t> m_unOrdOccupancy;     // Bytes held in unOrdered
+  TracedCallback<uint64_t> m_reorderDistance; // How far ahead of nextRxSequence a stored segment starts
+  TracedCallback<uint8_t, Time> m_recoveryTime; // Subflow and duration of each completed fast recovery
+  TracedCallback<uint8_t, uint32_t, uint32_t> m_spuriousRetx; // Subflow, sequence number and length the peer got twice
+  std::string m_traceFile;                    // Evaluation trace file, empty if not tracing
+  uint32_t m_traceRingRecords;                // Keep only this many records in m_traceFile, 0 for all
+  Ptr<MpTcpTraceSink> m_traceSink;            // Sink of m_traceFile, opened on the first traced event
+  uint32_t m_traceConnection;                 // This connection's id in m_traceSink
 
   // Congestion control
+  Ptr<MpTcpCongestionControl> m_congestionControl; // Null for the COUPLED_* and UNCOUPLED algorithms, which use the members below
   double alpha;
   uint32_t a;
   double _e;
@@ -299,12 +322,13 @@ protected: // protected variables
   uint32_t totalCwnd;
   CongestionCtrl_t AlgoCC;       // Algorithm for Congestion Control
   DataDistribAlgo_t distribAlgo; // Algorithm for Data Distribution
+  Ptr<MpTcpScheduler> m_scheduler; // Picks the subflow for the next segment
   PathManager_t pathManager;        // Mechanism for subflow establishement
 
   // Window management variables
   uint32_t m_ssThresh;           // Slow start threshold
   uint32_t m_initialCWnd;        // Initial congestion window value
-  uint32_t remoteRecvWnd;        // Flow control window at remote side
+  uint32_t remoteRecvWnd;        // Flow control window at remote side, connection level and already scaled
   uint32_t segmentSize;          // Segment size
   uint64_t nextTxSequence;       // Next expected sequence number to send in connection level
   uint64_t nextRxSequence;       // Next expected sequence number to receive in connection level
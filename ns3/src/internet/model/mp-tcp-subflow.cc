@@ -50,8 +50,8 @@ MpTcpSubFlow::MpTcpSubFlow() :
     dAddr(Ipv4Address::GetZero()),
     dPort(0),
     oif(0),
-    mapDSN(0),
-    lastMeasuredRtt(Seconds(0.0))
+    lastMeasuredRtt(Seconds(0.0)),
+    m_traceConnection(0)
 {
   connected = false;
   TxSeqNumber = rand() % 1000;
@@ -79,6 +79,15 @@ MpTcpSubFlow::MpTcpSubFlow() :
   m_gotFin = false;
   AccumulativeAck = false;
   m_limitedTxCount = 0;
+  winScaling = false;
+  sndWScale = 0;
+  rcvWScale = 0;
+  sackEnabled = false;
+  highRxt = 0;
+  pipe = 0;
+  lastRcvdSeq = 0;
+  dsackLeft = 0;
+  dsackRight = 0;
 }
 
 MpTcpSubFlow::~MpTcpSubFlow()
@@ -92,12 +101,7 @@ MpTcpSubFlow::~MpTcpSubFlow()
   cwnd = 0;
   maxSeqNb = 0;
   highestAck = 0;
-  for (list<DSNMapping *>::iterator it = mapDSN.begin(); it != mapDSN.end(); ++it)
-    {
-      DSNMapping * ptrDSN = *it;
-      delete ptrDSN;
-    }
-  mapDSN.clear();
+  mapDSN.Clear();
 }
 
 bool
@@ -107,20 +111,21 @@ MpTcpSubFlow::Finished(void)
 }
 
 void
-MpTcpSubFlow::StartTracing(string traced)
+MpTcpSubFlow::StartTracing(Ptr<MpTcpTraceSink> sink, uint32_t connection)
 {
-  //NS_LOG_UNCOND("("<< routeId << ") MpTcpSubFlow -> starting tracing of: "<< traced);
-  TraceConnectWithoutContext(traced, MakeCallback(&MpTcpSubFlow::CwndTracer, this)); //"CongestionWindow"
+  if (m_traceSink != 0)
+    return;
+  m_traceSink = sink;
+  m_traceConnection = connection;
+  m_traceSink->Write(m_traceConnection, routeId, MpTcpTraceSink::SEGMENT_SIZE, MSS);
+  TraceConnectWithoutContext("cWindow", MakeCallback(&MpTcpSubFlow::CwndTracer, this));
 }
 
 void
 MpTcpSubFlow::CwndTracer(uint32_t oldval, uint32_t newval)
 {
-  //NS_LOG_UNCOND("Subflow "<< routeId <<": Moving cwnd from " << oldval << " to " << newval);
-  cwndTracer.push_back(make_pair(Simulator::Now().GetSeconds(), newval));
-  sstTracer.push_back(make_pair(Simulator::Now().GetSeconds(), ssthresh));
-  rttTracer.push_back(make_pair(Simulator::Now().GetSeconds(), rtt->GetCurrentEstimate().GetMilliSeconds()));
-  rtoTracer.push_back(make_pair(Simulator::Now().GetSeconds(), rtt->RetransmitTimeout().GetMilliSeconds()));
+  m_traceSink->Write(m_traceConnection, routeId, MpTcpTraceSink::CWND, newval);
+  m_traceSink->Write(m_traceConnection, routeId, MpTcpTraceSink::SSTHRESH, ssthresh);
 }
 
 void
@@ -128,7 +133,7 @@ MpTcpSubFlow::AddDSNMapping(uint8_t sFlowIdx, uint64_t dSeqNum, uint16_t dLvlLen
     Ptr<Packet> pkt)
 {
   NS_LOG_FUNCTION_NOARGS();
-  mapDSN.push_back(new DSNMapping(sFlowIdx, dSeqNum, dLvlLen, sflowSeqNum, ack, pkt));
+  mapDSN.Add(sFlowIdx, dSeqNum, dLvlLen, sflowSeqNum, ack, pkt);
 }
 
 void
@@ -145,16 +150,7 @@ DSNMapping *
 MpTcpSubFlow::GetunAckPkt()
 {
   NS_LOG_FUNCTION(this);
-  DSNMapping * ptrDSN = 0;
-  for (list<DSNMapping *>::iterator it = mapDSN.begin(); it != mapDSN.end(); ++it)
-    {
-      DSNMapping * ptr = *it;
-      if (ptr->subflowSeqNumber == highestAck + 1)
-        {
-          ptrDSN = ptr;
-          break;
-        }
-    }
+  DSNMapping * ptrDSN = mapDSN.Find(highestAck + 1);
   return ptrDSN;
 }
 }
@@ -38,6 +38,7 @@
 #include "ns3/tcp-socket.h"
 #include "ns3/ipv4-end-point.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/mp-tcp-trace-sink.h"
 
 using namespace std;
 
@@ -53,7 +54,7 @@ public:
   ~MpTcpSubFlow();
 
   void AddDSNMapping(uint8_t sFlowIdx, uint64_t dSeqNum, uint16_t dLvlLen, uint32_t sflowSeqNum, uint32_t ack, Ptr<Packet> pkt);
-  void StartTracing(string traced);
+  void StartTracing(Ptr<MpTcpTraceSink> sink, uint32_t connection);
   void CwndTracer(uint32_t oldval, uint32_t newval);
   void SetFinSequence(const SequenceNumber32& s);
   bool Finished();
@@ -71,6 +72,16 @@ public:
   EventId m_lastAckEvent;     // Timer for last ACK
   EventId m_timewaitEvent;    // Timer for closing connection at sender side
   uint32_t MSS;               // Maximum Segment Size
+  bool winScaling;            // Both ends sent the window scale option on the SYN exchange (RFC 7323)
+  uint8_t sndWScale;          // Shift of the windows the peer advertises on this subflow
+  uint8_t rcvWScale;          // Shift of the windows advertised on this subflow
+  bool sackEnabled;           // Both ends sent SACK permitted on the SYN exchange (RFC 2018)
+  uint32_t highRxt;           // Highest sequence number retransmitted in the current SACK recovery (RFC 6675)
+  uint32_t pipe;              // Bytes estimated in the network while in SACK recovery (RFC 6675)
+  Time recoveryStart;         // When the current fast recovery began
+  uint32_t lastRcvdSeq;       // Receiver: last segment stored ahead of RxSeqNumber, reported in the first SACK block
+  uint32_t dsackLeft;         // Receiver: duplicate segment to report in the next ACK (RFC 2883), none if equal to dsackRight
+  uint32_t dsackRight;
   uint32_t cnCount;           // Count of remaining connection retries
   uint32_t cnRetries;         // Number of connection retries before giving up
   Time     cnTimeout;         // Timeout for connection retry
@@ -86,8 +97,7 @@ public:
   bool m_limitedTx;           // perform limited transmit
   uint32_t m_dupAckCount;     // DupACK counter
   Ipv4EndPoint* m_endPoint;   // L4 stack object
-  list<DSNMapping *> mapDSN;  // List of all sent packets
-  multiset<double> measuredRTT;
+  DSNMappingTable mapDSN;     // Sent but unacknowledged packets, ordered by subflow seqNb
   Ptr<RttMeanDeviation> rtt;  // RTT calculator
   Time lastMeasuredRtt;       // Last measured RTT, used for plotting
   uint32_t TxSeqNumber;       // Subflow's next expected sequence number to send
@@ -99,28 +109,8 @@ public:
   uint32_t m_limitedTxCount;
   uint32_t initialSequnceNumber; // Plotting
 
-  //plotting
-  vector<pair<double, uint32_t> > cwndTracer;
-  vector<pair<double, uint32_t> > sstTracer;
-  vector<pair<double, double> > rtoTracer;
-  vector<pair<double, double> > rttTracer;
-
-  vector<pair<double, double> > ssthreshtrack;
-  vector<pair<double, double> > CWNDtrack;
-  vector<pair<double, uint32_t> > DATA;
-  vector<pair<double, uint32_t> > ACK;
-  vector<pair<double, uint32_t> > DROP;
-  vector<pair<double, uint32_t> > RETRANSMIT;
-  vector<pair<double, uint32_t> > DUPACK;
-  vector<pair<double, double> > _ss;
-  vector<pair<double, double> > _ca;
-  vector<pair<double, double> > _FR_FA;
-  vector<pair<double, double> > _FR_PA;
-  vector<pair<double, double> > _FReTx;
-  vector<pair<double, double> > _TimeOut;
-  vector<pair<double, double> > _RTT;
-  vector<pair<double, double> > _AvgRTT;
-  vector<pair<double, double> > _RTO;
+  Ptr<MpTcpTraceSink> m_traceSink; // Trace sink of the connection, null unless tracing
+  uint32_t m_traceConnection;       // Connection id in m_traceSink
 };
 
 }
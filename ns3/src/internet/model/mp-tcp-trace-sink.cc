@@ -0,0 +1,204 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <map>
+#include <algorithm>
+#include <string.h>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "mp-tcp-trace-sink.h"
+
+NS_LOG_COMPONENT_DEFINE ("MpTcpTraceSink");
+
+namespace ns3 {
+
+typedef std::map<std::string, MpTcpTraceSink*> TraceSinks;
+
+static TraceSinks &
+GetTraceSinks (void)
+{
+  static TraceSinks sinks;
+  return sinks;
+}
+
+Ptr<MpTcpTraceSink>
+MpTcpTraceSink::Open (std::string fileName, uint32_t ringRecords)
+{
+  TraceSinks::iterator it = GetTraceSinks ().find (fileName);
+  if (it != GetTraceSinks ().end ())
+    {
+      return it->second;
+    }
+  Ptr<MpTcpTraceSink> sink = Ptr<MpTcpTraceSink> (new MpTcpTraceSink (fileName, ringRecords), false);
+  GetTraceSinks ()[fileName] = PeekPointer (sink);
+  // Sockets still alive at the end of the run would otherwise keep the last records buffered
+  Simulator::ScheduleDestroy (&MpTcpTraceSink::FlushAll);
+  return sink;
+}
+
+MpTcpTraceSink::MpTcpTraceSink (std::string fileName, uint32_t ringRecords)
+  : m_fileName (fileName),
+    m_ringRecords (ringRecords),
+    m_totalRecords (0),
+    m_connections (0),
+    m_buffered (0)
+{
+  NS_LOG_FUNCTION (this << fileName << ringRecords);
+  m_file.open (fileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_UNLESS (m_file.is_open (), "Cannot open MPTCP trace file " << fileName);
+  Flush ();
+}
+
+MpTcpTraceSink::~MpTcpTraceSink ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  m_file.close ();
+  GetTraceSinks ().erase (m_fileName);
+}
+
+uint32_t
+MpTcpTraceSink::AddConnection (uint32_t nodeId)
+{
+  uint32_t connection = m_connections++;
+  Write (connection, 0, CONNECTION, nodeId);
+  return connection;
+}
+
+void
+MpTcpTraceSink::Flush (void)
+{
+  NS_LOG_FUNCTION (this << m_buffered);
+  uint32_t i = 0;
+  while (i < m_buffered)
+    {
+      // Write the longest run that does not wrap around the ring
+      uint64_t slot = m_totalRecords;
+      uint32_t count = m_buffered - i;
+      if (m_ringRecords > 0)
+        {
+          slot %= m_ringRecords;
+          count = std::min<uint64_t> (count, m_ringRecords - slot);
+        }
+      m_file.seekp (sizeof (Header) + slot * sizeof (Record));
+      m_file.write (reinterpret_cast<const char*> (&m_buffer[i]), count * sizeof (Record));
+      m_totalRecords += count;
+      i += count;
+    }
+  m_buffered = 0;
+
+  Header header;
+  memcpy (header.magic, "MPTR", 4);
+  header.version = 1;
+  header.recordSize = sizeof (Record);
+  header.ringRecords = m_ringRecords;
+  header.totalRecords = m_totalRecords;
+  m_file.seekp (0);
+  m_file.write (reinterpret_cast<const char*> (&header), sizeof (header));
+  m_file.flush ();
+}
+
+const char*
+MpTcpTraceSink::GetRecordName (uint16_t type)
+{
+  static const char *names[RECORD_TYPES] = {
+    "CONNECTION", "SEGMENT_SIZE", "CWND", "SSTHRESH", "RTT", "AVG_RTT", "RTO", "DATA", "ACK",
+    "RETRANSMIT", "DUPACK", "TIMEOUT", "SLOW_START", "CONG_AVOID", "FAST_RETX", "FR_PARTIAL_ACK",
+    "FR_FULL_ACK", "FR_DUPACK", "TOTAL_CWND", "TX_QUEUE"
+  };
+  return type < RECORD_TYPES ? names[type] : "UNKNOWN";
+}
+
+double
+MpTcpTraceSink::Now (void)
+{
+  return Simulator::Now ().GetSeconds ();
+}
+
+void
+MpTcpTraceSink::FlushAll (void)
+{
+  for (TraceSinks::iterator it = GetTraceSinks ().begin (); it != GetTraceSinks ().end (); ++it)
+    {
+      it->second->Flush ();
+    }
+}
+
+MpTcpTraceReader::MpTcpTraceReader (std::string fileName)
+  : m_open (false),
+    m_first (0),
+    m_next (0)
+{
+  m_file.open (fileName.c_str (), std::ios::in | std::ios::binary);
+  if (!m_file.read (reinterpret_cast<char*> (&m_header), sizeof (m_header)))
+    {
+      return;
+    }
+  if (memcmp (m_header.magic, "MPTR", 4) != 0 || m_header.version != 1
+      || m_header.recordSize != sizeof (MpTcpTraceSink::Record))
+    {
+      return;
+    }
+  m_open = true;
+  if (m_header.ringRecords > 0 && m_header.totalRecords > m_header.ringRecords)
+    {
+      m_first = m_header.totalRecords - m_header.ringRecords;
+    }
+  m_next = m_first;
+}
+
+bool
+MpTcpTraceReader::IsOpen (void) const
+{
+  return m_open;
+}
+
+uint64_t
+MpTcpTraceReader::GetNRecords (void) const
+{
+  return m_open ? m_header.totalRecords - m_first : 0;
+}
+
+uint64_t
+MpTcpTraceReader::GetNLost (void) const
+{
+  return m_first;
+}
+
+bool
+MpTcpTraceReader::Next (MpTcpTraceSink::Record &record)
+{
+  if (!m_open || m_next == m_header.totalRecords)
+    {
+      return false;
+    }
+  uint64_t slot = m_next++;
+  if (m_header.ringRecords > 0)
+    {
+      slot %= m_header.ringRecords;
+    }
+  // Records are read in order, so only seek when wrapping around the ring
+  if (slot == 0 || m_next == m_first + 1)
+    {
+      m_file.seekg (sizeof (MpTcpTraceSink::Header) + slot * sizeof (MpTcpTraceSink::Record));
+    }
+  m_file.read (reinterpret_cast<char*> (&record), sizeof (record));
+  return !m_file.fail ();
+}
+
+} // namespace ns3
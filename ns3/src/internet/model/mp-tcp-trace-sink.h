@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MP_TCP_TRACE_SINK_H
+#define MP_TCP_TRACE_SINK_H
+
+#include <stdint.h>
+#include <string>
+#include <fstream>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+/**
+ * \brief Streaming sink for the MPTCP evaluation traces
+ *
+ * Records are appended to a binary file as events happen, through a small
+ * fixed buffer, instead of being kept in memory for the whole run. With a
+ * ring size the file holds only the last records, so its size is bounded
+ * too. All sockets tracing to the same file share one sink; each gets its
+ * own connection id. utils/mptcp-trace-to-gnuplot turns the file into
+ * gnuplot scripts.
+ *
+ * The file starts with a Header, followed by Records, both in host byte
+ * order.
+ */
+class MpTcpTraceSink : public SimpleRefCount<MpTcpTraceSink>
+{
+public:
+  enum Record_t
+  {
+    CONNECTION,       //!< New connection, value is the node id
+    SEGMENT_SIZE,     //!< New subflow, value is its segment size
+    CWND,             //!< Subflow cwnd changed, value in bytes
+    SSTHRESH,         //!< ssthresh at that cwnd change, value in bytes
+    RTT,              //!< RTT sample, value in ms
+    AVG_RTT,          //!< Smoothed RTT after that sample, value in ms
+    RTO,              //!< Retransmission timeout after that sample, value in ms
+    DATA,             //!< Data segment sent, value is its end in segments since the start
+    ACK,              //!< ACK received, value in segments since the start
+    RETRANSMIT,       //!< Segment retransmitted, value as for DATA
+    DUPACK,           //!< Duplicate ACK received, value as for ACK
+    TIMEOUT,          //!< Retransmission timeout, value is the cwnd
+    SLOW_START,       //!< Slow start increase, value is the cwnd
+    CONG_AVOID,       //!< Congestion avoidance increase, value is the cwnd
+    FAST_RETX,        //!< Fast retransmit, value is the cwnd
+    FR_PARTIAL_ACK,   //!< Partial ACK in fast recovery, value is the cwnd
+    FR_FULL_ACK,      //!< Full ACK ending fast recovery, value is the cwnd
+    FR_DUPACK,        //!< Duplicate ACK inflating the cwnd in fast recovery, value is the cwnd
+    TOTAL_CWND,       //!< Sum of the subflow cwnds, value in bytes
+    TX_QUEUE,         //!< Packets in the device queue of a local address
+    RECORD_TYPES
+  };
+
+  /// File header
+  struct Header
+  {
+    char magic[4];          //!< "MPTR"
+    uint32_t version;       //!< Format version, 1
+    uint32_t recordSize;    //!< sizeof (Record)
+    uint32_t ringRecords;   //!< Ring size in records, 0 if the file only grows
+    uint64_t totalRecords;  //!< Records written so far, including those overwritten
+  };
+
+  /// One traced event
+  struct Record
+  {
+    double time;            //!< Simulation time in seconds
+    uint32_t connection;    //!< Connection id within the file
+    uint16_t subflow;       //!< Subflow index within the connection
+    uint16_t type;          //!< Record_t
+    double value;           //!< See Record_t
+  };
+
+  /**
+   * \brief Get the sink writing to a file, creating it on first use
+   * \param fileName the trace file, truncated when the sink is created
+   * \param ringRecords keep only this many records, 0 for all of them
+   * \returns the sink
+   */
+  static Ptr<MpTcpTraceSink> Open (std::string fileName, uint32_t ringRecords);
+
+  ~MpTcpTraceSink ();
+
+  /**
+   * \brief Register a connection and write its CONNECTION record
+   * \param nodeId the node of the connection
+   * \returns the connection id to pass to Write ()
+   */
+  uint32_t AddConnection (uint32_t nodeId);
+
+  /**
+   * \brief Append a record at the current simulation time
+   */
+  void Write (uint32_t connection, uint16_t subflow, Record_t type, double value)
+  {
+    Record &r = m_buffer[m_buffered++];
+    r.time = Now ();
+    r.connection = connection;
+    r.subflow = subflow;
+    r.type = type;
+    r.value = value;
+    if (m_buffered == BUFFER_RECORDS)
+      {
+        Flush ();
+      }
+  }
+
+  /**
+   * \brief Write the buffered records and the header to the file
+   */
+  void Flush (void);
+
+  /**
+   * \returns the printable name of a record type
+   */
+  static const char* GetRecordName (uint16_t type);
+
+private:
+  static const uint32_t BUFFER_RECORDS = 1024;
+
+  MpTcpTraceSink (std::string fileName, uint32_t ringRecords);
+  static double Now (void);
+  static void FlushAll (void);
+
+  std::string m_fileName;
+  std::ofstream m_file;
+  uint32_t m_ringRecords;
+  uint64_t m_totalRecords;            // Records written to the file
+  uint32_t m_connections;
+  uint32_t m_buffered;
+  Record m_buffer[BUFFER_RECORDS];
+};
+
+/**
+ * \brief Reads the records of a MpTcpTraceSink file back in the order they were written
+ */
+class MpTcpTraceReader
+{
+public:
+  MpTcpTraceReader (std::string fileName);
+
+  /// \returns true if the file is a valid trace file
+  bool IsOpen (void) const;
+  /// \returns the number of records that will be read
+  uint64_t GetNRecords (void) const;
+  /// \returns the number of records that were overwritten in the ring
+  uint64_t GetNLost (void) const;
+  /**
+   * \param record set to the next record
+   * \returns false once all records were read
+   */
+  bool Next (MpTcpTraceSink::Record &record);
+
+private:
+  std::ifstream m_file;
+  bool m_open;
+  MpTcpTraceSink::Header m_header;
+  uint64_t m_first;                   // Index of the oldest record kept
+  uint64_t m_next;                    // Index of the next record to read
+};
+
+} // namespace ns3
+
+#endif /* MP_TCP_TRACE_SINK_H */
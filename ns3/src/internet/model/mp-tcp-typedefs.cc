@@ -1,4 +1,5 @@
 #include <iostream>
+#include <algorithm>
 #include "ns3/mp-tcp-typedefs.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
@@ -16,6 +17,7 @@ DSNMapping::DSNMapping()
   dataLevelLength = 0;
   subflowSeqNumber = 0;
   dupAckCount = 0;
+  sacked = false;
   payload = 0;
 }
 
@@ -27,10 +29,8 @@ DSNMapping::DSNMapping(uint8_t sFlowIdx, uint64_t dSeqNum, uint16_t dLvlLen, uin
   subflowSeqNumber = sflowSeqNum;
   acknowledgement = ack;
   dupAckCount = 0;
-  payload = new uint8_t[dLvlLen];
-  pkt->CopyData(payload, dLvlLen);
-
-
+  sacked = false;
+  payload = pkt;
 }
 /*
  DSNMapping::DSNMapping (const DSNMapping &res)
@@ -54,8 +54,7 @@ DSNMapping::~DSNMapping()
 //  if (packet != 0)
   // delete[] packet;
   //packet = 0;
-  //if (payload != 0) // maybe it causes double free
-    delete[] payload;
+  payload = 0;
 }
 
 bool
@@ -67,205 +66,173 @@ DSNMapping::operator <(const DSNMapping& rhs) const
 DataBuffer::DataBuffer()
 {
   bufMaxSize = 0;
+  bufSize = 0;
 }
 
 DataBuffer::DataBuffer(uint32_t size)
 {
   bufMaxSize = size;
+  bufSize = 0;
 }
 
 DataBuffer::~DataBuffer()
 {
   bufMaxSize = 0;
+  bufSize = 0;
 }
+
 uint32_t
 DataBuffer::Add(uint32_t size)
 {
-  // read data from buf and insert it into the DataBuffer instance
-  NS_LOG_FUNCTION (this << (int) size << (int) (bufMaxSize - (uint32_t) buffer.size()) );
-  uint32_t toWrite = std::min(size, (bufMaxSize - (uint32_t) buffer.size()));
-  if (buffer.empty() == true)
-    {
-      NS_LOG_INFO("DataBuffer::Add -> buffer is empty !");
-    }
-  else
+  // Dummy payload: a zero-filled packet of the requested size, no bytes are written
+  NS_LOG_FUNCTION (this << (int) size << (int) (bufMaxSize - bufSize) );
+  uint32_t toWrite = std::min(size, (bufMaxSize - bufSize));
+  if (toWrite > 0)
     {
-      NS_LOG_INFO("DataBuffer::Add -> buffer was not empty !");
+      buffer.push_back(Create<Packet>(toWrite));
+      bufSize += toWrite;
     }
-
-  uint32_t qty = 0;
-
-  while (qty < toWrite)
-    {
-      //buffer.push(buf[qty]);
-      buffer.push((uint8_t)qty);
-      qty++;
-    }NS_LOG_INFO("DataBuffer::Add -> amount of data = "<< qty);NS_LOG_INFO("DataBuffer::Add -> freeSpace Size = "<< (bufMaxSize - (uint32_t) buffer.size()) );
-
-  return qty;
+  NS_LOG_INFO("DataBuffer::Add -> amount of data = "<< toWrite);
+  NS_LOG_INFO("DataBuffer::Add -> freeSpace Size = "<< (bufMaxSize - bufSize) );
+  return toWrite;
 }
 
 uint32_t
 DataBuffer::AddRealData(uint8_t* data, uint32_t size)
 {
-  // read data from buf and insert it into the DataBuffer instance
-  NS_LOG_FUNCTION (this << (int) size << (int) (bufMaxSize - (uint32_t) buffer.size()) );
-  // uint32_t toWrite = std::min(size, (bufMaxSize - (uint32_t) buffer.size()));
-  if (buffer.empty() == true)
+  // read data from buf and insert it into the DataBuffer instance as a single chunk
+  NS_LOG_FUNCTION (this << (int) size << (int) (bufMaxSize - bufSize) );
+  if (size > 0)
     {
-      NS_LOG_INFO("DataBuffer::Add -> buffer is empty !");
+      buffer.push_back(Create<Packet>(data, size));
+      bufSize += size;
     }
-  else
-    {
-      NS_LOG_INFO("DataBuffer::Add -> buffer was not empty !");
-    }
-
-  for (uint32_t i = 0; i < size; i++)
-  {
-    buffer.push(data[i]);
-  }
-
-  // NS_LOG_INFO("DataBuffer::Add -> amount of data = "<< qty);NS_LOG_INFO("DataBuffer::Add -> freeSpace Size = "<< (bufMaxSize - (uint32_t) buffer.size()) );
-  // std::cout << "\n\n buf: ";
-  // while (!buffer.empty())
-  // {
-  //   std::cout << buffer.front();
-  //   buffer.pop();
-  // }
-  // std::cout << std::endl;
   return size;
 }
 
-
-#ifdef OLD
+/**
+ Append the payload of an application packet without copying its bytes.
+ The packet is copied (copy-on-write) so that later header additions on the
+ segments made from it do not alter the caller's packet. */
 uint32_t
-DataBuffer::Add(uint8_t* buf, uint32_t size)
+DataBuffer::AddPacket(Ptr<const Packet> pkt)
 {
-  // read data from buf and insert it into the DataBuffer instance
-  NS_LOG_FUNCTION (this << (int) size << (int) (bufMaxSize - (uint32_t) buffer.size()) );
-  uint32_t toWrite = std::min(size, (bufMaxSize - (uint32_t) buffer.size()));
-    if (buffer.empty() == true)
-      {
-        NS_LOG_INFO("DataBuffer::Add -> buffer is empty !");
-      }
-    else
-      {
-        NS_LOG_INFO("DataBuffer::Add -> buffer was not empty !");
-      }
+  NS_LOG_FUNCTION (this << pkt->GetSize() << (int) (bufMaxSize - bufSize) );
+  uint32_t size = pkt->GetSize();
+  if (size > 0)
+    {
+      buffer.push_back(pkt->Copy());
+      bufSize += size;
+    }
+  return size;
+}
 
-  uint32_t qty = 0;
+/**
+ Detach the first 'size' bytes of the buffer as a single packet.
+ Whole chunks are moved out untouched, only the last one may be split. */
+Ptr<Packet>
+DataBuffer::PopFront(uint32_t size)
+{
+  uint32_t quantity = std::min(size, bufSize);
+  if (quantity == 0)
+    {
+      return 0;
+    }
 
-  while (qty < toWrite)
+  Ptr<Packet> pkt = 0;
+  uint32_t taken = 0;
+  while (taken < quantity)
     {
-      //buffer.push(buf[qty]);
-      buffer.push((uint8_t)qty);
-      qty++;
-    }NS_LOG_INFO("DataBuffer::Add -> amount of data = "<< qty);NS_LOG_INFO("DataBuffer::Add -> freeSpace Size = "<< (bufMaxSize - (uint32_t) buffer.size()) );
-  return qty;
+      Ptr<Packet> chunk = buffer.front();
+      uint32_t chunkSize = chunk->GetSize();
+      uint32_t need = quantity - taken;
+      if (chunkSize > need)
+        { // split: keep the tail of the chunk at the front of the buffer
+          buffer.front() = chunk->CreateFragment(need, chunkSize - need);
+          chunk = chunk->CreateFragment(0, need);
+          chunkSize = need;
+        }
+      else
+        {
+          buffer.pop_front();
+        }
+      if (pkt == 0)
+        {
+          pkt = chunk;
+        }
+      else
+        {
+          pkt->AddAtEnd(chunk);
+        }
+      taken += chunkSize;
+    }
+  bufSize -= quantity;
+  return pkt;
 }
-#endif
-
 
 uint32_t
 DataBuffer::Retrieve(uint32_t size)
 {
-  NS_LOG_FUNCTION (this << (int) size << (int) (bufMaxSize - (uint32_t) buffer.size()) );
-  uint32_t quantity = std::min(size, (uint32_t) buffer.size());
+  NS_LOG_FUNCTION (this << (int) size << (int) (bufMaxSize - bufSize) );
+  uint32_t quantity = std::min(size, bufSize);
   if (quantity == 0)
     {
       NS_LOG_INFO("DataBuffer::Retrieve -> No data to read from buffer reception !");
       return 0;
     }
 
-  for (uint32_t i = 0; i < quantity; i++)
+  uint32_t dropped = 0;
+  while (dropped < quantity)
     {
-      //buf[i] = buffer.front();
-      buffer.pop();
+      uint32_t chunkSize = buffer.front()->GetSize();
+      uint32_t need = quantity - dropped;
+      if (chunkSize > need)
+        {
+          buffer.front() = buffer.front()->CreateFragment(need, chunkSize - need);
+          dropped += need;
+        }
+      else
+        {
+          buffer.pop_front();
+          dropped += chunkSize;
+        }
     }
+  bufSize -= quantity;
 
-  NS_LOG_INFO("DataBuffer::Retrieve -> freeSpaceSize == "<< bufMaxSize - (uint32_t) buffer.size() );
+  NS_LOG_INFO("DataBuffer::Retrieve -> freeSpaceSize == "<< bufMaxSize - bufSize );
   return quantity;
 }
 
 uint8_t*
 DataBuffer::RetrieveRealData(uint32_t size)
 {
-  NS_LOG_FUNCTION (this << (int) size << (int) (bufMaxSize - (uint32_t) buffer.size()) );
-  uint32_t quantity = std::min(size, (uint32_t) buffer.size());
-  if (quantity == 0)
+  NS_LOG_FUNCTION (this << (int) size << (int) (bufMaxSize - bufSize) );
+  Ptr<Packet> pkt = PopFront(size);
+  if (pkt == 0)
     {
       NS_LOG_WARN("DataBuffer::Retrieve -> No data to read from buffer reception !");
       return 0;
     }
 
-  uint8_t *payload = new uint8_t[quantity]; // should I delete this afterwards?
-  // uint8_t *payload[quantity];
-  // std::cout << "\nretrieving buffer of size:" << quantity << "|";
-  for (uint32_t i = 0; i < quantity; i++)
-    {
-      payload[i] = buffer.front();
-      // std::cout << buffer.front();
-      buffer.pop();
-    }
-
+  uint8_t *payload = new uint8_t[pkt->GetSize()]; // caller owns it
+  pkt->CopyData(payload, pkt->GetSize());
 
-  NS_LOG_INFO("DataBuffer::Retrieve -> freeSpaceSize == "<< bufMaxSize - (uint32_t) buffer.size() );
+  NS_LOG_INFO("DataBuffer::Retrieve -> freeSpaceSize == "<< bufMaxSize - bufSize );
   return payload;
 }
 
-
-//uint32_t
-//DataBuffer::Retrieve(uint8_t* buf, uint32_t size)
-//{
-//  NS_LOG_FUNCTION (this << (int) size << (int) (bufMaxSize - (uint32_t) buffer.size()) );
-//  uint32_t quantity = std::min(size, (uint32_t) buffer.size());
-//  if (quantity == 0)
-//    {
-//      NS_LOG_INFO("DataBuffer::Retrieve -> No data to read from buffer reception !");
-//      return 0;
-//    }
-//
-//  for (uint32_t i = 0; i < quantity; i++)
-//    {
-//      buf[i] = buffer.front();
-//      buffer.pop();
-//    }
-//
-//  NS_LOG_INFO("DataBuffer::Retrieve -> freeSpaceSize == "<< bufMaxSize - (uint32_t) buffer.size() );
-//  return quantity;
-//}
-
 Ptr<Packet>
 DataBuffer::CreatePacket(uint32_t size)
 {
-  NS_LOG_FUNCTION (this << (int) size << (int) ( bufMaxSize - (uint32_t) buffer.size()) );
-  uint32_t quantity = std::min(size, (uint32_t) buffer.size());
-  if (quantity == 0)
+  NS_LOG_FUNCTION (this << (int) size << (int) ( bufMaxSize - bufSize) );
+  Ptr<Packet> pkt = PopFront(size);
+  if (pkt == 0)
     {
       NS_LOG_INFO("DataBuffer::CreatePacket -> No data ready for sending !");
       return 0;
     }
-  // Copy from front of Buffer to a new uint8_t array pointer
-  uint8_t *ptrBuffer = new uint8_t[quantity];
-  // std::cout << "\n\nsending: |";
-  for (uint32_t i = 0; i < quantity; i++)
-    {
-      ptrBuffer[i] = buffer.front();
-      // std::cout << buffer.front();
-      buffer.pop();
-    }
-  // Create packet from a data pointer and its size
-  //Ptr<Packet> pkt = new Packet(ptrBuffer, quantity);
-  Ptr<Packet> pkt = Create<Packet>(ptrBuffer, quantity);
-  // Ptr<Packet> pkt = Create<Packet>(quantity);
-  delete[] ptrBuffer;
-  //ptrBuffer = 0; // MKS
-
-  // uint8_t *bf = new uint8_t[quantity]; // leaks memory and probably not needed
-  // pkt->CopyData(bf, quantity);
 
-
-  NS_LOG_INFO("DataBuffer::CreatePacket -> freeSpaceSize == "<< bufMaxSize - (uint32_t) buffer.size() );
+  NS_LOG_INFO("DataBuffer::CreatePacket -> freeSpaceSize == "<< bufMaxSize - bufSize );
   return pkt;
 }
 
@@ -275,59 +242,54 @@ Initially it is only called upon receiving an incoming packet by mptcp stack */
 uint32_t
 DataBuffer::ReadPacket(Ptr<Packet> pkt, uint32_t dataLen)
 {
-  NS_LOG_FUNCTION (this << (int) (bufMaxSize - (uint32_t) buffer.size()) );
-
-  uint32_t toWrite = std::min(dataLen, (bufMaxSize - (uint32_t) buffer.size()));
-
-  uint8_t *ptrBuffer = new uint8_t[toWrite];
-  pkt->CopyData(ptrBuffer, toWrite);
-
-  for (uint32_t j = 0; j < toWrite; j++)
-    // buffer.push(0); // this disregards the packet contents and only pushes spaces to the recv buffer >:(
-    buffer.push(ptrBuffer[j]);
+  NS_LOG_FUNCTION (this << (int) (bufMaxSize - bufSize) );
 
-  delete[] ptrBuffer;
-  //ptrBuffer = 0; // MKS
+  uint32_t toWrite = std::min(std::min(dataLen, pkt->GetSize()), (bufMaxSize - bufSize));
+  if (toWrite > 0)
+    {
+      // Keep a reference to the payload instead of copying it; tags are not part of the byte stream
+      Ptr<Packet> chunk = pkt->CreateFragment(0, toWrite);
+      chunk->RemoveAllPacketTags();
+      chunk->RemoveAllByteTags();
+      buffer.push_back(chunk);
+      bufSize += toWrite;
+    }
 
   NS_LOG_INFO("DataBuffer::ReadPacket -> data   readed == "<< toWrite );
-  NS_LOG_INFO("DataBuffer::ReadPacket -> freeSpaceSize == "<< bufMaxSize - (uint32_t) buffer.size() );
+  NS_LOG_INFO("DataBuffer::ReadPacket -> freeSpaceSize == "<< bufMaxSize - bufSize );
   return toWrite;
 }
 
 uint32_t
 DataBuffer::PendingData()
 {
-  return ((uint32_t) buffer.size());
+  return bufSize;
 }
 
 bool
 DataBuffer::ClearBuffer()
 {
-  while (!buffer.empty())
-    {
-      buffer.pop();
-    }
-  NS_ASSERT(buffer.empty());
+  buffer.clear();
+  bufSize = 0;
   return true;
 }
 
 uint32_t
 DataBuffer::FreeSpaceSize()
 {
-  return (bufMaxSize - (uint32_t) buffer.size());
+  return (bufMaxSize - bufSize);
 }
 
 bool
 DataBuffer::Empty()
 {
-  // std::cout << "\n\n empty: |" << buffer.size() << "|\n";
-  return buffer.empty(); // ( freeSpaceSize == bufMaxSize );
+  return (bufSize == 0); // ( freeSpaceSize == bufMaxSize );
 }
 
 bool
 DataBuffer::Full()
 {
-  return (bufMaxSize == (uint32_t) buffer.size()); //( freeSpaceSize == 0 );
+  return (bufMaxSize == bufSize); //( freeSpaceSize == 0 );
 }
 
 void
@@ -336,6 +298,396 @@ DataBuffer::SetBufferSize(uint32_t size)
   bufMaxSize = size;
 }
 
+static bool
+DSNMappingSeqLess(const DSNMapping* ptrDSN, uint32_t seq)
+{
+  return ptrDSN->subflowSeqNumber < seq;
+}
+
+static bool
+DSNMappingEndLess(const DSNMapping* ptrDSN, uint32_t seq)
+{
+  return ptrDSN->subflowSeqNumber + ptrDSN->dataLevelLength < seq;
+}
+
+DSNMappingTable::DSNMappingTable() :
+    m_sackedBytes(0)
+{
+}
+
+DSNMappingTable::~DSNMappingTable()
+{
+  Clear();
+  for (vector<DSNMapping*>::iterator it = m_pool.begin(); it != m_pool.end(); ++it)
+    {
+      delete *it;
+    }
+  m_pool.clear();
+}
+
+DSNMapping*
+DSNMappingTable::Add(uint8_t sFlowIdx, uint64_t dSeqNum, uint16_t dLvlLen, uint32_t sflowSeqNum, uint32_t ack,
+    Ptr<Packet> pkt)
+{
+  NS_ASSERT_MSG(m_mappings.empty() || m_mappings.back()->subflowSeqNumber < sflowSeqNum,
+      "DSN mappings have to be added in subflow sequence order");
+  DSNMapping* ptrDSN;
+  if (m_pool.empty())
+    {
+      ptrDSN = new DSNMapping(sFlowIdx, dSeqNum, dLvlLen, sflowSeqNum, ack, pkt);
+    }
+  else
+    {
+      ptrDSN = m_pool.back();
+      m_pool.pop_back();
+      *ptrDSN = DSNMapping(sFlowIdx, dSeqNum, dLvlLen, sflowSeqNum, ack, pkt);
+    }
+  m_mappings.push_back(ptrDSN);
+  return ptrDSN;
+}
+
+DSNMapping*
+DSNMappingTable::Find(uint32_t sflowSeqNum)
+{
+  iterator it = lower_bound(m_mappings.begin(), m_mappings.end(), sflowSeqNum, DSNMappingSeqLess);
+  if (it != m_mappings.end() && (*it)->subflowSeqNumber == sflowSeqNum)
+    {
+      return *it;
+    }
+  return 0;
+}
+
+DSNMapping*
+DSNMappingTable::FindEndingAt(uint32_t ack)
+{
+  iterator it = lower_bound(m_mappings.begin(), m_mappings.end(), ack, DSNMappingEndLess);
+  if (it != m_mappings.end() && (*it)->subflowSeqNumber + (*it)->dataLevelLength == ack)
+    {
+      return *it;
+    }
+  return 0;
+}
+
+uint32_t
+DSNMappingTable::DiscardUpTo(uint32_t ack)
+{
+  uint32_t count = 0;
+  while (!m_mappings.empty() && m_mappings.front()->subflowSeqNumber + m_mappings.front()->dataLevelLength <= ack)
+    {
+      Release(m_mappings.front());
+      m_mappings.pop_front();
+      count++;
+    }
+  return count;
+}
+
+uint32_t
+DSNMappingTable::MarkSacked(uint32_t left, uint32_t right)
+{
+  uint32_t marked = 0;
+  iterator it = lower_bound(m_mappings.begin(), m_mappings.end(), left, DSNMappingSeqLess);
+  for (; it != m_mappings.end() && (*it)->subflowSeqNumber + (*it)->dataLevelLength <= right; ++it)
+    {
+      if (!(*it)->sacked)
+        {
+          (*it)->sacked = true;
+          marked += (*it)->dataLevelLength;
+        }
+    }
+  m_sackedBytes += marked;
+  return marked;
+}
+
+void
+DSNMappingTable::ClearSacked()
+{
+  for (iterator it = m_mappings.begin(); it != m_mappings.end() && m_sackedBytes > 0; ++it)
+    {
+      if ((*it)->sacked)
+        {
+          (*it)->sacked = false;
+          m_sackedBytes -= (*it)->dataLevelLength;
+        }
+    }
+  NS_ASSERT(m_sackedBytes == 0);
+}
+
+uint32_t
+DSNMappingTable::SackedBytes() const
+{
+  return m_sackedBytes;
+}
+
+bool
+DSNMappingTable::LossBoundary(uint32_t dupThresh, uint32_t &seq) const
+{
+  if (m_sackedBytes == 0)
+    {
+      return false;
+    }
+  uint32_t count = 0;
+  for (deque<DSNMapping*>::const_reverse_iterator it = m_mappings.rbegin(); it != m_mappings.rend(); ++it)
+    {
+      if ((*it)->sacked && ++count == dupThresh)
+        {
+          seq = (*it)->subflowSeqNumber;
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+DSNMappingTable::Clear()
+{
+  for (iterator it = m_mappings.begin(); it != m_mappings.end(); ++it)
+    {
+      Release(*it);
+    }
+  m_mappings.clear();
+}
+
+void
+DSNMappingTable::Release(DSNMapping* ptrDSN)
+{
+  if (ptrDSN->sacked)
+    {
+      m_sackedBytes -= ptrDSN->dataLevelLength;
+    }
+  ptrDSN->payload = 0; // do not keep the segment alive while pooled
+  m_pool.push_back(ptrDSN);
+}
+
+uint32_t
+DSNMappingTable::size() const
+{
+  return m_mappings.size();
+}
+
+bool
+DSNMappingTable::empty() const
+{
+  return m_mappings.empty();
+}
+
+DSNMappingTable::iterator
+DSNMappingTable::begin()
+{
+  return m_mappings.begin();
+}
+
+DSNMappingTable::iterator
+DSNMappingTable::end()
+{
+  return m_mappings.end();
+}
+
+UnOrderedBuffer::UnOrderedBuffer() :
+    m_size(0)
+{
+}
+
+UnOrderedBuffer::~UnOrderedBuffer()
+{
+  Clear();
+}
+
+bool
+UnOrderedBuffer::Store(uint8_t sFlowIdx, uint64_t dSeqNum, uint16_t dLvlLen, uint32_t sflowSeqNum, uint32_t ack,
+    Ptr<Packet> pkt, bool aheadOfSubflow)
+{
+  NS_LOG_FUNCTION (this << (int) sFlowIdx << dSeqNum << dLvlLen);
+  uint64_t end = dSeqNum + dLvlLen;
+  map<uint64_t, Range>::iterator next = m_ranges.lower_bound(dSeqNum);
+  if (next != m_ranges.end() && next->first < end)
+    {
+      return false;
+    }
+  map<uint64_t, Range>::iterator prev = m_ranges.end();
+  if (next != m_ranges.begin())
+    {
+      prev = next;
+      --prev;
+      if (prev->first + prev->second.length > dSeqNum)
+        {
+          return false;
+        }
+    }
+
+  Ptr<Packet> chunk = pkt->GetSize() > dLvlLen ? pkt->CreateFragment(0, dLvlLen) : pkt;
+  map<uint64_t, Range>::iterator range;
+  if (prev != m_ranges.end() && prev->first + prev->second.length == dSeqNum)
+    { // Extends the previous range
+      range = prev;
+    }
+  else
+    {
+      range = m_ranges.insert(next, make_pair(dSeqNum, Range()));
+      range->second.length = 0;
+    }
+  range->second.chunks.push_back(chunk);
+  range->second.length += dLvlLen;
+  if (next != m_ranges.end() && next->first == end)
+    { // Fills the gap to the next range
+      range->second.chunks.splice(range->second.chunks.end(), next->second.chunks);
+      range->second.length += next->second.length;
+      m_ranges.erase(next);
+    }
+  m_size += dLvlLen;
+
+  SubflowState &sFlow = m_subflows[sFlowIdx];
+  sFlow.stored.insert(dSeqNum);
+  if (aheadOfSubflow)
+    {
+      SubflowSegment &seg = sFlow.ahead[sflowSeqNum];
+      seg.length = dLvlLen;
+      seg.ack = ack;
+    }
+  return true;
+}
+
+uint32_t
+UnOrderedBuffer::Drain(uint64_t dSeqNum, list<Ptr<Packet> > &out)
+{
+  if (m_ranges.empty() || m_ranges.begin()->first != dSeqNum)
+    {
+      return 0;
+    }
+  Range &range = m_ranges.begin()->second;
+  uint32_t length = range.length;
+  out.splice(out.end(), range.chunks);
+  m_ranges.erase(m_ranges.begin());
+  m_size -= length;
+
+  for (map<uint8_t, SubflowState>::iterator it = m_subflows.begin(); it != m_subflows.end(); ++it)
+    {
+      set<uint64_t> &stored = it->second.stored;
+      stored.erase(stored.begin(), stored.lower_bound(dSeqNum + length));
+    }
+  return length;
+}
+
+bool
+UnOrderedBuffer::AdvanceSubflow(uint8_t sFlowIdx, uint32_t sflowSeqNum, uint16_t &dLvlLen, uint32_t &ack)
+{
+  map<uint8_t, SubflowState>::iterator sFlow = m_subflows.find(sFlowIdx);
+  if (sFlow == m_subflows.end())
+    {
+      return false;
+    }
+  map<uint32_t, SubflowSegment> &ahead = sFlow->second.ahead;
+  ahead.erase(ahead.begin(), ahead.lower_bound(sflowSeqNum));
+  if (ahead.empty() || ahead.begin()->first != sflowSeqNum)
+    {
+      return false;
+    }
+  dLvlLen = ahead.begin()->second.length;
+  ack = ahead.begin()->second.ack;
+  ahead.erase(ahead.begin());
+  return true;
+}
+
+bool
+UnOrderedBuffer::IsAhead(uint8_t sFlowIdx, uint32_t sflowSeqNum) const
+{
+  map<uint8_t, SubflowState>::const_iterator sFlow = m_subflows.find(sFlowIdx);
+  return (sFlow != m_subflows.end() && sFlow->second.ahead.count(sflowSeqNum) > 0);
+}
+
+uint8_t
+UnOrderedBuffer::SackBlocks(uint8_t sFlowIdx, uint32_t recent, uint32_t *left, uint32_t *right, uint8_t maxBlocks) const
+{
+  map<uint8_t, SubflowState>::const_iterator sFlow = m_subflows.find(sFlowIdx);
+  if (sFlow == m_subflows.end() || sFlow->second.ahead.empty() || maxBlocks == 0)
+    {
+      return 0;
+    }
+  const map<uint32_t, SubflowSegment> &ahead = sFlow->second.ahead;
+  typedef map<uint32_t, SubflowSegment>::const_iterator Iter;
+  uint8_t n = 0;
+
+  // RFC 2018: the first block holds the segment received last
+  Iter first = ahead.upper_bound(recent);
+  if (first != ahead.begin())
+    {
+      --first;
+      if (first->first + first->second.length > recent)
+        {
+          Iter lo = first;
+          while (lo != ahead.begin())
+            {
+              Iter prev = lo;
+              --prev;
+              if (prev->first + prev->second.length != lo->first)
+                break;
+              lo = prev;
+            }
+          Iter hi = first;
+          for (Iter next = hi; ++next != ahead.end() && hi->first + hi->second.length == next->first; hi = next)
+            ;
+          left[n] = lo->first;
+          right[n] = hi->first + hi->second.length;
+          n++;
+        }
+    }
+
+  // Then the other blocks, highest first
+  Iter it = ahead.end();
+  while (it != ahead.begin() && n < maxBlocks)
+    {
+      --it;
+      uint32_t end = it->first + it->second.length;
+      while (it != ahead.begin())
+        {
+          Iter prev = it;
+          --prev;
+          if (prev->first + prev->second.length != it->first)
+            break;
+          it = prev;
+        }
+      if (n == 0 || it->first != left[0])
+        {
+          left[n] = it->first;
+          right[n] = end;
+          n++;
+        }
+    }
+  return n;
+}
+
+bool
+UnOrderedBuffer::HasData(uint8_t sFlowIdx) const
+{
+  map<uint8_t, SubflowState>::const_iterator sFlow = m_subflows.find(sFlowIdx);
+  return (sFlow != m_subflows.end() && !sFlow->second.stored.empty());
+}
+
+bool
+UnOrderedBuffer::Empty() const
+{
+  return m_ranges.empty();
+}
+
+uint32_t
+UnOrderedBuffer::Size() const
+{
+  return m_size;
+}
+
+uint32_t
+UnOrderedBuffer::RangeCount() const
+{
+  return m_ranges.size();
+}
+
+void
+UnOrderedBuffer::Clear()
+{
+  m_ranges.clear();
+  m_subflows.clear();
+  m_size = 0;
+}
+
 MpTcpAddressInfo::MpTcpAddressInfo() :
     addrID(0), ipv4Addr(Ipv4Address::GetZero()), mask(Ipv4Mask::GetZero())
 {
@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <vector>
 #include <queue>
+#include <deque>
 #include <list>
 #include <set>
 #include <map>
@@ -47,7 +48,10 @@ typedef enum
 
 typedef enum
 {
-  Round_Robin
+  Round_Robin,  // 0
+  Min_RTT,      // 1 lowest smoothed RTT with free window
+  BLEST,        // 2 blocking estimation, skip the slow subflow if it would stall the window
+  ECF           // 3 earliest completion first
 } DataDistribAlgo_t;
 
 typedef enum
@@ -71,9 +75,98 @@ public:
   uint32_t subflowSeqNumber;
   uint32_t acknowledgement;
   uint32_t dupAckCount;
+  bool sacked;          // Reported received by a SACK block of the peer
   uint8_t subflowIndex;
   //uint8_t *packet;
-  uint8_t *payload;
+  Ptr<Packet> payload;  // Shares the segment's payload, kept for retransmission/reassembly
+};
+
+/**
+ * Per-subflow table of sent but not yet acknowledged segments.
+ *
+ * Segments are only ever appended in increasing subflow sequence order, so the
+ * table is a deque that is binary searched on lookup and trimmed from the front
+ * on a cumulative ACK. Released DSNMapping objects are pooled for reuse.
+ *
+ * It is also the SACK scoreboard of the subflow: segments covered by a SACK
+ * block of the peer are marked, and the bytes so marked are counted.
+ */
+class DSNMappingTable
+{
+public:
+  typedef deque<DSNMapping*>::iterator iterator;
+  DSNMappingTable();
+  ~DSNMappingTable();
+  DSNMapping* Add(uint8_t sFlowIdx, uint64_t dSeqNum, uint16_t dLvlLen, uint32_t sflowSeqNum, uint32_t ack, Ptr<Packet> pkt);
+  DSNMapping* Find(uint32_t sflowSeqNum);   // Segment starting at sflowSeqNum, 0 if none
+  DSNMapping* FindEndingAt(uint32_t ack);   // Segment whose last byte is ack - 1, 0 if none
+  uint32_t DiscardUpTo(uint32_t ack);       // Releases every segment fully covered by ack
+  uint32_t MarkSacked(uint32_t left, uint32_t right); // Marks the segments within [left, right), returns the bytes newly marked
+  void ClearSacked();
+  uint32_t SackedBytes() const;
+  // RFC 6675 IsLost(): an unSACKed segment starting below 'seq' has at least dupThresh SACKed segments above it
+  bool LossBoundary(uint32_t dupThresh, uint32_t &seq) const;
+  void Clear();
+  uint32_t size() const;
+  bool empty() const;
+  iterator begin();
+  iterator end();
+private:
+  void Release(DSNMapping* ptrDSN);
+  deque<DSNMapping*> m_mappings;
+  vector<DSNMapping*> m_pool;
+  uint32_t m_sackedBytes;
+};
+
+/**
+ * Connection level reassembly queue for data received out of order.
+ *
+ * Payload is indexed by data sequence number and contiguous segments are
+ * coalesced into one range, so the data that becomes in-order when a hole is
+ * filled is drained with a single lookup. Segments that arrived ahead of their
+ * subflow's RxSeqNumber are also indexed per subflow, so the subflow can move
+ * past them once its own hole is filled.
+ */
+class UnOrderedBuffer
+{
+public:
+  UnOrderedBuffer();
+  ~UnOrderedBuffer();
+  // Returns false if the segment overlaps stored data
+  bool Store(uint8_t sFlowIdx, uint64_t dSeqNum, uint16_t dLvlLen, uint32_t sflowSeqNum, uint32_t ack, Ptr<Packet> pkt,
+      bool aheadOfSubflow);
+  // Moves the range starting at dSeqNum (if any) to 'out' and returns its length
+  uint32_t Drain(uint64_t dSeqNum, list<Ptr<Packet> > &out);
+  // Pops the segment of sFlowIdx that starts at sflowSeqNum (if any); older ones are dropped
+  bool AdvanceSubflow(uint8_t sFlowIdx, uint32_t sflowSeqNum, uint16_t &dLvlLen, uint32_t &ack);
+  // Whether the segment of sFlowIdx starting at sflowSeqNum is held ahead of the subflow
+  bool IsAhead(uint8_t sFlowIdx, uint32_t sflowSeqNum) const;
+  // SACK blocks of the segments held ahead of sFlowIdx: the one holding 'recent' first, then the highest ones
+  uint8_t SackBlocks(uint8_t sFlowIdx, uint32_t recent, uint32_t *left, uint32_t *right, uint8_t maxBlocks) const;
+  bool HasData(uint8_t sFlowIdx) const;
+  bool Empty() const;
+  uint32_t Size() const;        // Bytes held
+  uint32_t RangeCount() const;  // Number of disjoint ranges held
+  void Clear();
+private:
+  struct Range
+  {
+    uint32_t length;
+    list<Ptr<Packet> > chunks;
+  };
+  struct SubflowSegment
+  {
+    uint16_t length;
+    uint32_t ack;
+  };
+  struct SubflowState
+  {
+    set<uint64_t> stored;                  // dSeqNum of this subflow's segments still held
+    map<uint32_t, SubflowSegment> ahead;   // Segments beyond the subflow's RxSeqNumber
+  };
+  map<uint64_t, Range> m_ranges;
+  map<uint8_t, SubflowState> m_subflows;
+  uint32_t m_size;
 };
 
 class MpTcpAddressInfo
@@ -86,17 +179,26 @@ public:
   Ipv4Mask mask;
 };
 
+/**
+ * Connection level byte stream buffer.
+ *
+ * Data is kept as a queue of packet chunks rather than individual bytes, so
+ * appending and splitting are O(1) in the number of bytes. Chunks added with
+ * Add(size) are zero-filled packets that never materialize their payload.
+ */
 class DataBuffer
 {
 public:
   DataBuffer();
   DataBuffer(uint32_t size);
   ~DataBuffer();
-  queue<uint8_t> buffer;
+  deque<Ptr<Packet> > buffer;
   uint32_t bufMaxSize;
+  uint32_t bufSize;
   //uint32_t Add(uint8_t* buf, uint32_t size);
   uint32_t Add(uint32_t size);
   uint32_t AddRealData(uint8_t* data, uint32_t size);
+  uint32_t AddPacket(Ptr<const Packet> pkt);
   //uint32_t Retrieve(uint8_t* buf, uint32_t size);
   uint32_t Retrieve(uint32_t size);
   uint8_t* RetrieveRealData(uint32_t size);
@@ -108,6 +210,8 @@ public:
   uint32_t PendingData();
   uint32_t FreeSpaceSize();
   void SetBufferSize(uint32_t size);
+private:
+  Ptr<Packet> PopFront(uint32_t size);
 };
 
 } //namespace ns3
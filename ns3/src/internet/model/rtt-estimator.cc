@@ -326,4 +326,9 @@ void RttMeanDeviation::Gain (double g)
   m_gain = g;
 }
 
+Time RttMeanDeviation::GetVariance (void) const
+{
+  return m_variance;
+}
+
 } //namespace ns3
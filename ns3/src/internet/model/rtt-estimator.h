@@ -227,6 +227,12 @@ public:
    */
   void Gain (double g);
 
+  /**
+   * \brief gets the current mean deviation of the RTT samples.
+   * \return The current RTT variance.
+   */
+  Time GetVariance (void) const;
+
 private:
   double       m_gain;       //!< Filter gain
   Time         m_variance;   //!< Current variance
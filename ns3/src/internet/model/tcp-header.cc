@@ -24,6 +24,7 @@
 #include "ns3/buffer.h"
 #include "ns3/address-utils.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 
 NS_LOG_COMPONENT_DEFINE ("TcpHeader");
 //using namespace std;
@@ -35,7 +36,7 @@ NS_OBJECT_ENSURE_REGISTERED(TcpHeader);
 
 TcpHeader::TcpHeader() :
     m_sourcePort(0), m_destinationPort(0), m_sequenceNumber(0), m_ackNumber(0), m_length(5), m_flags(0), m_windowSize(0xffff), m_urgentPointer(
-        0), m_calcChecksum(false), m_goodChecksum(true), m_option(0), oLen(0), pLen(0), original(true)
+        0), m_calcChecksum(false), m_goodChecksum(true), m_nOptions(0), oLen(0), pLen(0)
 {
 }
 
@@ -305,39 +306,49 @@ TcpHeader::Print(std::ostream &os) const
     }
   os << " Seq=" << GetSequenceNumber() << " Ack=" << GetAckNumber() << " Win=" << GetWindowSize();
 
-  for (uint32_t j = 0; j < m_option.size(); j++)
+  for (uint8_t j = 0; j < m_nOptions; j++)
     {
       os << " {";
-      TcpOptions *opt = m_option[j];
-      OptMultipathCapable *optMPC;
-      //OptJoinConnection *optJOIN;
-      //OptAddAddress *optADDR;
-      //OptDataSeqMapping *optDSN;
-      //os << opt->optName;
-      if (opt->optName == OPT_MPC)
+      const TcpOptions &opt = m_option[j];
+      //os << opt.optName;
+      if (opt.optName == OPT_MPC)
         {
           os << "OPT_MPC(";
-          optMPC = (OptMultipathCapable *) opt;
-          os << optMPC->senderToken << ")";
+          os << opt.mpc.senderToken << ")";
         }
-      else if (opt->optName == OPT_JOIN)
+      else if (opt.optName == OPT_JOIN)
         {
           os << "OPT_JOIN";
-//          optJOIN = (OptJoinConnection *) opt;
-//          os << optJOIN->receiverToken;
-//          os << optJOIN->addrID;
+//          os << opt.join.receiverToken;
+//          os << opt.join.addrID;
         }
-      else if (opt->optName == OPT_ADDR)
+      else if (opt.optName == OPT_ADDR)
         {
           os << "OPT_ADDR";
         }
-      else if (opt->optName == OPT_DSN)
+      else if (opt.optName == OPT_WSCALE)
+        {
+          os << "OPT_WSCALE(" << (int) opt.wscale.shift << ")";
+        }
+      else if (opt.optName == OPT_SACK_PERMITTED)
+        {
+          os << "OPT_SACK_PERMITTED";
+        }
+      else if (opt.optName == OPT_SACK)
+        {
+          os << "OPT_SACK(";
+          for (uint8_t k = 0; k < opt.sack.nBlocks; k++)
+            {
+              os << (k ? " " : "") << opt.sack.left[k] << "-" << opt.sack.right[k];
+            }
+          os << ")";
+        }
+      else if (opt.optName == OPT_DSN)
         {
           os << "OPT_DSN";
-          //optDSN = (OptDataSeqMapping *) opt;
-          //os << optDSN->dataSeqNumber;
-          //os << optDSN->dataLevelLength;
-          //os << optDSN->subflowSeqNumber;
+          //os << opt.dsn.dataSeqNumber;
+          //os << opt.dsn.dataLevelLength;
+          //os << opt.dsn.subflowSeqNumber;
         }
       os << "}";
     }
@@ -397,38 +408,43 @@ TcpHeader::Serialize(Buffer::Iterator start) const
     }
 
   // write options in head
-  for (uint32_t j = 0; j < m_option.size(); j++)
+  for (uint8_t j = 0; j < m_nOptions; j++)
     {
-      TcpOptions *opt = m_option[j];
-      OptMultipathCapable *optMPC;
-      OptJoinConnection *optJOIN;
-      OptAddAddress *optADDR;
-      OptDataSeqMapping *optDSN;
-      i.WriteU8(TcpOptionToUint(opt->optName));
-
-      if (opt->optName == OPT_MPC)
+      const TcpOptions &opt = m_option[j];
+      i.WriteU8(TcpOptionToUint(opt.optName));
+
+      if (opt.optName == OPT_MPC)
         {
-          optMPC = (OptMultipathCapable *) opt;
-          i.WriteHtonU32(optMPC->senderToken);
+          i.WriteHtonU32(opt.mpc.senderToken);
         }
-      else if (opt->optName == OPT_JOIN)
+      else if (opt.optName == OPT_JOIN)
         {
-          optJOIN = (OptJoinConnection *) opt;
-          i.WriteHtonU32(optJOIN->receiverToken);
-          i.WriteU8(optJOIN->addrID);
+          i.WriteHtonU32(opt.join.receiverToken);
+          i.WriteU8(opt.join.addrID);
         }
-      else if (opt->optName == OPT_ADDR)
+      else if (opt.optName == OPT_ADDR)
         {
-          optADDR = (OptAddAddress *) opt;
-          i.WriteU8(optADDR->addrID);
-          i.WriteHtonU32(optADDR->addr.Get());
+          i.WriteU8(opt.addAddr.addrID);
+          i.WriteHtonU32(opt.addAddr.addr);
         }
-      else if (opt->optName == OPT_DSN)
+      else if (opt.optName == OPT_DSN)
         {
-          optDSN = (OptDataSeqMapping *) opt;
-          i.WriteU64(optDSN->dataSeqNumber);
-          i.WriteHtonU16(optDSN->dataLevelLength);
-          i.WriteHtonU32(optDSN->subflowSeqNumber);
+          i.WriteU64(opt.dsn.dataSeqNumber);
+          i.WriteHtonU16(opt.dsn.dataLevelLength);
+          i.WriteHtonU32(opt.dsn.subflowSeqNumber);
+        }
+      else if (opt.optName == OPT_WSCALE)
+        {
+          i.WriteU8(opt.wscale.shift);
+        }
+      else if (opt.optName == OPT_SACK)
+        {
+          i.WriteU8(opt.sack.nBlocks);
+          for (uint8_t k = 0; k < opt.sack.nBlocks; k++)
+            {
+              i.WriteHtonU32(opt.sack.left[k]);
+              i.WriteHtonU32(opt.sack.right[k]);
+            }
         }
     }
   for (int j = 0; j < (int) pLen; j++)
@@ -495,43 +511,80 @@ TcpHeader::Deserialize(Buffer::Iterator start)
     }
 
   // handle options field
-  while (!i.IsEnd() && hlen > 0)
+  m_nOptions = 0;
+  while (!i.IsEnd() && hlen > 0 && m_nOptions < MAX_OPTIONS)
     {
-      TcpOptions *opt;
       TcpOption_t kind = (TcpOption_t) i.ReadU8(); //TcpOption_t kind = UintToTcpOption(i.ReadU8());
       if (kind == OPT_MPC)
         {
-          opt = new OptMultipathCapable(kind, i.ReadNtohU32());
+          TcpOptions *opt = AddOption(kind, 5);
+          opt->mpc.senderToken = i.ReadNtohU32();
           plen = (plen + 5) % 4;
           hlen -= 5;
         }
       else if (kind == OPT_JOIN)
         {
-          opt = new OptJoinConnection(kind, i.ReadNtohU32(), i.ReadU8());
+          TcpOptions *opt = AddOption(kind, 6);
+          opt->join.receiverToken = i.ReadNtohU32();
+          opt->join.addrID = i.ReadU8();
           plen = (plen + 6) % 4;
           hlen -= 6;
         }
       else if (kind == OPT_ADDR)
         {
-          opt = new OptAddAddress(kind, i.ReadU8(), Ipv4Address(i.ReadNtohU32()));
+          TcpOptions *opt = AddOption(kind, 6);
+          opt->addAddr.addrID = i.ReadU8();
+          opt->addAddr.addr = i.ReadNtohU32();
           plen = (plen + 6) % 4;
           hlen -= 6;
         }
       else if (kind == OPT_DSN)
         {
-          opt = new OptDataSeqMapping(kind, i.ReadU64(), i.ReadNtohU16(), i.ReadNtohU32());
+          TcpOptions *opt = AddOption(kind, 15);
+          opt->dsn.dataSeqNumber = i.ReadU64();
+          opt->dsn.dataLevelLength = i.ReadNtohU16();
+          opt->dsn.subflowSeqNumber = i.ReadNtohU32();
           plen = (plen + 15) % 4;
           hlen -= 15;
         }
+      else if (kind == OPT_WSCALE)
+        {
+          TcpOptions *opt = AddOption(kind, 2);
+          opt->wscale.shift = i.ReadU8();
+          plen = (plen + 2) % 4;
+          hlen -= 2;
+        }
+      else if (kind == OPT_SACK_PERMITTED)
+        {
+          AddOption(kind, 1);
+          plen = (plen + 1) % 4;
+          hlen -= 1;
+        }
+      else if (kind == OPT_SACK)
+        {
+          uint8_t nBlocks = i.ReadU8();
+          TcpOptions *opt = AddOption(kind, 2 + 8 * nBlocks);
+          opt->sack.nBlocks = 0;
+          for (uint8_t k = 0; k < nBlocks; k++)
+            { // Blocks beyond what a TcpOptions holds are skipped
+              uint32_t left = i.ReadNtohU32();
+              uint32_t right = i.ReadNtohU32();
+              if (k < TcpOptions::MAX_SACK_BLOCKS)
+                {
+                  opt->sack.left[k] = left;
+                  opt->sack.right[k] = right;
+                  opt->sack.nBlocks++;
+                }
+            }
+          plen = (plen + opt->Length) % 4;
+          hlen -= opt->Length;
+        }
       else
         {
           // the rest are pending octets, so leave
           hlen = 0;
           break;
         }
-
-      m_option.insert(m_option.end(), opt);
-
     }
   //i.Next(plen);
   NS_LOG_INFO("TcpHeader::Deserialize leaving this method plen" << plen);
@@ -546,44 +599,27 @@ TcpHeader::SetOptionsLength(uint8_t length)
   oLen = length;
 }
 
-vector<TcpOptions*>
-TcpHeader::GetOptions(void) const
+uint8_t
+TcpHeader::GetNOptions(void) const
 {
-  return m_option;
+  return m_nOptions;
 }
 
-void
-TcpHeader::SetOptions(vector<TcpOptions*> opt)
+const TcpOptions&
+TcpHeader::GetOption(uint8_t i) const
 {
-  m_option = opt;
+  NS_ASSERT(i < m_nOptions);
+  return m_option[i];
 }
 
 uint8_t
 TcpHeader::GetOptionsLength() const
 {
   uint8_t length = 0;
-  TcpOptions *opt;
 
-  for (uint32_t j = 0; j < m_option.size(); j++)
+  for (uint8_t j = 0; j < m_nOptions; j++)
     {
-      opt = m_option[j];
-
-      if (opt->optName == OPT_MPC)
-        {
-          length += 5;
-        }
-      else if (opt->optName == OPT_JOIN)
-        {
-          length += 6;
-        }
-      else if (opt->optName == OPT_ADDR)
-        {
-          length += 6;
-        }
-      else if (opt->optName == OPT_DSN)
-        {
-          length += 15;
-        }
+      length += m_option[j].Length;
     }
   //return oLen;
   return length;
@@ -615,6 +651,12 @@ TcpHeader::TcpOptionToUint(TcpOption_t opt) const
     i = 32;
   else if (opt == OPT_DSN)
     i = 34;
+  else if (opt == OPT_WSCALE)
+    i = 3;
+  else if (opt == OPT_SACK_PERMITTED)
+    i = 4;
+  else if (opt == OPT_SACK)
+    i = 5;
   else if (opt == OPT_NONE)
     i = 0;
   return i;
@@ -632,28 +674,18 @@ TcpHeader::UintToTcpOption(uint8_t kind) const
     i = OPT_ADDR;
   else if (kind == 34)
     i = OPT_DSN;
+  else if (kind == 3)
+    i = OPT_WSCALE;
+  else if (kind == 4)
+    i = OPT_SACK_PERMITTED;
+  else if (kind == 5)
+    i = OPT_SACK;
   else if (kind == 0)
     i = OPT_NONE;
   return i;
 }
 
 
-TcpHeader::TcpHeader(const TcpHeader &res)
-{
-  //NS_LOG_FUNCTION_NOARGS();
-  SetSourcePort(res.GetSourcePort());
-  SetDestinationPort(res.GetDestinationPort());
-  SetFlags(res.GetFlags());
-  SetSequenceNumber(res.GetSequenceNumber());
-  SetAckNumber(res.GetAckNumber());
-  SetWindowSize(res.GetWindowSize());
-  //SetOptions         ( res.GetOptions () );
-  SetLength(res.GetLength());
-  SetOptionsLength(res.GetOptionsLength());
-  SetPaddingLength(res.GetPaddingLength());
-  SetOptions(res.GetOptions());
-  original = false;
-}
 /*
  TcpHeader
  TcpHeader::Copy()
@@ -675,32 +707,16 @@ TcpHeader::TcpHeader(const TcpHeader &res)
  */
 TcpHeader::~TcpHeader()
 {
-  if (original == false)
-    return;
-  //NS_LOG_FUNCTION_NOARGS();
-  for (uint32_t i = 0; i < m_option.size(); i++)
-    {
-      if (m_option[i] != 0)
-        switch (m_option[i]->optName)
-          {
-        case OPT_MPC:
-          delete (OptMultipathCapable*) m_option[i];
-          break;
-        case OPT_JOIN:
-          delete (OptJoinConnection*) m_option[i];
-          break;
-        case OPT_ADDR:
-          delete (OptAddAddress*) m_option[i];
-          break;
-        case OPT_DSN:
-          delete (OptDataSeqMapping*) m_option[i];
-          break;
-        default:
-          break;
-          }
-    }
-  m_option.clear();
-  oLen = 0;
+}
+
+TcpOptions*
+TcpHeader::AddOption(TcpOption_t optName, uint8_t length)
+{
+  NS_ABORT_MSG_IF(m_nOptions == MAX_OPTIONS, "No room for another MPTCP option in the TCP header");
+  TcpOptions *opt = &m_option[m_nOptions++];
+  opt->optName = optName;
+  opt->Length = length;
+  return opt;
 }
 
 bool
@@ -709,10 +725,7 @@ TcpHeader::AddOptMPC(TcpOption_t optName, uint32_t TxToken)
 //  NS_LOG_FUNCTION(this);
   if (optName == OPT_MPC)
     {
-      OptMultipathCapable* opt = new OptMultipathCapable(optName, TxToken);
-
-      m_option.insert(m_option.end(), opt);
-
+      AddOption(optName, 5)->mpc.senderToken = TxToken;
       return true;
     }
   return false;
@@ -724,9 +737,9 @@ TcpHeader::AddOptJOIN(TcpOption_t optName, uint32_t RxToken, uint8_t addrID)
 //  NS_LOG_FUNCTION(this);
   if (optName == OPT_JOIN)
     {
-      OptJoinConnection* opt = new OptJoinConnection(optName, RxToken, addrID);
-
-      m_option.insert(m_option.end(), opt);
+      TcpOptions *opt = AddOption(optName, 6);
+      opt->join.receiverToken = RxToken;
+      opt->join.addrID = addrID;
       return true;
     }
   return false;
@@ -738,9 +751,9 @@ TcpHeader::AddOptADDR(TcpOption_t optName, uint8_t addrID, Ipv4Address addr)
 //  NS_LOG_FUNCTION(this);
   if (optName == OPT_ADDR)
     {
-      OptAddAddress* opt = new OptAddAddress(optName, addrID, addr);
-
-      m_option.insert(m_option.end(), opt);
+      TcpOptions *opt = AddOption(optName, 6);
+      opt->addAddr.addrID = addrID;
+      opt->addAddr.addr = addr.Get();
       return true;
     }
   return false;
@@ -752,8 +765,49 @@ TcpHeader::AddOptDSN(TcpOption_t optName, uint64_t dSeqNum, uint16_t dLevelLengt
 //  NS_LOG_FUNCTION(this);
   if (optName == OPT_DSN)
     {
-      OptDataSeqMapping* opt = new OptDataSeqMapping(optName, dSeqNum, dLevelLength, sfSeqNum);
-      m_option.insert(m_option.end(), opt);
+      TcpOptions *opt = AddOption(optName, 15);
+      opt->dsn.dataSeqNumber = dSeqNum;
+      opt->dsn.dataLevelLength = dLevelLength;
+      opt->dsn.subflowSeqNumber = sfSeqNum;
+      return true;
+    }
+  return false;
+}
+
+bool
+TcpHeader::AddOptWSCALE(TcpOption_t optName, uint8_t shift)
+{
+  if (optName == OPT_WSCALE)
+    {
+      AddOption(optName, 2)->wscale.shift = shift;
+      return true;
+    }
+  return false;
+}
+
+bool
+TcpHeader::AddOptSACKPERM(TcpOption_t optName)
+{
+  if (optName == OPT_SACK_PERMITTED)
+    {
+      AddOption(optName, 1);
+      return true;
+    }
+  return false;
+}
+
+bool
+TcpHeader::AddOptSACK(TcpOption_t optName, uint8_t nBlocks, const uint32_t *left, const uint32_t *right)
+{
+  if (optName == OPT_SACK && nBlocks > 0 && nBlocks <= TcpOptions::MAX_SACK_BLOCKS)
+    {
+      TcpOptions *opt = AddOption(optName, 2 + 8 * nBlocks);
+      opt->sack.nBlocks = nBlocks;
+      for (uint8_t k = 0; k < nBlocks; k++)
+        {
+          opt->sack.left[k] = left[k];
+          opt->sack.right[k] = right[k];
+        }
       return true;
     }
   return false;
@@ -47,7 +47,6 @@ class TcpHeader : public Header
 {
 public:
   TcpHeader();
-  TcpHeader(const TcpHeader &res);
   //TcpHeader Copy();
 
   virtual
@@ -58,14 +57,26 @@ public:
   bool AddOptJOIN(TcpOption_t optName, uint32_t RxToken, uint8_t addrID);   // Join Connection Option
   bool AddOptADDR(TcpOption_t optName, uint8_t addrID, Ipv4Address addr);// Add address Option
   bool AddOptDSN(TcpOption_t optName, uint64_t dSeqNum, uint16_t dLevelLength, uint32_t sfSeqNum); // Data Sequence Mapping Option
+  bool AddOptWSCALE(TcpOption_t optName, uint8_t shift);   // Window Scale Option (RFC 7323), SYN segments only
+  bool AddOptSACKPERM(TcpOption_t optName);                // SACK Permitted Option (RFC 2018), SYN segments only
+  bool AddOptSACK(TcpOption_t optName, uint8_t nBlocks, const uint32_t *left, const uint32_t *right); // SACK Option (RFC 2018)
   void SetOptionsLength(uint8_t length);
   void SetPaddingLength(uint8_t length);
   uint8_t GetOptionsLength() const;
   uint8_t GetPaddingLength() const;
   uint8_t TcpOptionToUint(TcpOption_t opt) const;
   TcpOption_t UintToTcpOption(uint8_t kind) const;
-  vector<TcpOptions*> GetOptions(void) const;
-  void SetOptions(vector<TcpOptions*> opt);
+  /**
+   * \return the number of MPTCP options in this TcpHeader
+   */
+  uint8_t GetNOptions(void) const;
+  /**
+   * \param i index of the option, below GetNOptions()
+   * \return the i-th MPTCP option, valid as long as this TcpHeader
+   */
+  const TcpOptions& GetOption(uint8_t i) const;
+
+  static const uint8_t MAX_OPTIONS = 8;   //!< 40 bytes of options hold at most 8 of the shortest (OPT_MPC)
   //--------------------------------------------
   /**
    * \brief Enable checksum calculation for TCP
@@ -266,10 +277,12 @@ private:
   bool m_goodChecksum;    //!< Flag to indicate that checksum is correct
 
   // MPTCP related variables------------
-  vector<TcpOptions*> m_option;
+  TcpOptions* AddOption(TcpOption_t optName, uint8_t length);
+
+  TcpOptions m_option[MAX_OPTIONS];       //!< MPTCP options, stored inline
+  uint8_t m_nOptions;                     //!< Number of options in m_option
   uint8_t oLen;
   uint8_t pLen;
-  bool original;
   //------------------------------------
 };
 
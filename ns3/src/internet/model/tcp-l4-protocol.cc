@@ -39,6 +39,7 @@
 #include "ipv6-end-point.h"
 #include "ipv4-l3-protocol.h"
 #include "ipv6-l3-protocol.h"
+#include "ipv4-routing-protocol.h"
 #include "ipv6-routing-protocol.h"
 #include "tcp-socket-factory-impl.h"
 #include "tcp-newreno.h"
@@ -86,7 +87,7 @@ TcpL4Protocol::GetTypeId(void)
 }
 
 TcpL4Protocol::TcpL4Protocol() :
-    m_endPoints(new Ipv4EndPointDemux()), m_endPoints6(new Ipv6EndPointDemux())
+    m_endPoints(new Ipv4EndPointDemux()), m_endPoints6(new Ipv6EndPointDemux()), m_routeCacheVersion(0)
 {
   NS_LOG_FUNCTION_NOARGS (); NS_LOG_LOGIC ("Made a TcpL4Protocol "<<this);
 }
@@ -167,6 +168,8 @@ TcpL4Protocol::DoDispose(void)
       m_endPoints6 = 0;
     }
 
+  m_routeCache.clear();
+  m_routeCacheProtocol = 0;
   m_node = 0;
   m_downTarget.Nullify();
   m_downTarget6.Nullify();
@@ -359,21 +362,19 @@ TcpL4Protocol::Receive(Ptr<Packet> packet, Ipv4Header const &ipHeader, Ptr<Ipv4I
   //
   // MPTCP related modification----------------------------
   // Extract MPTCP options if there is any
-  vector<TcpOptions*> options = tcpHeader.GetOptions();
   uint8_t flags = tcpHeader.GetFlags();
   bool hasSyn = flags & TcpHeader::SYN;
-  TcpOptions *opt;
   uint32_t Token;
-  for (uint32_t j = 0; j < options.size(); j++)
+  for (uint8_t j = 0; j < tcpHeader.GetNOptions(); j++)
     {
-      opt = options[j];
+      const TcpOptions *opt = &tcpHeader.GetOption(j);
       if ((opt->optName == OPT_MPC) && hasSyn)
         { // In this case the endpoint with destination port and token value of zero need to be find.
           NS_LOG_INFO("TcpL4Protocol::Receive -> OPT_MPC -> Do NOTTING");
         }
       else if ((opt->optName == OPT_JOIN) && hasSyn)
         { // In this case there should be endPoint with this token, so look for a match on all endpoints.
-          Token = ((OptJoinConnection *) opt)->receiverToken;
+          Token = opt->join.receiverToken;
           TokenMaps::iterator it;
           it = m_TokenMap.find(Token);
           if (it != m_TokenMap.end())
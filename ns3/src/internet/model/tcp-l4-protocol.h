@@ -26,6 +26,7 @@
 #include <map>
 
 #include "ns3/packet.h"
+#include "ns3/sgi-hashmap.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/ptr.h"
@@ -44,6 +45,7 @@ class Ipv6EndPointDemux;
 class Ipv4Interface;
 class TcpSocketBase;
 class Ipv4EndPoint;
+class Ipv4RoutingProtocol;
 class Ipv6EndPoint;
 
 /**
@@ -64,7 +66,8 @@ public:
    */
   static TypeId GetTypeId (void);
   static const uint8_t PROT_NUMBER; //!< protocol number (0x6)
-  typedef std::map<uint32_t, Ipv4EndPoint*> TokenMaps; // MPTCP related modification
+  typedef sgi::hash_map<uint32_t, Ipv4EndPoint*> TokenMaps; // MPTCP related modification
+  typedef std::map<std::pair<Ipv4Address, Ipv4Address>, bool> RouteCache; // MPTCP related modification
 
   TcpL4Protocol ();
   virtual ~TcpL4Protocol ();
@@ -268,7 +271,10 @@ private:
   TcpL4Protocol &operator = (const TcpL4Protocol &);
 
   std::vector<Ptr<TcpSocketBase> > m_sockets;      //!< list of sockets
-  std::map<uint32_t, Ipv4EndPoint* > m_TokenMap;   //!< list of Token
+  TokenMaps m_TokenMap;                            //!< MPTCP connection endpoint of each local token
+  RouteCache m_routeCache;                         //!< MPTCP subflow route checks by (source, destination)
+  Ptr<Ipv4RoutingProtocol> m_routeCacheProtocol;   //!< Routing protocol m_routeCache was filled from
+  uint32_t m_routeCacheVersion;                    //!< Its routing table version at that time
   IpL4Protocol::DownTargetCallback m_downTarget;   //!< Callback to send packets over IPv4
   IpL4Protocol::DownTargetCallback6 m_downTarget6; //!< Callback to send packets over IPv6
 };
@@ -14,61 +14,65 @@ namespace ns3
 typedef enum
 {
   OPT_NONE = 0,
+  OPT_WSCALE = 3,
+  OPT_SACK_PERMITTED = 4,
+  OPT_SACK = 5,
   OPT_MPC = 30,
   OPT_JOIN = 31,
   OPT_ADDR = 32,
   OPT_DSN = 34
 } TcpOption_t;
 
+/**
+ * \brief An MPTCP (or window scale / SACK) option carried by a TcpHeader
+ *
+ * A tagged variant: optName says which member of the union holds the fields
+ * of the option. TcpHeader keeps its options by value, so adding, parsing
+ * and reading them never allocates.
+ */
 class TcpOptions
 {
 public:
-  TcpOptions();
-  virtual
-  ~TcpOptions();
-
-  TcpOption_t optName;
-  uint8_t Length;
-};
-
-class OptMultipathCapable : public TcpOptions
-{
-public:
-  virtual
-  ~OptMultipathCapable();
-  uint32_t senderToken;
-  OptMultipathCapable(TcpOption_t oName, uint32_t TxToken);
-};
+  static const uint8_t MAX_SACK_BLOCKS = 3; //!< SACK blocks an OPT_SACK carries at most
 
-class OptJoinConnection : public TcpOptions
-{
-public:
-  virtual
-  ~OptJoinConnection();
-  uint32_t receiverToken;
-  uint8_t addrID;
-  OptJoinConnection(TcpOption_t oName, uint32_t RxToken, uint8_t aID);
-};
+  TcpOptions();
 
-class OptAddAddress : public TcpOptions
-{
-public:
-  virtual
-  ~OptAddAddress();
-  uint8_t addrID;
-  Ipv4Address addr;
-  OptAddAddress(TcpOption_t oName, uint8_t aID, Ipv4Address address);
-};
+  TcpOption_t optName;  //!< Kind of the option, selects the member of the union
+  uint8_t Length;       //!< Length of the option on the wire, kind included
 
-class OptDataSeqMapping : public TcpOptions
-{
-public:
-  virtual
-  ~OptDataSeqMapping();
-  uint64_t dataSeqNumber;
-  uint16_t dataLevelLength;
-  uint32_t subflowSeqNumber;
-  OptDataSeqMapping(TcpOption_t oName, uint64_t dSeqNum, uint16_t dLevelLength, uint32_t sfSeqNum);
+  union
+  {
+    struct
+    {
+      uint32_t senderToken;
+    } mpc;              //!< OPT_MPC, multipath capable
+    struct
+    {
+      uint32_t receiverToken;
+      uint8_t addrID;
+    } join;             //!< OPT_JOIN, join connection
+    struct
+    {
+      uint8_t addrID;
+      uint32_t addr;    //!< Ipv4Address::Get() of the advertised address
+    } addAddr;          //!< OPT_ADDR, add address
+    struct
+    {
+      uint64_t dataSeqNumber;
+      uint16_t dataLevelLength;
+      uint32_t subflowSeqNumber;
+    } dsn;              //!< OPT_DSN, data sequence mapping
+    struct
+    {
+      uint8_t shift;    //!< RFC 7323 shift count, at most 14
+    } wscale;           //!< OPT_WSCALE, window scale, only on SYN segments
+    struct
+    {
+      uint8_t nBlocks;
+      uint32_t left[MAX_SACK_BLOCKS];   //!< First sequence number of each block
+      uint32_t right[MAX_SACK_BLOCKS];  //!< Sequence number after each block
+    } sack;             //!< OPT_SACK, selective acknowledgment (RFC 2018)
+  };
 };
 
 }
@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemuxTestSuite");
+
+using namespace ns3;
+
+class Ipv4EndPointDemuxCacheTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+  Ipv4EndPoint* LookupOne (Ipv4EndPointDemux &demux, Ipv4Address peer, uint16_t peerPort);
+
+  Ptr<Ipv4Interface> m_interface;
+};
+
+Ipv4EndPointDemuxCacheTestCase::Ipv4EndPointDemuxCacheTestCase ()
+  : TestCase ("Connected end points found through the lookup cache")
+{
+}
+
+Ipv4EndPoint*
+Ipv4EndPointDemuxCacheTestCase::LookupOne (Ipv4EndPointDemux &demux, Ipv4Address peer, uint16_t peerPort)
+{
+  Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup (Ipv4Address ("10.0.0.1"), 80, peer, peerPort, m_interface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 1, "Exactly one end point should match");
+  return endPoints.empty () ? 0 : endPoints.front ();
+}
+
+void
+Ipv4EndPointDemuxCacheTestCase::DoRun (void)
+{
+  m_interface = CreateObject<Ipv4Interface> ();
+  Ipv4EndPointDemux demux;
+  Ipv4Address local ("10.0.0.1");
+  Ipv4Address peer ("10.0.0.2");
+  Ipv4Address other ("10.0.0.3");
+
+  Ipv4EndPoint *listen = demux.Allocate (80);
+  Ipv4EndPoint *conn = demux.Allocate (local, 80, peer, 1000);
+  NS_TEST_ASSERT_MSG_NE (conn, 0, "4-tuple allocation should succeed");
+
+  // first lookup walks the list, the second one is served from the cache
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, peer, 1000), conn, "Exact match expected");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, peer, 1000), conn, "Exact match expected from the cache");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, peer, 1001), listen, "Other peers go to the listening end point");
+
+  // the end point moves to another peer after it has been cached
+  conn->SetPeer (other, 1000);
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, peer, 1000), listen, "Stale cache entry must not be used");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, other, 1000), conn, "New 4-tuple expected");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, other, 1000), conn, "New 4-tuple expected from the cache");
+
+  // deallocated end points leave the cache
+  demux.DeAllocate (conn);
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, other, 1000), listen, "Deallocated end point must not be found");
+
+  // an end point bound to another device is skipped, also once it would be cached
+  Ipv4EndPoint *bound = demux.Allocate (local, 80, peer, 2000);
+  bound->BindToNetDevice (CreateObject<SimpleNetDevice> ());
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, peer, 2000), listen, "Bound end point must be skipped");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, peer, 2000), listen, "Bound end point must be skipped");
+}
+
+static class Ipv4EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  Ipv4EndPointDemuxTestSuite ()
+    : TestSuite ("ipv4-end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxCacheTestCase, TestCase::QUICK);
+  }
+} g_ipv4EndPointDemuxTestSuite;
@@ -20,6 +20,7 @@
 #include "ns3/test.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-static-routing.h"
 
 using namespace ns3;
 
@@ -112,6 +113,48 @@ Ipv4ListRoutingPositiveTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (secondRp, bRouting, "204");
 }
 
+class Ipv4ListRoutingVersionTestCase : public TestCase
+{
+public:
+  Ipv4ListRoutingVersionTestCase();
+  virtual void DoRun (void);
+};
+
+Ipv4ListRoutingVersionTestCase::Ipv4ListRoutingVersionTestCase()
+  : TestCase ("Check routing table versions")
+{
+}
+void
+Ipv4ListRoutingVersionTestCase::DoRun (void)
+{
+  Ptr<Ipv4ListRouting> lr = CreateObject<Ipv4ListRouting> ();
+  Ptr<Ipv4StaticRouting> staticRouting = CreateObject<Ipv4StaticRouting> ();
+  lr->AddRoutingProtocol (staticRouting, 0);
+  NS_TEST_ASSERT_MSG_EQ (lr->GetRoutingTableVersion (), 0, "300");
+  staticRouting->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), 1);
+  uint32_t version = lr->GetRoutingTableVersion ();
+  NS_TEST_ASSERT_MSG_NE (version, 0, "301");
+  NS_TEST_ASSERT_MSG_EQ (lr->GetRoutingTableVersion (), version, "302");
+  staticRouting->SetDefaultRoute (Ipv4Address ("10.1.0.1"), 1);
+  NS_TEST_ASSERT_MSG_NE (lr->GetRoutingTableVersion (), version, "303");
+  version = lr->GetRoutingTableVersion ();
+  staticRouting->RemoveRoute (0);
+  NS_TEST_ASSERT_MSG_NE (lr->GetRoutingTableVersion (), version, "304");
+  version = lr->GetRoutingTableVersion ();
+  staticRouting->AddMulticastRoute (Ipv4Address ("10.1.0.2"), Ipv4Address ("225.1.2.4"), 1, std::vector<uint32_t> (1, 2));
+  NS_TEST_ASSERT_MSG_NE (lr->GetRoutingTableVersion (), version, "306");
+  version = lr->GetRoutingTableVersion ();
+  staticRouting->RemoveMulticastRoute (Ipv4Address ("10.1.0.2"), Ipv4Address ("225.1.2.4"), 1);
+  NS_TEST_ASSERT_MSG_NE (lr->GetRoutingTableVersion (), version, "307");
+  staticRouting->AddMulticastRoute (Ipv4Address ("10.1.0.2"), Ipv4Address ("225.1.2.4"), 1, std::vector<uint32_t> (1, 2));
+  version = lr->GetRoutingTableVersion ();
+  staticRouting->RemoveMulticastRoute (0);
+  NS_TEST_ASSERT_MSG_NE (lr->GetRoutingTableVersion (), version, "308");
+  // A protocol that does not track its table disables caching altogether
+  lr->AddRoutingProtocol (CreateObject<Ipv4ARouting> (), 10);
+  NS_TEST_ASSERT_MSG_EQ (lr->GetRoutingTableVersion (), 0, "305");
+}
+
 static class Ipv4ListRoutingTestSuite : public TestSuite
 {
 public:
@@ -120,6 +163,7 @@ public:
   {
     AddTestCase (new Ipv4ListRoutingPositiveTestCase (), TestCase::QUICK);
     AddTestCase (new Ipv4ListRoutingNegativeTestCase (), TestCase::QUICK);
+    AddTestCase (new Ipv4ListRoutingVersionTestCase (), TestCase::QUICK);
   }
 
 } g_ipv4ListRoutingTestSuite;
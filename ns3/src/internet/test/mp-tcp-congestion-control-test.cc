@@ -0,0 +1,431 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/object-factory.h"
+#include "ns3/mp-tcp-socket-base.h"
+#include "ns3/mp-tcp-congestion-control.h"
+
+using namespace ns3;
+
+static const uint32_t MSS = 1400;
+
+static Ptr<MpTcpSubFlow>
+CreateSubflow (uint32_t packets, Time rtt)
+{
+  Ptr<MpTcpSubFlow> sFlow = CreateObject<MpTcpSubFlow> ();
+  sFlow->MSS = MSS;
+  sFlow->cwnd = packets * MSS;
+  sFlow->ssthresh = 2 * MSS;
+  sFlow->rtt->SetCurrentEstimate (rtt);
+  return sFlow;
+}
+
+/**
+ * On a single path every coupled controller has to be as aggressive as
+ * NewReno: MSS^2 / cwnd per ACK, half the flight on a loss.
+ */
+class MpTcpSinglePathTestCase : public TestCase
+{
+public:
+  MpTcpSinglePathTestCase (std::string type);
+
+private:
+  virtual void DoRun (void);
+
+  std::string m_type;
+};
+
+MpTcpSinglePathTestCase::MpTcpSinglePathTestCase (std::string type)
+  : TestCase (type + " is NewReno on a single path"),
+    m_type (type)
+{
+}
+
+void
+MpTcpSinglePathTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (m_type);
+  Ptr<MpTcpCongestionControl> cc = factory.Create<MpTcpCongestionControl> ();
+  MpTcpCongestionControl::SubFlows subflows;
+  subflows.push_back (CreateSubflow (20, MilliSeconds (100)));
+
+  cc->PktsAcked (subflows, 0, MSS, MilliSeconds (100));
+  cc->IncreaseWindow (subflows, 0, MSS);
+  NS_TEST_ASSERT_MSG_EQ_TOL ((double) subflows[0]->cwnd.Get (), 20 * MSS + MSS / 20.0, 1, "Increase of one MSS per window");
+  // A full window in flight, BALIA halves the cwnd
+  uint32_t cwnd = subflows[0]->cwnd.Get ();
+  NS_TEST_ASSERT_MSG_EQ (cc->GetSsThresh (subflows, 0, cwnd), cwnd / 2, "Half the flight on a loss");
+}
+
+/**
+ * Two equal paths: LIA takes half the increase of a single path TCP with
+ * the total window (alpha 0.5, RFC 6356), the fully coupled controller all
+ * of it.
+ */
+class MpTcpCoupledIncreaseTestCase : public TestCase
+{
+public:
+  MpTcpCoupledIncreaseTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MpTcpCoupledIncreaseTestCase::MpTcpCoupledIncreaseTestCase ()
+  : TestCase ("Coupled increase over two equal paths")
+{
+}
+
+void
+MpTcpCoupledIncreaseTestCase::DoRun (void)
+{
+  MpTcpCongestionControl::SubFlows subflows;
+  subflows.push_back (CreateSubflow (20, MilliSeconds (100)));
+  subflows.push_back (CreateSubflow (20, MilliSeconds (100)));
+  NS_TEST_ASSERT_MSG_EQ (MpTcpCongestionControl::GetTotalCwnd (subflows), 40 * MSS, "Total window");
+  NS_TEST_ASSERT_MSG_EQ_TOL (MpTcpCongestionLia::ComputeAlpha (subflows, 40 * MSS), 0.5, 1e-9, "RFC 6356 alpha of two equal paths");
+
+  Ptr<MpTcpCongestionControl> lia = CreateObject<MpTcpCongestionLia> ();
+  lia->IncreaseWindow (subflows, 0, MSS);
+  NS_TEST_ASSERT_MSG_EQ (subflows[0]->cwnd.Get (), 20 * MSS + MSS / 80, "alpha * MSS^2 / total");
+
+  Ptr<MpTcpCongestionControl> fully = CreateObject<MpTcpCongestionFullyCoupled> ();
+  subflows[0]->cwnd = 20 * MSS;
+  fully->IncreaseWindow (subflows, 1, MSS);
+  NS_TEST_ASSERT_MSG_EQ (subflows[1]->cwnd.Get (), 20 * MSS + MSS / 40, "MSS^2 / total");
+  NS_TEST_ASSERT_MSG_EQ (fully->GetSsThresh (subflows, 1, 20 * MSS), 2 * MSS, "The subflow gives up half the total window");
+}
+
+/**
+ * OLIA moves window from the largest subflow to the better path: the one
+ * that delivered more between losses grows faster than LIA would let it,
+ * the largest one shrinks.
+ */
+class MpTcpOliaTestCase : public TestCase
+{
+public:
+  MpTcpOliaTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MpTcpOliaTestCase::MpTcpOliaTestCase ()
+  : TestCase ("OLIA shifts window to the best path")
+{
+}
+
+void
+MpTcpOliaTestCase::DoRun (void)
+{
+  MpTcpCongestionControl::SubFlows subflows;
+  subflows.push_back (CreateSubflow (40, MilliSeconds (100)));
+  subflows.push_back (CreateSubflow (20, MilliSeconds (100)));
+  Ptr<MpTcpCongestionControl> olia = CreateObject<MpTcpCongestionOlia> ();
+  olia->PktsAcked (subflows, 0, 100000, Seconds (0));
+  olia->PktsAcked (subflows, 1, 1000000, Seconds (0));
+
+  // (20 / 0.1^2) / (600)^2 + (1 / (2 * 1)) / 20 packets
+  olia->IncreaseWindow (subflows, 1, MSS);
+  NS_TEST_ASSERT_MSG_EQ (subflows[1]->cwnd.Get (), 20 * MSS + 42, "Best path grows by alpha_r / w_r on top");
+  // (40 / 0.1^2) / (600)^2 - (1 / (2 * 1)) / 40 packets
+  olia->IncreaseWindow (subflows, 0, MSS);
+  NS_TEST_ASSERT_MSG_LT (subflows[0]->cwnd.Get (), 40 * MSS, "Largest window shrinks");
+
+  // A loss on the best path forgets what it delivered since the previous one
+  olia->GetSsThresh (subflows, 1, 20 * MSS);
+  olia->GetSsThresh (subflows, 1, 20 * MSS);
+  uint32_t cwnd = subflows[0]->cwnd.Get ();
+  olia->IncreaseWindow (subflows, 0, MSS);
+  NS_TEST_ASSERT_MSG_GT (subflows[0]->cwnd.Get (), cwnd, "No better path left, alpha is zero");
+}
+
+/**
+ * OLIA ranks paths by inter-loss distance over RTT squared, l_r / rtt_r^2.
+ * A short RTT path is the best one against a path with three times its RTT
+ * as long as the long one does not deliver nine times more between losses,
+ * even when it delivers more per RTT.
+ */
+class MpTcpOliaBestPathTestCase : public TestCase
+{
+public:
+  MpTcpOliaBestPathTestCase (uint32_t longInterval);
+
+private:
+  virtual void DoRun (void);
+  /// Window after one ACK of the OLIA increase with the given alpha
+  static double Increased (const MpTcpCongestionControl::SubFlows &subflows, uint8_t sFlowIdx, double alpha);
+
+  uint32_t m_longInterval;
+};
+
+MpTcpOliaBestPathTestCase::MpTcpOliaBestPathTestCase (uint32_t longInterval)
+  : TestCase ("OLIA best path with inter-loss distances of 1 MB and "
+              + std::string (longInterval == 1000000 ? "1 MB" : "5 MB")
+              + " over 100 ms and 300 ms"),
+    m_longInterval (longInterval)
+{
+}
+
+double
+MpTcpOliaBestPathTestCase::Increased (const MpTcpCongestionControl::SubFlows &subflows, uint8_t sFlowIdx, double alpha)
+{
+  double sumRate = 0;
+  for (uint32_t i = 0; i < subflows.size (); i++)
+    {
+      sumRate += (double) subflows[i]->cwnd.Get () / MSS / subflows[i]->rtt->GetCurrentEstimate ().GetSeconds ();
+    }
+  double w = (double) subflows[sFlowIdx]->cwnd.Get () / MSS;
+  double rtt = subflows[sFlowIdx]->rtt->GetCurrentEstimate ().GetSeconds ();
+  return subflows[sFlowIdx]->cwnd.Get () + ((w / (rtt * rtt)) / (sumRate * sumRate) + alpha / w) * MSS;
+}
+
+void
+MpTcpOliaBestPathTestCase::DoRun (void)
+{
+  // The largest window is on a path that hardly delivers between losses
+  MpTcpCongestionControl::SubFlows subflows;
+  subflows.push_back (CreateSubflow (50, MilliSeconds (100)));
+  subflows.push_back (CreateSubflow (20, MilliSeconds (100)));
+  subflows.push_back (CreateSubflow (20, MilliSeconds (300)));
+  Ptr<MpTcpCongestionControl> olia = CreateObject<MpTcpCongestionOlia> ();
+  olia->PktsAcked (subflows, 0, 10000, Seconds (0));
+  olia->PktsAcked (subflows, 1, 1000000, Seconds (0));
+  olia->PktsAcked (subflows, 2, m_longInterval, Seconds (0));
+
+  // The short RTT path is collected: alpha 1 / (3 * 1)
+  double expected = Increased (subflows, 1, 1.0 / 3);
+  olia->IncreaseWindow (subflows, 1, MSS);
+  NS_TEST_ASSERT_MSG_EQ_TOL ((double) subflows[1]->cwnd.Get (), expected, 1, "Short RTT path gains alpha_r / w_r");
+
+  // The long RTT path is neither the best nor the largest: alpha 0
+  expected = Increased (subflows, 2, 0);
+  olia->IncreaseWindow (subflows, 2, MSS);
+  NS_TEST_ASSERT_MSG_EQ_TOL ((double) subflows[2]->cwnd.Get (), expected, 1, "Long RTT path gains nothing on top");
+}
+
+/**
+ * LIA keeps alpha and the total window across ACKs. Whatever changes in
+ * between and is reported through SubflowChanged, a window, an RTT, fast
+ * recovery, or a new subflow, the increase has to be the one computed from
+ * scratch with ComputeAlpha.
+ */
+class MpTcpLiaIncrementalTestCase : public TestCase
+{
+public:
+  MpTcpLiaIncrementalTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Check (Ptr<MpTcpCongestionControl> lia, MpTcpCongestionControl::SubFlows &subflows, uint8_t sFlowIdx);
+};
+
+MpTcpLiaIncrementalTestCase::MpTcpLiaIncrementalTestCase ()
+  : TestCase ("LIA alpha kept across ACKs equals the RFC 6356 formula")
+{
+}
+
+void
+MpTcpLiaIncrementalTestCase::Check (Ptr<MpTcpCongestionControl> lia, MpTcpCongestionControl::SubFlows &subflows, uint8_t sFlowIdx)
+{
+  uint32_t total = MpTcpCongestionControl::GetTotalCwnd (subflows);
+  double adder = MpTcpCongestionLia::ComputeAlpha (subflows, total) * MSS * MSS / total;
+  uint32_t expected = (uint32_t) (subflows[sFlowIdx]->cwnd.Get () + std::max (1.0, adder));
+  lia->IncreaseWindow (subflows, sFlowIdx, MSS);
+  NS_TEST_EXPECT_MSG_EQ (subflows[sFlowIdx]->cwnd.Get (), expected, "Increase of subflow " << (int) sFlowIdx);
+}
+
+void
+MpTcpLiaIncrementalTestCase::DoRun (void)
+{
+  MpTcpCongestionControl::SubFlows subflows;
+  subflows.push_back (CreateSubflow (30, MilliSeconds (40)));
+  subflows.push_back (CreateSubflow (12, MilliSeconds (130)));
+  Ptr<MpTcpCongestionControl> lia = CreateObject<MpTcpCongestionLia> ();
+
+  for (uint32_t i = 0; i < 50; i++)
+    {
+      Check (lia, subflows, i % 2);
+    }
+  // Changes made outside the controller are reported, as the socket does
+  subflows[1]->rtt->SetCurrentEstimate (MilliSeconds (70));
+  lia->SubflowChanged (1);
+  Check (lia, subflows, 0);
+  subflows[0]->m_inFastRec = true;
+  subflows[0]->ssthresh = 15 * MSS;
+  lia->SubflowChanged (0);
+  Check (lia, subflows, 1);
+  subflows[0]->m_inFastRec = false;
+  subflows[0]->cwnd = 16 * MSS;
+  lia->SubflowChanged (0);
+  Check (lia, subflows, 1);
+  subflows.push_back (CreateSubflow (1, MilliSeconds (300)));
+  for (uint32_t i = 0; i < 30; i++)
+    {
+      Check (lia, subflows, i % 3);
+    }
+}
+
+/**
+ * BALIA gives a subflow whose rate is below the connection's best a deeper
+ * cut on a loss, at most 0.75 of its window.
+ */
+class MpTcpBaliaTestCase : public TestCase
+{
+public:
+  MpTcpBaliaTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MpTcpBaliaTestCase::MpTcpBaliaTestCase ()
+  : TestCase ("BALIA decrease depends on the rate ratio")
+{
+}
+
+void
+MpTcpBaliaTestCase::DoRun (void)
+{
+  MpTcpCongestionControl::SubFlows subflows;
+  subflows.push_back (CreateSubflow (40, MilliSeconds (100)));
+  subflows.push_back (CreateSubflow (40, MilliSeconds (200)));
+  Ptr<MpTcpCongestionControl> balia = CreateObject<MpTcpCongestionBalia> ();
+  NS_TEST_ASSERT_MSG_EQ (balia->GetSsThresh (subflows, 0, 40 * MSS), 20 * MSS, "Fastest subflow halves");
+  NS_TEST_ASSERT_MSG_EQ (balia->GetSsThresh (subflows, 1, 40 * MSS), 10 * MSS, "min (alpha, 1.5) of the window is cut");
+}
+
+/**
+ * wVegas moves the window once per round: one packet up while the queue
+ * is below its share, one down once above it.
+ */
+class MpTcpWVegasTestCase : public TestCase
+{
+public:
+  MpTcpWVegasTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Round (Ptr<MpTcpCongestionControl> cc, MpTcpCongestionControl::SubFlows &subflows, Time rtt);
+};
+
+MpTcpWVegasTestCase::MpTcpWVegasTestCase ()
+  : TestCase ("wVegas keeps its share of packets queued")
+{
+}
+
+void
+MpTcpWVegasTestCase::Round (Ptr<MpTcpCongestionControl> cc, MpTcpCongestionControl::SubFlows &subflows, Time rtt)
+{
+  uint32_t packets = subflows[0]->cwnd.Get () / MSS;
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      cc->PktsAcked (subflows, 0, MSS, rtt);
+      cc->IncreaseWindow (subflows, 0, MSS);
+    }
+}
+
+void
+MpTcpWVegasTestCase::DoRun (void)
+{
+  MpTcpCongestionControl::SubFlows subflows;
+  subflows.push_back (CreateSubflow (20, MilliSeconds (100)));
+  Ptr<MpTcpCongestionControl> wvegas = CreateObject<MpTcpCongestionWVegas> ();
+  // The first ACK ends an empty round, the next ones form the first full round
+  wvegas->PktsAcked (subflows, 0, MSS, MilliSeconds (100));
+  NS_TEST_ASSERT_MSG_EQ (subflows[0]->cwnd.Get (), 21 * MSS, "Too few RTT samples, one packet more as NewReno");
+
+  Round (wvegas, subflows, MilliSeconds (100));
+  NS_TEST_ASSERT_MSG_EQ (subflows[0]->cwnd.Get (), 22 * MSS, "Nothing queued, one packet more");
+  Round (wvegas, subflows, MilliSeconds (200));
+  NS_TEST_ASSERT_MSG_EQ (subflows[0]->cwnd.Get (), 21 * MSS, "Half the window queued, beyond Alpha, one packet less");
+
+  // In slow start, rounds without RTT samples still grow the window
+  subflows[0] = CreateSubflow (2, MilliSeconds (100));
+  subflows[0]->ssthresh = 64 * MSS;
+  wvegas = CreateObject<MpTcpCongestionWVegas> ();
+  wvegas->PktsAcked (subflows, 0, MSS, Seconds (0));
+  NS_TEST_ASSERT_MSG_EQ (subflows[0]->cwnd.Get (), 3 * MSS, "Slow start held back without RTT samples");
+  Round (wvegas, subflows, Seconds (0));
+  NS_TEST_ASSERT_MSG_EQ (subflows[0]->cwnd.Get (), 4 * MSS, "Slow start held back without RTT samples");
+}
+
+/**
+ * The socket attributes select the controller, which is copied with its
+ * attributes.
+ */
+class MpTcpCongestionControlTypeTestCase : public TestCase
+{
+public:
+  MpTcpCongestionControlTypeTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MpTcpCongestionControlTypeTestCase::MpTcpCongestionControlTypeTestCase ()
+  : TestCase ("Congestion controller selected by attribute")
+{
+}
+
+void
+MpTcpCongestionControlTypeTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (CreateObject<MpTcpSocketBase> ()->GetCongestionControl ()->GetName (), "Linked_Increases", "Default");
+
+  Config::SetDefault ("ns3::MpTcpSocketBase::CongestionControl", StringValue ("RTT_Compensator"));
+  NS_TEST_ASSERT_MSG_EQ (CreateObject<MpTcpSocketBase> ()->GetCongestionControl ()->GetName (), "RTT_Compensator", "Capped LIA");
+  // A forked socket gets its own copy, attributes included
+  Ptr<MpTcpCongestionControl> cc = CreateObject<MpTcpSocketBase> ()->GetCongestionControl ();
+  Ptr<MpTcpCongestionControl> copy = cc->Copy ();
+  NS_TEST_ASSERT_MSG_NE (copy, cc, "Copy shares the controller");
+  NS_TEST_ASSERT_MSG_EQ (copy->GetName (), "RTT_Compensator", "Copy lost Capped");
+
+  Config::SetDefault ("ns3::MpTcpSocketBase::CongestionControlType", StringValue ("ns3::MpTcpCongestionOlia"));
+  NS_TEST_ASSERT_MSG_EQ (CreateObject<MpTcpSocketBase> ()->GetCongestionControl ()->GetName (), "OLIA", "The type overrides CongestionControl");
+
+  Config::SetDefault ("ns3::MpTcpSocketBase::CongestionControlType", StringValue ("ns3::MpTcpCongestionControl"));
+  Config::SetDefault ("ns3::MpTcpSocketBase::CongestionControl", StringValue ("COUPLED_INC"));
+  NS_TEST_ASSERT_MSG_EQ (CreateObject<MpTcpSocketBase> ()->GetCongestionControl (), 0, "COUPLED_INC is run by the socket");
+
+  Config::Reset ();
+}
+
+static class MpTcpCongestionControlTestSuite : public TestSuite
+{
+public:
+  MpTcpCongestionControlTestSuite ()
+    : TestSuite ("mp-tcp-congestion-control", UNIT)
+  {
+    AddTestCase (new MpTcpSinglePathTestCase ("ns3::MpTcpCongestionUncoupled"), TestCase::QUICK);
+    AddTestCase (new MpTcpSinglePathTestCase ("ns3::MpTcpCongestionLia"), TestCase::QUICK);
+    AddTestCase (new MpTcpSinglePathTestCase ("ns3::MpTcpCongestionOlia"), TestCase::QUICK);
+    AddTestCase (new MpTcpSinglePathTestCase ("ns3::MpTcpCongestionBalia"), TestCase::QUICK);
+    AddTestCase (new MpTcpCoupledIncreaseTestCase, TestCase::QUICK);
+    AddTestCase (new MpTcpOliaTestCase, TestCase::QUICK);
+    AddTestCase (new MpTcpOliaBestPathTestCase (1000000), TestCase::QUICK);
+    AddTestCase (new MpTcpOliaBestPathTestCase (5000000), TestCase::QUICK);
+    AddTestCase (new MpTcpLiaIncrementalTestCase, TestCase::QUICK);
+    AddTestCase (new MpTcpBaliaTestCase, TestCase::QUICK);
+    AddTestCase (new MpTcpWVegasTestCase, TestCase::QUICK);
+    AddTestCase (new MpTcpCongestionControlTypeTestCase, TestCase::QUICK);
+  }
+} g_mpTcpCongestionControlTestSuite;
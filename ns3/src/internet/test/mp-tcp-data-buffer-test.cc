@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/mp-tcp-typedefs.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("MpTcpDataBufferTestSuite");
+
+using namespace ns3;
+
+class MpTcpDataBufferTestCase : public TestCase
+{
+public:
+  MpTcpDataBufferTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MpTcpDataBufferTestCase::MpTcpDataBufferTestCase ()
+  : TestCase ("MPTCP connection-level DataBuffer chunking")
+{
+}
+
+void
+MpTcpDataBufferTestCase::DoRun (void)
+{
+  DataBuffer buf (100);
+
+  // size-only mode is capped by the free space
+  NS_TEST_EXPECT_MSG_EQ (buf.Add (60), 60, "Dummy data should fit");
+  NS_TEST_EXPECT_MSG_EQ (buf.Add (60), 40, "Dummy data should be capped by free space");
+  NS_TEST_EXPECT_MSG_EQ (buf.Full (), true, "Buffer should be full");
+  NS_TEST_EXPECT_MSG_EQ (buf.Retrieve (30), 30, "Retrieve should drop 30 bytes");
+  NS_TEST_EXPECT_MSG_EQ (buf.PendingData (), 70, "70 bytes should remain");
+  NS_TEST_EXPECT_MSG_EQ (buf.ClearBuffer (), true, "Clear should succeed");
+  NS_TEST_EXPECT_MSG_EQ (buf.Empty (), true, "Buffer should be empty");
+
+  // real data keeps its byte order across chunk boundaries
+  uint8_t data[50];
+  for (uint32_t i = 0; i < sizeof (data); i++)
+    {
+      data[i] = i;
+    }
+  buf.AddRealData (data, 20);
+  buf.ReadPacket (Create<Packet> (data + 20, 30), 30);
+  NS_TEST_EXPECT_MSG_EQ (buf.PendingData (), 50, "Two chunks should be pending");
+
+  Ptr<Packet> p = buf.CreatePacket (25);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 25, "Packet spans both chunks");
+  uint8_t out[50];
+  p->CopyData (out, 25);
+  uint8_t *rest = buf.RetrieveRealData (100);
+  memcpy (out + 25, rest, 25);
+  delete[] rest;
+  for (uint32_t i = 0; i < sizeof (data); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) out[i], i, "Byte order not preserved");
+    }
+  NS_TEST_EXPECT_MSG_EQ (buf.Empty (), true, "Buffer should be drained");
+  NS_TEST_EXPECT_MSG_EQ ((buf.CreatePacket (10) == 0), true, "No packet from an empty buffer");
+}
+
+class MpTcpDSNMappingTableTestCase : public TestCase
+{
+public:
+  MpTcpDSNMappingTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MpTcpDSNMappingTableTestCase::MpTcpDSNMappingTableTestCase ()
+  : TestCase ("MPTCP subflow DSN mapping table lookup and discard")
+{
+}
+
+void
+MpTcpDSNMappingTableTestCase::DoRun (void)
+{
+  DSNMappingTable table;
+  Ptr<Packet> pkt = Create<Packet> (100);
+
+  // ten segments of 100 bytes starting at subflow seqNb 1000
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      table.Add (0, 5000 + i * 100, 100, 1000 + i * 100, 1, pkt);
+    }
+  NS_TEST_EXPECT_MSG_EQ (table.size (), 10, "Ten mappings expected");
+  NS_TEST_EXPECT_MSG_EQ (table.Find (1300)->dataSeqNumber, 5300, "Lookup by start seqNb");
+  NS_TEST_EXPECT_MSG_EQ ((table.Find (1350) == 0), true, "No segment starts at 1350");
+  NS_TEST_EXPECT_MSG_EQ (table.FindEndingAt (1500)->subflowSeqNumber, 1400, "Lookup by end seqNb");
+  NS_TEST_EXPECT_MSG_EQ ((table.FindEndingAt (2500) == 0), true, "No segment ends at 2500");
+
+  // a cumulative ACK in the middle of a segment keeps that segment
+  NS_TEST_EXPECT_MSG_EQ (table.DiscardUpTo (1450), 4, "Four segments fully acked");
+  NS_TEST_EXPECT_MSG_EQ ((*table.begin ())->subflowSeqNumber, 1400, "Partially acked segment remains");
+  NS_TEST_EXPECT_MSG_EQ ((table.Find (1300) == 0), true, "Discarded segment is gone");
+
+  // released mappings are reused and do not keep their payload
+  table.Add (0, 6000, 100, 2000, 1, pkt);
+  NS_TEST_EXPECT_MSG_EQ (table.size (), 7, "Seven mappings expected");
+  NS_TEST_EXPECT_MSG_EQ (table.FindEndingAt (2100)->dataSeqNumber, 6000, "New segment found");
+  table.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (table.empty (), true, "Table should be empty");
+  NS_TEST_EXPECT_MSG_EQ (pkt->GetReferenceCount (), 1, "Released mappings should drop the payload");
+}
+
+class MpTcpUnOrderedBufferTestCase : public TestCase
+{
+public:
+  MpTcpUnOrderedBufferTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MpTcpUnOrderedBufferTestCase::MpTcpUnOrderedBufferTestCase ()
+  : TestCase ("MPTCP out of sequence reassembly and coalescing")
+{
+}
+
+void
+MpTcpUnOrderedBufferTestCase::DoRun (void)
+{
+  UnOrderedBuffer buf;
+  uint8_t data[40];
+  for (uint32_t i = 0; i < sizeof (data); i++)
+    {
+      data[i] = i;
+    }
+
+  // data seqNb 100..139 arrives as four segments of 10 bytes over two subflows, 100..109 is missing
+  NS_TEST_EXPECT_MSG_EQ (buf.Store (0, 130, 10, 20, 1, Create<Packet> (data + 30, 10), true), true, "Store 130");
+  NS_TEST_EXPECT_MSG_EQ (buf.Store (1, 110, 10, 50, 1, Create<Packet> (data + 10, 10), false), true, "Store 110");
+  NS_TEST_EXPECT_MSG_EQ (buf.RangeCount (), 2, "Two disjoint ranges");
+  NS_TEST_EXPECT_MSG_EQ (buf.Store (0, 120, 10, 10, 1, Create<Packet> (data + 20, 10), false), true, "Store 120");
+  NS_TEST_EXPECT_MSG_EQ (buf.RangeCount (), 1, "Filling the gap coalesces the ranges");
+  NS_TEST_EXPECT_MSG_EQ (buf.Size (), 30, "30 bytes held");
+  NS_TEST_EXPECT_MSG_EQ (buf.Store (1, 115, 10, 60, 1, Create<Packet> (10), false), false, "Overlap is rejected");
+  NS_TEST_EXPECT_MSG_EQ (buf.HasData (1), true, "Subflow 1 has data held");
+
+  // subflow 0 reaches the segment that arrived ahead of it
+  uint16_t length;
+  uint32_t ack;
+  NS_TEST_EXPECT_MSG_EQ (buf.AdvanceSubflow (0, 10, length, ack), false, "Segment at 10 was not ahead");
+  NS_TEST_EXPECT_MSG_EQ (buf.AdvanceSubflow (0, 20, length, ack), true, "Segment at 20 was ahead");
+  NS_TEST_EXPECT_MSG_EQ (length, 10, "Length of segment at 20");
+
+  // nothing is in-order until 100..109 is there, then everything drains at once
+  std::list<Ptr<Packet> > chunks;
+  NS_TEST_EXPECT_MSG_EQ (buf.Drain (100, chunks), 0, "Hole at 100");
+  NS_TEST_EXPECT_MSG_EQ (buf.Drain (110, chunks), 30, "Whole range drained");
+  NS_TEST_EXPECT_MSG_EQ (buf.Empty (), true, "Buffer should be empty");
+  NS_TEST_EXPECT_MSG_EQ (buf.HasData (1), false, "Nothing held for subflow 1");
+
+  uint8_t out[40];
+  uint32_t offset = 10;
+  for (std::list<Ptr<Packet> >::iterator it = chunks.begin (); it != chunks.end (); ++it)
+    {
+      offset += (*it)->CopyData (out + offset, 40 - offset);
+    }
+  NS_TEST_EXPECT_MSG_EQ (offset, 40, "30 bytes copied");
+  for (uint32_t i = 10; i < 40; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) out[i], i, "Byte order not preserved");
+    }
+}
+
+static class MpTcpDataBufferTestSuite : public TestSuite
+{
+public:
+  MpTcpDataBufferTestSuite ()
+    : TestSuite ("mp-tcp-data-buffer", UNIT)
+  {
+    AddTestCase (new MpTcpDataBufferTestCase, TestCase::QUICK);
+    AddTestCase (new MpTcpDSNMappingTableTestCase, TestCase::QUICK);
+    AddTestCase (new MpTcpUnOrderedBufferTestCase, TestCase::QUICK);
+  }
+} g_mpTcpDataBufferTestSuite;
@@ -0,0 +1,271 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/mp-tcp-socket-base.h"
+#include "ns3/mp-tcp-scheduler.h"
+
+using namespace ns3;
+
+static const uint32_t SEG_SIZE = 1400;
+
+/**
+ * A connection with hand made subflows, as SendPendingData sees it.
+ */
+class SchedulerTestSocket : public MpTcpSocketBase
+{
+public:
+  /// An established subflow with a window of packets, inFlight of them unacknowledged
+  void AddSubflow (uint32_t packets, uint32_t inFlight, Time rtt)
+  {
+    Ptr<MpTcpSubFlow> sFlow = CreateObject<MpTcpSubFlow> ();
+    sFlow->state = ESTABLISHED;
+    sFlow->MSS = SEG_SIZE;
+    sFlow->cwnd = packets * SEG_SIZE;
+    sFlow->TxSeqNumber = 1000000;
+    sFlow->highestAck = sFlow->TxSeqNumber - 1 - inFlight * SEG_SIZE;
+    sFlow->rtt->SetCurrentEstimate (rtt);
+    subflows.push_back (sFlow);
+  }
+  /// Leaves inFlight packets of subflow sFlowIdx unacknowledged
+  void SetInFlight (uint8_t sFlowIdx, uint32_t inFlight)
+  {
+    subflows[sFlowIdx]->highestAck = subflows[sFlowIdx]->TxSeqNumber - 1 - inFlight * SEG_SIZE;
+  }
+  void SetPeerWindow (uint32_t bytes)
+  {
+    remoteRecvWnd = bytes;
+  }
+  void Queue (uint32_t bytes)
+  {
+    sendingBuffer.ClearBuffer ();
+    sendingBuffer.Add (bytes);
+  }
+  uint8_t Next (uint8_t lastUsed)
+  {
+    return GetScheduler ()->GetSubflowToUse (this, subflows, lastUsed);
+  }
+  Ptr<MpTcpSubFlow> GetSubflow (uint8_t sFlowIdx)
+  {
+    return subflows[sFlowIdx];
+  }
+};
+
+static Ptr<SchedulerTestSocket>
+CreateSocket (std::string type)
+{
+  Config::SetDefault ("ns3::MpTcpSocketBase::SchedulerType", StringValue (type));
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (1000000));
+  Ptr<SchedulerTestSocket> socket = CreateObject<SchedulerTestSocket> ();
+  Config::Reset ();
+  socket->SetPeerWindow (1000000);
+  socket->Queue (100 * SEG_SIZE);
+  return socket;
+}
+
+/**
+ * The socket attributes select the scheduler, SchedulingAlgorithm through
+ * its mapping to the types.
+ */
+class MpTcpSchedulerTypeTestCase : public TestCase
+{
+public:
+  MpTcpSchedulerTypeTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MpTcpSchedulerTypeTestCase::MpTcpSchedulerTypeTestCase ()
+  : TestCase ("Scheduler selected by attribute")
+{
+}
+
+void
+MpTcpSchedulerTypeTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (CreateObject<MpTcpSocketBase> ()->GetScheduler ()->GetName (), "Round_Robin", "Default");
+
+  Config::SetDefault ("ns3::MpTcpSocketBase::SchedulingAlgorithm", StringValue ("BLEST"));
+  NS_TEST_ASSERT_MSG_EQ (CreateObject<MpTcpSocketBase> ()->GetScheduler ()->GetName (), "BLEST", "Enum mapping");
+  Config::SetDefault ("ns3::MpTcpSocketBase::SchedulingAlgorithm", StringValue ("Min_RTT"));
+  NS_TEST_ASSERT_MSG_EQ (CreateObject<MpTcpSocketBase> ()->GetScheduler ()->GetName (), "Min_RTT", "Enum mapping");
+
+  Config::SetDefault ("ns3::MpTcpSocketBase::SchedulerType", StringValue ("ns3::MpTcpSchedulerEcf"));
+  Ptr<MpTcpScheduler> scheduler = CreateObject<MpTcpSocketBase> ()->GetScheduler ();
+  NS_TEST_ASSERT_MSG_EQ (scheduler->GetName (), "ECF", "The type overrides SchedulingAlgorithm");
+  // A forked socket gets its own copy
+  Ptr<MpTcpScheduler> copy = scheduler->Copy ();
+  NS_TEST_ASSERT_MSG_NE (copy, scheduler, "Copy shares the scheduler");
+  NS_TEST_ASSERT_MSG_EQ (copy->GetName (), "ECF", "Copy changed the type");
+
+  Config::Reset ();
+}
+
+/**
+ * Round robin rotates, min-RTT takes the fastest subflow that has window
+ * and waits for the fastest one if none has.
+ */
+class MpTcpSchedulerMinRttTestCase : public TestCase
+{
+public:
+  MpTcpSchedulerMinRttTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MpTcpSchedulerMinRttTestCase::MpTcpSchedulerMinRttTestCase ()
+  : TestCase ("Round robin and min-RTT")
+{
+}
+
+void
+MpTcpSchedulerMinRttTestCase::DoRun (void)
+{
+  Ptr<SchedulerTestSocket> rr = CreateSocket ("ns3::MpTcpSchedulerRoundRobin");
+  rr->AddSubflow (10, 0, MilliSeconds (100));
+  rr->AddSubflow (10, 0, MilliSeconds (10));
+  NS_TEST_ASSERT_MSG_EQ ((int) rr->Next (0), 1, "Round robin ignores the RTT");
+  NS_TEST_ASSERT_MSG_EQ ((int) rr->Next (1), 0, "Round robin wraps");
+
+  Ptr<SchedulerTestSocket> socket = CreateSocket ("ns3::MpTcpSchedulerMinRtt");
+  socket->AddSubflow (10, 0, MilliSeconds (100));
+  socket->AddSubflow (10, 0, MilliSeconds (10));
+  socket->AddSubflow (10, 0, MilliSeconds (50));
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (0), 1, "Lowest RTT first");
+
+  socket->GetSubflow (1)->highestAck -= 10 * SEG_SIZE;
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (1), 2, "Fastest subflow with window");
+
+  socket->GetSubflow (0)->highestAck -= 10 * SEG_SIZE;
+  socket->GetSubflow (2)->highestAck -= 10 * SEG_SIZE;
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (2), 1, "Wait for the fastest subflow when no window is left");
+
+  socket->GetSubflow (0)->state = TcpSocket::SYN_SENT;
+  socket->GetSubflow (1)->state = TcpSocket::SYN_SENT;
+  socket->GetSubflow (2)->state = TcpSocket::SYN_SENT;
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (2), 0, "Rotate until a subflow is established");
+}
+
+/**
+ * A fast subflow with a full window of 10 packets at 10 ms and an idle one
+ * at 100 ms. BLEST estimates the fast subflow to send
+ * X = 1400 * (10 + 4.5) * 10 = 203000 bytes while a segment is on the slow
+ * one, and leaves the slow subflow idle if the peer window lacks that room.
+ */
+class MpTcpSchedulerBlestTestCase : public TestCase
+{
+public:
+  MpTcpSchedulerBlestTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MpTcpSchedulerBlestTestCase::MpTcpSchedulerBlestTestCase ()
+  : TestCase ("BLEST")
+{
+}
+
+void
+MpTcpSchedulerBlestTestCase::DoRun (void)
+{
+  Ptr<SchedulerTestSocket> socket = CreateSocket ("ns3::MpTcpSchedulerBlest");
+  socket->AddSubflow (10, 10, MilliSeconds (10));
+  socket->AddSubflow (10, 0, MilliSeconds (100));
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (0), 1, "X fits into the peer window");
+
+  socket->SetPeerWindow (203000 + 10 * SEG_SIZE - 1);
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (0), 0, "X does not fit, wait for the fast subflow");
+
+  socket->SetPeerWindow (203000 + 10 * SEG_SIZE + 1);
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (0), 1, "X just fits");
+}
+
+/**
+ * The same two subflows with ECF. With k packets queued the fast subflow
+ * needs 1 + k / 10 round trips of 10 ms, the slow one 100 ms.
+ */
+class MpTcpSchedulerEcfTestCase : public TestCase
+{
+public:
+  MpTcpSchedulerEcfTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MpTcpSchedulerEcfTestCase::MpTcpSchedulerEcfTestCase ()
+  : TestCase ("ECF")
+{
+}
+
+void
+MpTcpSchedulerEcfTestCase::DoRun (void)
+{
+  Ptr<SchedulerTestSocket> socket = CreateSocket ("ns3::MpTcpSchedulerEcf");
+  socket->AddSubflow (10, 10, MilliSeconds (10));
+  socket->AddSubflow (10, 0, MilliSeconds (100));
+
+  socket->Queue (100 * SEG_SIZE);
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (0), 1, "110 ms on the fast subflow, use the slow one");
+  socket->Queue (SEG_SIZE);
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (0), 1, "The slow subflow is done within two fast round trips");
+  socket->Queue (20 * SEG_SIZE);
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (0), 0, "30 ms on the fast subflow, wait for it");
+  // While waiting beta moves the bar to 125 ms
+  socket->Queue (100 * SEG_SIZE);
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (0), 0, "Hysteresis keeps waiting");
+  socket->Queue (200 * SEG_SIZE);
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (0), 1, "210 ms on the fast subflow, use the slow one");
+  socket->Queue (100 * SEG_SIZE);
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (0), 1, "Waiting ended, no hysteresis");
+
+  // Whichever subflow it picks ends the waiting, until ECF waits again
+  socket->Queue (20 * SEG_SIZE);
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (0), 0, "Wait for the fast subflow");
+  socket->Queue (SEG_SIZE);
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (0), 1, "The slow subflow is done within two fast round trips");
+  socket->Queue (100 * SEG_SIZE);
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (0), 1, "Sending on the slow subflow ended the waiting");
+  socket->Queue (20 * SEG_SIZE);
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (0), 0, "Wait for the fast subflow");
+  socket->SetInFlight (0, 0);
+  socket->SetInFlight (1, 10);
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (1), 0, "Only the fast subflow has space");
+  socket->SetInFlight (0, 10);
+  socket->SetInFlight (1, 0);
+  socket->Queue (100 * SEG_SIZE);
+  NS_TEST_ASSERT_MSG_EQ ((int) socket->Next (0), 1, "Sending on the fast subflow ended the waiting");
+}
+
+static class MpTcpSchedulerTestSuite : public TestSuite
+{
+public:
+  MpTcpSchedulerTestSuite ()
+    : TestSuite ("mp-tcp-scheduler", UNIT)
+  {
+    AddTestCase (new MpTcpSchedulerTypeTestCase, TestCase::QUICK);
+    AddTestCase (new MpTcpSchedulerMinRttTestCase, TestCase::QUICK);
+    AddTestCase (new MpTcpSchedulerBlestTestCase, TestCase::QUICK);
+    AddTestCase (new MpTcpSchedulerEcfTestCase, TestCase::QUICK);
+  }
+} g_mpTcpSchedulerTestSuite;
@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <stdio.h>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/mp-tcp-trace-sink.h"
+
+using namespace ns3;
+
+class MpTcpTraceSinkTestCase : public TestCase
+{
+public:
+  MpTcpTraceSinkTestCase (uint32_t ringRecords, uint32_t records);
+
+private:
+  virtual void DoRun (void);
+  void WriteRecords (Ptr<MpTcpTraceSink> sink, uint32_t connection);
+
+  uint32_t m_ringRecords;
+  uint32_t m_records;
+};
+
+MpTcpTraceSinkTestCase::MpTcpTraceSinkTestCase (uint32_t ringRecords, uint32_t records)
+  : TestCase ("MPTCP trace file round trip"),
+    m_ringRecords (ringRecords),
+    m_records (records)
+{
+}
+
+void
+MpTcpTraceSinkTestCase::WriteRecords (Ptr<MpTcpTraceSink> sink, uint32_t connection)
+{
+  for (uint32_t i = 0; i < m_records; i++)
+    {
+      sink->Write (connection, i % 3, MpTcpTraceSink::CWND, i);
+    }
+}
+
+void
+MpTcpTraceSinkTestCase::DoRun (void)
+{
+  std::string file = CreateTempDirFilename ("mptcp-trace.bin");
+  {
+    Ptr<MpTcpTraceSink> sink = MpTcpTraceSink::Open (file, m_ringRecords);
+    NS_TEST_ASSERT_MSG_EQ (MpTcpTraceSink::Open (file, m_ringRecords), sink, "Sockets tracing to one file share its sink");
+    uint32_t connection = sink->AddConnection (7);
+    NS_TEST_ASSERT_MSG_EQ (connection, 0, "First connection of the file");
+    Simulator::Schedule (Seconds (1.5), &MpTcpTraceSinkTestCase::WriteRecords, this, sink, connection);
+    Simulator::Run ();
+  }
+  // The sink is gone, so it flushed everything
+  Simulator::Destroy ();
+
+  MpTcpTraceReader reader (file);
+  NS_TEST_ASSERT_MSG_EQ (reader.IsOpen (), true, "Trace file has a valid header");
+  uint64_t total = m_records + 1;
+  uint64_t kept = (m_ringRecords > 0 && total > m_ringRecords) ? m_ringRecords : total;
+  NS_TEST_ASSERT_MSG_EQ (reader.GetNRecords (), kept, "Ring keeps only the last records");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetNLost (), total - kept, "Overwritten records are counted");
+
+  MpTcpTraceSink::Record record;
+  uint64_t index = total - kept;
+  while (reader.Next (record))
+    {
+      if (index == 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ (record.type, MpTcpTraceSink::CONNECTION, "Connection record comes first");
+          NS_TEST_ASSERT_MSG_EQ (record.value, 7, "Connection record holds the node id");
+          NS_TEST_ASSERT_MSG_EQ (record.time, 0, "Connection added at the start");
+        }
+      else
+        {
+          uint32_t i = index - 1;
+          NS_TEST_ASSERT_MSG_EQ (record.type, MpTcpTraceSink::CWND, "Record type");
+          NS_TEST_ASSERT_MSG_EQ (record.subflow, i % 3, "Record subflow");
+          NS_TEST_ASSERT_MSG_EQ (record.value, i, "Records come back in the order they were written");
+          NS_TEST_ASSERT_MSG_EQ (record.time, 1.5, "Record time");
+        }
+      index++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (index, total, "All kept records are read");
+  remove (file.c_str ());
+}
+
+static class MpTcpTraceSinkTestSuite : public TestSuite
+{
+public:
+  MpTcpTraceSinkTestSuite ()
+    : TestSuite ("mp-tcp-trace-sink", UNIT)
+  {
+    AddTestCase (new MpTcpTraceSinkTestCase (0, 5000), TestCase::QUICK);
+    AddTestCase (new MpTcpTraceSinkTestCase (1000, 5000), TestCase::QUICK);
+    AddTestCase (new MpTcpTraceSinkTestCase (1000, 300), TestCase::QUICK);
+  }
+} g_mpTcpTraceSinkTestSuite;
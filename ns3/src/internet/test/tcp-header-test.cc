@@ -0,0 +1,231 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-header.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("TcpHeaderTestSuite");
+
+using namespace ns3;
+
+/// Sets the header length for the options added so far, padded to 32-bit words as the socket does
+static void
+SetOptionsLength (TcpHeader &header)
+{
+  uint32_t olen = 0;
+  for (uint8_t i = 0; i < header.GetNOptions (); i++)
+    {
+      olen += header.GetOption (i).Length;
+    }
+  uint8_t plen = (4 - (olen % 4)) % 4;
+  header.SetLength (5 + (olen + plen) / 4);
+  header.SetOptionsLength ((olen + plen) / 4);
+  header.SetPaddingLength (plen);
+}
+
+/**
+ * Every option kind survives Serialize/Deserialize with its fields, and the
+ * serialized size is the one the data offset announces.
+ */
+class TcpHeaderOptionsTestCase : public TestCase
+{
+public:
+  TcpHeaderOptionsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Serializes header into a packet and parses it back
+  TcpHeader RoundTrip (TcpHeader &header);
+};
+
+TcpHeaderOptionsTestCase::TcpHeaderOptionsTestCase ()
+  : TestCase ("TcpHeader options round trip")
+{
+}
+
+TcpHeader
+TcpHeaderOptionsTestCase::RoundTrip (TcpHeader &header)
+{
+  SetOptionsLength (header);
+  NS_TEST_EXPECT_MSG_EQ (header.GetSerializedSize (), header.GetLength () * 4u, "Size is not the data offset");
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (header);
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), header.GetLength () * 4u, "Serialized more or less than the data offset");
+  TcpHeader parsed;
+  p->RemoveHeader (parsed);
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 0, "Bytes left after the header");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) parsed.GetLength (), (uint32_t) header.GetLength (), "Data offset");
+  NS_TEST_EXPECT_MSG_EQ (parsed.GetSerializedSize (), header.GetSerializedSize (), "Parsed size");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) parsed.GetNOptions (), (uint32_t) header.GetNOptions (), "Number of options");
+  return parsed;
+}
+
+void
+TcpHeaderOptionsTestCase::DoRun (void)
+{
+  uint32_t left[TcpOptions::MAX_SACK_BLOCKS] = { 1000, 5000, 9000 };
+  uint32_t right[TcpOptions::MAX_SACK_BLOCKS] = { 2000, 6000, 9500 };
+
+  // MPTCP handshake options, and the SYN-only ones
+  TcpHeader syn;
+  syn.SetSourcePort (49153);
+  syn.SetDestinationPort (80);
+  syn.SetSequenceNumber (SequenceNumber32 (1));
+  syn.SetFlags (TcpHeader::SYN);
+  NS_TEST_ASSERT_MSG_EQ (syn.AddOptMPC (OPT_MPC, 0xdeadbeef), true, "MPC");
+  NS_TEST_ASSERT_MSG_EQ (syn.AddOptJOIN (OPT_JOIN, 0x01020304, 7), true, "JOIN");
+  NS_TEST_ASSERT_MSG_EQ (syn.AddOptADDR (OPT_ADDR, 3, Ipv4Address ("10.1.2.3")), true, "ADDR");
+  NS_TEST_ASSERT_MSG_EQ (syn.AddOptWSCALE (OPT_WSCALE, 14), true, "WSCALE");
+  NS_TEST_ASSERT_MSG_EQ (syn.AddOptSACKPERM (OPT_SACK_PERMITTED), true, "SACK_PERMITTED");
+  NS_TEST_EXPECT_MSG_EQ (syn.AddOptMPC (OPT_JOIN, 0), false, "Kind must match the method");
+
+  TcpHeader p = RoundTrip (syn);
+  NS_TEST_EXPECT_MSG_EQ (p.GetSourcePort (), 49153, "Source port");
+  NS_TEST_EXPECT_MSG_EQ (p.GetDestinationPort (), 80, "Destination port");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) p.GetFlags (), (uint32_t) TcpHeader::SYN, "Flags");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t) p.GetNOptions (), 5, "Options parsed");
+  NS_TEST_EXPECT_MSG_EQ (p.GetOption (0).optName, OPT_MPC, "Kind 0");
+  NS_TEST_EXPECT_MSG_EQ (p.GetOption (0).mpc.senderToken, 0xdeadbeef, "Sender token");
+  NS_TEST_EXPECT_MSG_EQ (p.GetOption (1).optName, OPT_JOIN, "Kind 1");
+  NS_TEST_EXPECT_MSG_EQ (p.GetOption (1).join.receiverToken, 0x01020304, "Receiver token");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) p.GetOption (1).join.addrID, 7, "Join address id");
+  NS_TEST_EXPECT_MSG_EQ (p.GetOption (2).optName, OPT_ADDR, "Kind 2");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) p.GetOption (2).addAddr.addrID, 3, "Address id");
+  NS_TEST_EXPECT_MSG_EQ (Ipv4Address (p.GetOption (2).addAddr.addr), Ipv4Address ("10.1.2.3"), "Address");
+  NS_TEST_EXPECT_MSG_EQ (p.GetOption (3).optName, OPT_WSCALE, "Kind 3");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) p.GetOption (3).wscale.shift, 14, "Shift");
+  NS_TEST_EXPECT_MSG_EQ (p.GetOption (4).optName, OPT_SACK_PERMITTED, "Kind 4");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) p.GetOption (4).Length, 1, "SACK_PERMITTED length");
+
+  // What a data segment and its ACK carry. Three SACK blocks leave no room
+  // for a DSN in 40 bytes, so that one goes alone.
+  for (uint8_t n = 1; n <= TcpOptions::MAX_SACK_BLOCKS; n++)
+    {
+      bool dsn = (n < TcpOptions::MAX_SACK_BLOCKS);
+      TcpHeader data;
+      data.SetAckNumber (SequenceNumber32 (500));
+      data.SetFlags (TcpHeader::ACK);
+      if (dsn)
+        {
+          NS_TEST_ASSERT_MSG_EQ (data.AddOptDSN (OPT_DSN, 0x0102030405060708ULL, 1400, 123456), true, "DSN");
+        }
+      NS_TEST_ASSERT_MSG_EQ (data.AddOptSACK (OPT_SACK, n, left, right), true, "SACK");
+      p = RoundTrip (data);
+      NS_TEST_EXPECT_MSG_EQ (p.GetAckNumber (), SequenceNumber32 (500), "Ack number");
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t) p.GetNOptions (), dsn ? 2u : 1u, "Options parsed");
+      if (dsn)
+        {
+          NS_TEST_EXPECT_MSG_EQ (p.GetOption (0).optName, OPT_DSN, "DSN kind");
+          NS_TEST_EXPECT_MSG_EQ (p.GetOption (0).dsn.dataSeqNumber, 0x0102030405060708ULL, "Data sequence number");
+          NS_TEST_EXPECT_MSG_EQ (p.GetOption (0).dsn.dataLevelLength, 1400, "Data level length");
+          NS_TEST_EXPECT_MSG_EQ (p.GetOption (0).dsn.subflowSeqNumber, 123456, "Subflow sequence number");
+        }
+      const TcpOptions &sack = p.GetOption (dsn ? 1 : 0);
+      NS_TEST_EXPECT_MSG_EQ (sack.optName, OPT_SACK, "SACK kind");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) sack.Length, 2 + 8u * n, "SACK length");
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t) sack.sack.nBlocks, (uint32_t) n, "SACK blocks");
+      for (uint8_t k = 0; k < n; k++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (sack.sack.left[k], left[k], "Left edge");
+          NS_TEST_EXPECT_MSG_EQ (sack.sack.right[k], right[k], "Right edge");
+        }
+    }
+
+  TcpHeader bad;
+  NS_TEST_EXPECT_MSG_EQ (bad.AddOptSACK (OPT_SACK, 0, left, right), false, "SACK without blocks");
+  NS_TEST_EXPECT_MSG_EQ (bad.AddOptSACK (OPT_SACK, TcpOptions::MAX_SACK_BLOCKS + 1, left, right), false, "Too many SACK blocks");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) bad.GetNOptions (), 0, "Rejected options are not added");
+
+  // Without options the header is the plain 20 bytes
+  TcpHeader plain;
+  p = RoundTrip (plain);
+  NS_TEST_EXPECT_MSG_EQ (p.GetSerializedSize (), 20, "Header without options");
+}
+
+/**
+ * A header holds MAX_OPTIONS options, 40 bytes of the shortest one. As many
+ * round trip with their values, and a parsed header keeps the first ones.
+ */
+class TcpHeaderMaxOptionsTestCase : public TestCase
+{
+public:
+  TcpHeaderMaxOptionsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpHeaderMaxOptionsTestCase::TcpHeaderMaxOptionsTestCase ()
+  : TestCase ("TcpHeader option capacity")
+{
+}
+
+void
+TcpHeaderMaxOptionsTestCase::DoRun (void)
+{
+  TcpHeader full;
+  for (uint32_t i = 0; i < TcpHeader::MAX_OPTIONS; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (full.AddOptMPC (OPT_MPC, 0xbeef0000 + i), true, "Option " << i << " not added");
+    }
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t) full.GetNOptions (), (uint32_t) TcpHeader::MAX_OPTIONS, "Options added");
+  SetOptionsLength (full);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) full.GetLength (), 15, "MPC options up to the limit are the largest header");
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (full);
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 60, "Largest header size");
+  TcpHeader parsed;
+  p->RemoveHeader (parsed);
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 0, "Bytes left after the header");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t) parsed.GetNOptions (), (uint32_t) TcpHeader::MAX_OPTIONS, "All options parsed");
+  for (uint8_t i = 0; i < TcpHeader::MAX_OPTIONS; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (parsed.GetOption (i).optName, OPT_MPC, "Kind of option " << (uint32_t) i);
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) parsed.GetOption (i).Length, 5, "Length of option " << (uint32_t) i);
+      NS_TEST_EXPECT_MSG_EQ (parsed.GetOption (i).mpc.senderToken, 0xbeef0000 + i, "Token of option " << (uint32_t) i);
+    }
+
+  // One option more on the wire than a header holds: the parser keeps the first ones instead of aborting
+  TcpHeader perm;
+  for (uint32_t i = 0; i < TcpHeader::MAX_OPTIONS; i++)
+    {
+      perm.AddOptSACKPERM (OPT_SACK_PERMITTED);
+    }
+  perm.SetLength (5 + 3);     // 8 bytes of options and a word of padding
+  perm.SetPaddingLength (4);
+  p = Create<Packet> ();
+  p->AddHeader (perm);
+  uint8_t wire[32];
+  NS_TEST_ASSERT_MSG_EQ (p->CopyData (wire, sizeof (wire)), sizeof (wire), "Padded header size");
+  wire[20 + 8] = OPT_SACK_PERMITTED;   // The first padding byte becomes one option too many
+  p = Create<Packet> (wire, sizeof (wire));
+  p->RemoveHeader (parsed);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) parsed.GetNOptions (), (uint32_t) TcpHeader::MAX_OPTIONS, "Parser keeps the first ones");
+}
+
+static class TcpHeaderTestSuite : public TestSuite
+{
+public:
+  TcpHeaderTestSuite ()
+    : TestSuite ("tcp-header", UNIT)
+  {
+    AddTestCase (new TcpHeaderOptionsTestCase, TestCase::QUICK);
+    AddTestCase (new TcpHeaderMaxOptionsTestCase, TestCase::QUICK);
+  }
+} g_tcpHeaderTestSuite;
@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/mp-tcp-bulk-send-helper.h"
+#include "ns3/mp-tcp-packet-sink-helper.h"
+#include "ns3/mp-tcp-packet-sink.h"
+
+#include <set>
+
+using namespace ns3;
+
+/**
+ * Drops the listed data segments (counted from 1) arriving at a device,
+ * whatever their retransmissions do.
+ */
+class DropDataSegmentsErrorModel : public ErrorModel
+{
+public:
+  DropDataSegmentsErrorModel (const std::set<uint32_t> &drop)
+    : m_drop (drop),
+      m_segments (0)
+  {
+  }
+
+private:
+  virtual bool DoCorrupt (Ptr<Packet> p)
+  {
+    if (p->GetSize () < 1000)
+      {
+        return false;   // SYN, ACK or FIN
+      }
+    return m_drop.count (++m_segments) > 0;
+  }
+  virtual void DoReset (void)
+  {
+    m_segments = 0;
+  }
+
+  std::set<uint32_t> m_drop;
+  uint32_t m_segments;
+};
+
+/**
+ * Four segments of one window are lost on a single path with a 40 ms RTT.
+ * With SACK all four holes are repaired in one recovery of about one RTT,
+ * NewReno repairs one hole per RTT.
+ */
+class MpTcpSackRecoveryTestCase : public TestCase
+{
+public:
+  MpTcpSackRecoveryTestCase (bool sack);
+
+private:
+  virtual void DoRun (void);
+  void Connect (void);
+  void RecoveryTime (uint8_t sFlowIdx, Time duration);
+  void SpuriousRetransmission (uint8_t sFlowIdx, uint32_t seq, uint32_t length);
+
+  bool m_sack;
+  std::vector<Time> m_recoveries;
+  uint32_t m_spurious;
+};
+
+MpTcpSackRecoveryTestCase::MpTcpSackRecoveryTestCase (bool sack)
+  : TestCase (sack ? "Several losses of a window repaired in one RTT with SACK"
+              : "Several losses of a window repaired one per RTT without SACK"),
+    m_sack (sack),
+    m_spurious (0)
+{
+}
+
+void
+MpTcpSackRecoveryTestCase::RecoveryTime (uint8_t sFlowIdx, Time duration)
+{
+  m_recoveries.push_back (duration);
+}
+
+void
+MpTcpSackRecoveryTestCase::SpuriousRetransmission (uint8_t sFlowIdx, uint32_t seq, uint32_t length)
+{
+  m_spurious++;
+}
+
+void
+MpTcpSackRecoveryTestCase::Connect (void)
+{
+  std::string socket = "/NodeList/0/$ns3::TcpL4Protocol/SocketList/*/$ns3::MpTcpSocketBase/";
+  Config::ConnectWithoutContext (socket + "RecoveryTime",
+                                 MakeCallback (&MpTcpSackRecoveryTestCase::RecoveryTime, this));
+  Config::ConnectWithoutContext (socket + "SpuriousRetransmission",
+                                 MakeCallback (&MpTcpSackRecoveryTestCase::SpuriousRetransmission, this));
+}
+
+void
+MpTcpSackRecoveryTestCase::DoRun (void)
+{
+  const uint32_t bytes = 1000000;
+  const uint32_t rttMs = 40;   // two 20 ms hops
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (MpTcpSocketBase::GetTypeId ()));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1400));
+  Config::SetDefault ("ns3::MpTcpSocketBase::CongestionControl", StringValue ("Uncoupled_TCPs"));
+  Config::SetDefault ("ns3::MpTcpSocketBase::Sack", BooleanValue (m_sack));
+
+  NodeContainer n;
+  n.Create (2);
+
+  PointToPointHelper link;
+  link.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  link.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (rttMs / 2)));
+  NetDeviceContainer d = link.Install (n);
+
+  std::set<uint32_t> drop;
+  drop.insert (60);
+  drop.insert (62);
+  drop.insert (64);
+  drop.insert (66);
+  d.Get (1)->SetAttribute ("ReceiveErrorModel", PointerValue (Create<DropDataSegmentsErrorModel> (drop)));
+
+  InternetStackHelper internet;
+  internet.Install (n);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer i = ipv4.Assign (d);
+
+  uint16_t port = 9;
+  MpTcpPacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApps = sinkHelper.Install (n.Get (1));
+  sinkApps.Start (Seconds (0.0));
+  Ptr<MpTcpPacketSink> sink = DynamicCast<MpTcpPacketSink> (sinkApps.Get (0));
+
+  MpTcpBulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (i.GetAddress (1), port));
+  source.SetAttribute ("MaxBytes", UintegerValue (bytes));
+  ApplicationContainer sourceApps = source.Install (n.Get (0));
+  sourceApps.Start (Seconds (0.0));
+
+  // The sender's socket exists once its application started
+  Simulator::Schedule (MilliSeconds (1), &MpTcpSackRecoveryTestCase::Connect, this);
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  Config::Reset ();
+
+  NS_TEST_ASSERT_MSG_EQ (sink->GetTotalRx (), bytes, "Not all data was delivered");
+  NS_TEST_ASSERT_MSG_EQ (m_recoveries.size (), 1, "The losses have to be repaired by one fast recovery");
+  NS_TEST_ASSERT_MSG_EQ (m_spurious, 0, "No retransmission was spurious");
+  if (m_sack)
+    {
+      NS_TEST_ASSERT_MSG_LT (m_recoveries[0], MilliSeconds (3 * rttMs), "SACK recovery of " << m_recoveries[0].GetMilliSeconds () << " ms");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_GT (m_recoveries[0], MilliSeconds (4 * rttMs), "NewReno recovery of " << m_recoveries[0].GetMilliSeconds () << " ms");
+    }
+}
+
+static class MpTcpSackTestSuite : public TestSuite
+{
+public:
+  MpTcpSackTestSuite ()
+    : TestSuite ("mptcp-sack", SYSTEM)
+  {
+    AddTestCase (new MpTcpSackRecoveryTestCase (true), TestCase::QUICK);
+    AddTestCase (new MpTcpSackRecoveryTestCase (false), TestCase::QUICK);
+  }
+} g_mpTcpSackTestSuite;
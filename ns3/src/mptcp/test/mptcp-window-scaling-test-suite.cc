@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/mp-tcp-bulk-send-helper.h"
+#include "ns3/mp-tcp-packet-sink-helper.h"
+#include "ns3/mp-tcp-packet-sink.h"
+
+using namespace ns3;
+
+/**
+ * Bulk transfer over one 100 Mbps path with a 100 ms RTT, whose
+ * bandwidth-delay product (1.25 MB) is far beyond the 64 KB an unscaled
+ * window allows. With window scaling the connection has to reach line rate
+ * once out of slow start, without it the flow stays window limited.
+ */
+class MpTcpWindowScalingTestCase : public TestCase
+{
+public:
+  MpTcpWindowScalingTestCase (bool windowScaling);
+
+private:
+  virtual void DoRun (void);
+  void Sample (Ptr<MpTcpPacketSink> sink, uint32_t *rx);
+
+  bool m_windowScaling;
+};
+
+MpTcpWindowScalingTestCase::MpTcpWindowScalingTestCase (bool windowScaling)
+  : TestCase (windowScaling ? "Line rate on a high BDP path with window scaling"
+              : "Window limited on a high BDP path without window scaling"),
+    m_windowScaling (windowScaling)
+{
+}
+
+void
+MpTcpWindowScalingTestCase::Sample (Ptr<MpTcpPacketSink> sink, uint32_t *rx)
+{
+  *rx = sink->GetTotalRx ();
+}
+
+void
+MpTcpWindowScalingTestCase::DoRun (void)
+{
+  const double rate = 100e6;
+  const Time rtt = MilliSeconds (100);   // two 50 ms hops
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (MpTcpSocketBase::GetTypeId ()));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1400));
+  Config::SetDefault ("ns3::MpTcpSocketBase::CongestionControl", StringValue ("Uncoupled_TCPs"));
+  Config::SetDefault ("ns3::MpTcpSocketBase::WindowScaling", BooleanValue (m_windowScaling));
+  // Leave slow start a little above the bandwidth-delay product, so the
+  // flow fills the link and the queue of one BDP takes it without a loss
+  Config::SetDefault ("ns3::TcpSocket::SlowStartThreshold", UintegerValue (1500000));
+  Config::SetDefault ("ns3::DropTailQueue::MaxPackets", UintegerValue (1000));
+
+  NodeContainer n;
+  n.Create (2);
+
+  PointToPointHelper link;
+  link.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ((uint64_t) rate)));
+  link.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (50)));
+  NetDeviceContainer d = link.Install (n);
+
+  InternetStackHelper internet;
+  internet.Install (n);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer i = ipv4.Assign (d);
+
+  uint16_t port = 9;
+  MpTcpPacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApps = sinkHelper.Install (n.Get (1));
+  sinkApps.Start (Seconds (0.0));
+  Ptr<MpTcpPacketSink> sink = DynamicCast<MpTcpPacketSink> (sinkApps.Get (0));
+
+  MpTcpBulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (i.GetAddress (1), port));
+  source.SetAttribute ("MaxBytes", UintegerValue (0));
+  ApplicationContainer sourceApps = source.Install (n.Get (0));
+  sourceApps.Start (Seconds (0.0));
+
+  // Slow start is over well before the first sample
+  Time start = Seconds (3.0);
+  Time end = Seconds (6.0);
+  uint32_t rxStart = 0;
+  uint32_t rxEnd = 0;
+  Simulator::Schedule (start, &MpTcpWindowScalingTestCase::Sample, this, sink, &rxStart);
+  Simulator::Schedule (end, &MpTcpWindowScalingTestCase::Sample, this, sink, &rxEnd);
+  Simulator::Stop (end);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  double goodput = (rxEnd - rxStart) * 8.0 / (end - start).GetSeconds ();
+  if (m_windowScaling)
+    {
+      // 1400 of every 1460 bytes on the wire are payload
+      NS_TEST_ASSERT_MSG_GT (goodput, 0.9 * rate * 1400 / 1460, "Goodput of " << goodput / 1e6 << " Mbps is not line rate");
+    }
+  else
+    {
+      double limit = 65535 * 8.0 / rtt.GetSeconds ();
+      NS_TEST_ASSERT_MSG_LT (goodput, 1.05 * limit, "Goodput of " << goodput / 1e6 << " Mbps beyond one unscaled window per RTT");
+    }
+
+  Config::Reset ();
+}
+
+static class MpTcpWindowScalingTestSuite : public TestSuite
+{
+public:
+  MpTcpWindowScalingTestSuite ()
+    : TestSuite ("mptcp-window-scaling", SYSTEM)
+  {
+    AddTestCase (new MpTcpWindowScalingTestCase (true), TestCase::QUICK);
+    AddTestCase (new MpTcpWindowScalingTestCase (false), TestCase::QUICK);
+  }
+} g_mpTcpWindowScalingTestSuite;
@@ -110,6 +110,7 @@ Ipv4NixVectorRouting::FlushNixCache ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_nixCache.clear ();
+  RoutingTableChanged ();
 }
 
 void
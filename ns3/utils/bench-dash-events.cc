@@ -0,0 +1,211 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Event count benchmark of DASH streaming over MPTCP.
+//
+//   clients 10.0.0.1 <--- PtP ---> 10.0.0.2 DASH server
+//           10.0.1.1 <--- PtP ---> 10.0.1.2
+//
+// --clients players on one node stream video 1 from the DASH server over
+// links of --rate. The program reports how many events the simulator
+// scheduled, the wall-clock time, and a digest of every PlayerTracer
+// record, so that changes to the player can be checked for both speed and
+// identical traces. Stall time and representation switches show
+// how well --alogic and --estimator adapt, the mean time of the downloads
+// how fast segments complete. With --pipeline above 1 the
+// players prefetch segments over pipelined requests; the utilization of
+// the paths towards the players shows the gain, e.g. at a --delay of 100ms.
+// With --ranges above 1 the players fetch byte ranges of each segment over
+// that many MPTCP connections, or with --rangepaths over single-path
+// connections taking turns on the two paths, which compares multipath in the
+// application with MPTCP; --rate2 makes the second path slower or faster.
+//
+// The DASH server reads ../content/representations/netflix_vid1.csv and
+// appends to ./segments, so run it from a scratch directory whose parent
+// links to the repository's content/, e.g.
+//   ./waf --run bench-dash-events --cwd=/tmp/bench/run
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <iostream>
+#include <map>
+#include <sstream>
+
+using namespace ns3;
+
+static uint64_t g_records = 0;
+static uint64_t g_stallMs = 0;
+static uint64_t g_digest = 0;
+static uint64_t g_switches = 0;
+static uint64_t g_rxBytes = 0;
+static uint64_t g_downloads = 0;
+static uint64_t g_downloadMs = 0;
+static std::map<unsigned int, std::string> g_lastRep;
+
+static void
+PlayerTrace (Ptr<Application> app, unsigned int userId, unsigned int videoId, unsigned int segmentNr,
+             std::string repId, unsigned int bitrate, unsigned int stallMs, unsigned int bufferLevel)
+{
+  std::ostringstream record;
+  record << Simulator::Now ().GetTimeStep () << " " << userId << " " << videoId << " " << segmentNr
+         << " " << repId << " " << bitrate << " " << stallMs << " " << bufferLevel;
+  g_digest = g_digest * 1000003 + Hash64 (record.str ());
+  g_records++;
+  g_stallMs += stallMs;
+
+  std::map<unsigned int, std::string>::iterator last = g_lastRep.find (userId);
+  if (last != g_lastRep.end () && last->second != repId)
+    {
+      g_switches++;
+    }
+  g_lastRep[userId] = repId;
+}
+
+static void
+MacRx (Ptr<const Packet> packet)
+{
+  g_rxBytes += packet->GetSize ();
+}
+
+static void
+DownloadFinished (Ptr<Application> app, std::string file, double bytesPerSecond, long milliSeconds)
+{
+  g_downloads++;
+  g_downloadMs += milliSeconds;
+}
+
+static void
+Nothing (void)
+{
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t clients = 20;
+  std::string rate = "2Mbps";
+  std::string delay = "10ms";
+  double duration = 120;
+  std::string alogic = "dash::player::BufferBasedAdaptationLogic";
+  std::string estimator = "LastDownload";
+  uint32_t pipeline = 1;
+  std::string rate2 = "";
+  uint32_t ranges = 1;
+  bool rangePaths = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("clients", "Number of DASH players", clients);
+  cmd.AddValue ("rate", "Data rate of each path", rate);
+  cmd.AddValue ("delay", "Delay of each path", delay);
+  cmd.AddValue ("duration", "Seconds the players stream", duration);
+  cmd.AddValue ("alogic", "Adaptation logic of the players", alogic);
+  cmd.AddValue ("estimator", "Throughput estimator of the players", estimator);
+  cmd.AddValue ("pipeline", "Requests a player keeps outstanding, more than 1 prefetches segments", pipeline);
+  cmd.AddValue ("rate2", "Data rate of the second path, if other than --rate", rate2);
+  cmd.AddValue ("ranges", "Connections a player fetches the byte ranges of each segment over", ranges);
+  cmd.AddValue ("rangepaths", "Whether each range connection stays on one of the paths", rangePaths);
+  cmd.Parse (argc, argv);
+
+  if (rate2.empty ())
+    {
+      rate2 = rate;
+    }
+
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1400));
+  Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (0));
+  Config::SetDefault ("ns3::DropTailQueue::Mode", StringValue ("QUEUE_MODE_PACKETS"));
+  Config::SetDefault ("ns3::DropTailQueue::MaxPackets", UintegerValue (100));
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (MpTcpSocketBase::GetTypeId ()));
+  Config::SetDefault ("ns3::MpTcpSocketBase::MaxSubflows", UintegerValue (8));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue (rate));
+  p2p.SetChannelAttribute ("Delay", StringValue (delay));
+  NetDeviceContainer d0 = p2p.Install (nodes);
+  p2p.SetDeviceAttribute ("DataRate", StringValue (rate2));
+  NetDeviceContainer d1 = p2p.Install (nodes);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.0");
+  ipv4.Assign (d0);
+  ipv4.SetBase ("10.0.1.0", "255.255.255.0");
+  ipv4.Assign (d1);
+
+  d0.Get (0)->TraceConnectWithoutContext ("MacRx", MakeCallback (&MacRx));
+  d1.Get (0)->TraceConnectWithoutContext ("MacRx", MakeCallback (&MacRx));
+
+  DASHServerHelper server (Ipv4Address::GetAny (), 80, "10.0.0.2", "/content/mpds/",
+                           "/content/representations/netflix_vid1.csv", "/content/segments/");
+  ApplicationContainer serverApps = server.Install (nodes.Get (1));
+  serverApps.Start (Seconds (0.1));
+
+  DASHHttpClientHelper player ("http://10.0.0.2/content/mpds/vid1.mpd.gz");
+  player.SetAttribute ("AdaptationLogic", StringValue (alogic));
+  player.SetAttribute ("ThroughputEstimator", StringValue (estimator));
+  player.SetAttribute ("StartUpDelay", StringValue ("0.5"));
+  player.SetAttribute ("AllowDownscale", BooleanValue (true));
+  player.SetAttribute ("AllowUpscale", BooleanValue (true));
+  player.SetAttribute ("MaxBufferedSeconds", StringValue ("1600"));
+  player.SetAttribute ("PipelineDepth", UintegerValue (pipeline));
+  player.SetAttribute ("Prefetch", BooleanValue (pipeline > 1));
+  player.SetAttribute ("RangeConnections", UintegerValue (ranges));
+  if (rangePaths)
+    {
+      player.SetAttribute ("RangeServers", StringValue ("10.0.0.2,10.0.1.2"));
+      player.SetAttribute ("RangeMultipath", BooleanValue (false));
+    }
+  ApplicationContainer clientApps;
+  for (uint32_t i = 0; i < clients; ++i)
+    {
+      player.SetAttribute ("UserId", UintegerValue (i));
+      ApplicationContainer app = player.Install (nodes.Get (0));
+      app.Get (0)->TraceConnectWithoutContext ("PlayerTracer", MakeCallback (&PlayerTrace));
+      app.Get (0)->TraceConnectWithoutContext ("FileDownloadFinished", MakeCallback (&DownloadFinished));
+      clientApps.Add (app);
+    }
+  clientApps.Start (Seconds (1.0));
+  clientApps.Stop (Seconds (1.0 + duration));
+
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Stop (Seconds (2.0 + duration));
+  Simulator::Run ();
+  double wall = time.End () / 1000.0;
+  // event uids are handed out in order, so the next one counts all events scheduled so far
+  uint32_t events = Simulator::Schedule (Seconds (0), &Nothing).GetUid ();
+  Simulator::Destroy ();
+
+  std::cout << "events: " << events
+            << " player-records: " << g_records
+            << " stall: " << g_stallMs << " ms"
+            << " switches: " << g_switches
+            << " download-time: " << (g_downloads ? g_downloadMs / g_downloads : 0) << " ms"
+            << " utilization: " << 100.0 * g_rxBytes * 8 / ((DataRate (rate).GetBitRate () + DataRate (rate2).GetBitRate ()) * duration) << " %"
+            << " digest: " << std::hex << g_digest << std::dec
+            << " wall-time: " << wall << " s" << std::endl;
+  return 0;
+}
@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Throughput and fairness of the MPTCP congestion controllers on a shared
+// bottleneck.
+//
+//   mptcp ==== r1 ---------- r2 ==== sink (two addresses)
+//   tcp   ----/   --rate--
+//
+// An MPTCP connection over two paths and a single path connection (an MPTCP
+// socket with one subflow and uncoupled control, i.e. NewReno) share the
+// r1-r2 link. For each controller in --cc the program reports the goodput
+// of both and Jain's fairness index between them, 1 being an equal share,
+// which is what a coupled controller should reach.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+static void
+SinglePathDefaults (void)
+{
+  // Sockets created from now on, the single path source's, are NewReno
+  Config::SetDefault ("ns3::MpTcpSocketBase::CongestionControl", StringValue ("Uncoupled_TCPs"));
+  Config::SetDefault ("ns3::MpTcpSocketBase::CongestionControlType", TypeIdValue (MpTcpCongestionControl::GetTypeId ()));
+}
+
+static void
+Run (std::string cc, std::string rate, std::string delay, std::string delay2, double duration)
+{
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1400));
+  Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (0));
+  Config::SetDefault ("ns3::DropTailQueue::Mode", StringValue ("QUEUE_MODE_PACKETS"));
+  Config::SetDefault ("ns3::DropTailQueue::MaxPackets", UintegerValue (100));
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (MpTcpSocketBase::GetTypeId ()));
+  Config::SetDefault ("ns3::MpTcpSocketBase::MaxSubflows", UintegerValue (2));
+  Config::SetDefault ("ns3::MpTcpSocketBase::CongestionControlType", StringValue (cc));
+
+  NodeContainer hosts;
+  hosts.Create (3);   // mptcp, tcp, sink
+  NodeContainer routers;
+  routers.Create (2);
+
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  access.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue (rate));
+  bottleneck.SetChannelAttribute ("Delay", StringValue (delay));
+
+  NetDeviceContainer mp0 = access.Install (hosts.Get (0), routers.Get (0));
+  if (!delay2.empty ())
+    {
+      access.SetChannelAttribute ("Delay", StringValue (delay2));
+    }
+  NetDeviceContainer mp1 = access.Install (hosts.Get (0), routers.Get (0));
+  access.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer sp = access.Install (hosts.Get (1), routers.Get (0));
+  NetDeviceContainer core = bottleneck.Install (routers);
+  NetDeviceContainer sink0 = access.Install (routers.Get (1), hosts.Get (2));
+  NetDeviceContainer sink1 = access.Install (routers.Get (1), hosts.Get (2));
+
+  InternetStackHelper internet;
+  internet.Install (hosts);
+  internet.Install (routers);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (mp0);
+  ipv4.SetBase ("10.1.2.0", "255.255.255.0");
+  ipv4.Assign (mp1);
+  ipv4.SetBase ("10.1.3.0", "255.255.255.0");
+  ipv4.Assign (sp);
+  ipv4.SetBase ("10.2.1.0", "255.255.255.0");
+  ipv4.Assign (core);
+  ipv4.SetBase ("10.3.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer s0 = ipv4.Assign (sink0);
+  ipv4.SetBase ("10.3.2.0", "255.255.255.0");
+  ipv4.Assign (sink1);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  MpTcpPacketSinkHelper mpSinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 9));
+  MpTcpPacketSinkHelper spSinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 10));
+  ApplicationContainer sinkApps = mpSinkHelper.Install (hosts.Get (2));
+  sinkApps.Add (spSinkHelper.Install (hosts.Get (2)));
+  sinkApps.Start (Seconds (0.0));
+
+  MpTcpBulkSendHelper mpSource ("ns3::TcpSocketFactory", InetSocketAddress (s0.GetAddress (1), 9));
+  mpSource.SetAttribute ("MaxBytes", UintegerValue (0));
+  ApplicationContainer mpApp = mpSource.Install (hosts.Get (0));
+  mpApp.Start (Seconds (0.0));
+
+  MpTcpBulkSendHelper spSource ("ns3::TcpSocketFactory", InetSocketAddress (s0.GetAddress (1), 10));
+  spSource.SetAttribute ("MaxBytes", UintegerValue (0));
+  ApplicationContainer spApp = spSource.Install (hosts.Get (1));
+  Simulator::Schedule (Seconds (0.5), &SinglePathDefaults);
+  spApp.Start (Seconds (1.0));
+
+  Simulator::Stop (Seconds (1.0 + duration));
+  Simulator::Run ();
+
+  double mp = DynamicCast<MpTcpPacketSink> (sinkApps.Get (0))->GetTotalRx () * 8 / duration / 1e6;
+  double tcp = DynamicCast<MpTcpPacketSink> (sinkApps.Get (1))->GetTotalRx () * 8 / duration / 1e6;
+  double jain = (mp + tcp) * (mp + tcp) / (2 * (mp * mp + tcp * tcp));
+  std::cout << cc << ": mptcp " << mp << " Mb/s, tcp " << tcp << " Mb/s, total " << mp + tcp
+            << " Mb/s, jain " << jain << std::endl;
+
+  Simulator::Destroy ();
+  Config::Reset ();
+}
+
+int main (int argc, char *argv[])
+{
+  std::string cc = "ns3::MpTcpCongestionUncoupled,ns3::MpTcpCongestionLia,ns3::MpTcpCongestionOlia,"
+                   "ns3::MpTcpCongestionBalia,ns3::MpTcpCongestionWVegas";
+  std::string rate = "10Mbps";
+  std::string delay = "20ms";
+  std::string delay2 = "";
+  double duration = 200;
+
+  CommandLine cmd;
+  cmd.AddValue ("cc", "Comma separated MpTcpCongestionControl types to compare", cc);
+  cmd.AddValue ("rate", "Data rate of the shared bottleneck", rate);
+  cmd.AddValue ("delay", "Delay of the shared bottleneck", delay);
+  cmd.AddValue ("delay2", "Access delay of the second MPTCP path, if it should differ", delay2);
+  cmd.AddValue ("duration", "Seconds both connections compete", duration);
+  cmd.Parse (argc, argv);
+
+  std::istringstream types (cc);
+  std::string type;
+  while (std::getline (types, type, ','))
+    {
+      Run (type, rate, delay, delay2, duration);
+    }
+  return 0;
+}
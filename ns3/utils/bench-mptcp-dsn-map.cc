@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Microbenchmark of the per-subflow DSN mapping table.
+//
+// Keeps --inflight segments outstanding and replays an ACK trace against
+// it: every new ACK looks up the acked segment (RTT sample), discards
+// everything it covers and sends one more segment; every --dupEvery-th ACK
+// is preceded by three duplicate ACKs that look up the first unacked segment.
+// The start of the same trace (--listAcks) is run against a list<DSNMapping*>
+// with the linear scans MpTcpSocketBase used before, for comparison.
+
+#include "ns3/core-module.h"
+#include "ns3/mp-tcp-typedefs.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <iostream>
+#include <list>
+
+using namespace ns3;
+
+static const uint16_t MSS = 1400;
+
+class ListTable
+{
+public:
+  ~ListTable ()
+  {
+    for (std::list<DSNMapping *>::iterator it = m_list.begin (); it != m_list.end (); ++it)
+      {
+        delete *it;
+      }
+  }
+  void Add (uint64_t dsn, uint32_t seq, Ptr<Packet> pkt)
+  {
+    m_list.push_back (new DSNMapping (0, dsn, MSS, seq, 0, pkt));
+  }
+  DSNMapping* Find (uint32_t seq)
+  {
+    for (std::list<DSNMapping *>::iterator it = m_list.begin (); it != m_list.end (); ++it)
+      {
+        if ((*it)->subflowSeqNumber == seq)
+          {
+            return *it;
+          }
+      }
+    return 0;
+  }
+  DSNMapping* FindEndingAt (uint32_t ack)
+  {
+    for (std::list<DSNMapping *>::iterator it = m_list.begin (); it != m_list.end (); ++it)
+      {
+        if ((*it)->subflowSeqNumber + (*it)->dataLevelLength == ack)
+          {
+            return *it;
+          }
+      }
+    return 0;
+  }
+  void DiscardUpTo (uint32_t ack)
+  {
+    std::list<DSNMapping *>::iterator it = m_list.begin ();
+    while (it != m_list.end ())
+      {
+        if ((*it)->subflowSeqNumber + (*it)->dataLevelLength <= ack)
+          {
+            delete *it;
+            it = m_list.erase (it);
+          }
+        else
+          {
+            ++it;
+          }
+      }
+  }
+private:
+  std::list<DSNMapping *> m_list;
+};
+
+class DequeTable
+{
+public:
+  void Add (uint64_t dsn, uint32_t seq, Ptr<Packet> pkt)
+  {
+    m_table.Add (0, dsn, MSS, seq, 0, pkt);
+  }
+  DSNMapping* Find (uint32_t seq)
+  {
+    return m_table.Find (seq);
+  }
+  DSNMapping* FindEndingAt (uint32_t ack)
+  {
+    return m_table.FindEndingAt (ack);
+  }
+  void DiscardUpTo (uint32_t ack)
+  {
+    m_table.DiscardUpTo (ack);
+  }
+private:
+  DSNMappingTable m_table;
+};
+
+template <typename T>
+static double
+Replay (uint32_t inflight, uint32_t acks, uint32_t dupEvery, uint64_t &found)
+{
+  T table;
+  Ptr<Packet> pkt = Create<Packet> (MSS);
+  uint32_t seq = 1;
+  uint64_t dsn = 1;
+  for (uint32_t i = 0; i < inflight; i++)
+    {
+      table.Add (dsn, seq, pkt);
+      seq += MSS;
+      dsn += MSS;
+    }
+
+  SystemWallClockMs time;
+  time.Start ();
+  uint32_t ack = 1;
+  for (uint32_t i = 0; i < acks; i++)
+    {
+      if (dupEvery > 0 && i % dupEvery == 0)
+        {
+          for (uint32_t d = 0; d < 3; d++)
+            {
+              found += (table.Find (ack) != 0);
+            }
+        }
+      ack += MSS;
+      found += (table.FindEndingAt (ack) != 0);
+      table.DiscardUpTo (ack);
+      table.Add (dsn, seq, pkt);
+      seq += MSS;
+      dsn += MSS;
+    }
+  return time.End () / 1000.0;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t inflight = 20000;
+  uint32_t acks = 1000000;
+  uint32_t listAcks = 20000;
+  uint32_t dupEvery = 10;
+
+  CommandLine cmd;
+  cmd.AddValue ("inflight", "Number of segments in flight", inflight);
+  cmd.AddValue ("acks", "Number of new ACKs to replay", acks);
+  cmd.AddValue ("listAcks", "Number of new ACKs to replay against the list (0 to skip)", listAcks);
+  cmd.AddValue ("dupEvery", "Insert three duplicate ACKs every n new ACKs (0 for none)", dupEvery);
+  cmd.Parse (argc, argv);
+
+  uint64_t found = 0;
+  double table = Replay<DequeTable> (inflight, acks, dupEvery, found);
+  std::cout << "inflight: " << inflight << std::endl;
+  std::cout << "DSNMappingTable:   " << acks << " acks in " << table << " s ("
+            << (table * 1e9 / acks) << " ns/ack)" << std::endl;
+
+  if (listAcks > 0)
+    {
+      uint64_t foundList = 0;
+      uint64_t foundTable = 0;
+      double list = Replay<ListTable> (inflight, listAcks, dupEvery, foundList);
+      Replay<DequeTable> (inflight, listAcks, dupEvery, foundTable);
+      NS_ABORT_MSG_UNLESS (foundList == foundTable, "Both tables have to find the same segments");
+      std::cout << "list<DSNMapping*>: " << listAcks << " acks in " << list << " s ("
+                << (list * 1e9 / listAcks) << " ns/ack)" << std::endl;
+    }
+  return 0;
+}
@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Wall-clock benchmark of the HTTP GET/response path over MPTCP.
+//
+//   client 10.0.0.1 <--- PtP ---> 10.0.0.2 server
+//          10.0.1.1 <--- PtP ---> 10.0.1.2   (--delay2)
+//
+// The server serves one virtual file of --size bytes per client and --count
+// clients fetch them concurrently. The program reports how many payload
+// bytes the simulator moves per wall-clock second. With --outfile each
+// client also writes its body to <outfile><i> (--mode=File), or only
+// checksums it (--mode=Checksum), to measure the cost of the output path.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <fstream>
+#include <iostream>
+#include <stdio.h>
+
+using namespace ns3;
+
+static uint32_t g_downloads = 0;
+static uint64_t g_bytes = 0;
+static double g_lastFinish = 0;
+static bool g_checksum = false;
+
+static void
+DownloadFinished (Ptr<Application> app, std::string file, double speed, long ms)
+{
+  g_downloads++;
+  g_lastFinish = Simulator::Now ().GetSeconds ();
+  if (g_checksum)
+    {
+      Ptr<HttpClientApplication> client = DynamicCast<HttpClientApplication> (app);
+      std::cout << file << " checksum " << std::hex << client->GetLastDownloadChecksum ()
+                << std::dec << std::endl;
+    }
+}
+
+static void
+HeaderReceived (Ptr<Application> app, std::string file, long size)
+{
+  g_bytes += size;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t size = 10000000;
+  uint32_t count = 1;
+  std::string rate = "100Mbps";
+  std::string delay = "5ms";
+  std::string delay2 = "";
+  std::string trace = "";
+  std::string outfile = "";
+  std::string mode = "File";
+
+  CommandLine cmd;
+  cmd.AddValue ("size", "Size of the served file in bytes", size);
+  cmd.AddValue ("count", "Number of concurrent downloads (one client each)", count);
+  cmd.AddValue ("rate", "Data rate of each path", rate);
+  cmd.AddValue ("delay", "Delay of each path", delay);
+  cmd.AddValue ("delay2", "Delay of the second path, if it should differ", delay2);
+  cmd.AddValue ("trace", "MPTCP trace file to stream to (see mptcp-trace-to-gnuplot), none if empty", trace);
+  cmd.AddValue ("outfile", "Prefix of the files the clients write their download to, none if empty", outfile);
+  cmd.AddValue ("mode", "OutfileMode of the clients: File, Checksum or Discard", mode);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1400));
+  Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (0));
+  Config::SetDefault ("ns3::DropTailQueue::Mode", StringValue ("QUEUE_MODE_PACKETS"));
+  Config::SetDefault ("ns3::DropTailQueue::MaxPackets", UintegerValue (100));
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (MpTcpSocketBase::GetTypeId ()));
+  Config::SetDefault ("ns3::MpTcpSocketBase::MaxSubflows", UintegerValue (8));
+  Config::SetDefault ("ns3::MpTcpSocketBase::TraceFile", StringValue (trace));
+  Config::SetDefault ("ns3::HttpClientApplication::OutfileMode", StringValue (mode));
+  g_checksum = (mode == "Checksum");
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue (rate));
+  p2p.SetChannelAttribute ("Delay", StringValue (delay));
+  NetDeviceContainer d0 = p2p.Install (nodes);
+  if (!delay2.empty ())
+    {
+      p2p.SetChannelAttribute ("Delay", StringValue (delay2));
+    }
+  NetDeviceContainer d1 = p2p.Install (nodes);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer i0 = ipv4.Assign (d0);
+  ipv4.SetBase ("10.0.1.0", "255.255.255.0");
+  ipv4.Assign (d1);
+
+  // one virtual file per client, described by a meta data file
+  std::string metaFile = "bench-mptcp-http.csv";
+  std::ofstream meta (metaFile.c_str ());
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      meta << "file" << i << ".bin," << size << std::endl;
+    }
+  meta.close ();
+
+  HttpServerHelper server (Ipv4Address::GetAny (), 80, "/", "localhost");
+  server.SetAttribute ("MetaDataFile", StringValue (metaFile));
+  server.SetAttribute ("MetaDataDirectory", StringValue (""));
+  ApplicationContainer serverApps = server.Install (nodes.Get (1));
+  serverApps.Start (Seconds (0.0));
+
+  ApplicationContainer clientApps;
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      std::ostringstream file;
+      file << "file" << i << ".bin";
+      HttpClientHelper client (i0.GetAddress (1), 80, file.str (), "localhost");
+      if (!outfile.empty ())
+        {
+          std::ostringstream out;
+          out << outfile << i;
+          client.SetAttribute ("WriteOutfile", StringValue (out.str ()));
+        }
+      ApplicationContainer app = client.Install (nodes.Get (0));
+      app.Get (0)->TraceConnectWithoutContext ("FileDownloadFinished", MakeCallback (&DownloadFinished));
+      app.Get (0)->TraceConnectWithoutContext ("HeaderReceived", MakeCallback (&HeaderReceived));
+      clientApps.Add (app);
+    }
+  clientApps.Start (Seconds (1.0));
+
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Stop (Seconds (1000.0));
+  Simulator::Run ();
+  double wall = time.End () / 1000.0;
+  Simulator::Destroy ();
+
+  remove (metaFile.c_str ());
+
+  std::cout << "downloads: " << g_downloads << "/" << count
+            << " payload: " << g_bytes << " bytes"
+            << " sim-time: " << g_lastFinish << " s"
+            << " wall-time: " << wall << " s" << std::endl;
+  if (wall > 0)
+    {
+      std::cout << (g_bytes / wall / 1000000.0) << " MB/s (payload per wall-clock second)" << std::endl;
+    }
+  return 0;
+}
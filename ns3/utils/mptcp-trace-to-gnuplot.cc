@@ -0,0 +1,229 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Offline converter of MpTcpSocketBase trace files (TraceFile attribute)
+// into gnuplot scripts.
+//
+// For every connection in --input (or only --connection) it writes the
+// cwnd, ssthresh, RTT and RTO of each subflow over time and the number of
+// data packets each subflow sent, the plots MpTcpSocketBase used to
+// generate at the end of the run, and prints how many records of each type
+// the connection has.
+
+#include "ns3/core-module.h"
+#include "ns3/gnuplot.h"
+#include "ns3/mp-tcp-trace-sink.h"
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+struct SubflowPlots
+{
+  SubflowPlots ()
+    : segmentSize (1),
+      packets (0),
+      cwndPoints (0),
+      rttPoints (0)
+  {
+  }
+  double segmentSize;
+  uint64_t packets;
+  uint64_t cwndPoints;
+  uint64_t rttPoints;
+  Gnuplot2dDataset cwnd;
+  Gnuplot2dDataset ssthresh;
+  Gnuplot2dDataset rtt;
+  Gnuplot2dDataset rto;
+};
+
+struct ConnectionPlots
+{
+  ConnectionPlots ()
+    : node (0),
+      counts (MpTcpTraceSink::RECORD_TYPES, 0)
+  {
+  }
+  uint32_t node;
+  std::vector<uint64_t> counts;
+  std::map<uint16_t, SubflowPlots> subflows;
+};
+
+static Gnuplot
+MakePlot (std::string file, std::string ylabel, std::string title, uint32_t connection, uint32_t node)
+{
+  Gnuplot plot;
+  std::ostringstream extra;
+  extra << "set terminal postscript eps enhanced color solid font 'Times-Bold,15'\n"
+        << "set output \"" << file << "-" << connection << ".eps\"\n"
+        << "set xlabel \"Time (s)\" offset 0,-1\n"
+        << "set ylabel \"" << ylabel << "\" offset 0,0\n"
+        << "set grid\n"
+        << "set lmargin 10.0\n"
+        << "set rmargin 5.0\n"
+        << "set key bmargin center horizontal Left reverse noenhanced autotitles columnhead nobox\n";
+  plot.AppendExtra (extra.str ());
+  std::ostringstream detail;
+  detail << title << "\\n\\nNode[" << node << "]  Connection[" << connection << "]";
+  plot.SetTitle (detail.str ());
+  return plot;
+}
+
+static void
+AddSubflowDataset (Gnuplot &plot, Gnuplot2dDataset dataset, std::string name, uint16_t subflow,
+                   Gnuplot2dDataset::Style style)
+{
+  std::ostringstream title;
+  title << name << " " << subflow;
+  dataset.SetTitle (title.str ());
+  dataset.SetStyle (style);
+  plot.AddDataset (dataset);
+}
+
+int main (int argc, char *argv[])
+{
+  std::string input = "mptcp-trace.bin";
+  std::string output = "";
+  int64_t only = -1;
+
+  CommandLine cmd;
+  cmd.AddValue ("input", "Trace file written by MpTcpSocketBase (TraceFile attribute)", input);
+  cmd.AddValue ("output", "Gnuplot script to write, <input>.plt if empty", output);
+  cmd.AddValue ("connection", "Only convert this connection id (-1 for all)", only);
+  cmd.Parse (argc, argv);
+  if (output.empty ())
+    {
+      output = input + ".plt";
+    }
+
+  MpTcpTraceReader reader (input);
+  if (!reader.IsOpen ())
+    {
+      std::cerr << input << " is not an MPTCP trace file" << std::endl;
+      return 1;
+    }
+  std::cout << input << ": " << reader.GetNRecords () << " records";
+  if (reader.GetNLost () > 0)
+    {
+      std::cout << " (" << reader.GetNLost () << " older ones overwritten in the ring)";
+    }
+  std::cout << std::endl;
+
+  std::map<uint32_t, ConnectionPlots> connections;
+  MpTcpTraceSink::Record r;
+  while (reader.Next (r))
+    {
+      if ((only >= 0 && r.connection != only) || r.type >= MpTcpTraceSink::RECORD_TYPES)
+        {
+          continue;
+        }
+      ConnectionPlots &c = connections[r.connection];
+      c.counts[r.type]++;
+      SubflowPlots &sf = c.subflows[r.subflow];
+      switch (r.type)
+        {
+        case MpTcpTraceSink::CONNECTION:
+          c.node = r.value;
+          break;
+        case MpTcpTraceSink::SEGMENT_SIZE:
+          sf.segmentSize = r.value;
+          break;
+        case MpTcpTraceSink::CWND:
+          sf.cwnd.Add (r.time, r.value / sf.segmentSize);
+          sf.cwndPoints++;
+          break;
+        case MpTcpTraceSink::SSTHRESH:
+          sf.ssthresh.Add (r.time, r.value);
+          break;
+        case MpTcpTraceSink::AVG_RTT:
+          sf.rtt.Add (r.time, r.value);
+          sf.rttPoints++;
+          break;
+        case MpTcpTraceSink::RTO:
+          sf.rto.Add (r.time, r.value);
+          break;
+        case MpTcpTraceSink::DATA:
+          sf.packets++;
+          break;
+        default:
+          break;
+        }
+    }
+
+  // Each plot sets its own eps output
+  GnuplotCollection gnu ("");
+  for (std::map<uint32_t, ConnectionPlots>::iterator it = connections.begin (); it != connections.end (); ++it)
+    {
+      uint32_t id = it->first;
+      ConnectionPlots &c = it->second;
+      std::cout << "connection " << id << " node " << c.node << ":";
+      for (uint16_t type = 0; type < MpTcpTraceSink::RECORD_TYPES; type++)
+        {
+          if (c.counts[type] > 0)
+            {
+              std::cout << " " << MpTcpTraceSink::GetRecordName (type) << "=" << c.counts[type];
+            }
+        }
+      std::cout << std::endl;
+
+      Gnuplot cwnd = MakePlot ("cwnd", "Cwnd (pkts)", "Congestion Window vs Time", id, c.node);
+      Gnuplot sst = MakePlot ("sst", "ssthreshold (bytes)", "Slow Start Threshold vs Time", id, c.node);
+      Gnuplot rtt = MakePlot ("rtt", "RTT (ms)", "RTT vs Time", id, c.node);
+      Gnuplot rto = MakePlot ("rto", "RTO (ms)", "RTO vs Time", id, c.node);
+      Gnuplot pkt = MakePlot ("pkt", "Packets", "Sent Packets per Subflow", id, c.node);
+      pkt.AppendExtra ("set style data histogram\n"
+                       "set style histogram cluster gap 3.0\n"
+                       "set style fill solid\n"
+                       "set boxwidth 2.0\n"
+                       "set xlabel \"Subflow Id\\n\" offset 0,-1\n"
+                       "unset key\n");
+      Gnuplot2dDataset packets;
+      packets.SetStyle (Gnuplot2dDataset::MKS);
+      packets.SetTitle ("");
+      packets.SetExtra (" using 2:xtic(1) lc 62\n");
+      for (std::map<uint16_t, SubflowPlots>::iterator s = c.subflows.begin (); s != c.subflows.end (); ++s)
+        {
+          SubflowPlots &sf = s->second;
+          if (sf.cwndPoints > 0)
+            {
+              AddSubflowDataset (cwnd, sf.cwnd, "SF", s->first, Gnuplot2dDataset::LINES_POINTS);
+              AddSubflowDataset (sst, sf.ssthresh, "SST", s->first, Gnuplot2dDataset::LINES);
+            }
+          if (sf.rttPoints > 0)
+            {
+              AddSubflowDataset (rtt, sf.rtt, "RTT", s->first, Gnuplot2dDataset::LINES_POINTS);
+              AddSubflowDataset (rto, sf.rto, "RTO", s->first, Gnuplot2dDataset::LINES_POINTS);
+            }
+          packets.Add (s->first, sf.packets);
+        }
+      pkt.AddDataset (packets);
+      gnu.AddPlot (cwnd);
+      gnu.AddPlot (sst);
+      gnu.AddPlot (rtt);
+      gnu.AddPlot (rto);
+      gnu.AddPlot (pkt);
+    }
+
+  std::ofstream out (output.c_str ());
+  gnu.GenerateOutput (out);
+  std::cout << "wrote " << output << std::endl;
+  return 0;
+}